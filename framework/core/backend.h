@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Platform the frame loop of Game runs on: window, input, device and presentation.
+// D3D12Backend is a window with Render, NullBackend runs the loop without a window or GPU.
+// Backend stops the loop as the window does, with Game::set_destroy and Game::set_animating(false).
+class Backend
+{
+public:
+    virtual ~Backend() = default;
+
+    virtual bool initialize(uint32_t width, uint32_t height) = 0;
+    virtual void destroy() = 0;
+
+    // Game::win and Game::render are valid only if false
+    virtual bool headless() const = 0;
+
+    // platform messages and input of the frame
+    virtual void poll() = 0;
+    // after the frame, input of this frame is consumed
+    virtual void end_poll() = 0;
+
+    virtual void prepare_frame() = 0;
+    virtual void submit_uploads() = 0;
+    // work recorded by the component after this call is submitted after lower components
+    virtual void begin_component(uint32_t component) = 0;
+    virtual void end_frame() = 0;
+    // false if there is no ui, component imgui isn't called then
+    virtual bool prepare_imgui() = 0;
+    virtual void end_imgui() = 0;
+    virtual void present() = 0;
+
+    virtual void resize() = 0;
+    virtual void fullscreen(bool fullscreen) = 0;
+
+    // render and components are initialized, startup_ms is the time it took
+    virtual void startup_done(float startup_ms) = 0;
+    // line of the log: debugger output or console
+    virtual void output(const char* text) = 0;
+};
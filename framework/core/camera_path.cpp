@@ -0,0 +1,178 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "camera_path.h"
+
+namespace
+{
+
+constexpr char file_magic[4] = { 'C', 'A', 'M', 'P' };
+constexpr uint32_t file_version = 1;
+// guards allocations of a broken file
+constexpr uint32_t max_frame_transforms = 1u << 16;
+
+bool write_floats(FILE* file, const float* values, size_t count)
+{
+    return fwrite(values, sizeof(float), count, file) == count;
+}
+
+bool read_floats(FILE* file, float* values, size_t count)
+{
+    return fread(values, sizeof(float), count, file) == count;
+}
+
+} // namespace
+
+void CameraPath::set_timestep(float timestep)
+{
+    assert(timestep > 0.f);
+    timestep_ = timestep;
+}
+
+void CameraPath::start_recording()
+{
+    frames_.clear();
+    cursor_ = 0;
+    next_ = 0;
+    mode_ = Mode::record;
+}
+
+bool CameraPath::start_replay(bool loop)
+{
+    if (frames_.empty()) {
+        return false;
+    }
+    loop_ = loop;
+    cursor_ = 0;
+    next_ = 0;
+    mode_ = Mode::replay;
+    return true;
+}
+
+void CameraPath::stop()
+{
+    mode_ = Mode::off;
+}
+
+void CameraPath::begin_frame()
+{
+    if (mode_ == Mode::record) {
+        frames_.push_back(frames_.empty() ? Frame{} : frames_.back());
+    } else if (mode_ == Mode::replay) {
+        // replay started in the middle of a frame begins with the next one
+        if (next_ == frames_.size()) {
+            next_ = 0;
+            if (!loop_) {
+                mode_ = Mode::off;
+                return;
+            }
+        }
+        cursor_ = next_++;
+    }
+}
+
+void CameraPath::record_camera(const Vector3& position, const Vector3& forward)
+{
+    // recording started in the middle of a frame begins with the next one
+    if (mode_ != Mode::record || frames_.empty()) {
+        return;
+    }
+    frames_.back().position = position;
+    frames_.back().forward = forward;
+}
+
+void CameraPath::record_transform(uint32_t index, const Matrix& transform)
+{
+    if (mode_ != Mode::record || frames_.empty()) {
+        return;
+    }
+    assert(index < max_frame_transforms);
+    std::vector<Matrix>& transforms = frames_.back().transforms;
+    if (transforms.size() <= index) {
+        transforms.resize(index + 1, Matrix::Identity);
+    }
+    transforms[index] = transform;
+}
+
+const CameraPath::Frame* CameraPath::replay_frame() const
+{
+    return mode_ == Mode::replay ? &frames_[cursor_] : nullptr;
+}
+
+Matrix CameraPath::frame_transform(uint32_t index, const Matrix& live)
+{
+    const Frame* replayed = replay_frame();
+    const Matrix transform = replayed != nullptr && index < replayed->transforms.size() ? replayed->transforms[index] : live;
+    record_transform(index, transform);
+    return transform;
+}
+
+bool CameraPath::save(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const uint32_t frame_count = uint32_t(frames_.size());
+    bool written = fwrite(file_magic, sizeof(file_magic), 1, file) == 1 &&
+                   fwrite(&file_version, sizeof(file_version), 1, file) == 1 &&
+                   write_floats(file, &timestep_, 1) &&
+                   fwrite(&frame_count, sizeof(frame_count), 1, file) == 1;
+    for (const Frame& frame : frames_) {
+        if (!written) {
+            break;
+        }
+        const uint32_t transform_count = uint32_t(frame.transforms.size());
+        written = write_floats(file, &frame.position.x, 3) &&
+                  write_floats(file, &frame.forward.x, 3) &&
+                  fwrite(&transform_count, sizeof(transform_count), 1, file) == 1;
+        for (const Matrix& transform : frame.transforms) {
+            written = written && write_floats(file, &transform._11, 16);
+        }
+    }
+    return fclose(file) == 0 && written;
+}
+
+bool CameraPath::load(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    char magic[4];
+    uint32_t version = 0;
+    float timestep = 0.f;
+    uint32_t frame_count = 0;
+    bool read = fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, file_magic, sizeof(magic)) == 0 &&
+                fread(&version, sizeof(version), 1, file) == 1 && version == file_version &&
+                read_floats(file, &timestep, 1) && timestep > 0.f &&
+                fread(&frame_count, sizeof(frame_count), 1, file) == 1;
+
+    std::vector<Frame> frames;
+    for (uint32_t i = 0; read && i < frame_count; ++i) {
+        Frame frame;
+        uint32_t transform_count = 0;
+        read = read_floats(file, &frame.position.x, 3) &&
+               read_floats(file, &frame.forward.x, 3) &&
+               fread(&transform_count, sizeof(transform_count), 1, file) == 1 && transform_count <= max_frame_transforms;
+        if (read) {
+            frame.transforms.resize(transform_count);
+        }
+        for (Matrix& transform : frame.transforms) {
+            read = read && read_floats(file, &transform._11, 16);
+        }
+        frames.push_back(std::move(frame));
+    }
+    fclose(file);
+    if (!read) {
+        return false;
+    }
+
+    stop();
+    timestep_ = timestep;
+    frames_ = std::move(frames);
+    cursor_ = 0;
+    next_ = 0;
+    return true;
+}
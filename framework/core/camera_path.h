@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <SimpleMath.h>
+using namespace DirectX::SimpleMath;
+
+// Camera and object transforms of every frame, recorded from live input and replayed with a fixed timestep,
+// so benchmark runs of different builds see the same frames. Game begins a path frame with every frame,
+// the camera owner and components write the state of the frame while recording and read it while replaying.
+// Files are little endian: "CAMP", version, timestep, frame count, then per frame position, forward,
+// transform count and row major transforms as floats.
+class CameraPath
+{
+public:
+    enum class Mode : uint32_t
+    {
+        off,
+        record,
+        replay,
+    };
+
+    struct Frame
+    {
+        Vector3 position;
+        Vector3 forward;
+        // by owner order, e.g. model trees or instances
+        std::vector<Matrix> transforms;
+    };
+
+    Mode mode() const { return mode_; }
+    bool recording() const { return mode_ == Mode::record; }
+    bool replaying() const { return mode_ == Mode::replay; }
+
+    // replaced delta time of replayed frames, seconds
+    float timestep() const { return timestep_; }
+    void set_timestep(float timestep);
+
+    // drops recorded frames
+    void start_recording();
+    // false without frames
+    bool start_replay(bool loop = false);
+    void stop();
+
+    // called by Game before every frame, adds the recorded frame or moves to the next replayed one
+    void begin_frame();
+
+    // recorded frame, state of a frame without records repeats the previous one
+    void record_camera(const Vector3& position, const Vector3& forward);
+    void record_transform(uint32_t index, const Matrix& transform);
+    // replayed frame, nullptr if not replaying
+    const Frame* replay_frame() const;
+    // transform of the owner for this frame: replayed one if the frame has it, otherwise live; recorded either way
+    Matrix frame_transform(uint32_t index, const Matrix& live);
+
+    size_t frame_count() const { return frames_.size(); }
+    // frame of the path the replay is at
+    size_t cursor() const { return cursor_; }
+    const std::vector<Frame>& frames() const { return frames_; }
+
+    bool save(const std::string& path) const;
+    // stops, frames stay as they were on failure
+    bool load(const std::string& path);
+private:
+    Mode mode_{ Mode::off };
+    float timestep_{ 1.f / 60.f };
+    bool loop_{ false };
+
+    std::vector<Frame> frames_;
+    size_t cursor_{ 0 };
+    size_t next_{ 0 };
+};
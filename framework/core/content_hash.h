@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// FNV-1a over the bytes fed in order, stable between runs and builds so hashes can name files on disk
+class ContentHasher
+{
+public:
+    void add(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            value_ ^= bytes[i];
+            value_ *= 1099511628211ull;
+        }
+    }
+    template<class T>
+    void add(const T& value)
+    {
+        add(&value, sizeof(T));
+    }
+    // null is hashed as empty string, terminator separates successive strings
+    void add_string(const char* string)
+    {
+        if (string == nullptr) {
+            string = "";
+        }
+        add(string, strlen(string) + 1);
+    }
+
+    uint64_t value() const { return value_; }
+private:
+    uint64_t value_{ 14695981039346656037ull };
+};
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+#include "frame_timings.h"
+
+// static
+const char* FrameTimings::column_name(uint32_t column)
+{
+    static const char* names[column_count] = {
+        "input", "prepare", "update", "uploads", "draw", "record", "imgui", "present", "frame"
+    };
+    assert(column < column_count);
+    return names[column];
+}
+
+FrameTimings::FrameTimings(uint32_t window, uint32_t history)
+    : window_(std::max(window, 1u)), history_(std::max(history, window_))
+{
+}
+
+void FrameTimings::add(Phase phase, double ms)
+{
+    assert(phase < phase_count);
+    current_[phase] += ms;
+}
+
+void FrameTimings::end_frame(double frame_ms)
+{
+    Frame frame;
+    frame.index = frames_;
+    for (uint32_t phase = 0; phase < phase_count; ++phase) {
+        frame.ms[phase] = float(current_[phase]);
+        current_[phase] = 0.0;
+    }
+    frame.ms[frame_column] = float(frame_ms);
+
+    if (frames_ring_.size() < history_) {
+        frames_ring_.push_back(frame);
+    } else {
+        frames_ring_[frames_ % history_] = frame;
+    }
+    ++frames_;
+}
+
+void FrameTimings::clear()
+{
+    std::fill(std::begin(current_), std::end(current_), 0.0);
+    frames_ring_.clear();
+    frames_ = 0;
+}
+
+const FrameTimings::Frame& FrameTimings::recent(uint64_t count, uint64_t i) const
+{
+    assert(count <= frames_ring_.size() && i < count);
+    return frames_ring_[(frames_ - count + i) % frames_ring_.size()];
+}
+
+FrameTimings::Summary FrameTimings::summarize(uint32_t column, uint64_t count) const
+{
+    assert(column < column_count);
+    Summary summary;
+    summary.frames = count;
+    if (count == 0) {
+        return summary;
+    }
+
+    std::vector<float> values(count);
+    double total = 0.0;
+    for (uint64_t i = 0; i < count; ++i) {
+        values[i] = recent(count, i).ms[column];
+        total += values[i];
+    }
+    std::sort(values.begin(), values.end());
+
+    // nearest rank
+    const auto percentile = [&values](double p) {
+        const size_t rank = size_t(std::ceil(p * values.size()));
+        return double(values[std::max<size_t>(rank, 1) - 1]);
+    };
+    summary.mean_ms = total / count;
+    summary.p50_ms = percentile(0.50);
+    summary.p95_ms = percentile(0.95);
+    summary.p99_ms = percentile(0.99);
+    summary.max_ms = values.back();
+    return summary;
+}
+
+FrameTimings::Summary FrameTimings::window_summary(uint32_t column) const
+{
+    return summarize(column, std::min<uint64_t>(window_, frames_ring_.size()));
+}
+
+FrameTimings::Summary FrameTimings::history_summary(uint32_t column) const
+{
+    return summarize(column, frames_ring_.size());
+}
+
+std::vector<float> FrameTimings::window_values(uint32_t column) const
+{
+    assert(column < column_count);
+    const uint64_t count = std::min<uint64_t>(window_, frames_ring_.size());
+    std::vector<float> values(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        values[i] = recent(count, i).ms[column];
+    }
+    return values;
+}
+
+std::vector<float> FrameTimings::window_histogram(uint32_t column, uint32_t bucket_count, float max_ms) const
+{
+    std::vector<float> buckets(bucket_count, 0.f);
+    if (bucket_count == 0 || max_ms <= 0.f) {
+        return buckets;
+    }
+    for (float ms : window_values(column)) {
+        const uint32_t bucket = uint32_t(std::max(ms, 0.f) / max_ms * bucket_count);
+        buckets[std::min(bucket, bucket_count - 1)] += 1.f;
+    }
+    return buckets;
+}
+
+std::string FrameTimings::report() const
+{
+    std::stringstream ss;
+    ss << frames_ring_.size() << " of " << frames_ << " frames\n";
+    ss << std::left << std::setw(10) << "phase" << std::right << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms"
+       << std::setw(10) << "p95 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << "\n";
+    ss << std::fixed << std::setprecision(3);
+    for (uint32_t column = 0; column < column_count; ++column) {
+        const Summary summary = history_summary(column);
+        ss << std::left << std::setw(10) << column_name(column) << std::right << std::setw(10) << summary.mean_ms
+           << std::setw(10) << summary.p50_ms << std::setw(10) << summary.p95_ms << std::setw(10) << summary.p99_ms
+           << std::setw(10) << summary.max_ms << "\n";
+    }
+    return ss.str();
+}
+
+bool FrameTimings::write_csv(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fputs("frame", file);
+    for (uint32_t column = 0; column < column_count; ++column) {
+        fprintf(file, ",%s_ms", column_name(column));
+    }
+    fputc('\n', file);
+
+    const uint64_t count = frames_ring_.size();
+    for (uint64_t i = 0; i < count; ++i) {
+        const Frame& frame = recent(count, i);
+        fprintf(file, "%llu", (unsigned long long)frame.index);
+        for (uint32_t column = 0; column < column_count; ++column) {
+            fprintf(file, ",%.4f", frame.ms[column]);
+        }
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+bool FrameTimings::write_json(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "{\"frames\":%llu,\"kept_frames\":%llu,\"columns\":{\n",
+        (unsigned long long)frames_, (unsigned long long)frames_ring_.size());
+    for (uint32_t column = 0; column < column_count; ++column) {
+        const Summary summary = history_summary(column);
+        fprintf(file, "\"%s\":{\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p95_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f}%s\n",
+            column_name(column), summary.mean_ms, summary.p50_ms, summary.p95_ms, summary.p99_ms, summary.max_ms,
+            column + 1 < column_count ? "," : "");
+    }
+    fputs("}}\n", file);
+    return fclose(file) == 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// CPU milliseconds of every frame by phase of Game::run, kept for the whole run up to history frames.
+// Percentiles of the last window frames are for the panel and the FPS line, exports summarize all kept frames
+// and list them one per row, so regression jobs get the same numbers on D3D12 and headless backends.
+class FrameTimings
+{
+public:
+    enum Phase : uint32_t
+    {
+        input,      // poll and end_poll
+        prepare,    // prepare_frame, waits for the frame slot
+        update,
+        uploads,    // submit_uploads
+        draw,       // components queue recording tasks
+        record,     // end_frame, records and submits command lists
+        imgui,
+        present,
+        phase_count
+    };
+    // wall time between ends of frames, includes time outside of phases
+    static constexpr uint32_t frame_column = phase_count;
+    static constexpr uint32_t column_count = phase_count + 1;
+
+    static const char* column_name(uint32_t column);
+
+    struct Summary
+    {
+        uint64_t frames{ 0 };
+        double mean_ms{ 0.0 };
+        double p50_ms{ 0.0 };
+        double p95_ms{ 0.0 };
+        double p99_ms{ 0.0 };
+        double max_ms{ 0.0 };
+    };
+
+    class Scope
+    {
+    public:
+        Scope(FrameTimings& timings, Phase phase)
+            : timings_(timings), phase_(phase), begin_(std::chrono::steady_clock::now())
+        {
+        }
+        ~Scope()
+        {
+            timings_.add(phase_, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_).count());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        FrameTimings& timings_;
+        Phase phase_;
+        std::chrono::steady_clock::time_point begin_;
+    };
+
+    explicit FrameTimings(uint32_t window = 1024, uint32_t history = 1u << 18);
+
+    // phase can be added several times a frame, times sum up
+    void add(Phase phase, double ms);
+    void end_frame(double frame_ms);
+    void clear();
+
+    uint64_t frames() const { return frames_; }
+    uint32_t window() const { return window_; }
+
+    // last window frames
+    Summary window_summary(uint32_t column) const;
+    // all kept frames
+    Summary history_summary(uint32_t column) const;
+    // column of the last window frames, oldest first
+    std::vector<float> window_values(uint32_t column) const;
+    // counts of the last window frames in buckets of max_ms / bucket_count, last bucket takes the rest
+    std::vector<float> window_histogram(uint32_t column, uint32_t bucket_count, float max_ms) const;
+
+    std::string report() const;
+    // frame number and milliseconds of every column, one row per kept frame
+    bool write_csv(const std::string& path) const;
+    // history summary of every column
+    bool write_json(const std::string& path) const;
+private:
+    struct Frame
+    {
+        uint64_t index;
+        float ms[column_count];
+    };
+
+    // i-th of the last count kept frames, oldest first
+    const Frame& recent(uint64_t count, uint64_t i) const;
+    Summary summarize(uint32_t column, uint64_t count) const;
+
+    uint32_t window_;
+    uint32_t history_;
+
+    double current_[phase_count]{};
+    // ring once history is full
+    std::vector<Frame> frames_ring_;
+    uint64_t frames_{ 0 };
+};
@@ -1,17 +1,16 @@
+#include <algorithm>
+#include <cassert>
 #include <chrono>
+#include <cstdio>
+#include <string>
 #include "game.h"
-#include "win32/win.h"
-#include "win32/input.h"
-#include "render/common.h"
-#include "render/render.h"
+#include "backend.h"
+#include "profiler.h"
 // #include "render/scene/scene.h"
-#include "render/camera.h"
 #include "component/game_component.h"
 
 Game::Game()
 {
-    win_ = std::make_unique<Win>();
-    render_ = std::make_unique<Render>();
     // scene_ = std::make_unique<Scene>();
 }
 
@@ -24,25 +23,43 @@ Game* Game::inst()
 
 Game::~Game()
 {
-    win_.release();
-    render_.release();
 }
 
 void Game::add_component(GameComponent* game_component)
 {
-    game_components_.emplace(game_component);
+    if (std::find(game_components_.begin(), game_components_.end(), game_component) == game_components_.end()) {
+        game_components_.push_back(game_component);
+    }
+}
+
+void Game::set_backend(std::unique_ptr<Backend> backend)
+{
+    assert(!animating_);
+    backend_ = std::move(backend);
+}
+
+Backend& Game::backend() const
+{
+    return *backend_;
 }
 
 bool Game::initialize(uint32_t w, uint32_t h)
 {
-    win_->initialize(w, h);
-    render_->initialize();
+    assert(backend_ != nullptr);
+    PROFILE_ZONE("Initialize");
+    const auto begin = std::chrono::steady_clock::now();
+    if (!backend_->initialize(w, h)) {
+        return false;
+    }
 
     // game components push different stuff to scene
     for (auto game_component : game_components_) {
         game_component->initialize();
     }
 
+    startup_ms_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    backend_->startup_done(startup_ms_);
+
     // initialize after game components
     // scene_->initialize();
 
@@ -52,15 +69,15 @@ bool Game::initialize(uint32_t w, uint32_t h)
 
 void Game::run()
 {
+    // first frame is timed from here
+    auto prev_time = std::chrono::steady_clock::now();
     while (!destroy_)
     {
-        // handle win messages
-        win_->run();
-
-        // process input queue
-        Input* input = win_->input();
         {
-            input->process_win_input();
+            // handle win messages and input queue
+            PROFILE_ZONE("Poll");
+            FrameTimings::Scope timing(frame_timings_, FrameTimings::input);
+            backend_->poll();
         }
 
         if (!animating_) {
@@ -68,12 +85,18 @@ void Game::run()
         }
 
         {
+            PROFILE_ZONE("Frame");
+            camera_path_.begin_frame();
             // prepares
             {
-                render_->prepare_frame();
+                PROFILE_ZONE("Prepare frame");
+                FrameTimings::Scope timing(frame_timings_, FrameTimings::prepare);
+                backend_->prepare_frame();
             }
 
             { // update components
+                PROFILE_ZONE("Update");
+                FrameTimings::Scope timing(frame_timings_, FrameTimings::update);
                 // scene_->update();
                 for (auto game_component : game_components_)
                 {
@@ -82,52 +105,74 @@ void Game::run()
             }
 
             {
+                PROFILE_ZONE("Submit uploads");
+                FrameTimings::Scope timing(frame_timings_, FrameTimings::uploads);
+                backend_->submit_uploads();
+            }
+
+            {
+                PROFILE_ZONE("Draw");
+                FrameTimings::Scope timing(frame_timings_, FrameTimings::draw);
                 // scene_->draw();
-                for (auto game_component : game_components_)
+                // components queue recording tasks, lists are recorded and submitted in end_frame
+                for (uint32_t i = 0; i < game_components_.size(); ++i)
                 {
-                    game_component->draw();
+                    backend_->begin_component(i);
+                    game_components_[i]->draw();
                 }
             }
 
             {
-                render_->end_frame();
+                PROFILE_ZONE("End frame");
+                FrameTimings::Scope timing(frame_timings_, FrameTimings::record);
+                backend_->end_frame();
             }
 
             // Handle components imgui
             {
-                render_->prepare_imgui();
-                for (auto game_component : game_components_)
-                {
-                    game_component->imgui();
+                PROFILE_ZONE("ImGui");
+                FrameTimings::Scope timing(frame_timings_, FrameTimings::imgui);
+                if (backend_->prepare_imgui()) {
+                    for (auto game_component : game_components_)
+                    {
+                        game_component->imgui();
+                    }
                 }
-                render_->end_imgui();
+                backend_->end_imgui();
             }
             {
-                render_->present();
+                PROFILE_ZONE("Present");
+                FrameTimings::Scope timing(frame_timings_, FrameTimings::present);
+                backend_->present();
             }
         }
 
         // clear keyboard
         {
-            win_->input()->clear_after_process();
+            FrameTimings::Scope timing(frame_timings_, FrameTimings::input);
+            backend_->end_poll();
         }
 
         // handle FPS
         {
-            static auto prev_time {
-                std::chrono::steady_clock::now()
-            };
             static float total_time = 0;
             static uint32_t frame_count = 0;
             auto cur_time = std::chrono::steady_clock::now();
-            delta_time_ = std::chrono::duration_cast<std::chrono::microseconds>(cur_time - prev_time).count() / 1e6f;
+            const float frame_time = std::chrono::duration_cast<std::chrono::microseconds>(cur_time - prev_time).count() / 1e6f;
+            // movement scaled by delta time is the same in every replay, FPS is still measured on the wall clock
+            delta_time_ = camera_path_.replaying() ? camera_path_.timestep() : frame_time;
+            frame_timings_.end_frame(std::chrono::duration<double, std::milli>(cur_time - prev_time).count());
             prev_time = cur_time;
 
-            total_time += delta_time_;
+            total_time += frame_time;
             frame_count++;
 
             if (total_time > 1.0f) {
-                OutputDebugString(("FPS: " + std::to_string(frame_count / total_time) + "\n").c_str());
+                const FrameTimings::Summary frame = frame_timings_.window_summary(FrameTimings::frame_column);
+                char line[128];
+                snprintf(line, sizeof(line), "FPS: %.1f, frame p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                    frame_count / total_time, frame.p50_ms, frame.p99_ms, frame.max_ms);
+                backend_->output(line);
                 total_time -= 1.0f;
                 frame_count = 0;
             }
@@ -146,8 +191,11 @@ void Game::destroy()
     }
     game_components_.clear();
 
-    render_->destroy_resources();
-    win_->destroy();
+    if (!frame_timings_path_.empty() && !export_frame_timings()) {
+        backend_->output(("Can't write frame timings to " + frame_timings_path_ + "\n").c_str());
+    }
+
+    backend_->destroy();
 }
 
 float Game::delta_time() const
@@ -155,40 +203,60 @@ float Game::delta_time() const
     return delta_time_;
 }
 
-void Game::set_animating(bool animating)
+float Game::startup_ms() const
 {
-    animating_ = animating;
+    return startup_ms_;
 }
 
-void Game::set_destroy()
+FrameTimings& Game::frame_timings()
 {
-    destroy_ = true;
+    return frame_timings_;
 }
 
-void Game::resize()
+const FrameTimings& Game::frame_timings() const
 {
-    render_->resize();
+    return frame_timings_;
 }
 
-void Game::toggle_fullscreen()
+void Game::set_frame_timings_path(const std::string& path)
 {
-    fullscreen_ = !fullscreen_;
-    render_->fullscreen(fullscreen_);
+    frame_timings_path_ = path;
 }
 
-const Win& Game::win() const
+bool Game::export_frame_timings() const
 {
-    return *win_;
+    if (frame_timings_path_.empty()) {
+        return false;
+    }
+    const bool csv = frame_timings_.write_csv(frame_timings_path_ + ".csv");
+    const bool json = frame_timings_.write_json(frame_timings_path_ + ".json");
+    return csv && json;
 }
 
-const Render& Game::render() const
+CameraPath& Game::camera_path()
 {
-    return *render_;
+    return camera_path_;
 }
 
-Render& Game::render()
+void Game::set_animating(bool animating)
+{
+    animating_ = animating;
+}
+
+void Game::set_destroy()
 {
-    return *render_;
+    destroy_ = true;
+}
+
+void Game::resize()
+{
+    backend_->resize();
+}
+
+void Game::toggle_fullscreen()
+{
+    fullscreen_ = !fullscreen_;
+    backend_->fullscreen(fullscreen_);
 }
 
 // Scene& Game::scene() const
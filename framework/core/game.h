@@ -2,27 +2,41 @@
 
 #include <cstdint>
 #include <memory>
-#include <unordered_set>
+#include <string>
+#include <vector>
+
+#include "camera_path.h"
+#include "frame_timings.h"
 
 class Win;
 class Render;
+class Backend;
 class GameComponent;
 // class Scene;
 
 class Game
 {
 private:
-    std::unique_ptr<Win> win_;
-    std::unique_ptr<Render> render_;
+    // window and Render by default, set_backend replaces it before initialize
+    std::unique_ptr<Backend> backend_;
     // std::unique_ptr<Scene> scene_;
 
     float delta_time_{ 0.f };
+    // backend and components initialization, pipelines from the library make it shorter
+    float startup_ms_{ 0.f };
+
+    FrameTimings frame_timings_;
+    // csv and json are written there on destroy and export_frame_timings, no export if empty
+    std::string frame_timings_path_;
+    // delta time is the path timestep while replaying
+    CameraPath camera_path_;
 
     bool destroy_{ false };
     bool animating_{ false };
     bool fullscreen_{ false };
 
-    std::unordered_set<GameComponent*> game_components_;
+    // in add order, which is also the submission order of their command lists
+    std::vector<GameComponent*> game_components_;
 
     Game();
     Game(Game&) = delete;
@@ -32,18 +46,30 @@ public:
     ~Game();
 
     virtual void add_component(GameComponent*);
+    void set_backend(std::unique_ptr<Backend> backend);
+    Backend& backend() const;
 
     virtual bool initialize(uint32_t, uint32_t);
     virtual void run();
     virtual void destroy();
 
     float delta_time() const;
+    float startup_ms() const;
+
+    FrameTimings& frame_timings();
+    const FrameTimings& frame_timings() const;
+    // path without extension, <path>.csv and <path>.json
+    void set_frame_timings_path(const std::string& path);
+    bool export_frame_timings() const;
+
+    CameraPath& camera_path();
 
     void set_animating(bool);
     void set_destroy();
     void resize();
     void toggle_fullscreen();
 
+    // D3D12 backend only
     const Win& win() const;
     const Render& render() const;
     Render& render();
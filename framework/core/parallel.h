@@ -0,0 +1,36 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// number of workers for count items with at least grain items per worker
+inline uint32_t parallel_worker_count(uint32_t count, uint32_t grain)
+{
+    const uint32_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    return std::max(std::min(hardware, count / std::max(grain, 1u)), 1u);
+}
+
+// splits [0, count) to worker_count contiguous ranges and calls fn(begin, end, worker)
+// ranges depend only on count and worker_count, so per worker results merged in worker order are deterministic
+template<class F>
+void parallel_for_ranges(uint32_t count, uint32_t worker_count, F&& fn)
+{
+    if (worker_count <= 1) {
+        fn(0u, count, 0u);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count - 1);
+    for (uint32_t i = 1; i < worker_count; ++i) {
+        const uint32_t begin = uint32_t(uint64_t(count) * i / worker_count);
+        const uint32_t end = uint32_t(uint64_t(count) * (i + 1) / worker_count);
+        workers.emplace_back([&fn, begin, end, i]() { fn(begin, end, i); });
+    }
+    fn(0u, uint32_t(uint64_t(count) / worker_count), 0u);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+#include "profiler.h"
+
+namespace
+{
+
+void write_json_string(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (; *text != '\0'; ++text) {
+        if (*text == '"' || *text == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+} // namespace
+
+Profiler::Profiler()
+    : start_ticks_(now()), start_time_(std::chrono::steady_clock::now())
+{
+}
+
+// static
+Profiler& Profiler::inst()
+{
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::LaneOwner::~LaneOwner()
+{
+    if (lane != nullptr) {
+        thread_lane_ = nullptr;
+        Profiler::inst().release_lane(lane);
+    }
+}
+
+// static
+Profiler::Lane* Profiler::acquire_lane()
+{
+    thread_local LaneOwner owner;
+    Profiler& profiler = inst();
+    std::lock_guard<std::mutex> lock(profiler.mutex_);
+    if (!profiler.free_lanes_.empty()) {
+        // lowest free lane, workers of one parallel call keep the same tracks
+        auto lowest = std::min_element(profiler.free_lanes_.begin(), profiler.free_lanes_.end(),
+            [](const Lane* a, const Lane* b) { return a->id < b->id; });
+        owner.lane = *lowest;
+        profiler.free_lanes_.erase(lowest);
+    } else {
+        profiler.lanes_.push_back(std::make_unique<Lane>());
+        profiler.lanes_.back()->id = uint32_t(profiler.lanes_.size() - 1);
+        owner.lane = profiler.lanes_.back().get();
+    }
+    thread_lane_ = owner.lane;
+    return owner.lane;
+}
+
+void Profiler::release_lane(Lane* lane)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_lanes_.push_back(lane);
+}
+
+double Profiler::ticks_to_ms(uint64_t ticks) const
+{
+#if defined(PROFILER_RDTSC)
+    const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time_).count();
+    const uint64_t elapsed_ticks = now() - start_ticks_;
+    return elapsed_ticks == 0 ? 0.0 : ticks * elapsed_ms / double(elapsed_ticks);
+#else
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::duration(ticks)).count();
+#endif
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::unique_ptr<Lane>& lane : lanes_) {
+        lane->first = lane->count.load(std::memory_order_acquire);
+    }
+}
+
+std::vector<std::pair<uint32_t, ProfileEvent>> Profiler::collect() const
+{
+    std::vector<std::pair<uint32_t, ProfileEvent>> events;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::unique_ptr<Lane>& lane : lanes_) {
+        const uint64_t count = lane->count.load(std::memory_order_acquire);
+        const uint64_t first = std::max(lane->first, count > events_per_thread ? count - events_per_thread : 0);
+        for (uint64_t i = first; i < count; ++i) {
+            events.emplace_back(lane->id, lane->events[i & (events_per_thread - 1)]);
+        }
+    }
+    return events;
+}
+
+std::vector<ProfileZoneStats> Profiler::zone_stats() const
+{
+    const double ms_per_tick = ticks_to_ms(1000000) / 1000000.0;
+
+    // same literal can have different addresses in different translation units
+    std::unordered_map<std::string, ProfileZoneStats> zones;
+    for (const auto& [lane, event] : collect()) {
+        const double ms = (event.end - event.begin) * ms_per_tick;
+        ProfileZoneStats& zone = zones[event.name];
+        if (zone.count == 0) {
+            zone.name = event.name;
+            zone.min_ms = ms;
+            zone.max_ms = ms;
+        }
+        ++zone.count;
+        zone.total_ms += ms;
+        zone.min_ms = std::min(zone.min_ms, ms);
+        zone.max_ms = std::max(zone.max_ms, ms);
+    }
+
+    std::vector<ProfileZoneStats> stats;
+    stats.reserve(zones.size());
+    for (auto& [name, zone] : zones) {
+        stats.push_back(std::move(zone));
+    }
+    std::sort(stats.begin(), stats.end(), [](const ProfileZoneStats& a, const ProfileZoneStats& b) {
+        return a.total_ms != b.total_ms ? a.total_ms > b.total_ms : a.name < b.name;
+    });
+    return stats;
+}
+
+std::string Profiler::report() const
+{
+    std::stringstream ss;
+    ss << std::left << std::setw(32) << "zone" << std::right << std::setw(10) << "count" << std::setw(12) << "total ms"
+       << std::setw(12) << "avg ms" << std::setw(12) << "min ms" << std::setw(12) << "max ms" << "\n";
+    ss << std::fixed << std::setprecision(3);
+    for (const ProfileZoneStats& zone : zone_stats()) {
+        ss << std::left << std::setw(32) << zone.name << std::right << std::setw(10) << zone.count
+           << std::setw(12) << zone.total_ms << std::setw(12) << zone.total_ms / zone.count
+           << std::setw(12) << zone.min_ms << std::setw(12) << zone.max_ms << "\n";
+    }
+    return ss.str();
+}
+
+bool Profiler::write_chrome_trace(const std::string& path) const
+{
+    const std::vector<std::pair<uint32_t, ProfileEvent>> events = collect();
+    uint64_t origin = ~0ull;
+    uint32_t lanes = 0;
+    for (const auto& [lane, event] : events) {
+        origin = std::min(origin, event.begin);
+        lanes = std::max(lanes, lane + 1);
+    }
+    const double us_per_tick = ticks_to_ms(1000000) / 1000.0;
+
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fputs("{\"traceEvents\":[\n", file);
+    for (uint32_t lane = 0; lane < lanes; ++lane) {
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"lane %u\"}},\n",
+            lane, lane);
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        const auto& [lane, event] = events[i];
+        fputs("{\"name\":", file);
+        write_json_string(file, event.name);
+        fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n", lane,
+            (event.begin - origin) * us_per_tick, (event.end - event.begin) * us_per_tick, i + 1 < events.size() ? "," : "");
+    }
+    fputs("],\"displayTimeUnit\":\"ms\"}\n", file);
+    return fclose(file) == 0;
+}
+
+double Profiler::measure_zone_overhead(uint32_t iterations)
+{
+#if defined(PROFILER_ENABLED)
+    // scratch lane keeps zones of the measurement out of the thread's ring
+    Lane* lane = thread_lane_;
+    Lane scratch;
+    thread_lane_ = &scratch;
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        PROFILE_ZONE("Profiler overhead");
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+    thread_lane_ = lane;
+    return iterations == 0 ? 0.0 : ns / iterations;
+#else
+    return 0.0;
+#endif
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_RDTSC 1
+#endif
+
+// zone of one thread, name is a string literal
+struct ProfileEvent
+{
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct ProfileZoneStats
+{
+    std::string name;
+    uint64_t count{ 0 };
+    double total_ms{ 0.0 };
+    double min_ms{ 0.0 };
+    double max_ms{ 0.0 };
+};
+
+// Scoped CPU zones of all threads with a timestamp counter, kept in per-thread rings of the last events.
+// Writing a zone takes no lock: a thread appends to its own ring and publishes the count, readers take
+// whatever is published. Rings of finished threads are handed to the next new thread, so short lived
+// workers of parallel_for_ranges reuse lanes instead of growing memory.
+// Statistics and traces are read between frames, zones still written while reading may come out torn.
+// clear() only moves the first event readers look at, so it's safe while other threads write zones.
+// Zones are compiled in with PROFILER_ENABLED only, PROFILE_ZONE is empty otherwise.
+class Profiler
+{
+public:
+    static constexpr uint32_t events_per_thread = 1u << 15;
+
+    static Profiler& inst();
+
+    static uint64_t now()
+    {
+#if defined(PROFILER_RDTSC)
+        return __rdtsc();
+#else
+        return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    static void record(const char* name, uint64_t begin, uint64_t end)
+    {
+        Lane* lane = thread_lane_ != nullptr ? thread_lane_ : acquire_lane();
+        const uint64_t count = lane->count.load(std::memory_order_relaxed);
+        lane->events[count & (events_per_thread - 1)] = { name, begin, end };
+        lane->count.store(count + 1, std::memory_order_release);
+    }
+
+    double ticks_to_ms(uint64_t ticks) const;
+    // drops zones recorded so far
+    void clear();
+
+    // zones still in the rings, by total time
+    std::vector<ProfileZoneStats> zone_stats() const;
+    std::string report() const;
+    // chrome://tracing or Perfetto JSON of zones still in the rings, one track per lane
+    bool write_chrome_trace(const std::string& path) const;
+
+    // nanoseconds of one empty zone on the calling thread, recorded into a scratch ring
+    double measure_zone_overhead(uint32_t iterations = 1000000);
+private:
+    struct Lane
+    {
+        uint32_t id{ 0 };
+        std::atomic<uint64_t> count{ 0 };
+        // events before it are cleared, read and written under mutex_
+        uint64_t first{ 0 };
+        std::unique_ptr<ProfileEvent[]> events{ new ProfileEvent[events_per_thread] };
+    };
+
+    struct LaneOwner
+    {
+        Lane* lane{ nullptr };
+        ~LaneOwner();
+    };
+
+    Profiler();
+
+    // lane of the calling thread, a plain pointer needs no guard or destructor on access;
+    // the thread_local LaneOwner of acquire_lane hands the lane back when the thread exits
+    static inline thread_local Lane* thread_lane_{ nullptr };
+
+    static Lane* acquire_lane();
+    void release_lane(Lane* lane);
+
+    // events of every lane in order of lanes, begin ticks
+    std::vector<std::pair<uint32_t, ProfileEvent>> collect() const;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::vector<Lane*> free_lanes_;
+
+    // ticks are converted with the rate measured since construction
+    uint64_t start_ticks_;
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+        : name_(name), begin_(Profiler::now())
+    {
+    }
+    ~ProfileZone()
+    {
+        Profiler::record(name_, begin_, Profiler::now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+private:
+    const char* name_;
+    uint64_t begin_;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(PROFILER_ENABLED)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) (void)0
+#endif
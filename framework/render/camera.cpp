@@ -24,7 +24,8 @@ Camera::~Camera()
 
 void Camera::initialize()
 {
-    camera_data_cb_.initialize();
+    camera_data_cb_.initialize("Camera data");
+    camera_data_cb_.register_bindless();
 }
 
 void Camera::destroy()
@@ -61,6 +61,11 @@ public:
         return camera_data_cb_.gpu_descriptor_handle();
     }
 
+    UINT bindless_index() const
+    {
+        return camera_data_cb_.bindless_index();
+    }
+
 private:
     bool durty_{ true };
 
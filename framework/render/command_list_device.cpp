@@ -0,0 +1,46 @@
+#include <cassert>
+
+#include "render/common.h"
+#include "command_list_device.h"
+
+CommandListDevice::CommandListDevice(ID3D12Device* device, ID3D12CommandQueue* graphics_queue)
+    : device_(device), graphics_queue_(graphics_queue)
+{
+}
+
+CommandListDevice::List CommandListDevice::create_list(Type type)
+{
+    assert(type == D3D12_COMMAND_LIST_TYPE_DIRECT);
+    ComPtr<ID3D12CommandAllocator> allocator;
+    HRESULT_CHECK(device_->CreateCommandAllocator(type, IID_PPV_ARGS(allocator.GetAddressOf())));
+    allocator->SetName(L"Pooled command allocator");
+
+    List list = nullptr;
+    HRESULT_CHECK(device_->CreateCommandList(0, type, allocator.Get(), nullptr, IID_PPV_ARGS(&list)));
+    list->SetName(L"Pooled command list");
+    allocators_.emplace(list, allocator);
+    return list;
+}
+
+void CommandListDevice::reset_list(List list, Type type)
+{
+    ID3D12CommandAllocator* allocator = allocators_.at(list).Get();
+    HRESULT_CHECK(allocator->Reset());
+    HRESULT_CHECK(list->Reset(allocator, nullptr));
+}
+
+void CommandListDevice::destroy_list(List list)
+{
+    list->Release();
+    allocators_.erase(list);
+}
+
+void CommandListDevice::close_list(List list)
+{
+    HRESULT_CHECK(list->Close());
+}
+
+void CommandListDevice::execute(const List* lists, uint32_t count)
+{
+    graphics_queue_->ExecuteCommandLists(count, reinterpret_cast<ID3D12CommandList* const*>(lists));
+}
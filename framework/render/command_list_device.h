@@ -0,0 +1,38 @@
+#pragma once
+
+#include <unordered_map>
+
+#include <Windows.h>
+#include <wrl.h>
+#include <d3d12.h>
+
+using namespace Microsoft::WRL;
+
+#include "render/command_list_pool.hpp"
+#include "render/command_recorder.hpp"
+
+// Device of CommandListPool and CommandRecorder on the graphics queue.
+// Every pooled list owns its allocator: lists recorded at the same time on different threads
+// never share one, and the allocator is reset only when the pool recycles the list,
+// that is after GPU finished the frame that used it. Only direct lists are supported.
+class CommandListDevice
+{
+public:
+    using List = ID3D12GraphicsCommandList*;
+    using Type = D3D12_COMMAND_LIST_TYPE;
+
+    CommandListDevice(ID3D12Device* device, ID3D12CommandQueue* graphics_queue);
+    ~CommandListDevice() = default;
+
+    List create_list(Type type);
+    void reset_list(List list, Type type);
+    void destroy_list(List list);
+    void close_list(List list);
+    void execute(const List* lists, uint32_t count);
+private:
+    ID3D12Device* device_;
+    ID3D12CommandQueue* graphics_queue_;
+    std::unordered_map<List, ComPtr<ID3D12CommandAllocator>> allocators_;
+};
+
+using GraphicsCommandRecorder = CommandRecorder<CommandListDevice>;
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <cstdint>
+
+struct CommandListPoolStats
+{
+    uint64_t lists{ 0 };          // created over lifetime, free and in flight
+    uint64_t frame_acquired{ 0 }; // since last begin_frame
+    uint64_t frame_created{ 0 };
+};
+
+// Recycles command lists by type. Lists handed out during a frame are returned to the pool
+// when the fence value of that frame completes, so steady state frames create no lists.
+// Device provides:
+//   List, Type
+//   List create_list(Type)          - new list open for recording
+//   void reset_list(List, Type)     - reopens a finished list with the allocator of current frame
+//   void destroy_list(List)
+template<class Device>
+class CommandListPool
+{
+public:
+    using List = typename Device::List;
+    using Type = typename Device::Type;
+
+    CommandListPool() = default;
+    ~CommandListPool() = default;
+
+    void initialize(Device* device)
+    {
+        device_ = device;
+        stats_ = CommandListPoolStats{};
+    }
+
+    // lists of all frames have to be finished on GPU
+    void destroy()
+    {
+        for (auto& [type, lists] : free_) {
+            for (List list : lists) {
+                device_->destroy_list(list);
+            }
+        }
+        free_.clear();
+        for (const Pending& pending : pending_) {
+            device_->destroy_list(pending.list);
+        }
+        pending_.clear();
+        for (const Acquired& acquired : acquired_) {
+            device_->destroy_list(acquired.list);
+        }
+        acquired_.clear();
+    }
+
+    // returns lists of completed frames to the pool
+    void begin_frame(uint64_t completed_value)
+    {
+        while (!pending_.empty() && pending_.front().fence_value <= completed_value) {
+            free_[pending_.front().type].push_back(pending_.front().list);
+            pending_.pop_front();
+        }
+        stats_.frame_acquired = 0;
+        stats_.frame_created = 0;
+    }
+
+    // list open for recording, valid until the end of frame
+    List acquire(Type type)
+    {
+        List list;
+        std::vector<List>& lists = free_[type];
+        if (!lists.empty()) {
+            list = lists.back();
+            lists.pop_back();
+            device_->reset_list(list, type);
+        } else {
+            list = device_->create_list(type);
+            ++stats_.lists;
+            ++stats_.frame_created;
+        }
+        ++stats_.frame_acquired;
+        acquired_.push_back({ type, list });
+        return list;
+    }
+
+    // lists acquired during the frame are in flight until fence_value completes
+    void end_frame(uint64_t fence_value)
+    {
+        for (const Acquired& acquired : acquired_) {
+            pending_.push_back({ fence_value, acquired.type, acquired.list });
+        }
+        acquired_.clear();
+    }
+
+    const CommandListPoolStats& stats() const { return stats_; }
+private:
+    struct Acquired
+    {
+        Type type;
+        List list;
+    };
+
+    struct Pending
+    {
+        uint64_t fence_value;
+        Type type;
+        List list;
+    };
+
+    Device* device_{ nullptr };
+    std::map<Type, std::vector<List>> free_;
+    std::vector<Acquired> acquired_;
+    std::deque<Pending> pending_;
+    CommandListPoolStats stats_;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core/parallel.h"
+#include "core/profiler.h"
+#include "render/command_list_pool.hpp"
+
+struct CommandRecorderStats
+{
+    uint64_t tasks{ 0 };     // recorded in the last flush
+    uint32_t workers{ 0 };
+    double record_ms{ 0.0 }; // parallel recording of the last flush
+    double submit_ms{ 0.0 };
+};
+
+// Records tasks of a frame into separate pooled lists on worker threads and submits them in one batch.
+// Submission order is resolved at flush: by group, then by record call order inside the group,
+// so it does not depend on which worker finished first.
+// Tasks run concurrently - state shared between tasks (e.g. lazily synced const buffer handles)
+// has to be resolved on the calling thread before record().
+// Device provides everything CommandListPool needs and:
+//   void close_list(List)                  - called on the worker that recorded the list
+//   void execute(const List*, uint32_t)    - submits closed lists in the given order
+template<class Device>
+class CommandRecorder
+{
+public:
+    using List = typename Device::List;
+    using Type = typename Device::Type;
+    using Task = std::function<void(List)>;
+
+    CommandRecorder() = default;
+    ~CommandRecorder() = default;
+
+    void initialize(Device* device, CommandListPool<Device>* pool, Type type)
+    {
+        device_ = device;
+        pool_ = pool;
+        type_ = type;
+        group_ = 0;
+        tasks_.clear();
+        stats_ = CommandRecorderStats{};
+    }
+
+    // 0 - one worker per hardware thread, 1 - records on the calling thread
+    void set_max_workers(uint32_t max_workers) { max_workers_ = max_workers; }
+    uint32_t max_workers() const { return max_workers_; }
+
+    // lists recorded after this call are submitted after lists of lower groups
+    void begin_group(uint32_t group) { group_ = group; }
+
+    // task records into its own open list, the list is closed by recorder
+    void record(Task task)
+    {
+        tasks_.push_back({ group_, uint32_t(tasks_.size()), std::move(task), List{} });
+    }
+
+    // records all tasks and submits their lists in deterministic order
+    void flush()
+    {
+        PROFILE_ZONE("Record command lists");
+        stats_.tasks = tasks_.size();
+        stats_.workers = 0;
+        stats_.record_ms = 0.0;
+        stats_.submit_ms = 0.0;
+        if (tasks_.empty()) {
+            return;
+        }
+
+        // sequence keeps record call order inside a group
+        std::sort(tasks_.begin(), tasks_.end(), [](const Entry& a, const Entry& b) {
+            return a.group != b.group ? a.group < b.group : a.sequence < b.sequence;
+        });
+        // pool is not thread safe, lists are taken here in submission order
+        for (Entry& entry : tasks_) {
+            entry.list = pool_->acquire(type_);
+        }
+
+        const uint32_t count = uint32_t(tasks_.size());
+        const uint32_t workers = max_workers_ == 0
+            ? parallel_worker_count(count, 1)
+            : std::min(parallel_worker_count(count, 1), max_workers_);
+        const auto record_begin = std::chrono::steady_clock::now();
+        parallel_for_ranges(count, workers, [this](uint32_t begin, uint32_t end, uint32_t) {
+            PROFILE_ZONE("Record tasks");
+            for (uint32_t i = begin; i < end; ++i) {
+                tasks_[i].task(tasks_[i].list);
+                device_->close_list(tasks_[i].list);
+            }
+        });
+        const auto submit_begin = std::chrono::steady_clock::now();
+
+        lists_.clear();
+        for (const Entry& entry : tasks_) {
+            lists_.push_back(entry.list);
+        }
+        device_->execute(lists_.data(), count);
+        tasks_.clear();
+        group_ = 0;
+
+        stats_.workers = workers;
+        stats_.record_ms = std::chrono::duration<double, std::milli>(submit_begin - record_begin).count();
+        stats_.submit_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submit_begin).count();
+    }
+
+    const CommandRecorderStats& stats() const { return stats_; }
+private:
+    struct Entry
+    {
+        uint32_t group;
+        uint32_t sequence;
+        Task task;
+        List list;
+    };
+
+    Device* device_{ nullptr };
+    CommandListPool<Device>* pool_{ nullptr };
+    Type type_{};
+    uint32_t max_workers_{ 0 };
+    uint32_t group_{ 0 };
+    std::vector<Entry> tasks_;
+    std::vector<List> lists_;
+    CommandRecorderStats stats_;
+};
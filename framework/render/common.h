@@ -7,6 +7,8 @@
 
 #include "headers/WinPixEventRuntime/pix3.h"
 
+#include "core/profiler.h"
+
 #define HRESULT_CHECK(expr)                                                                                                                   \
     do {                                                                                                                                      \
         HRESULT status = expr;                                                                                                                \
@@ -26,3 +28,44 @@
             com_ptr = nullptr;    \
         }                         \
     } while (0, 0)
+
+// PIX event of the list for GPU captures, ended with the scope.
+// With the profiler on PROFILE_ZONE already times the CPU side, so only the GPU marker is written
+// instead of PIXBeginEvent taking its own CPU timestamps too.
+#if defined(PROFILER_ENABLED) && defined(PIX_EVENTS_ARE_TURNED_ON) && defined(USE_PIX) && !defined(PIX_USE_GPU_MARKERS_V2)
+#define PIX_GPU_MARKERS_ONLY 1
+#endif
+
+class PixScopedEvent
+{
+public:
+    PixScopedEvent(ID3D12GraphicsCommandList* cmd_list, UINT64 color, PCSTR name)
+        : cmd_list_(cmd_list)
+    {
+#if defined(PIX_GPU_MARKERS_ONLY)
+        UINT64 buffer[PIXEventsGraphicsRecordSpaceQwords];
+        UINT64* end = PixEventsLegacy::EncodeBeginEventForContext(buffer, color, name);
+        PIXBeginGPUEventOnContext(cmd_list_, buffer, static_cast<UINT>(reinterpret_cast<BYTE*>(end) - reinterpret_cast<BYTE*>(buffer)));
+#else
+        PIXBeginEvent(cmd_list_, color, name);
+#endif
+    }
+    ~PixScopedEvent()
+    {
+#if defined(PIX_GPU_MARKERS_ONLY)
+        PIXEndGPUEventOnContext(cmd_list_);
+#else
+        PIXEndEvent(cmd_list_);
+#endif
+    }
+
+    PixScopedEvent(const PixScopedEvent&) = delete;
+    PixScopedEvent& operator=(const PixScopedEvent&) = delete;
+private:
+    ID3D12GraphicsCommandList* cmd_list_;
+};
+
+// PIX event on the list and CPU profiler zone of the recording thread under one name
+#define PROFILE_PIX_EVENT(cmd_list, color, name) \
+    PROFILE_ZONE(name);                           \
+    PixScopedEvent PROFILE_CONCAT(pix_event_, __LINE__)(cmd_list, color, name)
@@ -0,0 +1,141 @@
+#include <cassert>
+#include <cstdio>
+#include "d3d12_backend.h"
+#include "core/game.h"
+#include "win32/win.h"
+#include "win32/input.h"
+#include "render/common.h"
+#include "render/render.h"
+#include "render/resource/pipeline_cache.h"
+
+D3D12Backend::D3D12Backend()
+{
+    win_ = std::make_unique<Win>();
+    render_ = std::make_unique<Render>();
+}
+
+D3D12Backend::~D3D12Backend()
+{
+    win_.release();
+    render_.release();
+}
+
+bool D3D12Backend::initialize(uint32_t width, uint32_t height)
+{
+    if (!win_->initialize(width, height)) {
+        return false;
+    }
+    render_->initialize();
+    return true;
+}
+
+void D3D12Backend::destroy()
+{
+    render_->destroy_resources();
+    win_->destroy();
+}
+
+void D3D12Backend::poll()
+{
+    // handle win messages
+    win_->run();
+
+    // process input queue
+    win_->input()->process_win_input();
+}
+
+void D3D12Backend::end_poll()
+{
+    // clear keyboard
+    win_->input()->clear_after_process();
+}
+
+void D3D12Backend::prepare_frame()
+{
+    render_->prepare_frame();
+}
+
+void D3D12Backend::submit_uploads()
+{
+    render_->submit_uploads();
+}
+
+void D3D12Backend::begin_component(uint32_t component)
+{
+    render_->recorder()->begin_group(component);
+}
+
+void D3D12Backend::end_frame()
+{
+    render_->end_frame();
+}
+
+bool D3D12Backend::prepare_imgui()
+{
+    render_->prepare_imgui();
+    return true;
+}
+
+void D3D12Backend::end_imgui()
+{
+    render_->end_imgui();
+}
+
+void D3D12Backend::present()
+{
+    render_->present();
+}
+
+void D3D12Backend::resize()
+{
+    render_->resize();
+}
+
+void D3D12Backend::fullscreen(bool fullscreen)
+{
+    render_->fullscreen(fullscreen);
+}
+
+void D3D12Backend::startup_done(float startup_ms)
+{
+    const PipelineCache::Stats& pipelines = render_->pipeline_cache()->stats();
+    char startup[256];
+    sprintf_s(startup, "Startup: %.1f ms, pipelines %u created (%.1f ms), %u loaded (%.1f ms), %u shared, library %zu KB\n",
+        startup_ms, pipelines.created_pipelines, pipelines.create_ms, pipelines.loaded_pipelines, pipelines.load_ms,
+        pipelines.shared_pipelines, render_->pipeline_library_bytes() / 1024);
+    output(startup);
+}
+
+void D3D12Backend::output(const char* text)
+{
+    OutputDebugString(text);
+}
+
+const Win& D3D12Backend::win() const
+{
+    return *win_;
+}
+
+Render& D3D12Backend::render() const
+{
+    return *render_;
+}
+
+// window and render exist only with D3D12 backend, Game doesn't depend on them otherwise
+const Win& Game::win() const
+{
+    assert(!backend_->headless());
+    return static_cast<const D3D12Backend&>(*backend_).win();
+}
+
+const Render& Game::render() const
+{
+    assert(!backend_->headless());
+    return static_cast<const D3D12Backend&>(*backend_).render();
+}
+
+Render& Game::render()
+{
+    assert(!backend_->headless());
+    return static_cast<D3D12Backend&>(*backend_).render();
+}
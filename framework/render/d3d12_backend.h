@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+
+#include "core/backend.h"
+
+class Win;
+class Render;
+
+// window with D3D12 Render, what Game always ran on before backends
+class D3D12Backend final : public Backend
+{
+private:
+    std::unique_ptr<Win> win_;
+    std::unique_ptr<Render> render_;
+public:
+    D3D12Backend();
+    ~D3D12Backend();
+
+    bool initialize(uint32_t width, uint32_t height) override;
+    void destroy() override;
+
+    bool headless() const override { return false; }
+
+    void poll() override;
+    void end_poll() override;
+
+    void prepare_frame() override;
+    void submit_uploads() override;
+    void begin_component(uint32_t component) override;
+    void end_frame() override;
+    bool prepare_imgui() override;
+    void end_imgui() override;
+    void present() override;
+
+    void resize() override;
+    void fullscreen(bool fullscreen) override;
+
+    void startup_done(float startup_ms) override;
+    void output(const char* text) override;
+
+    const Win& win() const;
+    Render& render() const;
+};
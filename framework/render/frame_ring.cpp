@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iterator>
+
+#include "frame_ring.h"
+
+void FrameRing::initialize(FrameFence* fence, uint32_t frames_in_flight)
+{
+    assert(fence != nullptr);
+    fence_ = fence;
+    slot_ = 0;
+    std::fill(std::begin(slot_fence_values_), std::end(slot_fence_values_), uint64_t(0));
+    stats_ = Stats{};
+    set_frames_in_flight(frames_in_flight);
+}
+
+void FrameRing::set_frames_in_flight(uint32_t frames_in_flight)
+{
+    assert(frames_in_flight >= 1 && frames_in_flight <= max_frames_in_flight);
+    wait_idle();
+    frames_in_flight_ = frames_in_flight;
+}
+
+uint32_t FrameRing::begin_frame()
+{
+    slot_ = uint32_t(stats_.frames % frames_in_flight_);
+
+    stats_.last_wait_ms = 0.0;
+    const uint64_t value = slot_fence_values_[slot_];
+    if (value != 0 && fence_->completed_value() < value) {
+        const auto begin = std::chrono::steady_clock::now();
+        fence_->wait(value);
+        stats_.last_wait_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        stats_.total_wait_ms += stats_.last_wait_ms;
+        ++stats_.waits;
+    }
+    return slot_;
+}
+
+uint64_t FrameRing::end_frame()
+{
+    slot_fence_values_[slot_] = fence_->signal();
+    ++stats_.frames;
+    return slot_fence_values_[slot_];
+}
+
+void FrameRing::wait_idle()
+{
+    const uint64_t value = *std::max_element(std::begin(slot_fence_values_), std::end(slot_fence_values_));
+    if (value != 0) {
+        fence_->wait(value);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+// Fence of the queue frames are submitted to, implemented by Render on graphics queue
+class FrameFence
+{
+public:
+    virtual ~FrameFence() = default;
+
+    // signals after all work submitted so far, returns signaled value
+    virtual uint64_t signal() = 0;
+    virtual uint64_t completed_value() = 0;
+    virtual void wait(uint64_t value) = 0;
+};
+
+// Frame slots for frames in flight: per-frame data (command allocators, constant buffer versions)
+// is indexed by slot, and a slot is reused only after GPU is done with the frame that used it before.
+// With one frame in flight CPU waits for every frame, as Render did before.
+class FrameRing
+{
+public:
+    static constexpr uint32_t max_frames_in_flight = 3;
+
+    struct Stats
+    {
+        uint64_t frames{ 0 };
+        uint64_t waits{ 0 };        // frames that had to wait for a slot
+        double last_wait_ms{ 0.0 }; // CPU wait of the last begin_frame
+        double total_wait_ms{ 0.0 };
+    };
+
+    FrameRing() = default;
+    ~FrameRing() = default;
+
+    void initialize(FrameFence* fence, uint32_t frames_in_flight);
+    // waits for all frames, slots keep their data
+    void set_frames_in_flight(uint32_t frames_in_flight);
+
+    // waits until the slot of the next frame is free, returns it
+    uint32_t begin_frame();
+    // signals the fence after the frame's work is submitted, returns signaled value
+    uint64_t end_frame();
+    void wait_idle();
+
+    uint32_t frame_slot() const { return slot_; }
+    uint32_t frames_in_flight() const { return frames_in_flight_; }
+    uint64_t frame_number() const { return stats_.frames; }
+    const Stats& stats() const { return stats_; }
+private:
+    FrameFence* fence_{ nullptr };
+    uint32_t frames_in_flight_{ 1 };
+    uint32_t slot_{ 0 };
+    uint64_t slot_fence_values_[max_frames_in_flight] = {};
+    Stats stats_;
+};
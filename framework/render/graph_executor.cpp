@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cassert>
+
+#include "render/common.h"
+#include "graph_executor.h"
+
+namespace
+{
+
+D3D12_RESOURCE_STATES native_state(uint32_t state)
+{
+    static const D3D12_RESOURCE_STATES states[] = {
+        D3D12_RESOURCE_STATE_RENDER_TARGET,
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        D3D12_RESOURCE_STATE_DEPTH_WRITE,
+        D3D12_RESOURCE_STATE_DEPTH_READ,
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_COPY_SOURCE,
+        D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
+        D3D12_RESOURCE_STATE_INDEX_BUFFER,
+    };
+    D3D12_RESOURCE_STATES native = D3D12_RESOURCE_STATE_COMMON;
+    for (uint32_t i = 0; i < _countof(states); ++i) {
+        if (state & (1u << i)) {
+            native |= states[i];
+        }
+    }
+    return native;
+}
+
+bool same_desc(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b)
+{
+    return a.Dimension == b.Dimension && a.Alignment == b.Alignment && a.Width == b.Width && a.Height == b.Height
+        && a.DepthOrArraySize == b.DepthOrArraySize && a.MipLevels == b.MipLevels && a.Format == b.Format
+        && a.SampleDesc.Count == b.SampleDesc.Count && a.SampleDesc.Quality == b.SampleDesc.Quality
+        && a.Layout == b.Layout && a.Flags == b.Flags;
+}
+
+} // namespace
+
+void GraphExecutor::initialize(ID3D12Device* device)
+{
+    device_ = device;
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    HRESULT_CHECK(device_->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+    heap_flags_ = options.ResourceHeapTier >= D3D12_RESOURCE_HEAP_TIER_2
+        ? D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES
+        : D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+}
+
+void GraphExecutor::destroy()
+{
+    for (TransientHeap& heap : heaps_) {
+        heap.placed.clear();
+        SAFE_RELEASE(heap.heap);
+        heap.size = 0;
+    }
+    natives_.clear();
+    transient_descs_.clear();
+}
+
+GraphResource GraphExecutor::import_resource(const std::string& name, ID3D12Resource* resource, uint32_t state, uint32_t final_state)
+{
+    const GraphResource id = graph_.import_resource(name, state, final_state);
+    natives_.resize(graph_.resource_count(), nullptr);
+    transient_descs_.resize(graph_.resource_count());
+    natives_[id] = resource;
+    return id;
+}
+
+void GraphExecutor::set_resource(GraphResource id, ID3D12Resource* resource)
+{
+    assert(!graph_.resource(id).transient);
+    natives_[id] = resource;
+}
+
+GraphResource GraphExecutor::create_transient(const std::string& name, const D3D12_RESOURCE_DESC& desc)
+{
+    assert(heap_flags_ == D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES
+        || (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)));
+    const D3D12_RESOURCE_ALLOCATION_INFO info = device_->GetResourceAllocationInfo(0, 1, &desc);
+    const GraphResource id = graph_.create_transient(name, info.SizeInBytes, info.Alignment);
+    natives_.resize(graph_.resource_count(), nullptr);
+    transient_descs_.resize(graph_.resource_count());
+    transient_descs_[id] = desc;
+    return id;
+}
+
+void GraphExecutor::reset()
+{
+    graph_.reset();
+    natives_.resize(graph_.resource_count());
+    transient_descs_.resize(graph_.resource_count());
+}
+
+const CompiledGraph& GraphExecutor::compile(uint32_t slot)
+{
+    const CompiledGraph& compiled = graph_.compile();
+
+    // slot heap is free, frame ring waited for the frame that used it before
+    TransientHeap& heap = heaps_[slot];
+    if (heap.size < compiled.stats.heap_bytes) {
+        heap.placed.clear();
+        D3D12_HEAP_DESC heap_desc = {};
+        heap_desc.SizeInBytes = compiled.stats.heap_bytes;
+        heap_desc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        heap_desc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+        heap_desc.Flags = heap_flags_;
+        HRESULT_CHECK(device_->CreateHeap(&heap_desc, IID_PPV_ARGS(heap.heap.ReleaseAndGetAddressOf())));
+        heap.heap->SetName(L"Render graph transient heap");
+        heap.size = compiled.stats.heap_bytes;
+    }
+
+    for (Placed& placed : heap.placed) {
+        placed.used = false;
+    }
+    for (const CompiledGraph::Placement& placement : compiled.placements) {
+        natives_[placement.resource] = place(heap, transient_descs_[placement.resource], placement.offset, placement.initial_state);
+    }
+    heap.placed.erase(std::remove_if(heap.placed.begin(), heap.placed.end(), [](const Placed& placed) { return !placed.used; }),
+        heap.placed.end());
+    return compiled;
+}
+
+ID3D12Resource* GraphExecutor::place(TransientHeap& heap, const D3D12_RESOURCE_DESC& desc, uint64_t offset, uint32_t state)
+{
+    for (Placed& placed : heap.placed) {
+        if (!placed.used && placed.offset == offset && placed.state == state && same_desc(placed.desc, desc)) {
+            placed.used = true;
+            return placed.resource.Get();
+        }
+    }
+
+    Placed placed = { desc, offset, state, nullptr, true };
+    HRESULT_CHECK(device_->CreatePlacedResource(heap.heap.Get(), offset, &desc, native_state(state), nullptr,
+        IID_PPV_ARGS(placed.resource.GetAddressOf())));
+    placed.resource->SetName(L"Render graph transient resource");
+    heap.placed.push_back(placed);
+    return heap.placed.back().resource.Get();
+}
+
+void GraphExecutor::record_barriers(ID3D12GraphicsCommandList* cmd_list, const GraphBatch& batch) const
+{
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    barriers.reserve(batch.barriers.size());
+    for (const GraphBarrier& barrier : batch.barriers) {
+        ID3D12Resource* resource = natives_[barrier.resource];
+        switch (barrier.type) {
+        case GraphBarrier::Type::transition:
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, native_state(barrier.state_before), native_state(barrier.state_after)));
+            break;
+        case GraphBarrier::Type::uav:
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+            break;
+        case GraphBarrier::Type::aliasing:
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(barrier.before != GraphBarrier::invalid ? natives_[barrier.before] : nullptr, resource));
+            break;
+        }
+    }
+    if (!barriers.empty()) {
+        cmd_list->ResourceBarrier(UINT(barriers.size()), barriers.data());
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <Windows.h>
+#include <wrl.h>
+#include <d3d12.h>
+
+using namespace Microsoft::WRL;
+
+#include "render/render_graph.h"
+#include "render/frame_ring.h"
+
+// D3D12 side of RenderGraph: native resources of graph resources, transient heaps and barrier recording.
+// Transient resources are placed resources in one heap per frame slot, so frames in flight never share
+// transient memory. Placed resources are kept while the compiled layout doesn't change.
+// Without resource heap tier 2 transient resources have to be render target or depth stencil textures.
+class GraphExecutor
+{
+public:
+    GraphExecutor() = default;
+    ~GraphExecutor() = default;
+
+    void initialize(ID3D12Device* device);
+    // GPU has to be done with all frames
+    void destroy();
+
+    RenderGraph* graph() { return &graph_; }
+
+    GraphResource import_resource(const std::string& name, ID3D12Resource* resource, uint32_t state,
+                                  uint32_t final_state = RenderGraph::keep_state);
+    // imported resource can change every frame, e.g. back buffer
+    void set_resource(GraphResource id, ID3D12Resource* resource);
+    GraphResource create_transient(const std::string& name, const D3D12_RESOURCE_DESC& desc);
+    // transient resources are valid after compile until the next reset
+    ID3D12Resource* resource(GraphResource id) const { return natives_[id]; }
+
+    void reset();
+    // compiles the graph and places transient resources in the heap of the slot
+    const CompiledGraph& compile(uint32_t slot);
+    void record_barriers(ID3D12GraphicsCommandList* cmd_list, const GraphBatch& batch) const;
+private:
+    struct Placed
+    {
+        D3D12_RESOURCE_DESC desc;
+        uint64_t offset;
+        uint32_t state;
+        ComPtr<ID3D12Resource> resource;
+        bool used;
+    };
+
+    struct TransientHeap
+    {
+        ComPtr<ID3D12Heap> heap;
+        uint64_t size{ 0 };
+        std::vector<Placed> placed;
+    };
+
+    ID3D12Resource* place(TransientHeap& heap, const D3D12_RESOURCE_DESC& desc, uint64_t offset, uint32_t state);
+
+    ID3D12Device* device_{ nullptr };
+    D3D12_HEAP_FLAGS heap_flags_{ D3D12_HEAP_FLAG_NONE };
+    RenderGraph graph_;
+    std::vector<ID3D12Resource*> natives_;
+    std::vector<D3D12_RESOURCE_DESC> transient_descs_; // by transient resource id
+    TransientHeap heaps_[FrameRing::max_frames_in_flight];
+};
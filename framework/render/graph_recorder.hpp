@@ -0,0 +1,70 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+#include "render/render_graph.h"
+#include "render/command_recorder.hpp"
+
+// Pass tasks of a frame, recorded through CommandRecorder in compiled graph order once the graph is compiled.
+// Barriers of the batch before a pass go to the head of the first list of the pass, a pass without tasks
+// gets an empty one for them. Render and NullBackend differ only in how a barrier batch is recorded.
+template<class Device>
+class GraphRecorder
+{
+public:
+    using List = typename Device::List;
+    using Task = typename CommandRecorder<Device>::Task;
+
+    GraphRecorder() = default;
+    ~GraphRecorder() = default;
+
+    // task records into its own list after the barriers of the pass, tasks of a pass keep call order
+    void record_pass(GraphPass pass, Task task)
+    {
+        if (pass_tasks_.size() <= pass) {
+            pass_tasks_.resize(pass + 1);
+        }
+        pass_tasks_[pass].push_back(std::move(task));
+    }
+
+    // drops tasks of the frame
+    void reset()
+    {
+        pass_tasks_.clear();
+    }
+
+    // records tasks of passes kept by compile, after lists recorded by components directly;
+    // record_barriers(List, const GraphBatch&) runs on recorder workers
+    template<class RecordBarriers>
+    void record(const CompiledGraph& compiled, uint32_t pass_count, CommandRecorder<Device>& recorder, RecordBarriers record_barriers)
+    {
+        pass_tasks_.resize(pass_count);
+
+        recorder.begin_group(~0u);
+        size_t batch = 0;
+        for (uint32_t position = 0; position < compiled.order.size(); ++position) {
+            const GraphBatch* barriers = nullptr;
+            if (batch < compiled.batches.size() && compiled.batches[batch].position == position) {
+                barriers = &compiled.batches[batch++];
+            }
+
+            std::vector<Task>& tasks = pass_tasks_[compiled.order[position]];
+            if (tasks.empty() && barriers != nullptr) {
+                tasks.push_back([](List) {});
+            }
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                const GraphBatch* head = i == 0 ? barriers : nullptr;
+                recorder.record([record_barriers, head, task = std::move(tasks[i])](List list) {
+                    if (head != nullptr) {
+                        record_barriers(list, *head);
+                    }
+                    task(list);
+                });
+            }
+        }
+    }
+private:
+    std::vector<std::vector<Task>> pass_tasks_; // by pass
+};
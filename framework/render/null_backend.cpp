@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+#include "null_backend.h"
+#include "core/game.h"
+
+namespace
+{
+
+// GPU of the null backend finishes every frame as soon as it is submitted
+class NullFrameFence : public FrameFence
+{
+public:
+    uint64_t signal() override { return ++value_; }
+    uint64_t completed_value() override { return value_; }
+    void wait(uint64_t) override {}
+private:
+    uint64_t value_{ 0 };
+};
+
+const char* barrier_name(const GraphBarrier& barrier)
+{
+    switch (barrier.type) {
+    case GraphBarrier::Type::transition:
+        return "transition ";
+    case GraphBarrier::Type::uav:
+        return "uav ";
+    default:
+        return "aliasing ";
+    }
+}
+
+} // namespace
+
+NullBackend::NullBackend(uint32_t frame_count)
+    : frame_count_(frame_count)
+{
+}
+
+NullBackend::~NullBackend()
+{
+}
+
+bool NullBackend::initialize(uint32_t width, uint32_t height)
+{
+    width_ = width;
+    height_ = height;
+
+    fence_ = std::make_unique<NullFrameFence>();
+    frame_ring_.initialize(fence_.get(), 2);
+    pool_.initialize(&device_);
+    recorder_.initialize(&device_, &pool_, 0);
+
+    // same imported resources as Render, passes of components declare accesses to them
+    back_buffer_resource_ = graph_.import_resource("back buffer", GraphState::present, GraphState::present);
+    depth_stencil_resource_ = graph_.import_resource("depth stencil",
+        GraphState::non_pixel_shader_resource | GraphState::depth_read, GraphState::non_pixel_shader_resource | GraphState::depth_read);
+
+    stats_ = Stats{};
+    return true;
+}
+
+void NullBackend::destroy()
+{
+    frame_ring_.wait_idle();
+    pool_.destroy();
+    graph_ = RenderGraph{};
+    graph_recorder_.reset();
+}
+
+void NullBackend::poll()
+{
+    // stops as closed window does
+    if (frame_count_ != 0 && stats_.frames >= frame_count_) {
+        Game::inst()->set_destroy();
+        Game::inst()->set_animating(false);
+    }
+}
+
+void NullBackend::prepare_frame()
+{
+    frame_begin_ = std::chrono::steady_clock::now();
+
+    frame_ring_.begin_frame();
+    pool_.begin_frame(fence_->completed_value());
+
+    graph_.reset();
+    graph_recorder_.reset();
+
+    const GraphPass clear = graph_.add_pass("Clear targets");
+    graph_.write(clear, back_buffer_resource_, GraphState::render_target);
+    graph_.write(clear, depth_stencil_resource_, GraphState::depth_write);
+    record_pass(clear, [](NullCommandDevice::List list) {
+        list->command("ClearRenderTargetView");
+        list->command("ClearDepthStencilView");
+    });
+}
+
+void NullBackend::begin_component(uint32_t component)
+{
+    recorder_.begin_group(component);
+}
+
+void NullBackend::end_frame()
+{
+    // stands for ImGui of Render, keeps the back buffer written after the graph
+    const GraphPass imgui = graph_.add_pass("ImGui", true);
+    graph_.write(imgui, back_buffer_resource_, GraphState::render_target);
+
+    graph_recorder_.record(graph_.compile(), graph_.pass_count(), recorder_, [this](NullCommandDevice::List list, const GraphBatch& batch) {
+        record_barriers(list, batch);
+    });
+    recorder_.flush();
+    stats_.tasks += recorder_.stats().tasks;
+    stats_.record_ms += recorder_.stats().record_ms;
+}
+
+void NullBackend::present()
+{
+    // barriers after the last pass restore final states of graph resources
+    const CompiledGraph& compiled = graph_.compiled();
+    if (!compiled.batches.empty() && compiled.batches.back().position == compiled.order.size()) {
+        NullCommandDevice::List list = pool_.acquire(0);
+        record_barriers(list, compiled.batches.back());
+        list->command("Present");
+        device_.close_list(list);
+        device_.execute(&list, 1);
+    }
+
+    const uint64_t fence_value = frame_ring_.end_frame();
+    pool_.end_frame(fence_value);
+
+    device_.take_executed(frame_commands_);
+
+    ++stats_.frames;
+    stats_.frame_commands = frame_commands_.size();
+    stats_.commands += frame_commands_.size();
+    stats_.passes = compiled.stats.passes;
+    stats_.culled_passes = compiled.stats.culled_passes;
+    stats_.barriers = compiled.stats.barriers;
+    stats_.lists = pool_.stats().lists;
+    stats_.last_frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_begin_).count();
+    stats_.total_frame_ms += stats_.last_frame_ms;
+    stats_.peak_frame_ms = std::max(stats_.peak_frame_ms, stats_.last_frame_ms);
+}
+
+void NullBackend::record_barriers(NullCommandDevice::List list, const GraphBatch& batch) const
+{
+    for (const GraphBarrier& barrier : batch.barriers) {
+        list->command(barrier_name(barrier) + graph_.resource(barrier.resource).name);
+    }
+}
+
+void NullBackend::record_pass(GraphPass pass, NullCommandRecorder::Task task)
+{
+    graph_recorder_.record_pass(pass, std::move(task));
+}
+
+void NullBackend::startup_done(float startup_ms)
+{
+    char startup[128];
+    snprintf(startup, sizeof(startup), "Startup: %.1f ms, null backend %ux%u\n", startup_ms, width_, height_);
+    output(startup);
+}
+
+void NullBackend::output(const char* text)
+{
+    fputs(text, stdout);
+}
+
+std::string NullBackend::report() const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << stats_.frames << " frames, " << stats_.total_frame_ms / std::max<uint64_t>(stats_.frames, 1) << " ms average, "
+       << stats_.peak_frame_ms << " ms peak\n";
+    ss << stats_.tasks << " tasks recorded in " << stats_.record_ms << " ms, " << stats_.lists << " lists, "
+       << stats_.commands << " commands, " << stats_.frame_commands << " in the last frame\n";
+    ss << "last graph: " << stats_.passes << " passes, " << stats_.culled_passes << " culled, " << stats_.barriers << " barriers\n";
+    return ss.str();
+}
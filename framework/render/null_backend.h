@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "core/backend.h"
+#include "render/frame_ring.h"
+#include "render/render_graph.h"
+#include "render/null_command_device.h"
+#include "render/command_list_pool.hpp"
+#include "render/command_recorder.hpp"
+#include "render/graph_recorder.hpp"
+
+using NullCommandRecorder = CommandRecorder<NullCommandDevice>;
+
+// Backend without window and GPU, runs the frame loop for a fixed number of frames.
+// Frames go through the same CPU path as with D3D12 Render: frame ring on a fence, render graph compiled
+// every frame, tasks recorded in parallel into pooled lists and submitted in deterministic order.
+// Commands are recorded as names into NullCommandDevice streams, the fence completes on signal.
+class NullBackend final : public Backend
+{
+public:
+    struct Stats
+    {
+        uint64_t frames{ 0 };
+        uint64_t commands{ 0 };      // executed over all frames
+        uint64_t frame_commands{ 0 };
+        uint64_t tasks{ 0 };         // recorded over all frames
+        uint32_t passes{ 0 };        // last compiled graph
+        uint32_t culled_passes{ 0 };
+        uint32_t barriers{ 0 };
+        uint64_t lists{ 0 };         // created by the pool over lifetime
+        double last_frame_ms{ 0.0 }; // prepare_frame to present
+        double total_frame_ms{ 0.0 };
+        double peak_frame_ms{ 0.0 };
+        double record_ms{ 0.0 };     // parallel recording over all frames
+    };
+
+    // frame_count - frames until the loop stops, 0 - until Game::set_destroy
+    explicit NullBackend(uint32_t frame_count);
+    ~NullBackend();
+
+    bool initialize(uint32_t width, uint32_t height) override;
+    void destroy() override;
+
+    bool headless() const override { return true; }
+
+    void poll() override;
+    void end_poll() override {}
+
+    void prepare_frame() override;
+    void submit_uploads() override {}
+    void begin_component(uint32_t component) override;
+    void end_frame() override;
+    bool prepare_imgui() override { return false; }
+    void end_imgui() override {}
+    void present() override;
+
+    void resize() override {}
+    void fullscreen(bool) override {}
+
+    void startup_done(float startup_ms) override;
+    // stdout, headless runs are console applications
+    void output(const char* text) override;
+
+    uint32_t width() const { return width_; }
+    uint32_t height() const { return height_; }
+    // frames run so far, the frame being recorded between prepare_frame and present
+    uint64_t frame() const { return stats_.frames; }
+    uint32_t frame_slot() const { return frame_ring_.frame_slot(); }
+
+    // passes declared between prepare_frame and end_frame are compiled and recorded in end_frame
+    RenderGraph* graph() { return &graph_; }
+    GraphResource back_buffer_resource() const { return back_buffer_resource_; }
+    GraphResource depth_stencil_resource() const { return depth_stencil_resource_; }
+    // task records into its own list after the barriers of the pass, tasks of a pass keep call order
+    void record_pass(GraphPass pass, NullCommandRecorder::Task task);
+    // tasks recorded in parallel and submitted in deterministic order in end_frame
+    NullCommandRecorder* recorder() { return &recorder_; }
+
+    const Stats& stats() const { return stats_; }
+    // commands executed in the last frame in submission order
+    const std::vector<std::string>& frame_commands() const { return frame_commands_; }
+    std::string report() const;
+private:
+    void record_barriers(NullCommandDevice::List list, const GraphBatch& batch) const;
+
+    uint32_t frame_count_;
+    uint32_t width_{ 0 };
+    uint32_t height_{ 0 };
+
+    std::unique_ptr<FrameFence> fence_;
+    FrameRing frame_ring_;
+    NullCommandDevice device_;
+    CommandListPool<NullCommandDevice> pool_;
+    NullCommandRecorder recorder_;
+
+    RenderGraph graph_;
+    GraphResource back_buffer_resource_{ 0 };
+    GraphResource depth_stencil_resource_{ 0 };
+    GraphRecorder<NullCommandDevice> graph_recorder_;
+
+    std::vector<std::string> frame_commands_;
+    std::chrono::steady_clock::time_point frame_begin_;
+    Stats stats_;
+};
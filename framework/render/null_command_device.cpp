@@ -0,0 +1,41 @@
+#include <cassert>
+
+#include "null_command_device.h"
+
+NullCommandDevice::~NullCommandDevice()
+{
+    assert(live_lists_ == 0);
+}
+
+NullCommandDevice::List NullCommandDevice::create_list(Type)
+{
+    ++live_lists_;
+    return new Stream{ next_id_++, true, {} };
+}
+
+void NullCommandDevice::reset_list(List list, Type)
+{
+    assert(!list->open);
+    list->open = true;
+    list->commands.clear();
+}
+
+void NullCommandDevice::destroy_list(List list)
+{
+    --live_lists_;
+    delete list;
+}
+
+void NullCommandDevice::close_list(List list)
+{
+    assert(list->open);
+    list->open = false;
+}
+
+void NullCommandDevice::execute(const List* lists, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        assert(!lists[i]->open);
+        executed_.insert(executed_.end(), lists[i]->commands.begin(), lists[i]->commands.end());
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Command list device without GPU for CommandListPool and CommandRecorder.
+// Lists are streams of command names, executed lists are appended to one queue stream
+// in submission order, so scheduling can be checked headlessly.
+class NullCommandDevice
+{
+public:
+    struct Stream
+    {
+        uint32_t id;
+        bool open;
+        std::vector<std::string> commands;
+
+        void command(const std::string& name) { commands.push_back(name); }
+    };
+
+    using List = Stream*;
+    using Type = uint32_t;
+
+    NullCommandDevice() = default;
+    ~NullCommandDevice();
+
+    List create_list(Type type);
+    void reset_list(List list, Type type);
+    void destroy_list(List list);
+    void close_list(List list);
+    void execute(const List* lists, uint32_t count);
+
+    // commands of executed lists in submission order
+    const std::vector<std::string>& executed() const { return executed_; }
+    void clear_executed() { executed_.clear(); }
+    // moves executed commands out, reuses storage of commands for the next ones
+    void take_executed(std::vector<std::string>& commands)
+    {
+        commands.swap(executed_);
+        executed_.clear();
+    }
+    uint32_t live_lists() const { return live_lists_; }
+private:
+    uint32_t next_id_{ 0 };
+    uint32_t live_lists_{ 0 };
+    std::vector<std::string> executed_;
+};
@@ -1,5 +1,6 @@
 #include <chrono>
 #include <thread>
+#include <stdexcept>
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_win32.h>
 #include <imgui/backends/imgui_impl_dx12.h>
@@ -10,6 +11,50 @@
 #include "win32/input.h"
 #include "camera.h"
 #include "resource/pipeline.h"
+#include "resource/geometry_arena.h"
+#include "resource/copy_queue.h"
+#include "resource/staging_uploader.h"
+#include "resource/residency.h"
+#include "resource/pipeline_cache.h"
+#include "resource/shader_cache.h"
+
+namespace
+{
+
+class QueueFence : public FrameFence
+{
+public:
+    QueueFence(ID3D12CommandQueue* queue, ID3D12Fence* fence, HANDLE event, UINT64 first_value)
+        : queue_(queue), fence_(fence), event_(event), next_value_(first_value)
+    {
+    }
+
+    uint64_t signal() override
+    {
+        HRESULT_CHECK(queue_->Signal(fence_, next_value_));
+        return next_value_++;
+    }
+
+    uint64_t completed_value() override
+    {
+        return fence_->GetCompletedValue();
+    }
+
+    void wait(uint64_t value) override
+    {
+        if (fence_->GetCompletedValue() < value) {
+            HRESULT_CHECK(fence_->SetEventOnCompletion(value, event_));
+            WaitForSingleObject(event_, INFINITE);
+        }
+    }
+private:
+    ID3D12CommandQueue* queue_;
+    ID3D12Fence* fence_;
+    HANDLE event_;
+    UINT64 next_value_;
+};
+
+} // namespace
 
 void Render::initialize()
 {
@@ -95,8 +140,34 @@ void Render::initialize()
 
     create_cmd_list();
 
+    graph_executor_ = new GraphExecutor();
+    graph_executor_->initialize(device_.Get());
+    back_buffer_resource_ = graph_executor_->import_resource("back buffer", render_targets_[frame_index_].Get(),
+        GraphState::present, GraphState::present);
+    depth_stencil_resource_ = graph_executor_->import_resource("depth stencil", depth_stencil_[frame_index_].Get(),
+        GraphState::non_pixel_shader_resource | GraphState::depth_read, GraphState::non_pixel_shader_resource | GraphState::depth_read);
+
+    residency_ = new ResidencyPolicy();
+    residency_->set_settings(residency_settings_);
+
+    pipeline_library_ = new PipelineLibrary();
+    pipeline_library_->initialize(device_.Get(), "./pipelines.cache");
+    pipeline_cache_ = new PipelineCache();
+    pipeline_cache_->initialize(pipeline_library_);
+    shader_cache_ = new ShaderCache();
+    shader_cache_->initialize("./resources/shaders/cache", { "./framework/shaders/common/" });
+
+    copy_queue_ = new CopyQueue();
+    copy_queue_->initialize(device_.Get(), graphics_queue_.Get(), 64 * 1024 * 1024);
+    uploader_ = new StagingUploader();
+    uploader_->initialize(copy_queue_);
+
     camera_ = new Camera();
     camera_->initialize();
+
+    // grows on demand
+    geometry_arena_ = new GeometryArena();
+    geometry_arena_->initialize(256 * 1024, 1024 * 1024);
 }
 
 void Render::create_command_queue()
@@ -209,7 +280,7 @@ void Render::create_render_target_views()
 
 void Render::create_command_allocator()
 {
-    for (int i = 0; i < swapchain_buffer_count_; ++i) {
+    for (int i = 0; i < FrameRing::max_frames_in_flight; ++i) {
         HRESULT_CHECK(device_->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(graphics_command_allocator_[i].ReleaseAndGetAddressOf())));
         graphics_command_allocator_[i]->SetName(L"Graphics command allocator");
         graphics_command_allocator_[i]->Reset();
@@ -222,15 +293,25 @@ void Render::create_descriptor_heap()
 
     D3D12_DESCRIPTOR_HEAP_DESC resource_heap_desc = {};
     resource_heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    resource_heap_desc.NumDescriptors = 1000;
+    gpu_descriptor_allocator_ = new DescriptorAllocator();
+    gpu_descriptor_allocator_->initialize(persistent_descriptor_count_, frame_descriptor_count_, FrameRing::max_frames_in_flight);
+    resource_heap_desc.NumDescriptors = gpu_descriptor_allocator_->capacity();
     resource_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
     resource_heap_desc.NodeMask = 0;
     HRESULT_CHECK(device_->CreateDescriptorHeap(&resource_heap_desc, IID_PPV_ARGS(gpu_resource_descriptor_heap_.ReleaseAndGetAddressOf())));
-    gpu_resources_allocated_ = 0;
 
+    cpu_descriptor_allocator_ = new DescriptorAllocator();
+    cpu_descriptor_allocator_->initialize(cpu_descriptor_count_, 0, 1);
+    resource_heap_desc.NumDescriptors = cpu_descriptor_allocator_->capacity();
     resource_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     HRESULT_CHECK(device_->CreateDescriptorHeap(&resource_heap_desc, IID_PPV_ARGS(cpu_resource_descriptor_heap_.ReleaseAndGetAddressOf())));
-    cpu_resources_allocated_ = 0;
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    HRESULT_CHECK(device_->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+    bindless_supported_ = options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3;
+    bindless_table_ = new BindlessTable();
+    bindless_table_->initialize(BINDLESS_TABLE_CAPACITY, FrameRing::max_frames_in_flight);
+    bindless_range_ = allocate_gpu_resource_descriptor(bindless_cpu_, bindless_gpu_, BINDLESS_TABLE_CAPACITY);
 
     D3D12_DESCRIPTOR_HEAP_DESC sampler_heap_desc = {};
     sampler_heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
@@ -250,6 +331,25 @@ void Render::create_fence()
     if (graphics_fence_event_ == nullptr) {
         assert(!GetLastError());
     }
+
+    frame_fence_ = new QueueFence(graphics_queue_.Get(), graphics_fence_.Get(), graphics_fence_event_, graphics_fence_value_);
+    frame_ring_ = new FrameRing();
+    frame_ring_->initialize(frame_fence_, 2);
+
+    HRESULT_CHECK(device_->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(constant_ring_size_),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(constant_ring_buffer_.ReleaseAndGetAddressOf())));
+    constant_ring_buffer_->SetName(L"Constant ring");
+    // stays mapped, CPU only writes it
+    uint8_t* constant_memory = nullptr;
+    CD3DX12_RANGE range(0, 0);
+    HRESULT_CHECK(constant_ring_buffer_->Map(0, &range, reinterpret_cast<void**>(&constant_memory)));
+    constant_ring_ = new ConstantRing();
+    constant_ring_->initialize(frame_fence_, constant_memory, constant_ring_buffer_->GetGPUVirtualAddress(), constant_ring_size_);
 }
 
 void Render::setup_viewport()
@@ -272,7 +372,7 @@ void Render::init_imgui()
     imgui_srv_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
     device_->CreateDescriptorHeap(&imgui_srv_heap_desc, IID_PPV_ARGS(imgui_srv_heap_.ReleaseAndGetAddressOf()));
 
-    ImGui_ImplDX12_Init(device_.Get(), swapchain_buffer_count_, DXGI_FORMAT_R8G8B8A8_UNORM, imgui_srv_heap_.Get(),
+    ImGui_ImplDX12_Init(device_.Get(), FrameRing::max_frames_in_flight, DXGI_FORMAT_R8G8B8A8_UNORM, imgui_srv_heap_.Get(),
         imgui_srv_heap_->GetCPUDescriptorHandleForHeapStart(), imgui_srv_heap_->GetGPUDescriptorHandleForHeapStart());
 
     for (int i = 0; i < swapchain_buffer_count_; ++i) {
@@ -289,6 +389,12 @@ void Render::create_cmd_list()
         cmd_list_[i]->SetName(L"Render internal cmd list");
         cmd_list_[i]->Close();
     }
+
+    command_list_device_ = new CommandListDevice(device_.Get(), graphics_queue_.Get());
+    command_list_pool_ = new CommandListPool<CommandListDevice>();
+    command_list_pool_->initialize(command_list_device_);
+    recorder_ = new GraphicsCommandRecorder();
+    recorder_->initialize(command_list_device_, command_list_pool_, D3D12_COMMAND_LIST_TYPE_DIRECT);
 }
 
 void Render::destroy_command_queue()
@@ -317,7 +423,7 @@ void Render::destroy_render_target_views()
 
 void Render::destroy_command_allocator()
 {
-    for (int i = 0; i < swapchain_buffer_count_; ++i) {
+    for (int i = 0; i < FrameRing::max_frames_in_flight; ++i) {
         SAFE_RELEASE(graphics_command_allocator_[i]);
     }
 }
@@ -327,10 +433,26 @@ void Render::destroy_descriptor_heap()
     SAFE_RELEASE(sampler_descriptor_heap_);
     SAFE_RELEASE(gpu_resource_descriptor_heap_);
     SAFE_RELEASE(cpu_resource_descriptor_heap_);
+    // buffers owned by components may be destroyed later, their frees are ignored
+    delete bindless_table_;
+    bindless_table_ = nullptr;
+    delete gpu_descriptor_allocator_;
+    gpu_descriptor_allocator_ = nullptr;
+    delete cpu_descriptor_allocator_;
+    cpu_descriptor_allocator_ = nullptr;
 }
 
 void Render::destroy_fence()
 {
+    delete constant_ring_;
+    constant_ring_ = nullptr;
+    constant_ring_buffer_->Unmap(0, nullptr);
+    SAFE_RELEASE(constant_ring_buffer_);
+    delete frame_ring_;
+    frame_ring_ = nullptr;
+    delete frame_fence_;
+    frame_fence_ = nullptr;
+
     CloseHandle(graphics_fence_event_);
     graphics_fence_event_ = nullptr;
     SAFE_RELEASE(graphics_fence_);
@@ -348,6 +470,14 @@ void Render::term_imgui()
 
 void Render::destroy_cmd_list()
 {
+    delete recorder_;
+    recorder_ = nullptr;
+    command_list_pool_->destroy();
+    delete command_list_pool_;
+    command_list_pool_ = nullptr;
+    delete command_list_device_;
+    command_list_device_ = nullptr;
+
     for (int i = 0; i < swapchain_buffer_count_; ++i) {
         SAFE_RELEASE(cmd_list_[i]);
     }
@@ -359,6 +489,9 @@ void Render::resize()
         return;
     }
 
+    // back buffers can't be referenced by frames in flight
+    wait_idle();
+
     swapchain_->ResizeBuffers(swapchain_buffer_count_,
                                 UINT(Game::inst()->win().screen_width()),
                                 UINT(Game::inst()->win().screen_height()),
@@ -381,7 +514,12 @@ void Render::fullscreen(bool is_fullscreen)
 
 void Render::prepare_frame()
 {
-    { // move camera
+    // input is ignored while replaying
+    const CameraPath::Frame* replayed = Game::inst()->camera_path().replay_frame();
+    if (replayed != nullptr) {
+        camera_->set_camera(replayed->position, replayed->forward);
+    }
+    if (replayed == nullptr) { // move camera
         float camera_move_delta = Game::inst()->delta_time() * 1e2f;
         const auto& keyboard = Game::inst()->win().input()->keyboard();
 
@@ -398,7 +536,7 @@ void Render::prepare_frame()
         camera_->move_up(camera_move_delta * keyboard.space.pressed);
         camera_->move_up(-camera_move_delta * keyboard.c.pressed);
     }
-    { // rotate camera
+    if (replayed == nullptr) { // rotate camera
         const float camera_rotate_delta = Game::inst()->delta_time() / 1e1f;
         const auto& mouse = Game::inst()->win().input()->mouse();
         if (mouse.rbutton.pressed)
@@ -411,24 +549,34 @@ void Render::prepare_frame()
             }
         }
     }
+    Game::inst()->camera_path().record_camera(camera_->position(), camera_->direction());
 
-    // reset command allocators
+    // slot allocator is free once GPU is done with the frame that used the slot
+    frame_ring_->begin_frame();
     HRESULT_CHECK(graphics_command_allocator()->Reset());
-
-    HRESULT_CHECK(cmd_list_[frame_index_]->Reset(graphics_command_allocator().Get(), nullptr));
-    PIXBeginEvent(cmd_list_[frame_index_].Get(), PIX_COLOR(0xFF, 0xFF, 0xFF), "Prepare frame");
-
-    cmd_list_[frame_index_]->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(render_targets_[frame_index_].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
-    cmd_list_[frame_index_]->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(depth_stencil_[frame_index_].Get(),
-        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_DEPTH_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE));
-
-    FLOAT clear_color[4] = { 0.f, 0.f, 0.f, 0.f };
-    cmd_list_[frame_index_]->ClearRenderTargetView(render_target(), clear_color, 0, nullptr);
-    cmd_list_[frame_index_]->ClearDepthStencilView(depth_stencil(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.f, 0, 0, nullptr);
-
-    PIXEndEvent(cmd_list_[frame_index_].Get());
-    HRESULT_CHECK(cmd_list_[frame_index_]->Close());
-    graphics_queue()->ExecuteCommandLists(1, (ID3D12CommandList*const*)cmd_list_[frame_index_].GetAddressOf());
+    constant_ring_->begin_frame();
+    gpu_descriptor_allocator_->begin_frame(frame_slot());
+    bindless_table_->begin_frame(frame_slot());
+    cpu_descriptor_allocator_->begin_frame(0);
+    command_list_pool_->begin_frame(frame_fence_->completed_value());
+
+    graph_executor_->reset();
+    graph_recorder_.reset();
+    graph_executor_->set_resource(back_buffer_resource_, render_targets_[frame_index_].Get());
+    graph_executor_->set_resource(depth_stencil_resource_, depth_stencil_[frame_index_].Get());
+
+    // transitions from present are recorded by the graph before the first pass
+    const GraphPass clear = graph()->add_pass("Clear targets");
+    graph()->write(clear, back_buffer_resource_, GraphState::render_target);
+    graph()->write(clear, depth_stencil_resource_, GraphState::depth_write);
+    const D3D12_CPU_DESCRIPTOR_HANDLE rtv = render_target();
+    const D3D12_CPU_DESCRIPTOR_HANDLE dsv = depth_stencil();
+    record_pass(clear, [rtv, dsv](ID3D12GraphicsCommandList* cmd_list) {
+        PROFILE_PIX_EVENT(cmd_list, PIX_COLOR(0xFF, 0xFF, 0xFF), "Clear targets");
+        FLOAT clear_color[4] = { 0.f, 0.f, 0.f, 0.f };
+        cmd_list->ClearRenderTargetView(rtv, clear_color, 0, nullptr);
+        cmd_list->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.f, 0, 0, nullptr);
+    });
 
     // update camera GPU resources
     camera_->update();
@@ -436,6 +584,16 @@ void Render::prepare_frame()
 
 void Render::end_frame()
 {
+    // ImGui draws to back buffer after the graph, transitions back to present stay after it
+    const GraphPass imgui = graph()->add_pass("ImGui", true);
+    graph()->write(imgui, back_buffer_resource_, GraphState::render_target);
+
+    const CompiledGraph& compiled = graph_executor_->compile(frame_slot());
+    const GraphExecutor* executor = graph_executor_;
+    graph_recorder_.record(compiled, graph()->pass_count(), *recorder_, [executor](ID3D12GraphicsCommandList* cmd_list, const GraphBatch& batch) {
+        executor->record_barriers(cmd_list, batch);
+    });
+    recorder_->flush();
 }
 
 void Render::prepare_imgui()
@@ -468,40 +626,146 @@ void Render::present()
 {
     HRESULT_CHECK(cmd_list_[frame_index_]->Reset(graphics_command_allocator().Get(), nullptr));
     PIXBeginEvent(cmd_list_[frame_index_].Get(), PIX_COLOR(0xFF, 0xFF, 0xFF), "render target transition to present");
-    cmd_list_[frame_index_]->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(render_targets_[frame_index_].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
-    cmd_list_[frame_index_]->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(depth_stencil_[frame_index_].Get(),
-        D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_DEPTH_READ));
+    // barriers after the last pass restore final states of graph resources
+    const CompiledGraph& compiled = graph_executor_->graph()->compiled();
+    if (!compiled.batches.empty() && compiled.batches.back().position == compiled.order.size()) {
+        graph_executor_->record_barriers(cmd_list_[frame_index_].Get(), compiled.batches.back());
+    }
     PIXEndEvent(cmd_list_[frame_index_].Get());
     HRESULT_CHECK(cmd_list_[frame_index_]->Close());
     graphics_queue()->ExecuteCommandLists(1, (ID3D12CommandList* const*)cmd_list_[frame_index_].GetAddressOf());
 
     HRESULT_CHECK(swapchain_->Present(1, 0));
 
-    // wait execution
-    {
-        PIXBeginEvent(graphics_queue_.Get(), PIX_COLOR(0xFF, 0xFF, 0xFF), "sync after present");
-        HRESULT_CHECK(graphics_queue_->Signal(graphics_fence_.Get(), graphics_fence_value_));
+    // frame slot is released by the fence, CPU waits for it only when the slot comes around again
+    PIXSetMarker(graphics_queue_.Get(), PIX_COLOR(0xFF, 0xFF, 0xFF), "end of frame");
+    const uint64_t fence_value = frame_ring_->end_frame();
+    constant_ring_->end_frame(fence_value);
+    command_list_pool_->end_frame(fence_value);
 
-        HRESULT_CHECK(graphics_fence_->SetEventOnCompletion(graphics_fence_value_, graphics_fence_event_));
+    frame_index_ = swapchain_->GetCurrentBackBufferIndex();
+}
 
-        if (graphics_fence_->GetCompletedValue() < graphics_fence_value_) {
-            WaitForSingleObject(graphics_fence_event_, INFINITE);
-        }
+void Render::set_frames_in_flight(uint32_t frames_in_flight)
+{
+    frame_ring_->set_frames_in_flight(frames_in_flight);
+    // slots above the new count are not visited anymore
+    gpu_descriptor_allocator_->release_pending();
+    bindless_table_->release_pending();
+}
 
-        ++graphics_fence_value_;
+uint32_t Render::frames_in_flight() const
+{
+    return frame_ring_->frames_in_flight();
+}
 
-        PIXEndEvent(graphics_queue_.Get());
-    }
+uint32_t Render::frame_slot() const
+{
+    return frame_ring_->frame_slot();
+}
 
-    frame_index_ = swapchain_->GetCurrentBackBufferIndex();
+const FrameRing::Stats& Render::frame_stats() const
+{
+    return frame_ring_->stats();
+}
+
+void Render::wait_idle()
+{
+    frame_ring_->wait_idle();
+}
+
+ID3D12GraphicsCommandList* Render::acquire_command_list(D3D12_COMMAND_LIST_TYPE type)
+{
+    return command_list_pool_->acquire(type);
+}
+
+const CommandListPoolStats& Render::command_list_stats() const
+{
+    return command_list_pool_->stats();
+}
+
+GraphicsCommandRecorder* Render::recorder() const
+{
+    return recorder_;
+}
+
+RenderGraph* Render::graph() const
+{
+    return graph_executor_->graph();
+}
+
+GraphResource Render::import_graph_resource(const std::string& name, ID3D12Resource* resource, uint32_t state, uint32_t final_state)
+{
+    return graph_executor_->import_resource(name, resource, state, final_state);
+}
+
+GraphResource Render::create_transient(const std::string& name, const D3D12_RESOURCE_DESC& desc)
+{
+    return graph_executor_->create_transient(name, desc);
+}
+
+ID3D12Resource* Render::graph_resource(GraphResource resource) const
+{
+    return graph_executor_->resource(resource);
+}
+
+GraphResource Render::back_buffer_resource() const
+{
+    return back_buffer_resource_;
+}
+
+GraphResource Render::depth_stencil_resource() const
+{
+    return depth_stencil_resource_;
+}
+
+void Render::record_pass(GraphPass pass, GraphicsCommandRecorder::Task task)
+{
+    graph_recorder_.record_pass(pass, std::move(task));
+}
+
+void Render::submit_uploads()
+{
+    uploader_->submit();
+    uploader_->retire();
 }
 
 void Render::destroy_resources()
 {
+    // pending copies write into buffers released below
+    wait_idle();
+    uploader_->flush();
+
     camera_->destroy();
     delete camera_;
     camera_ = nullptr;
 
+    geometry_arena_->destroy();
+    delete geometry_arena_;
+    geometry_arena_ = nullptr;
+
+    delete uploader_;
+    uploader_ = nullptr;
+    copy_queue_->destroy();
+    delete copy_queue_;
+    copy_queue_ = nullptr;
+    delete residency_;
+    residency_ = nullptr;
+
+    // pipelines created this run are loaded from the library next time
+    pipeline_library_->save();
+    delete pipeline_cache_;
+    pipeline_cache_ = nullptr;
+    pipeline_library_->destroy();
+    delete pipeline_library_;
+    pipeline_library_ = nullptr;
+    delete shader_cache_;
+    shader_cache_ = nullptr;
+
+    graph_executor_->destroy();
+    delete graph_executor_;
+    graph_executor_ = nullptr;
+
     destroy_cmd_list();
 
     term_imgui();
@@ -534,6 +798,52 @@ Camera* Render::camera() const
     return camera_;
 }
 
+GeometryArena* Render::geometry_arena() const
+{
+    return geometry_arena_;
+}
+
+StagingUploader* Render::uploader() const
+{
+    return uploader_;
+}
+
+ResidencyPolicy* Render::residency() const
+{
+    return residency_;
+}
+
+void Render::set_residency_settings(const ResidencyPolicy::Settings& settings)
+{
+    residency_settings_ = settings;
+    if (residency_ != nullptr) {
+        residency_->set_settings(settings);
+    }
+}
+
+void Render::release_placement(uint32_t& placement)
+{
+    if (residency_ != nullptr) {
+        residency_->release(placement);
+    }
+    placement = ResidencyPolicy::invalid_placement;
+}
+
+PipelineCache* Render::pipeline_cache() const
+{
+    return pipeline_cache_;
+}
+
+ShaderCache* Render::shader_cache() const
+{
+    return shader_cache_;
+}
+
+size_t Render::pipeline_library_bytes() const
+{
+    return pipeline_library_->loaded_bytes();
+}
+
 ComPtr<ID3D12Device> Render::device() const
 {
     return device_;
@@ -546,7 +856,7 @@ ComPtr<ID3D12CommandQueue> Render::graphics_queue() const
 
 ComPtr<ID3D12CommandAllocator> Render::graphics_command_allocator() const
 {
-    return graphics_command_allocator_[frame_index_];
+    return graphics_command_allocator_[frame_ring_->frame_slot()];
 }
 
 ComPtr<ID3D12DescriptorHeap> Render::resource_descriptor_heap() const
@@ -579,27 +889,127 @@ const D3D12_RECT& Render::scissor_rect() const
     return scissor_rect_;
 }
 
-UINT Render::allocate_gpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle)
+DescriptorRange Render::allocate_gpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle, UINT count)
 {
+    DescriptorRange range = gpu_descriptor_allocator_->allocate(count);
+    if (!range.valid()) {
+        // handles of a failed allocation would alias other descriptors, in release builds too
+        throw std::runtime_error("Shader visible descriptor heap is full");
+    }
     {
         CD3DX12_CPU_DESCRIPTOR_HANDLE handle(gpu_resource_descriptor_heap_->GetCPUDescriptorHandleForHeapStart());
-        handle.Offset(gpu_resources_allocated_, resource_descriptor_size_);
+        handle.Offset(range.offset, resource_descriptor_size_);
         cpu_handle = handle;
     }
     {
         CD3DX12_GPU_DESCRIPTOR_HANDLE handle(gpu_resource_descriptor_heap_->GetGPUDescriptorHandleForHeapStart());
-        handle.Offset(gpu_resources_allocated_, resource_descriptor_size_);
+        handle.Offset(range.offset, resource_descriptor_size_);
         gpu_handle = handle;
     }
-    return gpu_resources_allocated_++;
+    return range;
+}
+
+void Render::free_gpu_resource_descriptor(DescriptorRange& range)
+{
+    if (gpu_descriptor_allocator_ != nullptr && range.valid()) {
+        gpu_descriptor_allocator_->free(range);
+    }
+    range = DescriptorRange{};
 }
 
-UINT Render::allocate_cpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle)
+DescriptorRange Render::allocate_cpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, UINT count)
 {
+    DescriptorRange range = cpu_descriptor_allocator_->allocate(count);
+    if (!range.valid()) {
+        throw std::runtime_error("Cpu descriptor heap is full");
+    }
     {
         CD3DX12_CPU_DESCRIPTOR_HANDLE handle(cpu_resource_descriptor_heap_->GetCPUDescriptorHandleForHeapStart());
-        handle.Offset(cpu_resources_allocated_, resource_descriptor_size_);
+        handle.Offset(range.offset, resource_descriptor_size_);
         cpu_handle = handle;
     }
-    return cpu_resources_allocated_++;
+    return range;
+}
+
+void Render::free_cpu_resource_descriptor(DescriptorRange& range)
+{
+    if (cpu_descriptor_allocator_ != nullptr && range.valid()) {
+        cpu_descriptor_allocator_->free(range);
+    }
+    range = DescriptorRange{};
+}
+
+bool Render::allocate_frame_descriptors(UINT count, D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle)
+{
+    const uint32_t offset = gpu_descriptor_allocator_->allocate_frame(count);
+    if (offset == DescriptorAllocator::invalid_offset) {
+        return false;
+    }
+    cpu_handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(gpu_resource_descriptor_heap_->GetCPUDescriptorHandleForHeapStart(), offset, resource_descriptor_size_);
+    gpu_handle = CD3DX12_GPU_DESCRIPTOR_HANDLE(gpu_resource_descriptor_heap_->GetGPUDescriptorHandleForHeapStart(), offset, resource_descriptor_size_);
+    return true;
+}
+
+DescriptorAllocator::Stats Render::descriptor_stats() const
+{
+    return gpu_descriptor_allocator_->stats();
+}
+
+ConstantAllocation Render::allocate_constants(const void* data, UINT size)
+{
+    return constant_ring_->push(data, size);
+}
+
+bool Render::push_constant_buffer(const void* data, UINT size, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle)
+{
+    const ConstantAllocation allocation = constant_ring_->push(data, size);
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle;
+    if (!allocation.valid() || !allocate_frame_descriptors(1, cpu_handle, gpu_handle)) {
+        return false;
+    }
+    D3D12_CONSTANT_BUFFER_VIEW_DESC desc = {};
+    desc.BufferLocation = allocation.gpu_address;
+    desc.SizeInBytes = allocation.size;
+    device_->CreateConstantBufferView(&desc, cpu_handle);
+    return true;
+}
+
+const ConstantRing::Stats& Render::constant_stats() const
+{
+    return constant_ring_->stats();
+}
+
+BindlessHandle Render::register_bindless(uint64_t key, BindlessKind kind, D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, bool& created)
+{
+    const BindlessHandle handle = bindless_table_->add(key, kind, &created);
+    if (!handle.valid()) {
+        OutputDebugString("bindless table is full\n");
+        assert(false);
+        return handle;
+    }
+    cpu_handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(bindless_cpu_, handle.index, resource_descriptor_size_);
+    return handle;
+}
+
+void Render::release_bindless(BindlessHandle& handle)
+{
+    if (bindless_table_ != nullptr && handle.valid()) {
+        bindless_table_->release(handle);
+    }
+    handle = BindlessHandle{};
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE Render::bindless_table() const
+{
+    return bindless_gpu_;
+}
+
+const BindlessTable* Render::bindless() const
+{
+    return bindless_table_;
+}
+
+bool Render::bindless_supported() const
+{
+    return bindless_supported_;
 }
@@ -16,8 +16,23 @@
 using namespace DirectX::SimpleMath;
 using namespace Microsoft::WRL;
 
+#include "render/frame_ring.h"
+#include "render/command_list_device.h"
+#include "render/graph_executor.h"
+#include "render/graph_recorder.hpp"
+#include "render/resource/bindless_table.h"
+#include "render/resource/descriptor_allocator.h"
+#include "render/resource/constant_ring.h"
+#include "render/resource/residency.h"
+
 class GameComponent;
 class Camera;
+class GeometryArena;
+class CopyQueue;
+class StagingUploader;
+class PipelineLibrary;
+class PipelineCache;
+class ShaderCache;
 
 class Render
 {
@@ -60,14 +75,27 @@ private:
     ComPtr<ID3D12Resource> depth_stencil_[swapchain_buffer_count_];
 
     // create_command_allocator
-    ComPtr<ID3D12CommandAllocator> graphics_command_allocator_[swapchain_buffer_count_];
+    // one per frame slot, reset when the slot is reused
+    ComPtr<ID3D12CommandAllocator> graphics_command_allocator_[FrameRing::max_frames_in_flight];
 
     // create_descriptor_heap
+    // persistent ranges and per-frame linear regions of the shader visible heap,
+    // cpu heap holds persistent descriptors only
+    constexpr static uint32_t persistent_descriptor_count_{ 65536 };
+    constexpr static uint32_t frame_descriptor_count_{ 4096 };
+    constexpr static uint32_t cpu_descriptor_count_{ 4096 };
     UINT resource_descriptor_size_;
     ComPtr<ID3D12DescriptorHeap> gpu_resource_descriptor_heap_;
-    UINT gpu_resources_allocated_;
+    DescriptorAllocator* gpu_descriptor_allocator_{ nullptr };
     ComPtr<ID3D12DescriptorHeap> cpu_resource_descriptor_heap_;
-    UINT cpu_resources_allocated_;
+    DescriptorAllocator* cpu_descriptor_allocator_{ nullptr };
+    // global table of views for bindless passes, one persistent range of the shader visible heap
+    BindlessTable* bindless_table_{ nullptr };
+    DescriptorRange bindless_range_;
+    D3D12_CPU_DESCRIPTOR_HANDLE bindless_cpu_{};
+    D3D12_GPU_DESCRIPTOR_HANDLE bindless_gpu_{};
+    // arrays over the whole table index UAVs too, that needs resource binding tier 3
+    bool bindless_supported_{ false };
 
     UINT sampler_descriptor_size_;
     ComPtr<ID3D12DescriptorHeap> sampler_descriptor_heap_;
@@ -76,6 +104,12 @@ private:
     HANDLE graphics_fence_event_;
     ComPtr<ID3D12Fence> graphics_fence_;
     UINT64 graphics_fence_value_{};
+    FrameFence* frame_fence_{ nullptr };
+    FrameRing* frame_ring_{ nullptr };
+    // constant blocks of the frame in one upload buffer, released by the frame fence
+    constexpr static uint64_t constant_ring_size_{ 4 * 1024 * 1024 };
+    ComPtr<ID3D12Resource> constant_ring_buffer_;
+    ConstantRing* constant_ring_{ nullptr };
 
     // defaults
     CD3DX12_VIEWPORT viewport_;
@@ -83,6 +117,17 @@ private:
 
     // internal command list
     ComPtr<ID3D12GraphicsCommandList> cmd_list_[swapchain_buffer_count_];
+    // command lists of components, recycled when their frame completes
+    CommandListDevice* command_list_device_{ nullptr };
+    CommandListPool<CommandListDevice>* command_list_pool_{ nullptr };
+    // records draw tasks of components on workers, submitted in end_frame
+    GraphicsCommandRecorder* recorder_{ nullptr };
+
+    // passes of the frame, their barriers are recorded from the compiled graph
+    GraphExecutor* graph_executor_{ nullptr };
+    GraphResource back_buffer_resource_{ 0 };
+    GraphResource depth_stencil_resource_{ 0 };
+    GraphRecorder<CommandListDevice> graph_recorder_;
 
     // imgui data
     ComPtr<ID3D12DescriptorHeap> imgui_srv_heap_;
@@ -110,6 +155,19 @@ private:
     void destroy_cmd_list();
 
     Camera* camera_{ nullptr };
+    // shared vertex and index pools of meshes
+    GeometryArena* geometry_arena_{ nullptr };
+    // heap placement of buffers
+    ResidencyPolicy* residency_{ nullptr };
+    ResidencyPolicy::Settings residency_settings_;
+    // buffer uploads through one staging ring on copy queue
+    CopyQueue* copy_queue_{ nullptr };
+    StagingUploader* uploader_{ nullptr };
+    // root signatures and PSOs shared by description, PSOs kept on disk between runs
+    PipelineLibrary* pipeline_library_{ nullptr };
+    PipelineCache* pipeline_cache_{ nullptr };
+    // compiled shader permutations written by the build
+    ShaderCache* shader_cache_{ nullptr };
 public:
     Render() = default;
     ~Render() = default;
@@ -126,9 +184,51 @@ public:
 
     void present();
 
+    // frames recorded by CPU while GPU executes previous ones, 1 - wait for every frame
+    void set_frames_in_flight(uint32_t frames_in_flight);
+    uint32_t frames_in_flight() const;
+    // slot of per-frame data of the frame being recorded
+    uint32_t frame_slot() const;
+    const FrameRing::Stats& frame_stats() const;
+    // waits until GPU is done with all submitted frames
+    void wait_idle();
+
+    // open list with its own allocator, don't keep it after the frame
+    ID3D12GraphicsCommandList* acquire_command_list(D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
+    const CommandListPoolStats& command_list_stats() const;
+    // tasks recorded in parallel and submitted in deterministic order in end_frame
+    GraphicsCommandRecorder* recorder() const;
+
+    // passes declared between prepare_frame and end_frame are compiled and recorded in end_frame,
+    // resources are imported before transient ones are created, e.g. in initialize or update
+    RenderGraph* graph() const;
+    GraphResource import_graph_resource(const std::string& name, ID3D12Resource* resource, uint32_t state,
+                                        uint32_t final_state = RenderGraph::keep_state);
+    GraphResource create_transient(const std::string& name, const D3D12_RESOURCE_DESC& desc);
+    // transient resources are valid only in pass tasks
+    ID3D12Resource* graph_resource(GraphResource resource) const;
+    GraphResource back_buffer_resource() const;
+    GraphResource depth_stencil_resource() const;
+    // task records into its own list after the barriers of the pass, tasks of a pass keep call order
+    void record_pass(GraphPass pass, GraphicsCommandRecorder::Task task);
+
+    // executes uploads recorded so far, graphics work submitted later sees the data
+    void submit_uploads();
+
     void destroy_resources();
 
     Camera* camera() const;
+    GeometryArena* geometry_arena() const;
+    StagingUploader* uploader() const;
+    ResidencyPolicy* residency() const;
+    // before initialize, e.g. from the command line: buffers are placed at load
+    void set_residency_settings(const ResidencyPolicy::Settings& settings);
+    // released buffer leaves the placement report
+    void release_placement(uint32_t& placement);
+    PipelineCache* pipeline_cache() const;
+    ShaderCache* shader_cache() const;
+    // bytes of the pipeline library read at startup, 0 on a cold start
+    size_t pipeline_library_bytes() const;
 
     ComPtr<ID3D12Device> device() const;
 
@@ -146,6 +246,28 @@ public:
     const D3D12_VIEWPORT& viewport() const;
     const D3D12_RECT& scissor_rect() const;
 
-    UINT allocate_gpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle);
-    UINT allocate_cpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle);
+    // descriptors live until freed, freed ranges are reused after the frames in flight complete;
+    // a full heap throws std::runtime_error, returned ranges are always valid
+    DescriptorRange allocate_gpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle, UINT count = 1);
+    void free_gpu_resource_descriptor(DescriptorRange& range);
+    DescriptorRange allocate_cpu_resource_descriptor(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, UINT count = 1);
+    void free_cpu_resource_descriptor(DescriptorRange& range);
+    // count contiguous shader visible descriptors valid until the end of the current frame
+    bool allocate_frame_descriptors(UINT count, D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle);
+    DescriptorAllocator::Stats descriptor_stats() const;
+
+    // constant block valid until the end of the current frame, for data that changes every draw or dispatch
+    ConstantAllocation allocate_constants(const void* data, UINT size);
+    // constant block with its view in the frame region of the heap, false if either ran out
+    bool push_constant_buffer(const void* data, UINT size, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_handle);
+    const ConstantRing::Stats& constant_stats() const;
+
+    // index of the view of key in the global table, when created is set the caller writes the view at cpu_handle
+    BindlessHandle register_bindless(uint64_t key, BindlessKind kind, D3D12_CPU_DESCRIPTOR_HANDLE& cpu_handle, bool& created);
+    void release_bindless(BindlessHandle& handle);
+    // start of the table, bound once per list by bindless passes
+    D3D12_GPU_DESCRIPTOR_HANDLE bindless_table() const;
+    const BindlessTable* bindless() const;
+    // bindless passes fall back to per draw tables when false
+    bool bindless_supported() const;
 };
@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+
+#include "core/profiler.h"
+#include "render_graph.h"
+
+namespace
+{
+
+bool is_read_state(uint32_t state)
+{
+    return (state & GraphState::write_states) == 0;
+}
+
+uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::string state_name(uint32_t state)
+{
+    static const char* names[] = {
+        "render_target", "unordered_access", "depth_write", "depth_read", "non_pixel_shader_resource",
+        "pixel_shader_resource", "copy_dest", "copy_source", "vertex_and_constant_buffer", "index_buffer",
+    };
+    if (state == GraphState::common) {
+        return "common";
+    }
+    std::string name;
+    for (uint32_t i = 0; i < std::size(names); ++i) {
+        if (state & (1u << i)) {
+            name += (name.empty() ? "" : "|") + std::string(names[i]);
+        }
+    }
+    return name;
+}
+
+// barriers of one batch: restores of finished transients before aliasing barriers that take their memory over
+enum BarrierRank : uint32_t
+{
+    rank_restore,
+    rank_aliasing,
+    rank_transition,
+    rank_uav,
+};
+
+} // namespace
+
+GraphResource RenderGraph::import_resource(const std::string& name, uint32_t state, uint32_t final_state)
+{
+    // imported resources keep their ids across reset
+    assert(resources_.size() == imported_count_);
+    resources_.push_back({ name, false, state, final_state, 0, 0 });
+    ++imported_count_;
+    return GraphResource(resources_.size() - 1);
+}
+
+GraphResource RenderGraph::create_transient(const std::string& name, uint64_t size, uint64_t alignment)
+{
+    assert(size > 0 && alignment > 0);
+    resources_.push_back({ name, true, GraphState::common, GraphState::common, size, alignment });
+    return GraphResource(resources_.size() - 1);
+}
+
+GraphPass RenderGraph::add_pass(const std::string& name, bool side_effects)
+{
+    passes_.push_back({ name, side_effects, {} });
+    return GraphPass(passes_.size() - 1);
+}
+
+void RenderGraph::read(GraphPass pass, GraphResource resource, uint32_t state)
+{
+    access(pass, resource, state, false);
+}
+
+void RenderGraph::write(GraphPass pass, GraphResource resource, uint32_t state)
+{
+    access(pass, resource, state, true);
+}
+
+void RenderGraph::access(GraphPass pass, GraphResource resource, uint32_t state, bool write)
+{
+    assert(pass < passes_.size() && resource < resources_.size());
+    for (Access& access : passes_[pass].accesses) {
+        if (access.resource == resource) {
+            access.state |= state;
+            access.write |= write;
+            // one state per pass, write states can't be combined
+            assert(is_read_state(access.state) || (access.state & (access.state - 1)) == 0);
+            return;
+        }
+    }
+    passes_[pass].accesses.push_back({ resource, state, write });
+}
+
+void RenderGraph::reset()
+{
+    resources_.resize(imported_count_);
+    passes_.clear();
+}
+
+std::vector<bool> RenderGraph::cull() const
+{
+    // producers of a pass are the last writers of the resources it accesses
+    std::vector<std::vector<GraphPass>> producers(passes_.size());
+    std::vector<GraphPass> last_writer(resources_.size(), ~0u);
+    for (GraphPass pass = 0; pass < passes_.size(); ++pass) {
+        for (const Access& access : passes_[pass].accesses) {
+            if (last_writer[access.resource] != ~0u) {
+                producers[pass].push_back(last_writer[access.resource]);
+            }
+            if (access.write) {
+                last_writer[access.resource] = pass;
+            }
+        }
+    }
+
+    // passes writing imported resources are roots, producers come before their consumers
+    std::vector<bool> alive(passes_.size(), false);
+    for (GraphPass pass = GraphPass(passes_.size()); pass-- > 0;) {
+        if (!alive[pass]) {
+            alive[pass] = passes_[pass].side_effects || std::any_of(passes_[pass].accesses.begin(), passes_[pass].accesses.end(),
+                [this](const Access& access) { return access.write && !resources_[access.resource].transient; });
+        }
+        if (alive[pass]) {
+            for (GraphPass producer : producers[pass]) {
+                alive[producer] = true;
+            }
+        }
+    }
+    return alive;
+}
+
+void RenderGraph::place_transients(const std::vector<std::vector<Use>>& uses)
+{
+    struct Lifetime
+    {
+        GraphResource resource;
+        uint32_t first;
+        uint32_t last;
+    };
+
+    std::vector<Lifetime> lifetimes;
+    for (GraphResource resource = imported_count_; resource < resources_.size(); ++resource) {
+        if (!uses[resource].empty()) {
+            lifetimes.push_back({ resource, uses[resource].front().position, uses[resource].back().position });
+            // contents of a transient resource are undefined on first use
+            assert(uses[resource].front().write);
+        }
+    }
+    // largest first, ties by id to stay deterministic
+    std::sort(lifetimes.begin(), lifetimes.end(), [this](const Lifetime& a, const Lifetime& b) {
+        const uint64_t size_a = resources_[a.resource].size;
+        const uint64_t size_b = resources_[b.resource].size;
+        return size_a != size_b ? size_a > size_b : a.resource < b.resource;
+    });
+
+    std::vector<Lifetime> placed;
+    for (const Lifetime& lifetime : lifetimes) {
+        const Resource& resource = resources_[lifetime.resource];
+        std::vector<const CompiledGraph::Placement*> conflicts;
+        for (size_t i = 0; i < placed.size(); ++i) {
+            if (placed[i].first <= lifetime.last && lifetime.first <= placed[i].last) {
+                conflicts.push_back(&compiled_.placements[i]);
+            }
+        }
+
+        // lowest offset after 0 or after a conflicting resource that overlaps none of them
+        std::vector<uint64_t> candidates = { 0 };
+        for (const CompiledGraph::Placement* conflict : conflicts) {
+            candidates.push_back(align_up(conflict->offset + conflict->size, resource.alignment));
+        }
+        std::sort(candidates.begin(), candidates.end());
+        uint64_t offset = 0;
+        for (uint64_t candidate : candidates) {
+            const bool fits = std::none_of(conflicts.begin(), conflicts.end(), [&](const CompiledGraph::Placement* conflict) {
+                return candidate < conflict->offset + conflict->size && conflict->offset < candidate + resource.size;
+            });
+            if (fits) {
+                offset = candidate;
+                break;
+            }
+        }
+
+        placed.push_back(lifetime);
+        compiled_.placements.push_back({ lifetime.resource, offset, resource.size, uses[lifetime.resource].front().state });
+        compiled_.stats.transient_bytes += resource.size;
+        compiled_.stats.heap_bytes = std::max(compiled_.stats.heap_bytes, offset + resource.size);
+    }
+}
+
+void RenderGraph::emit_barriers(const std::vector<std::vector<Use>>& uses, std::vector<PendingBarrier>& pending)
+{
+    const uint32_t end = uint32_t(compiled_.order.size());
+
+    // memory sharing between transient resources
+    std::vector<uint32_t> restore_limit(resources_.size(), end);
+    for (const CompiledGraph::Placement& placement : compiled_.placements) {
+        uint32_t lo = 0;
+        GraphResource before = GraphBarrier::invalid;
+        bool shared = false;
+        const uint32_t first = uses[placement.resource].front().position;
+        for (const CompiledGraph::Placement& other : compiled_.placements) {
+            if (other.resource == placement.resource
+                || placement.offset >= other.offset + other.size || other.offset >= placement.offset + placement.size) {
+                continue;
+            }
+            shared = true;
+            const uint32_t other_first = uses[other.resource].front().position;
+            const uint32_t other_last = uses[other.resource].back().position;
+            if (other_last < first && other_last + 1 >= lo) {
+                lo = other_last + 1;
+                before = other.resource;
+            }
+            if (other_first > first) {
+                restore_limit[placement.resource] = std::min(restore_limit[placement.resource], other_first);
+            }
+        }
+        // memory is also shared with resources of the previous frame that used the heap
+        if (shared) {
+            pending.push_back({ { GraphBarrier::Type::aliasing, placement.resource, 0, 0, before }, lo, first, rank_aliasing });
+        }
+    }
+
+    for (GraphResource id = 0; id < resources_.size(); ++id) {
+        Resource& resource = resources_[id];
+        const std::vector<Use>& resource_uses = uses[id];
+        if (resource.transient && resource_uses.empty()) {
+            continue;
+        }
+
+        uint32_t state = resource.transient ? resource_uses.front().state : resource.state;
+        uint32_t lo = 0;
+        bool uav_write = false;
+        bool uav_access = false;
+        for (size_t i = 0; i < resource_uses.size(); ++i) {
+            const Use& use = resource_uses[i];
+            uint32_t target = use.state;
+            bool covered = false;
+            if (is_read_state(use.state)) {
+                covered = is_read_state(state) && (use.state & ~state) == 0 && (use.state != GraphState::common || state == GraphState::common);
+                if (!covered) {
+                    // one transition to the state all following reads need
+                    for (size_t j = i + 1; j < resource_uses.size() && !resource_uses[j].write && is_read_state(resource_uses[j].state); ++j) {
+                        if (resource_uses[j].state & ~target) {
+                            ++compiled_.stats.merged_reads;
+                        }
+                        target |= resource_uses[j].state;
+                    }
+                }
+            }
+
+            if (!covered && state != target) {
+                pending.push_back({ { GraphBarrier::Type::transition, id, state, target, GraphBarrier::invalid }, lo, use.position, rank_transition });
+                state = target;
+                uav_write = false;
+                uav_access = false;
+            } else if ((state & GraphState::unordered_access) && uav_access && (uav_write || use.write)) {
+                pending.push_back({ { GraphBarrier::Type::uav, id, state, state, GraphBarrier::invalid }, lo, use.position, rank_uav });
+                uav_write = false;
+            }
+            uav_access = (state & GraphState::unordered_access) != 0;
+            uav_write |= uav_access && use.write;
+            lo = use.position + 1;
+        }
+
+        // transient resources go back to the state they are created in before their memory is taken over
+        const uint32_t final_state = resource.transient ? resource_uses.front().state
+            : resource.final_state != keep_state ? resource.final_state : state;
+        if (state != final_state) {
+            const uint32_t hi = resource.transient ? restore_limit[id] : end;
+            pending.push_back({ { GraphBarrier::Type::transition, id, state, final_state, GraphBarrier::invalid }, lo, hi,
+                resource.transient ? rank_restore : rank_transition });
+        }
+        if (!resource.transient) {
+            resource.state = final_state;
+        }
+    }
+}
+
+void RenderGraph::build_batches(std::vector<PendingBarrier>& pending)
+{
+    compiled_.stats.barriers = uint32_t(pending.size());
+
+    std::vector<uint32_t> unhoisted;
+    for (const PendingBarrier& barrier : pending) {
+        unhoisted.push_back(barrier.hi);
+    }
+    std::sort(unhoisted.begin(), unhoisted.end());
+    compiled_.stats.unhoisted_batches = uint32_t(std::unique(unhoisted.begin(), unhoisted.end()) - unhoisted.begin());
+
+    // fewest points covering all [lo, hi] windows: the earliest ending window not covered yet takes its hi
+    std::stable_sort(pending.begin(), pending.end(), [](const PendingBarrier& a, const PendingBarrier& b) {
+        return a.hi < b.hi;
+    });
+    std::vector<std::pair<uint32_t, const PendingBarrier*>> assigned;
+    for (const PendingBarrier& barrier : pending) {
+        if (compiled_.batches.empty() || barrier.lo > compiled_.batches.back().position) {
+            compiled_.batches.push_back({ barrier.hi, {} });
+        }
+        assigned.push_back({ uint32_t(compiled_.batches.size() - 1), &barrier });
+    }
+    std::stable_sort(assigned.begin(), assigned.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : a.second->rank < b.second->rank;
+    });
+    for (const auto& [batch, barrier] : assigned) {
+        compiled_.batches[batch].barriers.push_back(barrier->barrier);
+    }
+    compiled_.stats.batches = uint32_t(compiled_.batches.size());
+}
+
+const CompiledGraph& RenderGraph::compile()
+{
+    PROFILE_ZONE("Compile render graph");
+    compiled_ = CompiledGraph{};
+
+    // dependencies follow declaration order, so passes left after culling are already in topological order
+    const std::vector<bool> alive = cull();
+    for (GraphPass pass = 0; pass < passes_.size(); ++pass) {
+        if (alive[pass]) {
+            compiled_.order.push_back(pass);
+        }
+    }
+    compiled_.stats.passes = uint32_t(compiled_.order.size());
+    compiled_.stats.culled_passes = uint32_t(passes_.size() - compiled_.order.size());
+
+    std::vector<std::vector<Use>> uses(resources_.size());
+    for (uint32_t position = 0; position < compiled_.order.size(); ++position) {
+        for (const Access& access : passes_[compiled_.order[position]].accesses) {
+            uses[access.resource].push_back({ position, access.state, access.write });
+        }
+    }
+
+    place_transients(uses);
+    std::vector<PendingBarrier> pending;
+    emit_barriers(uses, pending);
+    build_batches(pending);
+    return compiled_;
+}
+
+std::string RenderGraph::report() const
+{
+    const CompiledGraph::Stats& stats = compiled_.stats;
+    std::stringstream ss;
+    ss << stats.passes << " passes, " << stats.culled_passes << " culled\n"
+       << stats.barriers << " barriers in " << stats.batches << " batches, "
+       << stats.unhoisted_batches << " without hoisting, " << stats.merged_reads << " read transitions merged\n";
+    ss << std::fixed << std::setprecision(1)
+       << "transient " << stats.transient_bytes / 1024.0 << " KB in heap of " << stats.heap_bytes / 1024.0 << " KB, saved "
+       << (stats.transient_bytes - stats.heap_bytes) / 1024.0 << " KB\n";
+
+    size_t batch = 0;
+    for (uint32_t position = 0; position <= compiled_.order.size(); ++position) {
+        for (; batch < compiled_.batches.size() && compiled_.batches[batch].position == position; ++batch) {
+            for (const GraphBarrier& barrier : compiled_.batches[batch].barriers) {
+                ss << "    " << std::left << std::setw(12)
+                   << (barrier.type == GraphBarrier::Type::transition ? "transition" : barrier.type == GraphBarrier::Type::uav ? "uav" : "aliasing")
+                   << std::setw(28) << resources_[barrier.resource].name;
+                if (barrier.type == GraphBarrier::Type::transition) {
+                    ss << state_name(barrier.state_before) << " -> " << state_name(barrier.state_after);
+                } else if (barrier.type == GraphBarrier::Type::aliasing && barrier.before != GraphBarrier::invalid) {
+                    ss << "after " << resources_[barrier.before].name;
+                }
+                ss << "\n";
+            }
+        }
+        if (position < compiled_.order.size()) {
+            ss << passes_[compiled_.order[position]].name << "\n";
+        }
+    }
+    for (const CompiledGraph::Placement& placement : compiled_.placements) {
+        ss << std::left << std::setw(28) << resources_[placement.resource].name
+           << std::right << std::setw(12) << placement.offset / 1024.0 << " KB offset, "
+           << placement.size / 1024.0 << " KB\n";
+    }
+    return ss.str();
+}
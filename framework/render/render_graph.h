@@ -0,0 +1,173 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// resource states of the graph, mapped to D3D12_RESOURCE_STATES by Render
+namespace GraphState
+{
+constexpr uint32_t common = 0;
+constexpr uint32_t present = common;
+constexpr uint32_t render_target = 1u << 0;
+constexpr uint32_t unordered_access = 1u << 1;
+constexpr uint32_t depth_write = 1u << 2;
+constexpr uint32_t depth_read = 1u << 3;
+constexpr uint32_t non_pixel_shader_resource = 1u << 4;
+constexpr uint32_t pixel_shader_resource = 1u << 5;
+constexpr uint32_t copy_dest = 1u << 6;
+constexpr uint32_t copy_source = 1u << 7;
+constexpr uint32_t vertex_and_constant_buffer = 1u << 8;
+constexpr uint32_t index_buffer = 1u << 9;
+
+// states a resource can't share with any other state
+constexpr uint32_t write_states = render_target | unordered_access | depth_write | copy_dest;
+} // namespace GraphState
+
+using GraphResource = uint32_t;
+using GraphPass = uint32_t;
+
+struct GraphBarrier
+{
+    enum class Type
+    {
+        transition,
+        uav,      // between passes accessing the same resource as UAV
+        aliasing, // transient resource takes memory over, before is the previous owner or invalid
+    };
+
+    static constexpr GraphResource invalid = ~0u;
+
+    Type type;
+    GraphResource resource;
+    uint32_t state_before;
+    uint32_t state_after;
+    GraphResource before;
+};
+
+// barriers recorded before the pass at position of CompiledGraph::order, position == order.size() - after the last pass
+struct GraphBatch
+{
+    uint32_t position;
+    std::vector<GraphBarrier> barriers;
+};
+
+struct CompiledGraph
+{
+    struct Placement
+    {
+        GraphResource resource;
+        uint64_t offset;
+        uint64_t size;
+        uint32_t initial_state; // transient resources are created and kept in the state of their first access
+    };
+
+    struct Stats
+    {
+        uint32_t passes{ 0 };
+        uint32_t culled_passes{ 0 };
+        uint32_t barriers{ 0 };
+        uint32_t batches{ 0 };
+        uint32_t unhoisted_batches{ 0 }; // batches if every barrier stayed right before the pass that needs it
+        uint32_t merged_reads{ 0 };      // transitions saved by moving to combined read state once
+        uint64_t transient_bytes{ 0 };   // transient resources without aliasing
+        uint64_t heap_bytes{ 0 };        // transient heap with aliasing
+    };
+
+    std::vector<GraphPass> order;
+    std::vector<GraphBatch> batches; // ascending position
+    std::vector<Placement> placements;
+    Stats stats;
+};
+
+// Frame graph of passes that declare which named resources they read and write and in which state.
+// compile() culls passes nothing depends on and keeps the rest in declaration order, which is topological
+// because dependencies are derived from it, then tracks resource states and emits barriers. Every barrier can be issued anywhere after the previous access of its resource,
+// so barriers are hoisted to the fewest batch points that cover all of them; successive reads get one
+// transition to the combined read state. Transient resources are placed in one heap, resources with
+// disjoint lifetimes share memory and get an aliasing barrier on first use.
+// Imported resources live across frames, their state is carried over to the next frame;
+// passes and transient resources are declared again every frame after reset().
+class RenderGraph
+{
+public:
+    struct Resource
+    {
+        std::string name;
+        bool transient;
+        uint32_t state;       // imported: state at the start of frame
+        uint32_t final_state; // imported: state at the end of frame, keep_state - whatever the last pass left
+        uint64_t size;        // transient
+        uint64_t alignment;
+    };
+
+    struct Access
+    {
+        GraphResource resource;
+        uint32_t state;
+        bool write;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        bool side_effects;
+        std::vector<Access> accesses;
+    };
+
+    static constexpr uint32_t keep_state = ~0u;
+
+    RenderGraph() = default;
+    ~RenderGraph() = default;
+
+    // resource outliving the frame in state, final_state is restored at the end of every frame
+    GraphResource import_resource(const std::string& name, uint32_t state, uint32_t final_state = keep_state);
+    // resource living only between its first and last access this frame
+    GraphResource create_transient(const std::string& name, uint64_t size, uint64_t alignment);
+
+    // passes with side effects (e.g. writes outside of the graph) are never culled
+    GraphPass add_pass(const std::string& name, bool side_effects = false);
+    void read(GraphPass pass, GraphResource resource, uint32_t state);
+    void write(GraphPass pass, GraphResource resource, uint32_t state);
+
+    // drops passes and transient resources, imported resources keep their states
+    void reset();
+    // compiles declared passes, imported resource states move to the end of frame
+    const CompiledGraph& compile();
+
+    const CompiledGraph& compiled() const { return compiled_; }
+    const Resource& resource(GraphResource resource) const { return resources_[resource]; }
+    const Pass& pass(GraphPass pass) const { return passes_[pass]; }
+    uint32_t resource_count() const { return uint32_t(resources_.size()); }
+    uint32_t pass_count() const { return uint32_t(passes_.size()); }
+
+    // pass order, barrier batches and saved memory of the last compile
+    std::string report() const;
+private:
+    struct Use
+    {
+        uint32_t position;
+        uint32_t state;
+        bool write;
+    };
+
+    // barrier that can be issued at any batch point in [lo, hi]
+    struct PendingBarrier
+    {
+        GraphBarrier barrier;
+        uint32_t lo;
+        uint32_t hi;
+        uint32_t rank; // order inside a batch
+    };
+
+    void access(GraphPass pass, GraphResource resource, uint32_t state, bool write);
+    std::vector<bool> cull() const;
+    void place_transients(const std::vector<std::vector<Use>>& uses);
+    void emit_barriers(const std::vector<std::vector<Use>>& uses, std::vector<PendingBarrier>& pending);
+    void build_batches(std::vector<PendingBarrier>& pending);
+
+    std::vector<Resource> resources_;
+    uint32_t imported_count_{ 0 };
+    std::vector<Pass> passes_;
+    CompiledGraph compiled_;
+};
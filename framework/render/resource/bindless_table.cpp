@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <sstream>
+#include <iomanip>
+
+#include "bindless_table.h"
+
+void BindlessTable::initialize(uint32_t capacity, uint32_t frame_slots)
+{
+    assert(frame_slots > 0);
+    entries_.assign(capacity, Entry{});
+    // ascending order is a valid min heap
+    free_.clear();
+    for (uint32_t i = 0; i < capacity; ++i) {
+        free_.push_back(i);
+    }
+    indices_.clear();
+    pending_free_.assign(frame_slots, {});
+    slot_ = 0;
+    used_ = 0;
+    peak_ = 0;
+    failed_registrations_ = 0;
+}
+
+BindlessHandle BindlessTable::add(uint64_t key, BindlessKind kind, bool* created)
+{
+    if (created != nullptr) {
+        *created = false;
+    }
+    auto it = indices_.find(key);
+    if (it != indices_.end()) {
+        Entry& entry = entries_[it->second];
+        assert(entry.kind == kind);
+        ++entry.references;
+        return { it->second, entry.generation };
+    }
+    if (free_.empty()) {
+        ++failed_registrations_;
+        return BindlessHandle{};
+    }
+
+    std::pop_heap(free_.begin(), free_.end(), std::greater<uint32_t>());
+    const uint32_t index = free_.back();
+    free_.pop_back();
+
+    Entry& entry = entries_[index];
+    entry.key = key;
+    entry.references = 1;
+    entry.kind = kind;
+    indices_.emplace(key, index);
+    ++used_;
+    peak_ = std::max(peak_, used_);
+    if (created != nullptr) {
+        *created = true;
+    }
+    return { index, entry.generation };
+}
+
+void BindlessTable::release(BindlessHandle& handle)
+{
+    assert(is_valid(handle));
+    Entry& entry = entries_[handle.index];
+    if (--entry.references == 0) {
+        // key may be registered again right away, it gets a new index
+        indices_.erase(entry.key);
+        ++entry.generation;
+        pending_free_[slot_].push_back(handle.index);
+    }
+    handle = BindlessHandle{};
+}
+
+bool BindlessTable::is_valid(const BindlessHandle& handle) const
+{
+    return handle.valid() && handle.index < entries_.size() && entries_[handle.index].references > 0
+        && entries_[handle.index].generation == handle.generation;
+}
+
+uint32_t BindlessTable::find(uint64_t key) const
+{
+    auto it = indices_.find(key);
+    return it != indices_.end() ? it->second : BindlessHandle::invalid_index;
+}
+
+void BindlessTable::begin_frame(uint32_t slot)
+{
+    assert(slot < pending_free_.size());
+    slot_ = slot;
+    for (uint32_t index : pending_free_[slot_]) {
+        free_index(index);
+    }
+    pending_free_[slot_].clear();
+}
+
+void BindlessTable::release_pending()
+{
+    for (std::vector<uint32_t>& pending : pending_free_) {
+        for (uint32_t index : pending) {
+            free_index(index);
+        }
+        pending.clear();
+    }
+}
+
+void BindlessTable::free_index(uint32_t index)
+{
+    free_.push_back(index);
+    std::push_heap(free_.begin(), free_.end(), std::greater<uint32_t>());
+    --used_;
+}
+
+BindlessTable::Stats BindlessTable::stats() const
+{
+    Stats stats;
+    stats.capacity = capacity();
+    stats.used = used_;
+    stats.peak = peak_;
+    for (const std::vector<uint32_t>& pending : pending_free_) {
+        stats.pending_free += uint32_t(pending.size());
+    }
+    stats.failed_registrations = failed_registrations_;
+    return stats;
+}
+
+std::string BindlessTable::report() const
+{
+    static const char* kind_names[] = { "cbv", "srv", "uav" };
+
+    std::stringstream ss;
+    ss << "bindless table: " << used_ << " / " << capacity() << " used, peak " << peak_ << "\n";
+    ss << std::left << std::setw(8) << "index" << std::setw(6) << "kind" << std::right << std::setw(6) << "refs"
+       << std::setw(20) << "key" << "\n";
+    for (uint32_t i = 0; i < capacity(); ++i) {
+        const Entry& entry = entries_[i];
+        if (entry.references == 0) {
+            continue;
+        }
+        ss << std::left << std::setw(8) << i << std::setw(6) << kind_names[uint32_t(entry.kind)] << std::right
+           << std::setw(6) << entry.references << std::setw(20) << std::hex << entry.key << std::dec << "\n";
+    }
+    return ss.str();
+}
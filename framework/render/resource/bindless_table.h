@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <string>
+
+// how the shader reads the entry, one array per kind and element type overlaps the whole table
+enum class BindlessKind : uint8_t
+{
+    constant_buffer,
+    buffer,
+    rw_texture,
+};
+
+struct BindlessHandle
+{
+    static constexpr uint32_t invalid_index = ~0u;
+
+    uint32_t index{ invalid_index };
+    uint32_t generation{ 0 };
+
+    bool valid() const { return index != invalid_index; }
+};
+
+// Indices of one global table of views, doesn't know about D3D12.
+// A view is registered once under a key unique to it (e.g. GPU address of the buffer version)
+// and keeps its index until released; registering the same key again returns the same index.
+// Released indices are reused when the frame slot that released them comes back, frames in flight may still read them.
+// Lowest free index is taken first, so the used part of the table stays dense.
+class BindlessTable
+{
+public:
+    struct Stats
+    {
+        uint32_t capacity{ 0 };
+        uint32_t used{ 0 };
+        uint32_t peak{ 0 };
+        uint32_t pending_free{ 0 };
+        uint32_t failed_registrations{ 0 };
+    };
+
+    BindlessTable() = default;
+    ~BindlessTable() = default;
+
+    void initialize(uint32_t capacity, uint32_t frame_slots);
+    uint32_t capacity() const { return uint32_t(entries_.size()); }
+
+    // invalid handle if the table is full; created is true when the caller has to write the view
+    BindlessHandle add(uint64_t key, BindlessKind kind, bool* created = nullptr);
+    // every add of the key needs its release
+    void release(BindlessHandle& handle);
+    bool is_valid(const BindlessHandle& handle) const;
+
+    // invalid_index if the key isn't registered
+    uint32_t find(uint64_t key) const;
+    BindlessKind kind(uint32_t index) const { return entries_[index].kind; }
+
+    // releases indices freed when the slot was used before
+    void begin_frame(uint32_t slot);
+    // releases indices of all slots, GPU has to be idle
+    void release_pending();
+
+    Stats stats() const;
+    std::string report() const;
+private:
+    struct Entry
+    {
+        uint64_t key{ 0 };
+        uint32_t references{ 0 };
+        uint32_t generation{ 0 };
+        BindlessKind kind{ BindlessKind::buffer };
+    };
+
+    std::vector<Entry> entries_;
+    // min heap of free indices
+    std::vector<uint32_t> free_;
+    std::unordered_map<uint64_t, uint32_t> indices_;
+    std::vector<std::vector<uint32_t>> pending_free_; // by frame slot
+    uint32_t slot_{ 0 };
+    uint32_t used_{ 0 };
+    uint32_t peak_{ 0 };
+    uint32_t failed_registrations_{ 0 };
+
+    void free_index(uint32_t index);
+};
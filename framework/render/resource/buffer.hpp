@@ -3,24 +3,90 @@
 #include "core/game.h"
 #include "render/common.h"
 #include "render/render.h"
+#include "render/resource/staging_uploader.h"
+#include "render/resource/residency.h"
 
+#include <string>
+#include <vector>
 #include <Windows.h>
 #include <wrl.h>
 #include <d3d12.h>
 
 using namespace Microsoft::WRL;
 
+// committed buffer in the heap chosen by Render::residency
+// default heap buffer is created in COMMON state and filled by the uploader, mapped_ptr is nullptr
+// upload heap buffer is mapped for good and data is copied at once; data can be nullptr in both
+// placement stays in the report until Render::release_placement
+inline ComPtr<ID3D12Resource> create_buffer(const std::string& name, BufferUsage usage, const void* data, UINT64 bytes, void** mapped_ptr,
+                                            uint32_t& placement)
+{
+    auto device = Game::inst()->render().device();
+    const HeapPlacement heap = Game::inst()->render().residency()->place(name, usage, bytes, placement);
+
+    ComPtr<ID3D12Resource> resource;
+    HRESULT_CHECK(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(heap == HeapPlacement::default_heap ? D3D12_HEAP_TYPE_DEFAULT : D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(bytes),
+        heap == HeapPlacement::default_heap ? D3D12_RESOURCE_STATE_COMMON : D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(resource.ReleaseAndGetAddressOf())));
+    resource->SetName(std::wstring(name.begin(), name.end()).c_str());
+
+    *mapped_ptr = nullptr;
+    if (heap == HeapPlacement::default_heap) {
+        if (data != nullptr) {
+            Game::inst()->render().uploader()->upload(resource.Get(), 0, data, bytes);
+        }
+    } else {
+        CD3DX12_RANGE range(0, 0);
+        HRESULT_CHECK(resource->Map(0, &range, mapped_ptr));
+        if (data != nullptr) {
+            memcpy(*mapped_ptr, data, size_t(bytes));
+        }
+    }
+    return resource;
+}
+
+// one version per frame slot, update() writes the version of the current frame
+// other versions are refreshed from the last data when their slot binds them, GPU is done with them by then
 template<class T>
 class ConstBuffer
 {
 private:
     static_assert(sizeof(T) % D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT == 0);
+    static constexpr UINT version_count = FrameRing::max_frames_in_flight;
 
     ComPtr<ID3D12Resource> resource_;
-    UINT resource_index_;
-    D3D12_CPU_DESCRIPTOR_HANDLE resource_view_;
-    D3D12_GPU_DESCRIPTOR_HANDLE resource_view_gpu_;
+    DescriptorRange resource_range_[version_count];
+    D3D12_CPU_DESCRIPTOR_HANDLE resource_view_[version_count];
+    D3D12_GPU_DESCRIPTOR_HANDLE resource_view_gpu_[version_count];
+    BindlessHandle bindless_[version_count];
     void* mapped_ptr_ = nullptr;
+    uint32_t placement_{ ResidencyPolicy::invalid_placement };
+
+    T data_;
+    mutable uint32_t stale_versions_{ 0 };
+
+    // brings version of current frame to the last data
+    UINT sync() const
+    {
+        const UINT version = Game::inst()->render().frame_slot();
+        if (stale_versions_ & (1u << version)) {
+            memcpy(static_cast<uint8_t*>(mapped_ptr_) + version * sizeof(T), &data_, sizeof(T));
+            stale_versions_ &= ~(1u << version);
+        }
+        return version;
+    }
+
+    void create_view(UINT version, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+    {
+        D3D12_CONSTANT_BUFFER_VIEW_DESC desc = {};
+        desc.BufferLocation = resource_->GetGPUVirtualAddress() + version * sizeof(T);
+        desc.SizeInBytes = sizeof(T);
+        Game::inst()->render().device()->CreateConstantBufferView(&desc, handle);
+    }
 public:
     ConstBuffer() = default;
 
@@ -31,47 +97,65 @@ public:
             resource_->Unmap(0, &range);
             mapped_ptr_ = nullptr;
         }
+        for (UINT i = 0; i < version_count; ++i) {
+            Game::inst()->render().free_gpu_resource_descriptor(resource_range_[i]);
+            Game::inst()->render().release_bindless(bindless_[i]);
+        }
 
         SAFE_RELEASE(resource_);
+        Game::inst()->render().release_placement(placement_);
     }
 
-    void initialize()
+    void initialize(const std::string& name = "Constant buffer")
     {
-        auto device = Game::inst()->render().device();
-
-        HRESULT_CHECK(device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-            D3D12_HEAP_FLAG_NONE,
-            &CD3DX12_RESOURCE_DESC::Buffer(sizeof(T)),
-            D3D12_RESOURCE_STATE_COMMON,
-            nullptr,
-            IID_PPV_ARGS(resource_.ReleaseAndGetAddressOf())));
+        resource_ = create_buffer(name, BufferUsage::dynamic_data, nullptr, version_count * sizeof(T), &mapped_ptr_, placement_);
+        assert(mapped_ptr_ != nullptr);
 
-        resource_index_ = Game::inst()->render().allocate_gpu_resource_descriptor(resource_view_, resource_view_gpu_);
+        for (UINT i = 0; i < version_count; ++i) {
+            resource_range_[i] = Game::inst()->render().allocate_gpu_resource_descriptor(resource_view_[i], resource_view_gpu_[i]);
+            create_view(i, resource_view_[i]);
+        }
+    }
 
-        D3D12_CONSTANT_BUFFER_VIEW_DESC desc = {};
-        desc.BufferLocation = resource_->GetGPUVirtualAddress();
-        desc.SizeInBytes = sizeof(T);
-        device->CreateConstantBufferView(&desc, resource_view_);
+    // views of all versions in the global table, see Render::register_bindless
+    void register_bindless()
+    {
+        if (bindless_[0].valid()) {
+            return;
+        }
+        for (UINT i = 0; i < version_count; ++i) {
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            bool created = false;
+            bindless_[i] = Game::inst()->render().register_bindless(
+                resource_->GetGPUVirtualAddress() + i * sizeof(T), BindlessKind::constant_buffer, handle, created);
+            if (created) {
+                create_view(i, handle);
+            }
+        }
+    }
 
-        CD3DX12_RANGE range(0, 0);
-        HRESULT_CHECK(resource_->Map(0, &range, &mapped_ptr_));
+    // table index of the version of current frame
+    UINT bindless_index() const
+    {
+        return bindless_[sync()].index;
     }
 
-    void update(T& data) const
+    void update(const T& data)
     {
         assert(mapped_ptr_ != nullptr);
-        memcpy(mapped_ptr_, &data, sizeof(T));
+        data_ = data;
+        stale_versions_ = (1u << version_count) - 1;
+        sync();
     }
 
     const D3D12_CPU_DESCRIPTOR_HANDLE& cpu_descriptor_handle() const
     {
-        return resource_view_;
+        return resource_view_[sync()];
     }
 
     const D3D12_GPU_DESCRIPTOR_HANDLE& gpu_descriptor_handle() const
     {
-        return resource_view_gpu_;
+        return resource_view_gpu_[sync()];
     }
 };
 
@@ -79,96 +163,195 @@ template<class T>
 class ShaderResource
 {
 private:
-    ID3D12Resource* resource_;
-    UINT resource_index_;
+    ID3D12Resource* resource_{ nullptr };
+    DescriptorRange resource_range_;
     D3D12_CPU_DESCRIPTOR_HANDLE resource_view_;
     D3D12_GPU_DESCRIPTOR_HANDLE resource_view_gpu_;
+    BindlessHandle bindless_;
+    uint32_t placement_{ ResidencyPolicy::invalid_placement };
 
     UINT size_;
+
+    void create_view(D3D12_CPU_DESCRIPTOR_HANDLE handle)
+    {
+        D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+        desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+        desc.Format = DXGI_FORMAT_UNKNOWN;
+        desc.Buffer.FirstElement = 0;
+        desc.Buffer.NumElements = size_;
+        desc.Buffer.StructureByteStride = sizeof(T);
+        desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+        desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        Game::inst()->render().device()->CreateShaderResourceView(resource_, &desc, handle);
+    }
 public:
     ShaderResource() = default;
     ~ShaderResource()
     {
+        Game::inst()->render().free_gpu_resource_descriptor(resource_range_);
+        Game::inst()->render().release_bindless(bindless_);
         if (resource_) {
             resource_->Release();
             resource_ = nullptr;
         }
+        Game::inst()->render().release_placement(placement_);
     }
 
-    void initialize(T* data, UINT size)
+    // static data, in default heap it's copied on copy queue with the next Render::submit_uploads
+    void initialize(T* data, UINT size, const std::string& name = "Shader resource")
     {
         size_ = size;
 
-        auto device = Game::inst()->render().device();
-
-        HRESULT_CHECK(device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-            D3D12_HEAP_FLAG_NONE,
-            &CD3DX12_RESOURCE_DESC::Buffer(size * sizeof(T)),
-            D3D12_RESOURCE_STATE_COMMON,
-            nullptr,
-            IID_PPV_ARGS(&resource_)));
-
-        { // copy resource on gpu
-            ID3D12Resource* tmp;
-            ID3D12GraphicsCommandList* copy_cmd;
-            {
-                HRESULT_CHECK(device->CreateCommittedResource(
-                    &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-                    D3D12_HEAP_FLAG_NONE,
-                    &CD3DX12_RESOURCE_DESC::Buffer(size * sizeof(T)),
-                    D3D12_RESOURCE_STATE_COPY_SOURCE,
-                    nullptr,
-                    IID_PPV_ARGS(&tmp)));
-                tmp->SetName(L"Temporary object to upload data");
-
-                CD3DX12_RANGE range(0, 0);
-                void* mapped_ptr = nullptr;
-                HRESULT_CHECK(tmp->Map(0, &range, &mapped_ptr));
-                memcpy(mapped_ptr, data, sizeof(T) * size);
-                tmp->Unmap(0, &range);
-            }
-            {
-                device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, Game::inst()->render().graphics_command_allocator().Get(), nullptr, IID_PPV_ARGS(&copy_cmd));
-                PIXBeginEvent(copy_cmd, PIX_COLOR(0xFF, 0xFF, 0x00), "Copy shader resource");
-                copy_cmd->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resource_, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
-                copy_cmd->CopyResource(resource_, tmp);
-                copy_cmd->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resource_, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE));
-                PIXEndEvent(copy_cmd);
-                HRESULT_CHECK(copy_cmd->Close());
-
-                Game::inst()->render().graphics_queue()->ExecuteCommandLists(1, (ID3D12CommandList**)&copy_cmd);
-            }
+        void* mapped_ptr = nullptr;
+        resource_ = create_buffer(name, BufferUsage::static_data, data, UINT64(size) * sizeof(T), &mapped_ptr, placement_).Detach();
 
-            { // sync
-                ID3D12Fence* fence;
-                device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
-                HANDLE ev = CreateEvent(nullptr, false, false, nullptr);
-                fence->SetEventOnCompletion(1, ev);
-                Game::inst()->render().graphics_queue()->Signal(fence, 1);
-                if (fence->GetCompletedValue() < 1)
-                {
-                    WaitForSingleObject(ev, INFINITE);
-                }
-                CloseHandle(ev);
-                fence->Release();
-            }
+        resource_range_ = Game::inst()->render().allocate_gpu_resource_descriptor(resource_view_, resource_view_gpu_);
+        create_view(resource_view_);
+    }
 
-            tmp->Release();
-            copy_cmd->Release();
+    // view in the global table, see Render::register_bindless
+    void register_bindless()
+    {
+        if (bindless_.valid()) {
+            return;
         }
+        D3D12_CPU_DESCRIPTOR_HANDLE handle;
+        bool created = false;
+        bindless_ = Game::inst()->render().register_bindless(resource_->GetGPUVirtualAddress(), BindlessKind::buffer, handle, created);
+        if (created) {
+            create_view(handle);
+        }
+    }
+
+    UINT bindless_index() const
+    {
+        return bindless_.index;
+    }
+
+    UINT size() const
+    {
+        return size_;
+    }
 
-        resource_index_ = Game::inst()->render().allocate_gpu_resource_descriptor(resource_view_, resource_view_gpu_);
+    const D3D12_CPU_DESCRIPTOR_HANDLE& cpu_descriptor_handle() const
+    {
+        return resource_view_;
+    }
 
+    const D3D12_GPU_DESCRIPTOR_HANDLE& gpu_descriptor_handle() const
+    {
+        return resource_view_gpu_;
+    }
+};
+
+// structured buffer persistently mapped in upload heap, for data rewritten every frame
+// one version per frame slot, synced the same way as ConstBuffer
+template<class T>
+class DynamicShaderResource
+{
+private:
+    static constexpr UINT version_count = FrameRing::max_frames_in_flight;
+
+    ComPtr<ID3D12Resource> resource_;
+    DescriptorRange resource_range_[version_count];
+    D3D12_CPU_DESCRIPTOR_HANDLE resource_view_[version_count];
+    D3D12_GPU_DESCRIPTOR_HANDLE resource_view_gpu_[version_count];
+    BindlessHandle bindless_[version_count];
+    void* mapped_ptr_ = nullptr;
+    uint32_t placement_{ ResidencyPolicy::invalid_placement };
+
+    UINT capacity_{ 0 };
+    UINT size_{ 0 };
+
+    std::vector<T> data_;
+    mutable uint32_t stale_versions_{ 0 };
+
+    UINT sync() const
+    {
+        const UINT version = Game::inst()->render().frame_slot();
+        if (stale_versions_ & (1u << version)) {
+            memcpy(static_cast<T*>(mapped_ptr_) + size_t(version) * capacity_, data_.data(), sizeof(T) * size_);
+            stale_versions_ &= ~(1u << version);
+        }
+        return version;
+    }
+
+    void create_view(UINT version, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+    {
         D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
         desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
         desc.Format = DXGI_FORMAT_UNKNOWN;
-        desc.Buffer.FirstElement = 0;
-        desc.Buffer.NumElements = size;
+        desc.Buffer.FirstElement = UINT64(version) * capacity_;
+        desc.Buffer.NumElements = capacity_;
         desc.Buffer.StructureByteStride = sizeof(T);
         desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
         desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        device->CreateShaderResourceView(resource_, &desc, resource_view_);
+        Game::inst()->render().device()->CreateShaderResourceView(resource_.Get(), &desc, handle);
+    }
+public:
+    DynamicShaderResource() = default;
+
+    ~DynamicShaderResource()
+    {
+        if (mapped_ptr_ != nullptr) {
+            CD3DX12_RANGE range(0, 0);
+            resource_->Unmap(0, &range);
+            mapped_ptr_ = nullptr;
+        }
+        for (UINT i = 0; i < version_count; ++i) {
+            Game::inst()->render().free_gpu_resource_descriptor(resource_range_[i]);
+            Game::inst()->render().release_bindless(bindless_[i]);
+        }
+
+        SAFE_RELEASE(resource_);
+        Game::inst()->render().release_placement(placement_);
+    }
+
+    void initialize(UINT capacity, const std::string& name = "Dynamic shader resource")
+    {
+        assert(capacity > 0);
+        capacity_ = capacity;
+
+        resource_ = create_buffer(name, BufferUsage::dynamic_data, nullptr, UINT64(version_count) * capacity * sizeof(T), &mapped_ptr_, placement_);
+        assert(mapped_ptr_ != nullptr);
+
+        for (UINT i = 0; i < version_count; ++i) {
+            resource_range_[i] = Game::inst()->render().allocate_gpu_resource_descriptor(resource_view_[i], resource_view_gpu_[i]);
+            create_view(i, resource_view_[i]);
+        }
+    }
+
+    // views of all versions in the global table, see Render::register_bindless
+    void register_bindless()
+    {
+        if (bindless_[0].valid()) {
+            return;
+        }
+        for (UINT i = 0; i < version_count; ++i) {
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            bool created = false;
+            bindless_[i] = Game::inst()->render().register_bindless(
+                resource_->GetGPUVirtualAddress() + UINT64(i) * capacity_ * sizeof(T), BindlessKind::buffer, handle, created);
+            if (created) {
+                create_view(i, handle);
+            }
+        }
+    }
+
+    // table index of the version of current frame, syncs it like the descriptor handles
+    UINT bindless_index() const
+    {
+        return bindless_[sync()].index;
+    }
+
+    void update(const T* data, UINT size)
+    {
+        assert(mapped_ptr_ != nullptr);
+        assert(size <= capacity_);
+        data_.assign(data, data + size);
+        size_ = size;
+        stale_versions_ = (1u << version_count) - 1;
+        sync();
     }
 
     UINT size() const
@@ -176,14 +359,19 @@ public:
         return size_;
     }
 
+    UINT capacity() const
+    {
+        return capacity_;
+    }
+
     const D3D12_CPU_DESCRIPTOR_HANDLE& cpu_descriptor_handle() const
     {
-        return resource_view_;
+        return resource_view_[sync()];
     }
 
     const D3D12_GPU_DESCRIPTOR_HANDLE& gpu_descriptor_handle() const
     {
-        return resource_view_gpu_;
+        return resource_view_gpu_[sync()];
     }
 };
 
@@ -195,6 +383,7 @@ private:
     D3D12_INDEX_BUFFER_VIEW view_;
 
     void* mapped_ptr_ = nullptr;
+    uint32_t placement_{ ResidencyPolicy::invalid_placement };
 public:
     IndexBuffer() = default;
     ~IndexBuffer()
@@ -207,23 +396,13 @@ public:
         }
 
         SAFE_RELEASE(resource_);
+        Game::inst()->render().release_placement(placement_);
     }
 
-    void initialize(const std::vector<UINT32>& indices)
+    // dynamic indices stay mapped in upload heap
+    void initialize(const std::vector<UINT32>& indices, BufferUsage usage = BufferUsage::static_data, const std::string& name = "Index buffer")
     {
-        auto device = Game::inst()->render().device();
-
-        HRESULT_CHECK(device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-            D3D12_HEAP_FLAG_NONE,
-            &CD3DX12_RESOURCE_DESC::Buffer(indices.size() * sizeof(UINT32)),
-            D3D12_RESOURCE_STATE_GENERIC_READ | D3D12_RESOURCE_STATE_INDEX_BUFFER,
-            nullptr,
-            IID_PPV_ARGS(resource_.ReleaseAndGetAddressOf())));
-
-        CD3DX12_RANGE range(0, 0);
-        resource_->Map(0, &range, &mapped_ptr_);
-        memcpy(mapped_ptr_, indices.data(), indices.size() * sizeof(UINT32));
+        resource_ = create_buffer(name, usage, indices.data(), indices.size() * sizeof(UINT32), &mapped_ptr_, placement_);
 
         view_.BufferLocation = resource_->GetGPUVirtualAddress();
         view_.Format = DXGI_FORMAT_R32_UINT;
@@ -248,7 +427,8 @@ class VertexBuffer
 
     D3D12_VERTEX_BUFFER_VIEW view_;
 
-    void* mapped_ptr_;
+    void* mapped_ptr_ = nullptr;
+    uint32_t placement_{ ResidencyPolicy::invalid_placement };
 public:
     VertexBuffer() = default;
 
@@ -262,23 +442,13 @@ public:
         }
 
         SAFE_RELEASE(resource_);
+        Game::inst()->render().release_placement(placement_);
     }
 
-    void initialize(const std::vector<V>& vertices)
+    // dynamic vertices stay mapped in upload heap
+    void initialize(const std::vector<V>& vertices, BufferUsage usage = BufferUsage::static_data, const std::string& name = "Vertex buffer")
     {
-        auto device = Game::inst()->render().device();
-
-        HRESULT_CHECK(device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-            D3D12_HEAP_FLAG_NONE,
-            &CD3DX12_RESOURCE_DESC::Buffer(vertices.size() * sizeof(V)),
-            D3D12_RESOURCE_STATE_COMMON,
-            nullptr,
-            IID_PPV_ARGS(resource_.ReleaseAndGetAddressOf())));
-
-        CD3DX12_RANGE range(0, 0);
-        resource_->Map(0, &range, &mapped_ptr_);
-        memcpy(mapped_ptr_, vertices.data(), vertices.size() * sizeof(V));
+        resource_ = create_buffer(name, usage, vertices.data(), vertices.size() * sizeof(V), &mapped_ptr_, placement_);
 
         view_.BufferLocation = resource_->GetGPUVirtualAddress();
         view_.SizeInBytes = UINT(vertices.size()) * sizeof(V);
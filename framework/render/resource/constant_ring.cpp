@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "constant_ring.h"
+
+void ConstantRing::initialize(FrameFence* fence, uint8_t* memory, uint64_t gpu_address, uint64_t capacity)
+{
+    assert(fence != nullptr && memory != nullptr);
+    assert(capacity >= alignment && gpu_address % alignment == 0);
+    fence_ = fence;
+    memory_ = memory;
+    gpu_address_ = gpu_address;
+    ring_.initialize(capacity);
+    stats_ = Stats{};
+    stats_.capacity = capacity;
+}
+
+void ConstantRing::begin_frame()
+{
+    ring_.retire(fence_->completed_value());
+    stats_.frame_bytes = 0;
+    stats_.used = ring_.used();
+}
+
+void ConstantRing::end_frame(uint64_t fence_value)
+{
+    ring_.close_batch(fence_value);
+    ++stats_.frames;
+    stats_.last_frame_bytes = stats_.frame_bytes;
+    stats_.peak_frame_bytes = std::max(stats_.peak_frame_bytes, stats_.frame_bytes);
+}
+
+ConstantAllocation ConstantRing::allocate(uint64_t size)
+{
+    assert(fence_ != nullptr && size > 0);
+    const uint64_t aligned = (size + alignment - 1) & ~(alignment - 1);
+
+    uint64_t offset = 0;
+    while (aligned > ring_.capacity() || !ring_.allocate(aligned, alignment, offset)) {
+        if (aligned > ring_.capacity() || ring_.batches_in_flight() == 0) {
+            // nothing left to wait for, the current frame took the whole ring
+            ++stats_.failed_allocations;
+            return ConstantAllocation{};
+        }
+        ++stats_.stalls;
+        fence_->wait(ring_.oldest_fence_value());
+        ring_.retire(fence_->completed_value());
+    }
+
+    ++stats_.allocations;
+    stats_.frame_bytes += aligned;
+    stats_.total_bytes += aligned;
+    stats_.used = ring_.used();
+
+    ConstantAllocation allocation;
+    allocation.data = memory_ + offset;
+    allocation.gpu_address = gpu_address_ + offset;
+    allocation.offset = offset;
+    allocation.size = uint32_t(aligned);
+    return allocation;
+}
+
+ConstantAllocation ConstantRing::push(const void* data, uint64_t size)
+{
+    ConstantAllocation allocation = allocate(size);
+    if (allocation.valid()) {
+        memcpy(allocation.data, data, size_t(size));
+    }
+    return allocation;
+}
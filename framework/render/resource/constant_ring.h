@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+#include "render/frame_ring.h"
+#include "render/resource/staging_uploader.h"
+
+struct ConstantAllocation
+{
+    uint8_t* data{ nullptr };
+    uint64_t gpu_address{ 0 };
+    uint64_t offset{ 0 };
+    uint32_t size{ 0 }; // aligned, what a constant buffer view of it has to cover
+
+    bool valid() const { return data != nullptr; }
+};
+
+// Per-frame linear allocator of constant blocks in one persistently mapped upload buffer.
+// Blocks are 256 byte aligned as constant buffer views require, they live until GPU is done with the frame
+// that allocated them: allocations between begin_frame() and end_frame() are one StagingRing batch.
+// Replaces a constant buffer per value for data that changes every draw or dispatch.
+// Memory isn't D3D12 specific, a fake fence and plain memory can be used to exercise it.
+// Not thread-safe, allocate on the main thread and hand addresses over to recorders.
+class ConstantRing
+{
+public:
+    static constexpr uint64_t alignment = 256;
+
+    struct Stats
+    {
+        uint64_t frames{ 0 };
+        uint64_t allocations{ 0 };
+        uint64_t frame_bytes{ 0 };      // allocated since begin_frame
+        uint64_t last_frame_bytes{ 0 };
+        uint64_t peak_frame_bytes{ 0 };
+        uint64_t total_bytes{ 0 };
+        uint64_t stalls{ 0 };           // CPU waits for an older frame because the ring was full
+        uint64_t failed_allocations{ 0 };
+        uint64_t used{ 0 };
+        uint64_t capacity{ 0 };
+    };
+
+    ConstantRing() = default;
+    ~ConstantRing() = default;
+
+    void initialize(FrameFence* fence, uint8_t* memory, uint64_t gpu_address, uint64_t capacity);
+
+    // releases blocks of completed frames
+    void begin_frame();
+    // blocks allocated this frame are released when fence_value completes
+    void end_frame(uint64_t fence_value);
+
+    // waits for older frames if the ring is full, invalid allocation if the frame alone doesn't fit
+    ConstantAllocation allocate(uint64_t size);
+    ConstantAllocation push(const void* data, uint64_t size);
+    template<class T>
+    ConstantAllocation push(const T& data)
+    {
+        return push(&data, sizeof(T));
+    }
+
+    const Stats& stats() const { return stats_; }
+private:
+    FrameFence* fence_{ nullptr };
+    uint8_t* memory_{ nullptr };
+    uint64_t gpu_address_{ 0 };
+    StagingRing ring_;
+    Stats stats_;
+};
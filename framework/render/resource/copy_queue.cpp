@@ -0,0 +1,121 @@
+#include <cassert>
+
+#include "render/common.h"
+#include "copy_queue.h"
+
+void CopyQueue::initialize(ID3D12Device* device, ID3D12CommandQueue* graphics_queue, uint64_t capacity)
+{
+    device_ = device;
+    graphics_queue_ = graphics_queue;
+    capacity_ = capacity;
+
+    D3D12_COMMAND_QUEUE_DESC queue_desc = {};
+    queue_desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    queue_desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    HRESULT_CHECK(device_->CreateCommandQueue(&queue_desc, IID_PPV_ARGS(queue_.ReleaseAndGetAddressOf())));
+    queue_->SetName(L"Copy queue");
+
+    HRESULT_CHECK(device_->CreateFence(fence_value_, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence_.ReleaseAndGetAddressOf())));
+    fence_->SetName(L"Copy fence");
+    fence_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (fence_event_ == nullptr) {
+        assert(!GetLastError());
+    }
+
+    HRESULT_CHECK(device_->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(capacity_),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(staging_.ReleaseAndGetAddressOf())));
+    staging_->SetName(L"Staging ring");
+
+    CD3DX12_RANGE range(0, 0);
+    HRESULT_CHECK(staging_->Map(0, &range, reinterpret_cast<void**>(&mapped_)));
+}
+
+void CopyQueue::destroy()
+{
+    if (fence_value_ > 0) {
+        wait(fence_value_);
+    }
+    if (mapped_ != nullptr) {
+        CD3DX12_RANGE range(0, 0);
+        staging_->Unmap(0, &range);
+        mapped_ = nullptr;
+    }
+    staging_.Reset();
+    cmd_list_.Reset();
+    allocators_.clear();
+    queue_.Reset();
+
+    CloseHandle(fence_event_);
+    fence_event_ = nullptr;
+    fence_.Reset();
+}
+
+void CopyQueue::copy(ID3D12Resource* destination, uint64_t destination_offset, uint64_t staging_offset, uint64_t size)
+{
+    if (!recording_) {
+        open_list();
+    }
+    cmd_list_->CopyBufferRegion(destination, destination_offset, staging_.Get(), staging_offset, size);
+}
+
+uint64_t CopyQueue::submit()
+{
+    assert(recording_);
+    HRESULT_CHECK(cmd_list_->Close());
+    recording_ = false;
+    queue_->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList* const*>(cmd_list_.GetAddressOf()));
+
+    ++fence_value_;
+    HRESULT_CHECK(queue_->Signal(fence_.Get(), fence_value_));
+    allocators_[current_allocator_].fence_value = fence_value_;
+
+    // following graphics work waits for the copies on GPU
+    HRESULT_CHECK(graphics_queue_->Wait(fence_.Get(), fence_value_));
+    return fence_value_;
+}
+
+uint64_t CopyQueue::completed_value()
+{
+    return fence_->GetCompletedValue();
+}
+
+void CopyQueue::wait(uint64_t fence_value)
+{
+    if (fence_->GetCompletedValue() < fence_value) {
+        HRESULT_CHECK(fence_->SetEventOnCompletion(fence_value, fence_event_));
+        WaitForSingleObject(fence_event_, INFINITE);
+    }
+}
+
+// reuses allocator of a completed batch, new one is created only while all are in flight
+void CopyQueue::open_list()
+{
+    const uint64_t completed = completed_value();
+    uint32_t index = uint32_t(allocators_.size());
+    for (uint32_t i = 0; i < allocators_.size(); ++i) {
+        if (allocators_[i].fence_value <= completed) {
+            index = i;
+            break;
+        }
+    }
+    if (index == allocators_.size()) {
+        allocators_.emplace_back();
+        HRESULT_CHECK(device_->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(allocators_.back().allocator.ReleaseAndGetAddressOf())));
+    } else {
+        HRESULT_CHECK(allocators_[index].allocator->Reset());
+    }
+    current_allocator_ = index;
+
+    if (cmd_list_ == nullptr) {
+        HRESULT_CHECK(device_->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, allocators_[index].allocator.Get(), nullptr, IID_PPV_ARGS(cmd_list_.ReleaseAndGetAddressOf())));
+        cmd_list_->SetName(L"Staging copy command list");
+    } else {
+        HRESULT_CHECK(cmd_list_->Reset(allocators_[index].allocator.Get(), nullptr));
+    }
+    recording_ = true;
+}
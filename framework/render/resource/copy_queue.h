@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <Windows.h>
+#include <wrl.h>
+#include <d3d12.h>
+
+using namespace Microsoft::WRL;
+
+#include "render/resource/staging_uploader.h"
+
+// StagingDevice on a D3D12 copy queue with one upload heap buffer as staging memory.
+// Every batch is one copy command list; graphics queue waits for the batch fence on GPU,
+// so work submitted after submit() sees the copied data without CPU stall.
+// Destination buffers have to be in COMMON state, they are promoted to COPY_DEST and decay back.
+class CopyQueue : public StagingDevice
+{
+public:
+    CopyQueue() = default;
+    ~CopyQueue() = default;
+
+    void initialize(ID3D12Device* device, ID3D12CommandQueue* graphics_queue, uint64_t capacity);
+    void destroy();
+
+    uint8_t* staging_memory() override { return mapped_; }
+    uint64_t capacity() const override { return capacity_; }
+
+    void copy(ID3D12Resource* destination, uint64_t destination_offset, uint64_t staging_offset, uint64_t size) override;
+    uint64_t submit() override;
+    uint64_t completed_value() override;
+    void wait(uint64_t fence_value) override;
+private:
+    struct Allocator
+    {
+        ComPtr<ID3D12CommandAllocator> allocator;
+        uint64_t fence_value{ 0 }; // batch recorded with allocator
+    };
+
+    void open_list();
+
+    ID3D12Device* device_{ nullptr };
+    ID3D12CommandQueue* graphics_queue_{ nullptr };
+
+    ComPtr<ID3D12CommandQueue> queue_;
+    ComPtr<ID3D12GraphicsCommandList> cmd_list_;
+    std::vector<Allocator> allocators_;
+    uint32_t current_allocator_{ 0 };
+    bool recording_{ false };
+
+    ComPtr<ID3D12Fence> fence_;
+    HANDLE fence_event_{ nullptr };
+    uint64_t fence_value_{ 0 };
+
+    ComPtr<ID3D12Resource> staging_;
+    uint8_t* mapped_{ nullptr };
+    uint64_t capacity_{ 0 };
+};
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cassert>
+
+#include "descriptor_allocator.h"
+
+void DescriptorAllocator::initialize(uint32_t persistent_capacity, uint32_t frame_capacity, uint32_t frame_slots)
+{
+    assert(frame_slots > 0);
+    persistent_capacity_ = persistent_capacity;
+    frame_capacity_ = frame_capacity;
+    allocator_.initialize(persistent_capacity);
+    generations_.clear();
+    frame_regions_.assign(frame_slots, FrameRegion{});
+    slot_ = 0;
+    frame_peak_ = 0;
+    failed_allocations_ = 0;
+}
+
+DescriptorRange DescriptorAllocator::allocate(uint32_t count)
+{
+    assert(count > 0);
+    const OffsetAllocator::Allocation allocation = allocator_.allocate(count);
+    if (allocation.node == OffsetAllocator::invalid_node) {
+        ++failed_allocations_;
+        return DescriptorRange{};
+    }
+    if (generations_.size() <= allocation.node) {
+        generations_.resize(allocation.node + 1, 0);
+    }
+    return { allocation.offset, allocation.size, allocation.node, generations_[allocation.node] };
+}
+
+void DescriptorAllocator::free(DescriptorRange& range)
+{
+    assert(is_valid(range));
+    // node may be handed out again only after the release, bumping generation now invalidates copies of range
+    ++generations_[range.node];
+    frame_regions_[slot_].pending_free.push_back({ range.offset, range.count, range.node });
+    range = DescriptorRange{};
+}
+
+bool DescriptorAllocator::is_valid(const DescriptorRange& range) const
+{
+    return range.valid() && range.node < generations_.size() && generations_[range.node] == range.generation
+        && range.offset + range.count <= persistent_capacity_;
+}
+
+void DescriptorAllocator::begin_frame(uint32_t slot)
+{
+    assert(slot < frame_regions_.size());
+    slot_ = slot;
+    FrameRegion& region = frame_regions_[slot_];
+    region.used = 0;
+    for (OffsetAllocator::Allocation& allocation : region.pending_free) {
+        allocator_.free(allocation);
+    }
+    region.pending_free.clear();
+}
+
+uint32_t DescriptorAllocator::allocate_frame(uint32_t count)
+{
+    FrameRegion& region = frame_regions_[slot_];
+    if (region.used + count > frame_capacity_) {
+        ++failed_allocations_;
+        return invalid_offset;
+    }
+    const uint32_t offset = persistent_capacity_ + slot_ * frame_capacity_ + region.used;
+    region.used += count;
+    frame_peak_ = std::max(frame_peak_, region.used);
+    return offset;
+}
+
+void DescriptorAllocator::release_pending()
+{
+    for (FrameRegion& region : frame_regions_) {
+        for (OffsetAllocator::Allocation& allocation : region.pending_free) {
+            allocator_.free(allocation);
+        }
+        region.pending_free.clear();
+    }
+}
+
+DescriptorAllocator::Stats DescriptorAllocator::stats() const
+{
+    const OffsetAllocator::Stats allocator = allocator_.stats();
+    Stats stats;
+    stats.persistent_capacity = persistent_capacity_;
+    stats.persistent_used = allocator.used;
+    stats.persistent_ranges = allocator.allocations;
+    stats.largest_free_range = allocator.largest_free_block;
+    for (const FrameRegion& region : frame_regions_) {
+        for (const OffsetAllocator::Allocation& allocation : region.pending_free) {
+            stats.pending_free += allocation.size;
+        }
+    }
+    stats.frame_capacity = frame_capacity_;
+    stats.frame_used = frame_regions_[slot_].used;
+    stats.frame_peak = frame_peak_;
+    stats.failed_allocations = failed_allocations_;
+    return stats;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "render/resource/offset_allocator.h"
+
+// contiguous descriptors of the persistent region, generation detects use after free
+struct DescriptorRange
+{
+    uint32_t offset{ 0 };
+    uint32_t count{ 0 };
+    uint32_t node{ OffsetAllocator::invalid_node };
+    uint32_t generation{ 0 };
+
+    bool valid() const { return node != OffsetAllocator::invalid_node; }
+};
+
+// Slots of one descriptor heap, doesn't know about D3D12.
+// [0, persistent_capacity) is the persistent region: ranges live until free(), sub-allocated by OffsetAllocator.
+// The rest is split into one linear region per frame slot for tables built every frame; a region is
+// rewound when its slot begins the next frame, GPU is done with it by then (FrameRing).
+// Freed ranges are reused only when the slot that freed them comes back, frames in flight may still read them.
+class DescriptorAllocator
+{
+public:
+    static constexpr uint32_t invalid_offset = ~0u;
+
+    struct Stats
+    {
+        uint32_t persistent_capacity{ 0 };
+        uint32_t persistent_used{ 0 };
+        uint32_t persistent_ranges{ 0 };
+        uint32_t largest_free_range{ 0 };
+        uint32_t pending_free{ 0 };     // freed, waiting for frames in flight
+        uint32_t frame_capacity{ 0 };   // per frame slot
+        uint32_t frame_used{ 0 };       // current frame
+        uint32_t frame_peak{ 0 };
+        uint32_t failed_allocations{ 0 };
+    };
+
+    DescriptorAllocator() = default;
+    ~DescriptorAllocator() = default;
+
+    void initialize(uint32_t persistent_capacity, uint32_t frame_capacity, uint32_t frame_slots);
+    // heap size needed for both regions
+    uint32_t capacity() const { return persistent_capacity_ + frame_capacity_ * uint32_t(frame_regions_.size()); }
+
+    // invalid range if the persistent region has no free range of count
+    DescriptorRange allocate(uint32_t count);
+    void free(DescriptorRange& range);
+    // false for ranges that were freed or never allocated, checked on free in debug builds
+    bool is_valid(const DescriptorRange& range) const;
+
+    // rewinds the region of slot and releases ranges freed when the slot was used before
+    void begin_frame(uint32_t slot);
+    // first of count descriptors valid for the current frame, invalid_offset if the region is full
+    uint32_t allocate_frame(uint32_t count);
+    // releases freed ranges of all slots, GPU has to be idle
+    void release_pending();
+
+    Stats stats() const;
+private:
+    struct FrameRegion
+    {
+        uint32_t used{ 0 };
+        std::vector<OffsetAllocator::Allocation> pending_free;
+    };
+
+    uint32_t persistent_capacity_{ 0 };
+    uint32_t frame_capacity_{ 0 };
+    OffsetAllocator allocator_;
+    std::vector<uint32_t> generations_; // by allocator node
+    std::vector<FrameRegion> frame_regions_;
+    uint32_t slot_{ 0 };
+    uint32_t frame_peak_{ 0 };
+    uint32_t failed_allocations_{ 0 };
+};
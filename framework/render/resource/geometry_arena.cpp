@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "core/game.h"
+#include "render/common.h"
+#include "render/render.h"
+#include "render/resource/buffer.hpp"
+#include "geometry_arena.h"
+
+void GeometryArena::initialize(uint32_t vertex_capacity, uint32_t index_capacity)
+{
+    create_pool(vertices_, "Geometry arena vertices", sizeof(Vertex), vertex_capacity);
+    create_pool(indices_, "Geometry arena indices", sizeof(uint32_t), index_capacity);
+    update_views();
+}
+
+void GeometryArena::destroy()
+{
+    for (Pool* pool : { &vertices_, &indices_ }) {
+        if (pool->mapped != nullptr) {
+            CD3DX12_RANGE range(0, 0);
+            pool->resource->Unmap(0, &range);
+            pool->mapped = nullptr;
+        }
+        pool->resource.Reset();
+        Game::inst()->render().release_placement(pool->placement);
+        pool->shadow.clear();
+        pool->shadow.shrink_to_fit();
+        pool->allocator.initialize(0);
+        Game::inst()->render().free_gpu_resource_descriptor(pool->srv_range);
+    }
+}
+
+GeometryRange GeometryArena::allocate(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    GeometryRange range;
+    range.vertices = allocate_range(vertices_, vertices.data(), uint32_t(vertices.size()));
+    range.indices = allocate_range(indices_, indices.data(), uint32_t(indices.size()));
+    update_views();
+    return range;
+}
+
+void GeometryArena::free(GeometryRange& range)
+{
+    // range can be reused right away
+    Game::inst()->render().wait_idle();
+    if (range.vertices.node != OffsetAllocator::invalid_node) {
+        vertices_.allocator.free(range.vertices);
+    }
+    if (range.indices.node != OffsetAllocator::invalid_node) {
+        indices_.allocator.free(range.indices);
+    }
+}
+
+void GeometryArena::defragment()
+{
+    defragment_pool(vertices_);
+    defragment_pool(indices_);
+}
+
+UINT GeometryArena::first_vertex(const GeometryRange& range) const
+{
+    return range.vertices.node != OffsetAllocator::invalid_node ? vertices_.allocator.offset(range.vertices) : 0;
+}
+
+UINT GeometryArena::first_index(const GeometryRange& range) const
+{
+    return range.indices.node != OffsetAllocator::invalid_node ? indices_.allocator.offset(range.indices) : 0;
+}
+
+GeometryArena::Stats GeometryArena::stats() const
+{
+    Stats stats;
+    stats.vertices = vertices_.allocator.stats();
+    stats.indices = indices_.allocator.stats();
+    stats.defragmentations = defragmentations_;
+    stats.grows = grows_;
+    return stats;
+}
+
+void GeometryArena::create_pool(Pool& pool, const std::string& name, UINT stride, uint32_t capacity)
+{
+    assert(capacity > 0);
+    pool.name = name;
+    pool.stride = stride;
+    pool.allocator.initialize(capacity);
+    pool.srv_range = Game::inst()->render().allocate_gpu_resource_descriptor(pool.srv, pool.srv_gpu);
+    resize_pool(pool, capacity);
+}
+
+void GeometryArena::resize_pool(Pool& pool, uint32_t capacity)
+{
+    auto device = Game::inst()->render().device();
+
+    const uint32_t old_capacity = pool.allocator.size();
+    if (pool.resource != nullptr) {
+        // frames in flight and copies into old resource have to finish before it's released
+        Game::inst()->render().wait_idle();
+        Game::inst()->render().uploader()->flush();
+        if (pool.mapped != nullptr) {
+            CD3DX12_RANGE range(0, 0);
+            pool.resource->Unmap(0, &range);
+        }
+    }
+    pool.shadow.resize(size_t(capacity) * pool.stride);
+
+    // old resource leaves the placement report with the replacement
+    Game::inst()->render().release_placement(pool.placement);
+    void* mapped = nullptr;
+    pool.resource = create_buffer(pool.name, BufferUsage::static_data, nullptr, UINT64(capacity) * pool.stride, &mapped, pool.placement);
+    pool.mapped = static_cast<uint8_t*>(mapped);
+    if (old_capacity < capacity) {
+        write(pool, 0, pool.shadow.data(), old_capacity);
+    }
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+    desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    desc.Format = DXGI_FORMAT_UNKNOWN;
+    desc.Buffer.FirstElement = 0;
+    desc.Buffer.NumElements = capacity;
+    desc.Buffer.StructureByteStride = pool.stride;
+    desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    device->CreateShaderResourceView(pool.resource.Get(), &desc, pool.srv);
+}
+
+void GeometryArena::defragment_pool(Pool& pool)
+{
+    // moved ranges are read by frames in flight
+    Game::inst()->render().wait_idle();
+
+    std::vector<OffsetAllocator::Move> moves;
+    pool.allocator.defragment(moves);
+    // moves go in address order towards the beginning, so memmove in place is safe
+    for (const OffsetAllocator::Move& move : moves) {
+        memmove(pool.shadow.data() + size_t(move.to) * pool.stride, pool.shadow.data() + size_t(move.from) * pool.stride, size_t(move.size) * pool.stride);
+    }
+    // everything from the first move to the end of the last one is written again
+    if (!moves.empty()) {
+        const uint32_t begin = moves.front().to;
+        const uint32_t end = moves.back().to + moves.back().size;
+        write(pool, begin, pool.shadow.data() + size_t(begin) * pool.stride, end - begin);
+    }
+    ++defragmentations_;
+}
+
+OffsetAllocator::Allocation GeometryArena::allocate_range(Pool& pool, const void* data, uint32_t count)
+{
+    if (count == 0) {
+        return {};
+    }
+
+    OffsetAllocator::Allocation allocation = pool.allocator.allocate(count);
+    if (allocation.node == OffsetAllocator::invalid_node) {
+        const OffsetAllocator::Stats stats = pool.allocator.stats();
+        if (stats.free >= count) {
+            defragment_pool(pool);
+            allocation = pool.allocator.allocate(count);
+        }
+    }
+    if (allocation.node == OffsetAllocator::invalid_node) {
+        const uint32_t capacity = std::max(pool.allocator.size() * 2, pool.allocator.size() + count);
+        resize_pool(pool, capacity);
+        pool.allocator.grow(capacity);
+        ++grows_;
+        allocation = pool.allocator.allocate(count);
+    }
+    assert(allocation.node != OffsetAllocator::invalid_node);
+
+    write(pool, allocation.offset, data, count);
+    return allocation;
+}
+
+void GeometryArena::write(Pool& pool, uint32_t offset, const void* data, uint32_t count)
+{
+    const size_t begin = size_t(offset) * pool.stride;
+    const size_t bytes = size_t(count) * pool.stride;
+    if (data != pool.shadow.data() + begin) {
+        memcpy(pool.shadow.data() + begin, data, bytes);
+    }
+    if (pool.mapped != nullptr) {
+        memcpy(pool.mapped + begin, data, bytes);
+    } else {
+        Game::inst()->render().uploader()->upload(pool.resource.Get(), begin, data, bytes);
+    }
+}
+
+void GeometryArena::update_views()
+{
+    vertex_buffer_view_.BufferLocation = vertices_.resource->GetGPUVirtualAddress();
+    vertex_buffer_view_.SizeInBytes = vertices_.allocator.size() * vertices_.stride;
+    vertex_buffer_view_.StrideInBytes = vertices_.stride;
+
+    index_buffer_view_.BufferLocation = indices_.resource->GetGPUVirtualAddress();
+    index_buffer_view_.Format = DXGI_FORMAT_R32_UINT;
+    index_buffer_view_.SizeInBytes = indices_.allocator.size() * indices_.stride;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <Windows.h>
+#include <wrl.h>
+#include <d3d12.h>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+using namespace Microsoft::WRL;
+
+#include "render/resource/descriptor_allocator.h"
+#include "render/resource/offset_allocator.h"
+#include "render/resource/residency.h"
+#include "shaders/common/types.fx"
+
+// vertex and index ranges of one mesh in GeometryArena, indices are relative to the first vertex of the mesh
+struct GeometryRange
+{
+    OffsetAllocator::Allocation vertices;
+    OffsetAllocator::Allocation indices;
+};
+
+// One vertex pool and one index pool for all meshes, ranges are sub-allocated by OffsetAllocator.
+// Every mesh is drawn from the same views with base vertex and start index, so draws can be batched.
+// Pools are static data placed by Render::residency, in default heap they are written through the uploader
+// from a CPU copy of the pool. Freeing, defragmentation and growth wait for frames in flight first.
+class GeometryArena
+{
+public:
+    struct Stats
+    {
+        OffsetAllocator::Stats vertices;
+        OffsetAllocator::Stats indices;
+        uint32_t defragmentations{ 0 };
+        uint32_t grows{ 0 };
+    };
+
+    GeometryArena() = default;
+    ~GeometryArena() = default;
+
+    // capacities in elements
+    void initialize(uint32_t vertex_capacity, uint32_t index_capacity);
+    void destroy();
+
+    // copies geometry into the pools, pool is defragmented and then grown if range doesn't fit
+    GeometryRange allocate(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+    void free(GeometryRange& range);
+
+    // compacts both pools in place, ranges stay valid but their offsets change
+    void defragment();
+
+    UINT first_vertex(const GeometryRange& range) const;
+    UINT first_index(const GeometryRange& range) const;
+
+    const D3D12_VERTEX_BUFFER_VIEW& vertex_buffer_view() const { return vertex_buffer_view_; }
+    const D3D12_INDEX_BUFFER_VIEW& index_buffer_view() const { return index_buffer_view_; }
+    const D3D12_GPU_DESCRIPTOR_HANDLE& vertices_srv() const { return vertices_.srv_gpu; }
+    const D3D12_GPU_DESCRIPTOR_HANDLE& indices_srv() const { return indices_.srv_gpu; }
+
+    Stats stats() const;
+private:
+    struct Pool
+    {
+        ComPtr<ID3D12Resource> resource;
+        uint8_t* mapped{ nullptr }; // upload heap only
+        uint32_t placement{ ResidencyPolicy::invalid_placement };
+        std::vector<uint8_t> shadow; // CPU copy of the whole pool
+        OffsetAllocator allocator;
+        UINT stride{ 0 };
+        std::string name;
+
+        D3D12_CPU_DESCRIPTOR_HANDLE srv{};
+        D3D12_GPU_DESCRIPTOR_HANDLE srv_gpu{};
+        DescriptorRange srv_range;
+    };
+
+    void create_pool(Pool& pool, const std::string& name, UINT stride, uint32_t capacity);
+    // new resource of capacity elements with old content copied, srv is rewritten in place
+    void resize_pool(Pool& pool, uint32_t capacity);
+    void defragment_pool(Pool& pool);
+    // shadow and pool content of count elements from offset
+    void write(Pool& pool, uint32_t offset, const void* data, uint32_t count);
+    OffsetAllocator::Allocation allocate_range(Pool& pool, const void* data, uint32_t count);
+    void update_views();
+
+    Pool vertices_;
+    Pool indices_;
+    D3D12_VERTEX_BUFFER_VIEW vertex_buffer_view_{};
+    D3D12_INDEX_BUFFER_VIEW index_buffer_view_{};
+
+    uint32_t defragmentations_{ 0 };
+    uint32_t grows_{ 0 };
+};
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "offset_allocator.h"
+
+namespace
+{
+
+uint32_t lowest_bit(uint32_t mask)
+{
+    assert(mask != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return uint32_t(index);
+#else
+    return uint32_t(__builtin_ctz(mask));
+#endif
+}
+
+uint32_t highest_bit(uint32_t mask)
+{
+    assert(mask != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return uint32_t(index);
+#else
+    return uint32_t(31 - __builtin_clz(mask));
+#endif
+}
+
+} // namespace
+
+// sizes below second_level_count have exact bins,
+// larger ones are split to second_level_count bins per power of two
+uint32_t OffsetAllocator::bin_round_down(uint32_t size)
+{
+    if (size < second_level_count) {
+        return size;
+    }
+    const uint32_t msb = highest_bit(size);
+    const uint32_t first_level = msb - second_level_bits + 1;
+    const uint32_t second_level = (size >> (msb - second_level_bits)) & (second_level_count - 1);
+    return first_level * second_level_count + second_level;
+}
+
+// smallest bin whose blocks all fit size
+uint32_t OffsetAllocator::bin_round_up(uint32_t size)
+{
+    const uint32_t bin = bin_round_down(size);
+    if (size < second_level_count) {
+        return bin;
+    }
+    const uint32_t low_bits = size & ((1u << (highest_bit(size) - second_level_bits)) - 1);
+    return low_bits != 0 ? bin + 1 : bin;
+}
+
+void OffsetAllocator::initialize(uint32_t size)
+{
+    size_ = size;
+    nodes_.clear();
+    unused_nodes_.clear();
+    std::fill(std::begin(bin_heads_), std::end(bin_heads_), invalid_node);
+    first_level_mask_ = 0;
+    std::fill(std::begin(second_level_masks_), std::end(second_level_masks_), uint8_t(0));
+    head_ = invalid_node;
+    used_ = 0;
+    allocations_ = 0;
+
+    if (size > 0) {
+        head_ = new_node();
+        nodes_[head_].offset = 0;
+        nodes_[head_].size = size;
+        insert_free(head_);
+    }
+}
+
+OffsetAllocator::Allocation OffsetAllocator::allocate(uint32_t size)
+{
+    assert(size > 0);
+    Allocation allocation;
+
+    const uint32_t min_bin = bin_round_up(size);
+    const uint32_t bin = min_bin < bin_count ? find_free_bin(min_bin) : invalid_node;
+    if (bin == invalid_node) {
+        return allocation;
+    }
+
+    const uint32_t index = bin_heads_[bin];
+    remove_free(index);
+    assert(nodes_[index].size >= size);
+
+    // rest of the block goes back to bins
+    if (nodes_[index].size > size) {
+        const uint32_t rest = new_node();
+        Node& node = nodes_[index];
+        nodes_[rest].offset = node.offset + size;
+        nodes_[rest].size = node.size - size;
+        nodes_[rest].prev = index;
+        nodes_[rest].next = node.next;
+        if (node.next != invalid_node) {
+            nodes_[node.next].prev = rest;
+        }
+        node.next = rest;
+        node.size = size;
+        insert_free(rest);
+    }
+
+    Node& node = nodes_[index];
+    node.used = true;
+    used_ += size;
+    ++allocations_;
+
+    allocation.offset = node.offset;
+    allocation.size = size;
+    allocation.node = index;
+    return allocation;
+}
+
+void OffsetAllocator::free(Allocation& allocation)
+{
+    assert(allocation.node < nodes_.size() && nodes_[allocation.node].used);
+    uint32_t index = allocation.node;
+    allocation = Allocation{};
+
+    Node& node = nodes_[index];
+    node.used = false;
+    used_ -= node.size;
+    --allocations_;
+
+    // merge with free neighbours, merged node keeps the lowest address
+    const uint32_t prev = node.prev;
+    if (prev != invalid_node && !nodes_[prev].used) {
+        remove_free(prev);
+        nodes_[prev].size += node.size;
+        nodes_[prev].next = node.next;
+        if (node.next != invalid_node) {
+            nodes_[node.next].prev = prev;
+        }
+        unused_nodes_.push_back(index);
+        index = prev;
+    }
+    const uint32_t next = nodes_[index].next;
+    if (next != invalid_node && !nodes_[next].used) {
+        remove_free(next);
+        nodes_[index].size += nodes_[next].size;
+        nodes_[index].next = nodes_[next].next;
+        if (nodes_[next].next != invalid_node) {
+            nodes_[nodes_[next].next].prev = index;
+        }
+        unused_nodes_.push_back(next);
+    }
+    insert_free(index);
+}
+
+void OffsetAllocator::defragment(std::vector<Move>& moves)
+{
+    moves.clear();
+
+    std::vector<uint32_t> used_nodes;
+    used_nodes.reserve(allocations_);
+    for (uint32_t index = head_; index != invalid_node; index = nodes_[index].next) {
+        if (nodes_[index].used) {
+            used_nodes.push_back(index);
+        } else {
+            remove_free(index);
+            unused_nodes_.push_back(index);
+        }
+    }
+
+    uint32_t offset = 0;
+    uint32_t prev = invalid_node;
+    for (uint32_t index : used_nodes) {
+        Node& node = nodes_[index];
+        if (node.offset != offset) {
+            moves.push_back({ index, node.offset, offset, node.size });
+            node.offset = offset;
+        }
+        offset += node.size;
+        node.prev = prev;
+        node.next = invalid_node;
+        if (prev != invalid_node) {
+            nodes_[prev].next = index;
+        }
+        prev = index;
+    }
+    head_ = used_nodes.empty() ? invalid_node : used_nodes.front();
+
+    if (offset < size_) {
+        const uint32_t tail = new_node();
+        nodes_[tail].offset = offset;
+        nodes_[tail].size = size_ - offset;
+        nodes_[tail].prev = prev;
+        if (prev != invalid_node) {
+            nodes_[prev].next = tail;
+        } else {
+            head_ = tail;
+        }
+        insert_free(tail);
+    }
+}
+
+void OffsetAllocator::grow(uint32_t new_size)
+{
+    assert(new_size >= size_);
+    if (new_size == size_) {
+        return;
+    }
+
+    uint32_t tail = head_;
+    while (tail != invalid_node && nodes_[tail].next != invalid_node) {
+        tail = nodes_[tail].next;
+    }
+
+    const uint32_t extra = new_size - size_;
+    if (tail != invalid_node && !nodes_[tail].used) {
+        remove_free(tail);
+        nodes_[tail].size += extra;
+        insert_free(tail);
+    } else {
+        const uint32_t index = new_node();
+        nodes_[index].offset = size_;
+        nodes_[index].size = extra;
+        nodes_[index].prev = tail;
+        if (tail != invalid_node) {
+            nodes_[tail].next = index;
+        } else {
+            head_ = index;
+        }
+        insert_free(index);
+    }
+    size_ = new_size;
+}
+
+uint32_t OffsetAllocator::offset(const Allocation& allocation) const
+{
+    assert(allocation.node < nodes_.size() && nodes_[allocation.node].used);
+    return nodes_[allocation.node].offset;
+}
+
+OffsetAllocator::Stats OffsetAllocator::stats() const
+{
+    Stats stats;
+    stats.size = size_;
+    stats.used = used_;
+    stats.free = size_ - used_;
+    stats.allocations = allocations_;
+    for (uint32_t index = head_; index != invalid_node; index = nodes_[index].next) {
+        if (!nodes_[index].used) {
+            ++stats.free_blocks;
+            stats.largest_free_block = std::max(stats.largest_free_block, nodes_[index].size);
+        }
+    }
+    return stats;
+}
+
+uint32_t OffsetAllocator::new_node()
+{
+    if (!unused_nodes_.empty()) {
+        const uint32_t index = unused_nodes_.back();
+        unused_nodes_.pop_back();
+        nodes_[index] = Node{};
+        return index;
+    }
+    nodes_.push_back(Node{});
+    return uint32_t(nodes_.size() - 1);
+}
+
+void OffsetAllocator::insert_free(uint32_t index)
+{
+    Node& node = nodes_[index];
+    assert(!node.used && node.size > 0);
+    const uint32_t bin = bin_round_down(node.size);
+
+    node.prev_free = invalid_node;
+    node.next_free = bin_heads_[bin];
+    if (bin_heads_[bin] != invalid_node) {
+        nodes_[bin_heads_[bin]].prev_free = index;
+    }
+    bin_heads_[bin] = index;
+
+    first_level_mask_ |= 1u << (bin / second_level_count);
+    second_level_masks_[bin / second_level_count] |= uint8_t(1u << (bin % second_level_count));
+}
+
+void OffsetAllocator::remove_free(uint32_t index)
+{
+    Node& node = nodes_[index];
+    const uint32_t bin = bin_round_down(node.size);
+
+    if (node.prev_free != invalid_node) {
+        nodes_[node.prev_free].next_free = node.next_free;
+    } else {
+        assert(bin_heads_[bin] == index);
+        bin_heads_[bin] = node.next_free;
+    }
+    if (node.next_free != invalid_node) {
+        nodes_[node.next_free].prev_free = node.prev_free;
+    }
+    node.prev_free = invalid_node;
+    node.next_free = invalid_node;
+
+    if (bin_heads_[bin] == invalid_node) {
+        const uint32_t first_level = bin / second_level_count;
+        second_level_masks_[first_level] &= uint8_t(~(1u << (bin % second_level_count)));
+        if (second_level_masks_[first_level] == 0) {
+            first_level_mask_ &= ~(1u << first_level);
+        }
+    }
+}
+
+uint32_t OffsetAllocator::find_free_bin(uint32_t min_bin) const
+{
+    uint32_t first_level = min_bin / second_level_count;
+    const uint32_t second_level_mask = second_level_masks_[first_level] & (0xFFu << (min_bin % second_level_count)) & 0xFFu;
+    if (second_level_mask != 0) {
+        return first_level * second_level_count + lowest_bit(second_level_mask);
+    }
+
+    const uint32_t first_level_mask = (first_level + 1 < 32) ? first_level_mask_ & (~0u << (first_level + 1)) : 0;
+    if (first_level_mask == 0) {
+        return invalid_node;
+    }
+    first_level = lowest_bit(first_level_mask);
+    return first_level * second_level_count + lowest_bit(second_level_masks_[first_level]);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Two level segregated fit (TLSF) allocator of ranges inside [0, size), doesn't own any memory.
+// Free blocks are kept in 8 linear bins per power of two, bitmasks find a fitting bin in O(1).
+// Neighbour blocks are merged on free. Handles stay valid through defragment() and grow().
+class OffsetAllocator
+{
+public:
+    static constexpr uint32_t invalid_node = ~0u;
+
+    struct Allocation
+    {
+        uint32_t offset{ 0 };
+        uint32_t size{ 0 };
+        uint32_t node{ invalid_node }; // invalid_node - allocation failed or was freed
+    };
+
+    struct Stats
+    {
+        uint32_t size{ 0 };
+        uint32_t used{ 0 };
+        uint32_t free{ 0 };
+        uint32_t largest_free_block{ 0 };
+        uint32_t free_blocks{ 0 };
+        uint32_t allocations{ 0 };
+
+        // 0 - all free space is one block, close to 1 - free space is scattered in small blocks
+        float fragmentation() const
+        {
+            return free == 0 ? 0.f : 1.f - float(largest_free_block) / float(free);
+        }
+    };
+
+    // range copy needed to apply defragment(), in ascending source order
+    struct Move
+    {
+        uint32_t node;
+        uint32_t from;
+        uint32_t to;
+        uint32_t size;
+    };
+
+    OffsetAllocator() = default;
+    ~OffsetAllocator() = default;
+
+    void initialize(uint32_t size);
+
+    // size > 0; node is invalid_node if no free block fits
+    Allocation allocate(uint32_t size);
+    void free(Allocation& allocation);
+
+    // moves allocations to the beginning in address order, free space becomes one tail block
+    // moves are not overlapping copies only if done into separate memory, to <= from always
+    void defragment(std::vector<Move>& moves);
+    // extends range to new_size >= size
+    void grow(uint32_t new_size);
+
+    // current offset of allocation, changes on defragment()
+    uint32_t offset(const Allocation& allocation) const;
+    uint32_t size() const { return size_; }
+    Stats stats() const;
+private:
+    static constexpr uint32_t second_level_bits = 3;
+    static constexpr uint32_t second_level_count = 1 << second_level_bits;
+    static constexpr uint32_t first_level_count = 32 - second_level_bits + 1;
+    static constexpr uint32_t bin_count = first_level_count * second_level_count;
+
+    struct Node
+    {
+        uint32_t offset{ 0 };
+        uint32_t size{ 0 };
+        uint32_t prev{ invalid_node }; // neighbours in address order
+        uint32_t next{ invalid_node };
+        uint32_t prev_free{ invalid_node }; // bin list
+        uint32_t next_free{ invalid_node };
+        bool used{ false };
+    };
+
+    static uint32_t bin_round_down(uint32_t size);
+    static uint32_t bin_round_up(uint32_t size);
+
+    uint32_t new_node();
+    void insert_free(uint32_t node);
+    void remove_free(uint32_t node);
+    uint32_t find_free_bin(uint32_t min_bin) const;
+
+    uint32_t size_{ 0 };
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> unused_nodes_;
+    uint32_t bin_heads_[bin_count];
+    uint32_t first_level_mask_{ 0 };
+    uint8_t second_level_masks_[first_level_count];
+    uint32_t head_{ invalid_node }; // lowest address block
+    uint32_t used_{ 0 };
+    uint32_t allocations_{ 0 };
+};
@@ -1,6 +1,9 @@
 #include "pipeline.h"
 #include "core/game.h"
+#include "core/profiler.h"
 #include "render/render.h"
+#include "render/resource/pipeline_cache.h"
+#include "render/resource/shader_cache.h"
 
 #include <sstream>
 #include <fstream>
@@ -9,9 +12,25 @@
 
 #pragma comment(lib, "dxcompiler.lib")
 
-ComPtr<ID3DBlob> LoadShader(std::wstring path, std::wstring stage)
+ComPtr<ID3DBlob> LoadShader(std::wstring path, std::wstring stage, const std::vector<std::wstring>& defines)
 {
-    std::ifstream fin(path + L"." + stage + L".cso", std::ios::binary);
+    PROFILE_ZONE("Load shader");
+    // shader paths and defines are ASCII
+    std::vector<std::string> narrow_defines;
+    for (const std::wstring& define : defines) {
+        narrow_defines.emplace_back(define.begin(), define.end());
+    }
+    const std::string blob_path = Game::inst()->render().shader_cache()->find(
+        std::string(path.begin(), path.end()), std::string(stage.begin(), stage.end()), narrow_defines);
+
+    std::ifstream fin;
+    if (!blob_path.empty()) {
+        fin.open(blob_path, std::ios::binary);
+    } else {
+        // blobs compiled next to the source without options
+        OutputDebugString(("Shader permutation isn't in the cache: " + std::string(path.begin(), path.end()) + "\n").c_str());
+        fin.open(path + L"." + stage + L".cso", std::ios::binary);
+    }
 
     fin.seekg(0, std::ios_base::end);
     SIZE_T size = (SIZE_T)fin.tellg();
@@ -95,6 +114,7 @@ Pipeline::~Pipeline()
     SAFE_RELEASE(pso_);
 
     descriptor_ranges_.clear();
+    root_parameters_.clear();
 }
 
 void Pipeline::create_root_signature()
@@ -107,9 +127,13 @@ void Pipeline::create_root_signature()
     }
 
     std::vector<CD3DX12_ROOT_PARAMETER1> params;
-    for (auto& range : descriptor_ranges_) {
+    for (const RootParameter& parameter : root_parameters_) {
         params.push_back({});
-        params.back().InitAsDescriptorTable(1, &range, D3D12_SHADER_VISIBILITY_ALL);
+        if (parameter.range_count > 0) {
+            params.back().InitAsDescriptorTable(parameter.range_count, &descriptor_ranges_[parameter.first_range], D3D12_SHADER_VISIBILITY_ALL);
+        } else {
+            params.back().InitAsConstants(parameter.constant_count, parameter.slot, parameter.space, D3D12_SHADER_VISIBILITY_ALL);
+        }
     }
 
     CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC root_signature_desc;
@@ -124,15 +148,35 @@ void Pipeline::create_root_signature()
         OutputDebugString((char*)error->GetBufferPointer());
         assert(false);
     }
-    HRESULT_CHECK(device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(root_signature_.GetAddressOf())));
+    root_signature_ = Game::inst()->render().pipeline_cache()->root_signature(signature->GetBufferPointer(), signature->GetBufferSize(), root_signature_hash_);
 }
 
 void Pipeline::declare_range(D3D12_DESCRIPTOR_RANGE_TYPE range_type, UINT slot, UINT space)
 {
+    root_parameters_.push_back({ UINT(descriptor_ranges_.size()), 1, 0, slot, space });
     descriptor_ranges_.push_back({});
     descriptor_ranges_.back().Init(range_type, 1, slot, space, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC);
 }
 
+void Pipeline::declare_constants(UINT constant_count, UINT slot, UINT space)
+{
+    root_parameters_.push_back({ 0, 0, constant_count, slot, space });
+}
+
+void Pipeline::begin_table()
+{
+    root_parameters_.push_back({ UINT(descriptor_ranges_.size()), 0, 0, 0, 0 });
+}
+
+void Pipeline::declare_table_range(D3D12_DESCRIPTOR_RANGE_TYPE range_type, UINT space)
+{
+    assert(!root_parameters_.empty());
+    // all ranges start at the table start, entries are written while earlier frames are in flight
+    descriptor_ranges_.push_back({});
+    descriptor_ranges_.back().Init(range_type, BINDLESS_TABLE_CAPACITY, 0, space, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE, 0);
+    ++root_parameters_.back().range_count;
+}
+
 ID3D12RootSignature* Pipeline::get_root_signature() const
 {
     return root_signature_.Get();
@@ -188,21 +232,21 @@ void GraphicsPipeline::setup_input_layout(const D3D12_INPUT_ELEMENT_DESC* inputE
 
 void GraphicsPipeline::attach_vertex_shader(const std::wstring& path, const std::vector<std::wstring>& defines)
 {
-    vertex_shader_ = LoadShader(path, L"vertex");
+    vertex_shader_ = LoadShader(path, L"vertex", defines);
 
     pso_desc_.VS = CD3DX12_SHADER_BYTECODE(vertex_shader_->GetBufferPointer(), vertex_shader_->GetBufferSize());
 }
 
 void GraphicsPipeline::attach_geometry_shader(const std::wstring& path, const std::vector<std::wstring>& defines)
 {
-    geometry_shader_ = LoadShader(path, L"geometry");
+    geometry_shader_ = LoadShader(path, L"geometry", defines);
 
     pso_desc_.GS = CD3DX12_SHADER_BYTECODE(geometry_shader_->GetBufferPointer(), geometry_shader_->GetBufferSize());
 }
 
 void GraphicsPipeline::attach_pixel_shader(const std::wstring& path, const std::vector<std::wstring>& defines)
 {
-    pixel_shader_ = LoadShader(path, L"pixel");
+    pixel_shader_ = LoadShader(path, L"pixel", defines);
 
     pso_desc_.PS = CD3DX12_SHADER_BYTECODE(pixel_shader_->GetBufferPointer(), pixel_shader_->GetBufferSize());
 }
@@ -212,12 +256,9 @@ void GraphicsPipeline::create_pso_and_root_signature()
     assert(pso_.Get() == nullptr);
     assert(root_signature_.Get() == nullptr);
 
-    auto device = Game::inst()->render().device();
-    auto allocator = Game::inst()->render().graphics_command_allocator();
-
     create_root_signature();
     pso_desc_.pRootSignature = root_signature_.Get();
-    HRESULT_CHECK(device->CreateGraphicsPipelineState(&pso_desc_, IID_PPV_ARGS(pso_.GetAddressOf())));
+    pso_ = Game::inst()->render().pipeline_cache()->pipeline(pso_desc_, root_signature_hash_);
 }
 
 #pragma endregion
@@ -238,7 +279,7 @@ ComputePipeline::~ComputePipeline()
 
 void ComputePipeline::attach_compute_shader(const std::wstring& path, const std::vector<std::wstring>& defines)
 {
-    compute_shader_ = LoadShader(path, L"compute");
+    compute_shader_ = LoadShader(path, L"compute", defines);
 
     pso_desc_.CS = CD3DX12_SHADER_BYTECODE(compute_shader_->GetBufferPointer(), compute_shader_->GetBufferSize());
 }
@@ -256,7 +297,7 @@ void ComputePipeline::create_pso_and_root_signature(D3D12_COMMAND_LIST_TYPE type
 
     create_root_signature();
     pso_desc_.pRootSignature = root_signature_.Get();
-    HRESULT_CHECK(Game::inst()->render().device()->CreateComputePipelineState(&pso_desc_, IID_PPV_ARGS(pso_.GetAddressOf())));
+    pso_ = Game::inst()->render().pipeline_cache()->pipeline(pso_desc_, root_signature_hash_);
 }
 
 #pragma endregion
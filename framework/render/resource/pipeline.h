@@ -3,59 +3,82 @@
 #include "render/common.h"
 
 #include <string>
+#include <type_traits>
 #include <wrl.h>
 #include <dxcapi.h>
 using namespace Microsoft::WRL;
 
 #include "shaders/common/types.fx"
+#include "render/resource/pipeline_layout.h"
 
 class Pipeline
 {
 private:
+    // descriptor table of range_count ranges from first_range, or root constants if range_count is 0
+    struct RootParameter
+    {
+        UINT first_range;
+        UINT range_count;
+        UINT constant_count;
+        UINT slot;
+        UINT space;
+    };
+
     void declare_range(D3D12_DESCRIPTOR_RANGE_TYPE range_type, UINT slot, UINT space);
+    void declare_constants(UINT constant_count, UINT slot, UINT space);
+    // table of BINDLESS_TABLE_CAPACITY descriptors, ranges are added by declare_table_range
+    void begin_table();
+    void declare_table_range(D3D12_DESCRIPTOR_RANGE_TYPE range_type, UINT space);
+
+    template<class bind>
+    static constexpr D3D12_DESCRIPTOR_RANGE_TYPE range_type()
+    {
+        using type = typename bind::Type;
+        static_assert(std::is_same<type, CBV>::value || std::is_same<type, SRV>::value || std::is_same<type, UAV>::value,
+            "range has to be declared with DECLARE_CBV, DECLARE_SRV, DECLARE_UAV or DECLARE_TABLE_*");
+        if constexpr (std::is_same<type, CBV>::value) {
+            return D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+        } else if constexpr (std::is_same<type, SRV>::value) {
+            return D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+        } else {
+            return D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+        }
+    }
+
+    template<class... ranges>
+    void declare_table(TableInfo<ranges...>)
+    {
+        begin_table();
+        (declare_table_range(range_type<ranges>(), ranges::space()), ...);
+    }
 protected:
+    // shared through PipelineCache with every pipeline of the same description
     ComPtr<ID3D12RootSignature> root_signature_{ nullptr };
+    uint64_t root_signature_hash_{ 0 };
     std::vector<CD3DX12_DESCRIPTOR_RANGE1> descriptor_ranges_;
+    std::vector<RootParameter> root_parameters_;
 
     ComPtr<ID3D12PipelineState> pso_{ nullptr };
 
     void create_root_signature();
-public:
-    virtual ~Pipeline();
 
+    // every declared bind is one root parameter, in declaration order:
+    // a descriptor table of one descriptor, root constants or a bindless table
     template<class bind>
     void declare_bind()
     {
-        bind info;
-        if (std::is_same<decltype(info.type()), CBV>::value) {
-            declare_range(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, info.slot(), info.space());
-        } else if (std::is_same<decltype(info.type()), SRV>::value) {
-            declare_range(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, info.slot(), info.space());
-        } else if (std::is_same<decltype(info.type()), UAV>::value) {
-            declare_range(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, info.slot(), info.space());
-        }
-    }
-
-    template<class bind>
-    int resource_index()
-    {
-        bind info;
-        for (int i = 0; i < descriptor_ranges_.size(); ++i) {
-            if (descriptor_ranges_[i].BaseShaderRegister == info.slot() && descriptor_ranges_[i].RegisterSpace == info.space()) {
-                return i;
-            }
+        using type = typename bind::Type;
+        if constexpr (std::is_same<type, CONSTANTS>::value) {
+            static_assert(sizeof(bind) % sizeof(UINT) == 0, "root constants are 32 bit values");
+            declare_constants(UINT(sizeof(bind) / sizeof(UINT)), bind::slot(), bind::space());
+        } else if constexpr (std::is_same<type, TABLE>::value) {
+            declare_table(bind{});
+        } else {
+            declare_range(range_type<bind>(), bind::slot(), bind::space());
         }
-        char error_msg[256];
-        sprintf_s(error_msg, _countof(error_msg), "can't find registered range for current resource: %s slot: %d space: %d",
-            std::is_same<decltype(info.type()), CBV>::value ? "cbv"
-                                                            : (std::is_same<decltype(info.type()), SRV>::value ? "srv"
-                                                                                                                : "uav"),
-            info.slot(),
-            info.space());
-        OutputDebugString(error_msg);
-        assert(false);
-        return -1;
     }
+public:
+    virtual ~Pipeline();
 
     virtual void create_pso_and_root_signature() = 0;
 
@@ -105,3 +128,8 @@ public:
 
     void create_pso_and_root_signature(D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator* allocator);
 };
+
+template<class Layout>
+using LayoutGraphicsPipeline = LayoutPipeline<GraphicsPipeline, Layout>;
+template<class Layout>
+using LayoutComputePipeline = LayoutPipeline<ComputePipeline, Layout>;
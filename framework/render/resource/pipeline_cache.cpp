@@ -0,0 +1,185 @@
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+
+#include "pipeline_cache.h"
+
+#pragma region ================================================================================================Cache================================================================================================
+
+void PipelineCache::initialize(PipelineDevice* device)
+{
+    assert(device != nullptr);
+    device_ = device;
+    clear();
+    stats_ = Stats{};
+}
+
+void PipelineCache::clear()
+{
+    root_signatures_.clear();
+    pipelines_.clear();
+}
+
+ComPtr<ID3D12RootSignature> PipelineCache::root_signature(const void* blob, size_t size, uint64_t& hash)
+{
+    hash = hash_root_signature(blob, size);
+    auto it = root_signatures_.find(hash);
+    if (it != root_signatures_.end()) {
+        ++stats_.shared_root_signatures;
+        return it->second;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    ComPtr<ID3D12RootSignature> root_signature = device_->create_root_signature(blob, size);
+    stats_.root_signature_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    root_signatures_.emplace(hash, root_signature);
+    ++stats_.root_signatures;
+    return root_signature;
+}
+
+ComPtr<ID3D12PipelineState> PipelineCache::pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash)
+{
+    return find_or_create(desc, hash_pipeline(desc, root_signature_hash));
+}
+
+ComPtr<ID3D12PipelineState> PipelineCache::pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash)
+{
+    return find_or_create(desc, hash_pipeline(desc, root_signature_hash));
+}
+
+template<class Desc>
+ComPtr<ID3D12PipelineState> PipelineCache::find_or_create(const Desc& desc, uint64_t hash)
+{
+    auto it = pipelines_.find(hash);
+    if (it != pipelines_.end()) {
+        ++stats_.shared_pipelines;
+        return it->second;
+    }
+
+    const std::wstring name = pipeline_name(hash);
+    auto begin = std::chrono::steady_clock::now();
+    ComPtr<ID3D12PipelineState> pipeline = device_->load_pipeline(name, desc);
+    stats_.load_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    if (pipeline != nullptr) {
+        ++stats_.loaded_pipelines;
+    } else {
+        begin = std::chrono::steady_clock::now();
+        pipeline = device_->create_pipeline(desc);
+        stats_.create_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        device_->store_pipeline(name, pipeline.Get());
+        ++stats_.created_pipelines;
+    }
+
+    pipelines_.emplace(hash, pipeline);
+    ++stats_.pipelines;
+    return pipeline;
+}
+
+std::wstring PipelineCache::pipeline_name(uint64_t hash)
+{
+    wchar_t name[32];
+    swprintf(name, 32, L"pso_%016llx", (unsigned long long)hash);
+    return name;
+}
+
+#pragma endregion
+
+#pragma region ================================================================================================Library================================================================================================
+
+void PipelineLibrary::initialize(ID3D12Device* device, const std::string& path)
+{
+    device_ = device;
+    path_ = path;
+    loaded_bytes_ = 0;
+    dirty_ = false;
+
+    ComPtr<ID3D12Device1> device1;
+    if (FAILED(device->QueryInterface(IID_PPV_ARGS(device1.GetAddressOf())))) {
+        OutputDebugString("Pipeline library isn't supported, pipelines are created every run\n");
+        return;
+    }
+
+    std::ifstream fin(path_, std::ios::binary);
+    if (fin) {
+        fin.seekg(0, std::ios_base::end);
+        data_.resize(size_t(fin.tellg()));
+        fin.seekg(0, std::ios_base::beg);
+        fin.read(data_.data(), data_.size());
+    }
+    if (!data_.empty() && SUCCEEDED(device1->CreatePipelineLibrary(data_.data(), data_.size(), IID_PPV_ARGS(library_.GetAddressOf())))) {
+        loaded_bytes_ = data_.size();
+        return;
+    }
+    // missing file, other driver or adapter
+    data_.clear();
+    HRESULT_CHECK(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(library_.ReleaseAndGetAddressOf())));
+}
+
+void PipelineLibrary::save()
+{
+    if (library_ == nullptr || !dirty_) {
+        return;
+    }
+    std::vector<char> data(library_->GetSerializedSize());
+    HRESULT_CHECK(library_->Serialize(data.data(), data.size()));
+    std::ofstream fout(path_, std::ios::binary | std::ios::trunc);
+    fout.write(data.data(), data.size());
+    dirty_ = false;
+}
+
+void PipelineLibrary::destroy()
+{
+    SAFE_RELEASE(library_);
+    SAFE_RELEASE(device_);
+    data_.clear();
+}
+
+ComPtr<ID3D12RootSignature> PipelineLibrary::create_root_signature(const void* blob, size_t size)
+{
+    ComPtr<ID3D12RootSignature> root_signature;
+    HRESULT_CHECK(device_->CreateRootSignature(0, blob, size, IID_PPV_ARGS(root_signature.GetAddressOf())));
+    return root_signature;
+}
+
+ComPtr<ID3D12PipelineState> PipelineLibrary::create_pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    ComPtr<ID3D12PipelineState> pipeline;
+    HRESULT_CHECK(device_->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pipeline.GetAddressOf())));
+    return pipeline;
+}
+
+ComPtr<ID3D12PipelineState> PipelineLibrary::create_pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc)
+{
+    ComPtr<ID3D12PipelineState> pipeline;
+    HRESULT_CHECK(device_->CreateComputePipelineState(&desc, IID_PPV_ARGS(pipeline.GetAddressOf())));
+    return pipeline;
+}
+
+ComPtr<ID3D12PipelineState> PipelineLibrary::load_pipeline(const std::wstring& name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    ComPtr<ID3D12PipelineState> pipeline;
+    if (library_ != nullptr) {
+        // E_INVALIDARG if the name isn't stored or was stored with another description
+        library_->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(pipeline.GetAddressOf()));
+    }
+    return pipeline;
+}
+
+ComPtr<ID3D12PipelineState> PipelineLibrary::load_pipeline(const std::wstring& name, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc)
+{
+    ComPtr<ID3D12PipelineState> pipeline;
+    if (library_ != nullptr) {
+        library_->LoadComputePipeline(name.c_str(), &desc, IID_PPV_ARGS(pipeline.GetAddressOf()));
+    }
+    return pipeline;
+}
+
+void PipelineLibrary::store_pipeline(const std::wstring& name, ID3D12PipelineState* pipeline)
+{
+    if (library_ != nullptr && SUCCEEDED(library_->StorePipeline(name.c_str(), pipeline))) {
+        dirty_ = true;
+    }
+}
+
+#pragma endregion
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "render/common.h"
+#include "render/resource/pipeline_key.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <wrl.h>
+using namespace Microsoft::WRL;
+
+// Part of the device PipelineCache creates pipelines with, including a library that outlives the process.
+// PipelineLibrary implements it with D3D12, a fake device can be used to exercise the cache.
+class PipelineDevice
+{
+public:
+    virtual ~PipelineDevice() = default;
+
+    virtual ComPtr<ID3D12RootSignature> create_root_signature(const void* blob, size_t size) = 0;
+    virtual ComPtr<ID3D12PipelineState> create_pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) = 0;
+    virtual ComPtr<ID3D12PipelineState> create_pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc) = 0;
+    // nullptr if the library doesn't have a pipeline stored under name
+    virtual ComPtr<ID3D12PipelineState> load_pipeline(const std::wstring& name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) = 0;
+    virtual ComPtr<ID3D12PipelineState> load_pipeline(const std::wstring& name, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc) = 0;
+    virtual void store_pipeline(const std::wstring& name, ID3D12PipelineState* pipeline) = 0;
+};
+
+// Root signatures and pipelines by hash of their description: identical pipelines of different objects
+// (e.g. pipelines of every ModelTree) share one PSO, and PSOs created in earlier runs are loaded from the library.
+// 64 bit hashes are trusted, a collision would hand out the wrong pipeline.
+class PipelineCache
+{
+public:
+    struct Stats
+    {
+        uint32_t root_signatures{ 0 };
+        uint32_t shared_root_signatures{ 0 }; // requests served by an existing root signature
+        uint32_t pipelines{ 0 };
+        uint32_t shared_pipelines{ 0 };       // requests served by an existing PSO of this run
+        uint32_t loaded_pipelines{ 0 };       // PSOs loaded from the library of an earlier run
+        uint32_t created_pipelines{ 0 };      // PSOs compiled by the driver, stored to the library
+        double root_signature_ms{ 0.0 };
+        double load_ms{ 0.0 };
+        double create_ms{ 0.0 };
+    };
+
+    PipelineCache() = default;
+    ~PipelineCache() = default;
+
+    void initialize(PipelineDevice* device);
+    // releases cache references, pipelines still hold theirs
+    void clear();
+
+    ComPtr<ID3D12RootSignature> root_signature(const void* blob, size_t size, uint64_t& hash);
+    ComPtr<ID3D12PipelineState> pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash);
+    ComPtr<ID3D12PipelineState> pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash);
+
+    const Stats& stats() const { return stats_; }
+    // name of the pipeline in the library
+    static std::wstring pipeline_name(uint64_t hash);
+private:
+    template<class Desc>
+    ComPtr<ID3D12PipelineState> find_or_create(const Desc& desc, uint64_t hash);
+
+    PipelineDevice* device_{ nullptr };
+    std::unordered_map<uint64_t, ComPtr<ID3D12RootSignature>> root_signatures_;
+    std::unordered_map<uint64_t, ComPtr<ID3D12PipelineState>> pipelines_;
+    Stats stats_;
+};
+
+// ID3D12PipelineLibrary kept in a file between runs. A file written by another driver or adapter is dropped
+// and the library starts empty; without ID3D12Device1 pipelines are created every run.
+class PipelineLibrary : public PipelineDevice
+{
+public:
+    PipelineLibrary() = default;
+    ~PipelineLibrary() = default;
+
+    void initialize(ID3D12Device* device, const std::string& path);
+    // writes the file if pipelines were stored since it was read
+    void save();
+    void destroy();
+
+    // bytes read from the file, 0 if the library started empty
+    size_t loaded_bytes() const { return loaded_bytes_; }
+
+    ComPtr<ID3D12RootSignature> create_root_signature(const void* blob, size_t size) override;
+    ComPtr<ID3D12PipelineState> create_pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) override;
+    ComPtr<ID3D12PipelineState> create_pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc) override;
+    ComPtr<ID3D12PipelineState> load_pipeline(const std::wstring& name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) override;
+    ComPtr<ID3D12PipelineState> load_pipeline(const std::wstring& name, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc) override;
+    void store_pipeline(const std::wstring& name, ID3D12PipelineState* pipeline) override;
+private:
+    ComPtr<ID3D12Device> device_;
+    ComPtr<ID3D12PipelineLibrary> library_;
+    // library reads pipelines from this memory while it lives
+    std::vector<char> data_;
+    std::string path_;
+    size_t loaded_bytes_{ 0 };
+    bool dirty_{ false };
+};
@@ -0,0 +1,135 @@
+#include "pipeline_key.h"
+
+namespace
+{
+enum class PipelineType : uint32_t
+{
+    graphics,
+    compute,
+};
+
+void add_bytecode(ContentHasher& hasher, const D3D12_SHADER_BYTECODE& bytecode)
+{
+    hasher.add(uint64_t(bytecode.BytecodeLength));
+    if (bytecode.pShaderBytecode != nullptr) {
+        hasher.add(bytecode.pShaderBytecode, bytecode.BytecodeLength);
+    }
+}
+
+void add_stencil_op(ContentHasher& hasher, const D3D12_DEPTH_STENCILOP_DESC& op)
+{
+    hasher.add(op.StencilFailOp);
+    hasher.add(op.StencilDepthFailOp);
+    hasher.add(op.StencilPassOp);
+    hasher.add(op.StencilFunc);
+}
+} // namespace
+
+uint64_t hash_root_signature(const void* blob, size_t size)
+{
+    ContentHasher hasher;
+    hasher.add(uint64_t(size));
+    hasher.add(blob, size);
+    return hasher.value();
+}
+
+uint64_t hash_pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash)
+{
+    ContentHasher hasher;
+    hasher.add(PipelineType::graphics);
+    hasher.add(root_signature_hash);
+    add_bytecode(hasher, desc.VS);
+    add_bytecode(hasher, desc.PS);
+    add_bytecode(hasher, desc.DS);
+    add_bytecode(hasher, desc.HS);
+    add_bytecode(hasher, desc.GS);
+
+    hasher.add(desc.StreamOutput.NumEntries);
+    for (UINT i = 0; i < desc.StreamOutput.NumEntries; ++i) {
+        const D3D12_SO_DECLARATION_ENTRY& entry = desc.StreamOutput.pSODeclaration[i];
+        hasher.add(entry.Stream);
+        hasher.add_string(entry.SemanticName);
+        hasher.add(entry.SemanticIndex);
+        hasher.add(entry.StartComponent);
+        hasher.add(entry.ComponentCount);
+        hasher.add(entry.OutputSlot);
+    }
+    hasher.add(desc.StreamOutput.NumStrides);
+    if (desc.StreamOutput.NumStrides > 0) {
+        hasher.add(desc.StreamOutput.pBufferStrides, desc.StreamOutput.NumStrides * sizeof(UINT));
+    }
+    hasher.add(desc.StreamOutput.RasterizedStream);
+
+    hasher.add(desc.BlendState.AlphaToCoverageEnable);
+    hasher.add(desc.BlendState.IndependentBlendEnable);
+    for (const D3D12_RENDER_TARGET_BLEND_DESC& target : desc.BlendState.RenderTarget) {
+        hasher.add(target.BlendEnable);
+        hasher.add(target.LogicOpEnable);
+        hasher.add(target.SrcBlend);
+        hasher.add(target.DestBlend);
+        hasher.add(target.BlendOp);
+        hasher.add(target.SrcBlendAlpha);
+        hasher.add(target.DestBlendAlpha);
+        hasher.add(target.BlendOpAlpha);
+        hasher.add(target.LogicOp);
+        hasher.add(target.RenderTargetWriteMask);
+    }
+    hasher.add(desc.SampleMask);
+
+    const D3D12_RASTERIZER_DESC& rasterizer = desc.RasterizerState;
+    hasher.add(rasterizer.FillMode);
+    hasher.add(rasterizer.CullMode);
+    hasher.add(rasterizer.FrontCounterClockwise);
+    hasher.add(rasterizer.DepthBias);
+    hasher.add(rasterizer.DepthBiasClamp);
+    hasher.add(rasterizer.SlopeScaledDepthBias);
+    hasher.add(rasterizer.DepthClipEnable);
+    hasher.add(rasterizer.MultisampleEnable);
+    hasher.add(rasterizer.AntialiasedLineEnable);
+    hasher.add(rasterizer.ForcedSampleCount);
+    hasher.add(rasterizer.ConservativeRaster);
+
+    const D3D12_DEPTH_STENCIL_DESC& depth_stencil = desc.DepthStencilState;
+    hasher.add(depth_stencil.DepthEnable);
+    hasher.add(depth_stencil.DepthWriteMask);
+    hasher.add(depth_stencil.DepthFunc);
+    hasher.add(depth_stencil.StencilEnable);
+    hasher.add(depth_stencil.StencilReadMask);
+    hasher.add(depth_stencil.StencilWriteMask);
+    add_stencil_op(hasher, depth_stencil.FrontFace);
+    add_stencil_op(hasher, depth_stencil.BackFace);
+
+    hasher.add(desc.InputLayout.NumElements);
+    for (UINT i = 0; i < desc.InputLayout.NumElements; ++i) {
+        const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+        hasher.add_string(element.SemanticName);
+        hasher.add(element.SemanticIndex);
+        hasher.add(element.Format);
+        hasher.add(element.InputSlot);
+        hasher.add(element.AlignedByteOffset);
+        hasher.add(element.InputSlotClass);
+        hasher.add(element.InstanceDataStepRate);
+    }
+
+    hasher.add(desc.IBStripCutValue);
+    hasher.add(desc.PrimitiveTopologyType);
+    hasher.add(desc.NumRenderTargets);
+    hasher.add(desc.RTVFormats);
+    hasher.add(desc.DSVFormat);
+    hasher.add(desc.SampleDesc.Count);
+    hasher.add(desc.SampleDesc.Quality);
+    hasher.add(desc.NodeMask);
+    hasher.add(desc.Flags);
+    return hasher.value();
+}
+
+uint64_t hash_pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash)
+{
+    ContentHasher hasher;
+    hasher.add(PipelineType::compute);
+    hasher.add(root_signature_hash);
+    add_bytecode(hasher, desc.CS);
+    hasher.add(desc.NodeMask);
+    hasher.add(desc.Flags);
+    return hasher.value();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// descriptions only, no device: off Windows the WSL adapter of DirectX-Headers provides the types
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include "render/headers/d3d12/wsl/winadapter.h"
+#endif
+#include "render/headers/d3d12/directx/d3d12.h"
+
+#include "core/content_hash.h"
+
+// Keys of PipelineCache. Descriptions are hashed field by field, padding of D3D12 structs is never read.
+// Root signature is identified by the hash of its serialized blob, pointers in descriptions are ignored.
+uint64_t hash_root_signature(const void* blob, size_t size);
+uint64_t hash_pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash);
+uint64_t hash_pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t root_signature_hash);
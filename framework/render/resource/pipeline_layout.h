@@ -0,0 +1,79 @@
+#pragma once
+
+#include <type_traits>
+
+#include "shaders/common/types.fx"
+
+// Binds of a pipeline as a compile-time list, root parameter indices are known at compile time.
+// A bind that isn't in the list or two binds of the same register fail to compile.
+// Doesn't know about D3D12, pipeline.h declares root signatures from it.
+template<class... binds>
+struct PipelineLayout
+{
+    static constexpr UINT size = UINT(sizeof...(binds));
+
+    template<class bind>
+    static constexpr UINT root_index()
+    {
+        constexpr bool matches[] = { std::is_same<bind, binds>::value..., false };
+        UINT index = 0;
+        while (index < size && !matches[index]) {
+            ++index;
+        }
+        return index;
+    }
+
+    template<class bind>
+    static constexpr bool contains() { return root_index<bind>() < size; }
+
+    // register letter of the bind, tables are checked by their ranges' spaces only
+    template<class bind>
+    static constexpr char register_class()
+    {
+        using type = typename bind::Type;
+        return std::is_same<type, CBV>::value || std::is_same<type, CONSTANTS>::value ? 'b'
+             : std::is_same<type, SRV>::value ? 't'
+             : std::is_same<type, UAV>::value ? 'u'
+             : 0;
+    }
+
+    static constexpr bool unique_registers()
+    {
+        constexpr UINT slots[] = { binds::slot()..., 0 };
+        constexpr UINT spaces[] = { binds::space()..., 0 };
+        constexpr char classes[] = { register_class<binds>()..., 0 };
+        for (UINT i = 0; i < size; ++i) {
+            for (UINT j = i + 1; j < size; ++j) {
+                if (classes[i] != 0 && classes[i] == classes[j] && slots[i] == slots[j] && spaces[i] == spaces[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// Pipeline whose root signature is declared from Layout on construction,
+// Base declares every bind with declare_bind<bind>() in layout order
+template<class Base, class Layout>
+class LayoutPipeline;
+
+template<class Base, class... binds>
+class LayoutPipeline<Base, PipelineLayout<binds...>> : public Base
+{
+public:
+    using Layout = PipelineLayout<binds...>;
+    static_assert(Layout::unique_registers(), "two binds of the layout use the same register");
+
+    LayoutPipeline()
+    {
+        (this->template declare_bind<binds>(), ...);
+    }
+
+    template<class bind>
+    static constexpr UINT resource_index()
+    {
+        static_assert(Layout::template contains<bind>(), "bind is not declared in the pipeline layout");
+        return Layout::template root_index<bind>();
+    }
+};
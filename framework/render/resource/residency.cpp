@@ -0,0 +1,84 @@
+#include <cassert>
+#include <sstream>
+#include <iomanip>
+
+#include "residency.h"
+
+namespace
+{
+
+const char* usage_name(BufferUsage usage)
+{
+    return usage == BufferUsage::static_data ? "static" : "dynamic";
+}
+
+const char* heap_name(HeapPlacement heap)
+{
+    return heap == HeapPlacement::default_heap ? "default" : "upload";
+}
+
+} // namespace
+
+HeapPlacement ResidencyPolicy::placement(BufferUsage usage) const
+{
+    if (usage == BufferUsage::dynamic_data || settings_.static_in_upload_heap) {
+        return HeapPlacement::upload_heap;
+    }
+    return HeapPlacement::default_heap;
+}
+
+HeapPlacement ResidencyPolicy::place(const std::string& name, BufferUsage usage, uint64_t bytes, uint32_t& id)
+{
+    const HeapPlacement heap = placement(usage);
+    if (!free_ids_.empty()) {
+        id = free_ids_.back();
+        free_ids_.pop_back();
+        placements_[id] = { name, usage, heap, bytes, true };
+    } else {
+        id = uint32_t(placements_.size());
+        placements_.push_back({ name, usage, heap, bytes, true });
+    }
+    return heap;
+}
+
+void ResidencyPolicy::release(uint32_t& id)
+{
+    if (id == invalid_placement) {
+        return;
+    }
+    assert(id < placements_.size() && placements_[id].live);
+    placements_[id] = Placement{};
+    free_ids_.push_back(id);
+    id = invalid_placement;
+}
+
+uint64_t ResidencyPolicy::bytes(HeapPlacement heap) const
+{
+    uint64_t bytes = 0;
+    for (const Placement& placement : placements_) {
+        if (placement.live && placement.heap == heap) {
+            bytes += placement.bytes;
+        }
+    }
+    return bytes;
+}
+
+std::string ResidencyPolicy::report() const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "default heap " << bytes(HeapPlacement::default_heap) / 1024.0 << " KB, "
+       << "upload heap " << bytes(HeapPlacement::upload_heap) / 1024.0 << " KB, "
+       << live_count() << " buffers" << (settings_.static_in_upload_heap ? ", static data in upload heap" : "") << "\n";
+    ss << std::left << std::setw(36) << "buffer" << std::setw(10) << "usage" << std::setw(10) << "heap"
+       << std::right << std::setw(12) << "KB" << "\n";
+    for (const Placement& placement : placements_) {
+        if (!placement.live) {
+            continue;
+        }
+        ss << std::left << std::setw(36) << placement.name << std::setw(10) << usage_name(placement.usage)
+           << std::setw(10) << heap_name(placement.heap)
+           << std::right << std::setw(12) << placement.bytes / 1024.0 << "\n";
+    }
+    return ss.str();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+enum class BufferUsage
+{
+    static_data,  // written once or rarely, read by GPU every frame
+    dynamic_data, // rewritten by CPU every frame or on every change
+};
+
+enum class HeapPlacement
+{
+    default_heap, // video memory, filled through StagingUploader
+    upload_heap,  // system memory mapped for CPU writes, GPU reads it across the bus
+};
+
+// Decides where buffers live and keeps the decisions of live buffers for the placement report.
+// Static data goes to default heap, dynamic data stays in upload heap; static_in_upload_heap
+// puts everything in upload heap to compare with the old placement.
+// Released buffers leave the report, their slots are reused by the next placements.
+class ResidencyPolicy
+{
+public:
+    struct Settings
+    {
+        bool static_in_upload_heap{ false };
+    };
+
+    static constexpr uint32_t invalid_placement = ~0u;
+
+    struct Placement
+    {
+        std::string name;
+        BufferUsage usage;
+        HeapPlacement heap;
+        uint64_t bytes;
+        bool live;
+    };
+
+    ResidencyPolicy() = default;
+    ~ResidencyPolicy() = default;
+
+    // applies to buffers placed afterwards
+    void set_settings(const Settings& settings) { settings_ = settings; }
+    const Settings& settings() const { return settings_; }
+
+    HeapPlacement placement(BufferUsage usage) const;
+    // placement(usage) recorded in the report until release(id)
+    HeapPlacement place(const std::string& name, BufferUsage usage, uint64_t bytes, uint32_t& id);
+    void release(uint32_t& id);
+
+    // by id, released slots are not live
+    const std::vector<Placement>& placements() const { return placements_; }
+    uint32_t live_count() const { return uint32_t(placements_.size() - free_ids_.size()); }
+    uint64_t bytes(HeapPlacement heap) const;
+    // totals per heap and one line per buffer
+    std::string report() const;
+private:
+    Settings settings_;
+    std::vector<Placement> placements_;
+    std::vector<uint32_t> free_ids_;
+};
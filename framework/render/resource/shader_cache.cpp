@@ -0,0 +1,258 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+#include "core/content_hash.h"
+#include "shader_cache.h"
+
+namespace
+{
+bool read_file(const std::filesystem::path& path, std::string& text)
+{
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << fin.rdbuf();
+    text = ss.str();
+    return true;
+}
+
+std::string trim_left(const std::string& line)
+{
+    const size_t begin = line.find_first_not_of(" \t");
+    return begin == std::string::npos ? std::string() : line.substr(begin);
+}
+
+// name of a quoted include, empty for other lines; <> includes are returned with their brackets
+std::string include_name(const std::string& line)
+{
+    const std::string trimmed = trim_left(line);
+    if (trimmed.compare(0, 8, "#include") != 0) {
+        return {};
+    }
+    const size_t begin = trimmed.find_first_of("\"<", 8);
+    if (begin == std::string::npos) {
+        return {};
+    }
+    const size_t end = trimmed.find(trimmed[begin] == '"' ? '"' : '>', begin + 1);
+    if (end == std::string::npos) {
+        return {};
+    }
+    return trimmed[begin] == '"' ? trimmed.substr(begin + 1, end - begin - 1) : trimmed.substr(begin, end - begin + 1);
+}
+
+struct IncludeWalk
+{
+    explicit IncludeWalk(const std::vector<std::string>& dirs) : include_dirs(dirs) {}
+
+    const std::vector<std::string>& include_dirs;
+    std::unordered_set<std::string> visited;
+    ContentHasher hasher;
+    std::vector<ShaderOption> options;
+
+    void add_options(const std::string& text)
+    {
+        for (ShaderOption& option : parse_shader_options(text)) {
+            bool known = false;
+            for (const ShaderOption& existing : options) {
+                known = known || existing.name == option.name;
+            }
+            if (!known) {
+                options.push_back(std::move(option));
+            }
+        }
+    }
+
+    void walk(const std::filesystem::path& file, const std::string& text)
+    {
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            const std::string name = include_name(line);
+            if (name.empty()) {
+                continue;
+            }
+            hasher.add_string(name.c_str());
+            if (name[0] == '<') {
+                continue;
+            }
+
+            std::filesystem::path resolved = (file.parent_path() / name).lexically_normal();
+            std::string included;
+            bool found = read_file(resolved, included);
+            for (size_t i = 0; !found && i < include_dirs.size(); ++i) {
+                resolved = (std::filesystem::path(include_dirs[i]) / name).lexically_normal();
+                found = read_file(resolved, included);
+            }
+            if (!found || !visited.insert(resolved.generic_string()).second) {
+                continue;
+            }
+            hasher.add(uint64_t(included.size()));
+            hasher.add(included.data(), included.size());
+            add_options(included);
+            walk(resolved, included);
+        }
+    }
+};
+} // namespace
+
+std::vector<ShaderOption> parse_shader_options(const std::string& source)
+{
+    std::vector<ShaderOption> options;
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        const std::string trimmed = trim_left(line);
+        if (trimmed.compare(0, 10, "// option:") != 0) {
+            continue;
+        }
+        std::istringstream tokens(trimmed.substr(10));
+        ShaderOption option;
+        tokens >> option.name;
+        std::string value;
+        while (tokens >> value) {
+            option.values.push_back(value);
+        }
+        if (!option.name.empty() && !option.values.empty()) {
+            options.push_back(std::move(option));
+        }
+    }
+    return options;
+}
+
+ShaderSource read_shader_source(const std::string& path, const std::vector<std::string>& include_dirs)
+{
+    ShaderSource source;
+    std::string text;
+    const std::filesystem::path file = std::filesystem::path(path).lexically_normal();
+    if (!read_file(file, text)) {
+        return source;
+    }
+
+    ContentHasher hasher;
+    hasher.add(text.data(), text.size());
+    source.source_hash = hasher.value();
+
+    IncludeWalk includes(include_dirs);
+    includes.visited.insert(file.generic_string());
+    includes.add_options(text);
+    includes.walk(file, text);
+    source.includes_hash = includes.hasher.value();
+    source.options = std::move(includes.options);
+    source.valid = true;
+    return source;
+}
+
+bool select_permutation(const std::vector<ShaderOption>& options, const std::vector<std::string>& defines, std::vector<std::string>& selected)
+{
+    std::vector<const std::string*> values(options.size(), nullptr);
+    for (const std::string& define : defines) {
+        const size_t separator = define.find('=');
+        const std::string name = define.substr(0, separator);
+        const std::string value = separator == std::string::npos ? "1" : define.substr(separator + 1);
+
+        bool matched = false;
+        for (size_t i = 0; i < options.size() && !matched; ++i) {
+            if (options[i].name != name) {
+                continue;
+            }
+            for (const std::string& declared : options[i].values) {
+                if (declared == value) {
+                    values[i] = &declared;
+                    matched = true;
+                    break;
+                }
+            }
+            if (!matched) {
+                return false;
+            }
+        }
+        if (!matched) {
+            return false;
+        }
+    }
+
+    selected.clear();
+    for (size_t i = 0; i < options.size(); ++i) {
+        selected.push_back(options[i].name + "=" + (values[i] != nullptr ? *values[i] : options[i].values.front()));
+    }
+    return true;
+}
+
+std::vector<std::vector<std::string>> shader_permutations(const std::vector<ShaderOption>& options)
+{
+    std::vector<std::vector<std::string>> permutations(1);
+    for (const ShaderOption& option : options) {
+        std::vector<std::vector<std::string>> expanded;
+        expanded.reserve(permutations.size() * option.values.size());
+        // earlier options vary slowest, the first permutation has every default
+        for (const std::vector<std::string>& permutation : permutations) {
+            for (const std::string& value : option.values) {
+                expanded.push_back(permutation);
+                expanded.back().push_back(option.name + "=" + value);
+            }
+        }
+        permutations = std::move(expanded);
+    }
+    return permutations;
+}
+
+uint64_t shader_key(const ShaderSource& source, const std::string& stage, const std::vector<std::string>& selected)
+{
+    ContentHasher hasher;
+    hasher.add(source.source_hash);
+    hasher.add(source.includes_hash);
+    hasher.add_string(stage.c_str());
+    for (const std::string& define : selected) {
+        hasher.add_string(define.c_str());
+    }
+    return hasher.value();
+}
+
+std::string shader_blob_name(uint64_t key, const std::string& stage)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return std::string(name) + "." + stage + ".cso";
+}
+
+void ShaderCache::initialize(const std::string& cache_dir, const std::vector<std::string>& include_dirs)
+{
+    cache_dir_ = cache_dir;
+    include_dirs_ = include_dirs;
+    sources_.clear();
+    stats_ = Stats{};
+}
+
+std::string ShaderCache::find(const std::string& path, const std::string& stage, const std::vector<std::string>& defines)
+{
+    ++stats_.lookups;
+    auto it = sources_.find(path);
+    if (it == sources_.end()) {
+        it = sources_.emplace(path, read_shader_source(path, include_dirs_)).first;
+        ++stats_.sources;
+    }
+    const ShaderSource& source = it->second;
+    if (!source.valid) {
+        ++stats_.misses;
+        return {};
+    }
+
+    std::vector<std::string> selected;
+    if (!select_permutation(source.options, defines, selected)) {
+        ++stats_.invalid_defines;
+        return {};
+    }
+
+    const std::filesystem::path blob = std::filesystem::path(cache_dir_) / shader_blob_name(shader_key(source, stage, selected), stage);
+    if (!std::filesystem::exists(blob)) {
+        ++stats_.misses;
+        return {};
+    }
+    ++stats_.hits;
+    return blob.string();
+}
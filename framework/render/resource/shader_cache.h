@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Option axis a shader declares with a comment line "// option: NAME value0 value1 ...", the first value is default.
+// Every combination of values is compiled by tools/shader_permutations into the shader cache.
+struct ShaderOption
+{
+    std::string name;
+    std::vector<std::string> values;
+};
+
+struct ShaderSource
+{
+    bool valid{ false };
+    uint64_t source_hash{ 0 };
+    uint64_t includes_hash{ 0 }; // files included directly or indirectly, in include order
+    std::vector<ShaderOption> options;
+};
+
+std::vector<ShaderOption> parse_shader_options(const std::string& source);
+// includes are looked up next to the including file, then in include_dirs; unresolved ones hash their name only
+ShaderSource read_shader_source(const std::string& path, const std::vector<std::string>& include_dirs);
+
+// "NAME=VALUE" defines in the order of options, "NAME" means NAME=1 and options without a define get their default;
+// false if a define doesn't name an option or names a value the shader doesn't declare
+bool select_permutation(const std::vector<ShaderOption>& options, const std::vector<std::string>& defines, std::vector<std::string>& selected);
+// every combination of option values as selected defines, all defaults first
+std::vector<std::vector<std::string>> shader_permutations(const std::vector<ShaderOption>& options);
+
+// key of the compiled blob, changes with the shader, any of its includes, the stage or the selected defines
+uint64_t shader_key(const ShaderSource& source, const std::string& stage, const std::vector<std::string>& selected);
+// file name of the blob in the cache directory
+std::string shader_blob_name(uint64_t key, const std::string& stage);
+
+// Finds compiled permutations in the content-hashed cache written by the build, doesn't know about D3D12.
+// Sources are hashed once per run, edited shaders miss until the build compiles them again.
+class ShaderCache
+{
+public:
+    struct Stats
+    {
+        uint32_t sources{ 0 };
+        uint32_t lookups{ 0 };
+        uint32_t hits{ 0 };
+        uint32_t misses{ 0 };
+        uint32_t invalid_defines{ 0 };
+    };
+
+    ShaderCache() = default;
+    ~ShaderCache() = default;
+
+    void initialize(const std::string& cache_dir, const std::vector<std::string>& include_dirs);
+
+    // path of the compiled blob of the permutation, empty if the cache doesn't have it
+    std::string find(const std::string& path, const std::string& stage, const std::vector<std::string>& defines);
+
+    const Stats& stats() const { return stats_; }
+private:
+    std::string cache_dir_;
+    std::vector<std::string> include_dirs_;
+    std::unordered_map<std::string, ShaderSource> sources_;
+    Stats stats_;
+};
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "staging_uploader.h"
+
+void StagingRing::initialize(uint64_t capacity)
+{
+    assert(capacity > 0);
+    capacity_ = capacity;
+    head_ = 0;
+    tail_ = 0;
+    used_ = 0;
+    open_bytes_ = 0;
+    batches_.clear();
+}
+
+bool StagingRing::allocate(uint64_t size, uint64_t alignment, uint64_t& offset)
+{
+    assert(size > 0 && size <= capacity_);
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    if (used_ == 0) {
+        head_ = 0;
+        tail_ = 0;
+    }
+
+    uint64_t start = (head_ + alignment - 1) & ~(alignment - 1);
+    uint64_t padding = 0;
+    if (used_ == 0 || head_ > tail_) {
+        // free space is [head, capacity) and [0, tail)
+        if (start + size <= capacity_) {
+            padding = start - head_;
+        } else if (size <= tail_) {
+            // end of the ring is skipped, it's released with the batch
+            padding = capacity_ - head_;
+            start = 0;
+        } else {
+            return false;
+        }
+    } else if (head_ < tail_) {
+        // free space is [head, tail)
+        if (start + size > tail_) {
+            return false;
+        }
+        padding = start - head_;
+    } else {
+        return false; // full
+    }
+
+    head_ = (start + size) % capacity_;
+    used_ += padding + size;
+    open_bytes_ += padding + size;
+    offset = start;
+    return true;
+}
+
+void StagingRing::close_batch(uint64_t fence_value)
+{
+    if (open_bytes_ == 0) {
+        return;
+    }
+    assert(batches_.empty() || batches_.back().fence_value < fence_value);
+    batches_.push_back({ fence_value, head_, open_bytes_ });
+    open_bytes_ = 0;
+}
+
+void StagingRing::retire(uint64_t completed_value)
+{
+    while (!batches_.empty() && batches_.front().fence_value <= completed_value) {
+        const Batch& batch = batches_.front();
+        used_ -= batch.bytes;
+        tail_ = batch.end;
+        batches_.pop_front();
+    }
+}
+
+uint64_t StagingRing::oldest_fence_value() const
+{
+    return batches_.empty() ? 0 : batches_.front().fence_value;
+}
+
+void StagingUploader::initialize(StagingDevice* device)
+{
+    assert(device != nullptr);
+    device_ = device;
+    ring_.initialize(device_->capacity());
+    stats_ = Stats{};
+}
+
+void StagingUploader::upload(ID3D12Resource* destination, uint64_t destination_offset, const void* data, uint64_t size)
+{
+    assert(device_ != nullptr);
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const uint64_t chunk = std::min(size, ring_.capacity());
+        const uint64_t offset = allocate(chunk);
+        memcpy(device_->staging_memory() + offset, source, size_t(chunk));
+        device_->copy(destination, destination_offset, offset, chunk);
+
+        source += chunk;
+        destination_offset += chunk;
+        size -= chunk;
+        stats_.bytes += chunk;
+    }
+    ++stats_.uploads;
+}
+
+uint64_t StagingUploader::submit()
+{
+    if (!ring_.has_open_batch()) {
+        return 0;
+    }
+    const uint64_t fence_value = device_->submit();
+    ring_.close_batch(fence_value);
+    ++stats_.batches;
+    return fence_value;
+}
+
+void StagingUploader::flush()
+{
+    submit();
+    while (ring_.batches_in_flight() > 0) {
+        device_->wait(ring_.oldest_fence_value());
+        retire();
+    }
+    ++stats_.flushes;
+}
+
+void StagingUploader::retire()
+{
+    ring_.retire(device_->completed_value());
+}
+
+StagingUploader::Stats StagingUploader::stats() const
+{
+    Stats stats = stats_;
+    stats.batches_in_flight = ring_.batches_in_flight();
+    stats.ring_used = ring_.used();
+    stats.ring_capacity = ring_.capacity();
+    return stats;
+}
+
+uint64_t StagingUploader::allocate(uint64_t size)
+{
+    uint64_t offset = 0;
+    while (!ring_.allocate(size, alignment, offset)) {
+        retire();
+        if (ring_.allocate(size, alignment, offset)) {
+            break;
+        }
+        // open batch holds ring space too, it has to be executed before it can be waited for
+        if (ring_.has_open_batch()) {
+            submit();
+        } else {
+            assert(ring_.batches_in_flight() > 0);
+            ++stats_.stalls;
+            device_->wait(ring_.oldest_fence_value());
+        }
+    }
+    return offset;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <deque>
+#include <cstdint>
+
+// copy destination, staging code only passes it to StagingDevice
+struct ID3D12Resource;
+
+// Part of GPU used by StagingUploader: mapped staging memory, one open copy batch and a fence.
+// CopyQueue implements it with D3D12, anything else (a fake queue) can be used to exercise the ring.
+class StagingDevice
+{
+public:
+    virtual ~StagingDevice() = default;
+
+    // persistently mapped staging memory of capacity() bytes
+    virtual uint8_t* staging_memory() = 0;
+    virtual uint64_t capacity() const = 0;
+
+    // records copy from staging memory into the open batch
+    virtual void copy(ID3D12Resource* destination, uint64_t destination_offset, uint64_t staging_offset, uint64_t size) = 0;
+    // executes the open batch, returns fence value signaled when GPU is done with it
+    virtual uint64_t submit() = 0;
+    virtual uint64_t completed_value() = 0;
+    virtual void wait(uint64_t fence_value) = 0;
+};
+
+// Ring of byte ranges in [0, capacity), ranges are released in allocation order.
+// Ranges allocated between two close_batch() calls are released together when their fence value completes.
+class StagingRing
+{
+public:
+    StagingRing() = default;
+    ~StagingRing() = default;
+
+    void initialize(uint64_t capacity);
+
+    // contiguous range, doesn't wrap; false if there is no room until older batches retire
+    bool allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+    // ranges allocated since last close are retired when fence_value completes
+    void close_batch(uint64_t fence_value);
+    // releases batches with fence value <= completed_value
+    void retire(uint64_t completed_value);
+
+    // fence value of the oldest batch in flight, 0 if there are none
+    uint64_t oldest_fence_value() const;
+    bool has_open_batch() const { return open_bytes_ > 0; }
+    uint64_t batches_in_flight() const { return uint64_t(batches_.size()); }
+    uint64_t capacity() const { return capacity_; }
+    uint64_t used() const { return used_; }
+private:
+    struct Batch
+    {
+        uint64_t fence_value;
+        uint64_t end;   // head after the last range of the batch
+        uint64_t bytes; // including alignment and wrap padding
+    };
+
+    uint64_t capacity_{ 0 };
+    uint64_t head_{ 0 }; // next free byte
+    uint64_t tail_{ 0 }; // first byte of the oldest live range
+    uint64_t used_{ 0 };
+    uint64_t open_bytes_{ 0 };
+    std::deque<Batch> batches_;
+};
+
+// Uploads buffer data through StagingRing: data is copied to staging memory at once, copies are recorded
+// into one batch and executed by submit(). Nothing waits for GPU unless the ring is full or flush() is called.
+// Copies are ordered before GPU work submitted after submit(), see CopyQueue.
+class StagingUploader
+{
+public:
+    struct Stats
+    {
+        uint64_t uploads{ 0 };
+        uint64_t bytes{ 0 };
+        uint64_t batches{ 0 };
+        uint64_t stalls{ 0 };  // CPU waits for a batch because the ring was full
+        uint64_t flushes{ 0 };
+        uint64_t batches_in_flight{ 0 };
+        uint64_t ring_used{ 0 };
+        uint64_t ring_capacity{ 0 };
+    };
+
+    StagingUploader() = default;
+    ~StagingUploader() = default;
+
+    void initialize(StagingDevice* device);
+
+    // data larger than the ring is split into several copies
+    void upload(ID3D12Resource* destination, uint64_t destination_offset, const void* data, uint64_t size);
+    // executes recorded copies, returns their fence value or 0 if there were none
+    uint64_t submit();
+    // submit and wait for all batches, for load boundaries
+    void flush();
+    // releases ring space of completed batches
+    void retire();
+
+    Stats stats() const;
+private:
+    static constexpr uint64_t alignment = 16;
+
+    // waits for older batches until size bytes fit into the ring
+    uint64_t allocate(uint64_t size);
+
+    StagingDevice* device_{ nullptr };
+    StagingRing ring_;
+    Stats stats_;
+};
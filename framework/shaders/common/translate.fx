@@ -16,17 +16,35 @@ struct DummyStructure{};
 struct CBV {};
 struct SRV {};
 struct UAV {};
+struct CONSTANTS {}; // root constants, the bind structure is the data
+struct TABLE {};     // bindless table, see TableInfo
 template<class t, UINT sl, UINT sp>
 struct BindInfo
 {
-    t type() {return t{}};
-    UINT slot() {return sl;};
-    UINT space() {return sp;};
+    using Type = t;
+    static constexpr t type() {return t{};};
+    static constexpr UINT slot() {return sl;};
+    static constexpr UINT space() {return sp;};
+};
+
+// one descriptor table of ranges, every range covers the whole table in its own space
+template<class... ranges>
+struct TableInfo
+{
+    using Type = TABLE;
+    static constexpr UINT slot() {return 0;};
+    static constexpr UINT space() {return 0;};
 };
 
 #define DECLARE_CBV(NAME, SLOT, SPACE) struct NAME##_BIND : public BindInfo<CBV, SLOT, SPACE>
 #define DECLARE_SRV(NAME, TYPE, SLOT, SPACE) struct NAME##_BIND : public BindInfo<SRV, SLOT, SPACE> {};
 #define DECLARE_UAV(NAME, TYPE, SLOT, SPACE) struct NAME##_BIND : public BindInfo<UAV, SLOT, SPACE> {};
+#define DECLARE_CONSTANTS(NAME, SLOT, SPACE) struct NAME##_BIND : public BindInfo<CONSTANTS, SLOT, SPACE>
+
+#define DECLARE_TABLE_CBV(NAME, TYPE, SPACE) struct NAME##_BIND : public BindInfo<CBV, 0, SPACE> {};
+#define DECLARE_TABLE_SRV(NAME, TYPE, SPACE) struct NAME##_BIND : public BindInfo<SRV, 0, SPACE> {};
+#define DECLARE_TABLE_UAV(NAME, TYPE, SPACE) struct NAME##_BIND : public BindInfo<UAV, 0, SPACE> {};
+#define DECLARE_TABLE(NAME, ...) using NAME##_BIND = TableInfo<__VA_ARGS__>;
 
 #else
 
@@ -40,6 +58,13 @@ struct BindInfo
 
 #define DECLARE_SRV(NAME, TYPE, SLOT, SPACE) StructuredBuffer<TYPE> NAME : register(t##SLOT, space##SPACE);
 #define DECLARE_UAV(NAME, TYPE, SLOT, SPACE) RWTexture3D<TYPE> NAME : register(u##SLOT, space##SPACE);
+#define DECLARE_CONSTANTS(NAME, SLOT, SPACE) cbuffer NAME : register(b##SLOT, space##SPACE)
+
+// arrays over the whole bindless table, indexed by root constants
+#define DECLARE_TABLE_CBV(NAME, TYPE, SPACE) ConstantBuffer<TYPE> NAME[BINDLESS_TABLE_CAPACITY] : register(b0, space##SPACE);
+#define DECLARE_TABLE_SRV(NAME, TYPE, SPACE) StructuredBuffer<TYPE> NAME[BINDLESS_TABLE_CAPACITY] : register(t0, space##SPACE);
+#define DECLARE_TABLE_UAV(NAME, TYPE, SPACE) RWTexture3D<TYPE> NAME[BINDLESS_TABLE_CAPACITY] : register(u0, space##SPACE);
+#define DECLARE_TABLE(NAME, ...)
 
 #endif
 
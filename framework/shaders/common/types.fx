@@ -17,14 +17,22 @@ struct CameraData
     FLOAT4 _[14]; // align by D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT (256)
 };
 
+// voxel grid is updated by bricks of VOXEL_BRICK_DIM^3 voxels, multiple of fill.hlsl thread group size
+#define VOXEL_BRICK_DIM 8
+
 struct VoxelGrid
 {
     int dimension;
     float size;
-    UINT mesh_node_count;
-    UINT tree_count;
+    UINT instance_count; // MESH_INSTANCES entries, filled by one dispatch
+    UINT brick_count; // bricks scheduled in current frame
+
+    UINT bricks_per_axis;
+    UINT _pad0; // no arrays here, hlsl aligns every cbuffer array element by 16 bytes
+    UINT _pad1;
+    UINT _pad2;
 
-    FLOAT4 _[15]; // align by D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT (256)
+    FLOAT4 _[14]; // align by D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT (256)
 };
 
 struct Voxel
@@ -43,6 +51,10 @@ struct Vertex
     FLOAT3 normal;
 };
 
+// traversal stack of fill.hlsl, one pending sibling per tree level
+// trees deeper than MESH_TREE_STACK_SIZE - 1 levels are not supported
+#define MESH_TREE_STACK_SIZE 32
+
 struct MeshTreeNode
 {
     FLOAT3 min;
@@ -51,6 +63,51 @@ struct MeshTreeNode
     int count;
 };
 
+// world space triangle in its own unit space (Woop): rows of inverse of [v1 - v0, v2 - v0, normal, v0]
+// ray is transformed by the rows, hit needs one division; stored in tree order, record i is indices 3i..3i+2
+struct TriangleRecord
+{
+    FLOAT4 row0; // u
+    FLOAT4 row1; // v
+    FLOAT4 row2; // distance to the plane in normal units
+};
+
+// stackless layout of the mesh tree: nodes in depth first order, empty subtrees dropped
+// next node is index + 1 when the box is hit, skip otherwise; node count - end of traversal
+struct ThreadedTreeNode
+{
+    FLOAT3 min;
+    int start_index;
+    FLOAT3 max;
+    int count;
+    UINT skip;
+    UINT _pad0;
+    UINT _pad1;
+    UINT _pad2;
+};
+
+// mesh of the voxelized scene inside concatenated MESH_TREE, INDICES, VERTICES and TRIANGLE_RECORDS
+// node start_index is relative to index_offset, indices are relative to vertex_offset
+// records follow indices, record of mesh index i is (index_offset + i) / 3
+struct MeshInstance
+{
+    UINT node_offset;
+    UINT node_count;
+    UINT index_offset;
+    UINT vertex_offset;
+    UINT transform_index; // MODEL_MATRICES
+    UINT _pad0;
+    UINT _pad1;
+    UINT _pad2;
+};
+
+// MODEL_MATRICES entry, normals go through the inverse transpose so that scaled models keep them perpendicular
+struct InstanceTransform
+{
+    MATRIX transform;
+    MATRIX inverse_transpose_transform;
+};
+
 // space 0
 DECLARE_CBV(CAMERA_DATA, 0, 0)
 {
@@ -65,8 +122,10 @@ DECLARE_CBV(MODEL_DATA, 1, 0)
 DECLARE_SRV(MESH_TREE, MeshTreeNode, 2, 0)
 DECLARE_SRV(INDICES, int, 3, 0)
 DECLARE_SRV(VERTICES, Vertex, 4, 0)
-DECLARE_SRV(MODEL_MATRICES, MATRIX, 5, 0)
+DECLARE_SRV(MODEL_MATRICES, InstanceTransform, 5, 0)
 DECLARE_SRV(BOX_TRANSFORM, MATRIX, 6, 0)
+DECLARE_SRV(TRIANGLE_RECORDS, TriangleRecord, 7, 0)
+DECLARE_SRV(MESH_INSTANCES, MeshInstance, 8, 0)
 
 // space 1
 DECLARE_CBV(VOXEL_DATA, 0, 1)
@@ -74,5 +133,67 @@ DECLARE_CBV(VOXEL_DATA, 0, 1)
     VoxelGrid voxelGrid;
 };
 DECLARE_UAV(VOXELS, float4, 1, 1)
+DECLARE_SRV(VOXEL_BRICKS, uint, 2, 1)
+
+// bindless voxel fill: buffers are registered once in the global table (see BindlessTable),
+// the dispatch passes their table indices as root constants
+#define BINDLESS_TABLE_CAPACITY 4096
+
+struct FillTableIndices
+{
+    UINT camera_data;
+    UINT voxel_data;
+    UINT voxels;
+    UINT voxel_bricks;
+    UINT mesh_instances;
+    UINT mesh_tree;
+    UINT indices;
+    UINT vertices;
+    UINT model_matrices;
+    UINT triangle_records;
+};
+
+// space 2
+DECLARE_CONSTANTS(FILL_INDICES, 0, 2)
+{
+    FillTableIndices fillIndices;
+};
+
+// space 3 and up, one space per array
+DECLARE_TABLE_CBV(CAMERA_DATA_TABLE, CameraData, 3)
+DECLARE_TABLE_CBV(VOXEL_DATA_TABLE, VoxelGrid, 4)
+DECLARE_TABLE_UAV(VOXELS_TABLE, float4, 5)
+DECLARE_TABLE_SRV(VOXEL_BRICKS_TABLE, uint, 6)
+DECLARE_TABLE_SRV(MESH_INSTANCES_TABLE, MeshInstance, 7)
+DECLARE_TABLE_SRV(MESH_TREE_TABLE, MeshTreeNode, 8)
+DECLARE_TABLE_SRV(INDICES_TABLE, int, 9)
+DECLARE_TABLE_SRV(VERTICES_TABLE, Vertex, 10)
+DECLARE_TABLE_SRV(MODEL_MATRICES_TABLE, InstanceTransform, 11)
+DECLARE_TABLE_SRV(TRIANGLE_RECORDS_TABLE, TriangleRecord, 12)
+DECLARE_TABLE(FILL_TABLE,
+    CAMERA_DATA_TABLE_BIND,
+    VOXEL_DATA_TABLE_BIND,
+    VOXELS_TABLE_BIND,
+    VOXEL_BRICKS_TABLE_BIND,
+    MESH_INSTANCES_TABLE_BIND,
+    MESH_TREE_TABLE_BIND,
+    INDICES_TABLE_BIND,
+    VERTICES_TABLE_BIND,
+    MODEL_MATRICES_TABLE_BIND,
+    TRIANGLE_RECORDS_TABLE_BIND)
+
+#if defined(BINDLESS) && !defined(__cplusplus)
+// shader code stays the same, names of the bound resources go to the table entries
+#define cameraData CAMERA_DATA_TABLE[fillIndices.camera_data]
+#define voxelGrid VOXEL_DATA_TABLE[fillIndices.voxel_data]
+#define VOXELS VOXELS_TABLE[fillIndices.voxels]
+#define VOXEL_BRICKS VOXEL_BRICKS_TABLE[fillIndices.voxel_bricks]
+#define MESH_INSTANCES MESH_INSTANCES_TABLE[fillIndices.mesh_instances]
+#define MESH_TREE MESH_TREE_TABLE[fillIndices.mesh_tree]
+#define INDICES INDICES_TABLE[fillIndices.indices]
+#define VERTICES VERTICES_TABLE[fillIndices.vertices]
+#define MODEL_MATRICES MODEL_MATRICES_TABLE[fillIndices.model_matrices]
+#define TRIANGLE_RECORDS TRIANGLE_RECORDS_TABLE[fillIndices.triangle_records]
+#endif
 
 #endif // __TYPES_FX__
@@ -97,6 +97,9 @@ void Input::process_win_input()
             Game::inst()->set_animating(false);
             Game::inst()->set_destroy();
         }
+        if (keyboard_event.key_code == VK_F9 && keyboard_event.state.pressed) {
+            Game::inst()->export_frame_timings();
+        }
 
 #define HANDLE_INPUT_EVENT(key, code)                                       \
     do {                                                                    \
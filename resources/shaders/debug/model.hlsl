@@ -1,10 +1,13 @@
+// 0 - normals
+// 1 - albedo texture, needs t0 and s0 bound
+// option: ALBEDO 0 1
+#define CAMERA_REGISTER b0
 #include "../../../framework/shaders/common/types.fx"
 
 struct VS_IN
 {
     float3 position : POSITION0;
-    float texcoord_u : TEXCOORD_U0;
-    float texcoord_v : TEXCOORD_V0;
+    float2 texcoord : TEXCOORD0;
     float3 normal : NORMAL0;
 };
 
@@ -21,8 +24,10 @@ struct PS_OUT
     float4 color : SV_Target0;
 };
 
+#if ALBEDO
 Texture2D<float4> albedo_tex : register(t0);
 SamplerState tex_sampler : register(s0);
+#endif
 
 PS_IN VSMain(VS_IN input)
 {
@@ -31,7 +36,7 @@ PS_IN VSMain(VS_IN input)
     res.world_model_pos = mul(transform, float4(input.position, 1.f));
     res.pos = mul(cameraData.vp, float4(res.world_model_pos.xyz, 1.f));
     res.normal = mul(inverse_transpose_transform, float4(input.normal, 0.f));
-    res.uv = float2(input.texcoord_u, input.texcoord_v);
+    res.uv = input.texcoord;
 
     return res;
 }
@@ -41,6 +46,7 @@ PS_OUT PSMain(PS_IN input)
 {
     PS_OUT res = (PS_OUT)0;
 
+#if ALBEDO
     float4 albedo_color;
     albedo_color = albedo_tex.Sample(tex_sampler, input.uv);
     res.color = pow(abs(albedo_color), 2.2f);
@@ -48,6 +54,9 @@ PS_OUT PSMain(PS_IN input)
     if (res.color.x == 0 && res.color.y == 0 && res.color.z == 0 && res.color.w == 0) {
         res.color = (0.2).xxxx;
     }
+#else
+    res.color = input.normal * 0.2;
+#endif
 
     return res;
 }
@@ -1,3 +1,6 @@
+// 0 - boxes
+// 1 - lines
+// option: DRAW_LINES 1 0
 #define CAMERA_REGISTER b0
 #define voxelGrid_REGISTER b1
 #include "voxel.fx"
@@ -63,9 +66,6 @@ PS_VS VSMain(VS_IN input)
     return res;
 }
 
-// 0 - boxes
-// 1 - lines
-#define DRAW_LINES 1
 #if DRAW_LINES
 [maxvertexcount(18)]
 void GSMain(point PS_VS input[1], inout LineStream<PS_VS> OutputStream)
@@ -25,188 +25,197 @@ Voxel unpack_voxel(float4 data)
     return result;
 }
 
-uint get_heap_parent_index(uint index)
-{
-    return (max(index, 1u) - 1u) / 2u;
-}
+#define FLT_MAX 3.402823466e+38f
 
-bool inBoxBounds(MeshTreeNode mesh_node, float3 position)
+// slab test, t_entry is 0 if ray starts inside
+// node bounds are world space, refit on CPU when model moves (see refit_mesh_tree)
+bool box_intersection(Ray ray, float3 inv_direction, MeshTreeNode mesh_node, float t_max, out float t_entry)
 {
-    float3 diag = mesh_node.max - mesh_node.min;
-    float length = sqrt(dot(diag, diag));
-    bool inside = true;
+    float3 t0 = (mesh_node.min - ray.origin) * inv_direction;
+    float3 t1 = (mesh_node.max - ray.origin) * inv_direction;
+    float3 t_min = min(t0, t1);
+    float3 t_max3 = max(t0, t1);
+
+    // ray parallel to an axis is inside its slab along all of its length if the origin is, faces included,
+    // see slab_intersection in intersection.h; epsilon of inv_direction would clip it at 0 on the max face
     [unroll]
-    for(int i = 0; i < 3; i++) {
-        inside = inside && (position[i] > mesh_node.min[i] - length * 2);
-        inside = inside && (position[i] < mesh_node.max[i] + length * 2);
+    for (uint i = 0; i < 3; ++i) {
+        if (ray.direction[i] == 0) {
+            bool inside = ray.origin[i] >= mesh_node.min[i] && ray.origin[i] <= mesh_node.max[i];
+            t_min[i] = inside ? -FLT_MAX : FLT_MAX;
+            t_max3[i] = FLT_MAX;
+        }
     }
 
-    return inside;
+    t_entry = max(max(t_min.x, t_min.y), max(t_min.z, 0));
+    float t_exit = min(min(t_max3.x, t_max3.y), min(t_max3.z, t_max));
+    return t_entry <= t_exit;
 }
 
-float boxIntersection(in Ray ray[3], MeshTreeNode mesh_node)
+// ray in triangle unit space, see TriangleRecord; returns distance along the ray, 0 - no hit
+// u and v are barycentrics of second and third vertices
+float triangle_record_intersection(Ray ray, TriangleRecord record, out float u, out float v)
 {
-    float3 _min = mul(MODEL_MATRICES[0], float4(mesh_node.min, 1.f)).xyz;
-    float3 _max = mul(MODEL_MATRICES[0], float4(mesh_node.max, 1.f)).xyz;
-
-    float epsilon = 0.000001f;
-    [unroll]
-    for (int ray_index = 0; ray_index < 3; ++ray_index) {
-        if (ray[ray_index].direction.x == 0) {
-            ray[ray_index].direction.x = epsilon;
-        }
-        if (ray[ray_index].direction.y == 0) {
-            ray[ray_index].direction.y = epsilon;
-        }
-        if (ray[ray_index].direction.z == 0) {
-            ray[ray_index].direction.z = epsilon;
-        }
-
-        float coeffs[6];
-        coeffs[0] = (_min.x - ray[ray_index].origin.x) / (ray[ray_index].direction.x);
-        coeffs[1] = (_min.y - ray[ray_index].origin.y) / (ray[ray_index].direction.y);
-        coeffs[2] = (_min.z - ray[ray_index].origin.z) / (ray[ray_index].direction.z);
-        coeffs[3] = (_max.x - ray[ray_index].origin.x) / (ray[ray_index].direction.x);
-        coeffs[4] = (_max.y - ray[ray_index].origin.y) / (ray[ray_index].direction.y);
-        coeffs[5] = (_max.z - ray[ray_index].origin.z) / (ray[ray_index].direction.z);
+    u = 0;
+    v = 0;
 
-        float t = 0;
-        [unroll]
-        for (int i = 0; i < 6; ++i) {
-            if (coeffs[i] > 0 && inBoxBounds(mesh_node, ray[ray_index].origin + ray[ray_index].direction * coeffs[i])) {
-                if (t == 0 || coeffs[i] < t) {
-                    t = coeffs[i];
-                }
-            }
-        }
-
-        if (t > 0) {
-            return t;
-        }
+    float direction_z = dot(record.row2.xyz, ray.direction);
+    if (direction_z == 0) {
+        return 0;
+    }
+    float t = -(dot(record.row2.xyz, ray.origin) + record.row2.w) / direction_z;
+    if (t < 0) {
+        return 0;
     }
 
-    return 0;
+    float3 p = ray.origin + ray.direction * t;
+    u = dot(record.row0.xyz, p) + record.row0.w;
+    if (u < 0 || u > 1) {
+        return 0;
+    }
+    v = dot(record.row1.xyz, p) + record.row1.w;
+    if (v < 0 || u + v > 1) {
+        return 0;
+    }
+    return t;
 }
 
-float triangleIntersection(in Ray ray[3], float3 v0, float3 v1, float3 v2, float3 normal1, float3 normal2, float3 normal3, inout float3 o_normal)
+struct TreeHit
 {
-    float3 normal = normalize(cross(normalize(v1 - v0), normalize(v2 - v0)));
-
-    float3 edge1 = v1 - v0;
-    float3 edge2 = v2 - v0;
-    float3 _u1 = (edge1 * (dot(edge2, edge2)) - edge2 * (dot(edge1, edge2))) / ((dot(edge1, edge1)) * (dot(edge2, edge2)) - (dot(edge1, edge2)) * (dot(edge1, edge2)));
-    float3 _v1 = (edge2 * (dot(edge1, edge1)) - edge1 * (dot(edge1, edge2))) / ((dot(edge1, edge1)) * (dot(edge2, edge2)) - (dot(edge1, edge2)) * (dot(edge1, edge2)));
-    float u = dot(v0, _u1);
-    float v = dot(v0, _v1);
+    float t; // 0 - no hit
+    uint index; // first index of the triangle in INDICES
+    float u;
+    float v;
+    uint mesh; // MESH_INSTANCES entry
+};
+
+// closest hit in (0, t_max), nearest child first, see traverse_mesh_tree in tree_traversal.cpp
+// nodes and records of the instance are addressed through its offsets, see MeshInstance
+TreeHit traverse_mesh_tree(Ray ray, float t_max, MeshInstance mesh)
+{
+    TreeHit hit = (TreeHit)0;
+    float epsilon = 0.000001f;
+    float3 inv_direction = 1.f / (ray.direction + (ray.direction == 0) * epsilon);
+    float t_limit = t_max;
+
+    uint stack[MESH_TREE_STACK_SIZE];
+    float stack_entry[MESH_TREE_STACK_SIZE];
+    uint stack_size = 0;
+
+    float entry;
+    if (mesh.node_count > 0 && box_intersection(ray, inv_direction, MESH_TREE[mesh.node_offset], t_limit, entry)) {
+        stack[0] = 0;
+        stack_entry[0] = entry;
+        stack_size = 1;
+    }
 
-    [unroll]
-    for (int i = 0; i < 3; ++i) {
-        float dn = dot(ray[i].direction, normal);
-        if (dn == 0) {
-            return 0;
+    while (stack_size > 0) {
+        --stack_size;
+        uint index = stack[stack_size];
+        if (stack_entry[stack_size] > t_limit) {
+            continue;
         }
 
-        float t = -(dot(ray[i].origin, normal) - dot(v0, normal)) / (dn);
-        if (t < 0) {
-            return 0;
+        MeshTreeNode node = MESH_TREE[mesh.node_offset + index];
+        for (uint i = mesh.index_offset + node.start_index; i < mesh.index_offset + node.start_index + node.count; i += 3) {
+            float u;
+            float v;
+            float t = triangle_record_intersection(ray, TRIANGLE_RECORDS[i / 3], u, v);
+            if (t > 0 && t < t_limit) {
+                hit.t = t;
+                hit.index = i;
+                hit.u = u;
+                hit.v = v;
+                t_limit = t;
+            }
         }
 
-        float3 p = ray[i].origin + ray[i].direction * t;
-
-        float _u = dot(p, _u1) - u;
-        if (_u < 0 || _u > 1) {
-            return 0;
+        uint children[2] = { 2 * index + 1, 2 * index + 2 };
+        float children_entry[2] = { 0, 0 };
+        bool children_hit[2] = { false, false };
+        [unroll]
+        for (uint j = 0; j < 2; ++j) {
+            if (children[j] < mesh.node_count) {
+                children_hit[j] = box_intersection(ray, inv_direction, MESH_TREE[mesh.node_offset + children[j]], t_limit, children_entry[j]);
+            }
         }
 
-        float _v = dot(p, _v1) - v;
-        if (_v < 0 || _v > 1) {
-            return 0;
+        // far child goes first, so near child is popped next
+        uint near_child = (children_hit[0] && children_hit[1] && children_entry[1] < children_entry[0]) ? 1 : 0;
+        uint far_child = 1 - near_child;
+        if (children_hit[far_child]) {
+            stack[stack_size] = children[far_child];
+            stack_entry[stack_size] = children_entry[far_child];
+            ++stack_size;
         }
-
-        if (_u + _v > 1) {
-            return 0;
+        if (children_hit[near_child]) {
+            stack[stack_size] = children[near_child];
+            stack_entry[stack_size] = children_entry[near_child];
+            ++stack_size;
         }
+    }
+    return hit;
+}
 
-        float _w = (1 - _v - _u);
+#define GROUP_DIM 4
+#define GROUPS_PER_BRICK_AXIS (VOXEL_BRICK_DIM / GROUP_DIM)
+#define GROUPS_PER_BRICK (GROUPS_PER_BRICK_AXIS * GROUPS_PER_BRICK_AXIS * GROUPS_PER_BRICK_AXIS)
 
-        o_normal = normal1 * _w + normal2 * _u + normal3 * _v;
-        return t;
+// voxels are updated only inside bricks scheduled on CPU (see VoxelUpdateScheduler)
+// dispatch is (GROUPS_PER_BRICK, min(brick_count, 65535), brick_count / 65535 + 1)
+#define MAX_GROUPS_PER_DIMENSION 65535 // D3D12_CS_DISPATCH_MAX_THREAD_GROUPS_PER_DIMENSION
+bool scheduled_voxel(uint3 group_id, uint3 group_thread_id, out uint3 voxel_location)
+{
+    voxel_location = (0).xxx;
+    uint brick_slot = group_id.y + group_id.z * MAX_GROUPS_PER_DIMENSION;
+    if (brick_slot >= voxelGrid.brick_count) {
+        return false;
     }
-    return 0;
+
+    uint brick = VOXEL_BRICKS[brick_slot];
+    uint3 brick_coord = uint3(brick % voxelGrid.bricks_per_axis,
+                              (brick / voxelGrid.bricks_per_axis) % voxelGrid.bricks_per_axis,
+                              brick / (voxelGrid.bricks_per_axis * voxelGrid.bricks_per_axis));
+    uint3 group_coord = uint3(group_id.x % GROUPS_PER_BRICK_AXIS,
+                              (group_id.x / GROUPS_PER_BRICK_AXIS) % GROUPS_PER_BRICK_AXIS,
+                              group_id.x / (GROUPS_PER_BRICK_AXIS * GROUPS_PER_BRICK_AXIS));
+
+    voxel_location = brick_coord * VOXEL_BRICK_DIM + group_coord * GROUP_DIM + group_thread_id;
+    return all(voxel_location < (uint)voxelGrid.dimension);
 }
 
-#define BITS_COUNT 32
-#define ARRAY_SIZE 64
-[numthreads(4, 4, 4)]
-void CSMain(uint3 dispatchThreadID : SV_DispatchThreadID)
+[numthreads(GROUP_DIM, GROUP_DIM, GROUP_DIM)]
+void CSMain(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID)
 {
-    Voxel currentVoxel = unpack_voxel(VOXELS[uint3(dispatchThreadID.x, dispatchThreadID.y, dispatchThreadID.z)]);
-    int skiped = int(currentVoxel.sharpness);
-    if (skiped > 0) {
-        currentVoxel.sharpness = float(skiped - 1);
-        VOXELS[uint3(dispatchThreadID.x, dispatchThreadID.y, dispatchThreadID.z)] = pack_voxel(currentVoxel);
+    uint3 dispatchThreadID;
+    if (!scheduled_voxel(groupID, groupThreadID, dispatchThreadID)) {
         return;
     }
-    uint hit_buffer[ARRAY_SIZE] = (uint[ARRAY_SIZE])0; // [optimization] 32-bit buffer to store box hits
 
-    float t = 0;
-    float3 normal = (0).xxx;
-    float box_t = 0;
+    // hits are clipped to the voxel extent
+    float unit = voxelGrid.size / voxelGrid.dimension;
     Ray rays[3] = { GenerateRayForward(dispatchThreadID), GenerateRayRight(dispatchThreadID), GenerateRayUp(dispatchThreadID) };
-    for (uint i = 0; i < voxelGrid.mesh_node_count; ++i) {
-        uint parent_index = (max(i, 1u) - 1u) / 2u;
-        while (parent_index / BITS_COUNT > ARRAY_SIZE) {
-            parent_index = (max(parent_index, 1u) - 1u) / 2u;
-        }
-        uint parent_hit_bit = (1U << (parent_index - (parent_index / BITS_COUNT) * BITS_COUNT));
-        bool need_check = (i == 0) || (hit_buffer[parent_index / BITS_COUNT] & parent_hit_bit);
-
-        bool box_intersected = false;
-        float box_distance = 0;
-        float tri_t = 0;
-        float3 tri_normal = (0).xxx;
-        { // check box intersection
-            box_intersected = false;
-            if (!need_check) {
-                continue;
-            }
-            float box_distance = boxIntersection(rays, MESH_TREE[i]);
-            if (box_distance <= 0) { // || box_distance > voxelGrid.size / voxelGrid.dimension) {
-                if (i == 0) {
-                    break;
-                }
-                continue;
-            }
-            box_t = box_distance;
-        }
-        {
-            for (int j = MESH_TREE[i].start_index; j < MESH_TREE[i].start_index + MESH_TREE[i].count; j += 3) {
-                float3 _tri_normal = (0).xxx;
-                float _tri_t = triangleIntersection(rays, mul(MODEL_MATRICES[0], float4(VERTICES[INDICES[j + 0]].position, 1.f)).xyz,
-                                                            mul(MODEL_MATRICES[0], float4(VERTICES[INDICES[j + 1]].position, 1.f)).xyz,
-                                                            mul(MODEL_MATRICES[0], float4(VERTICES[INDICES[j + 2]].position, 1.f)).xyz,
-                                                            VERTICES[INDICES[j + 0]].normal,
-                                                            VERTICES[INDICES[j + 1]].normal,
-                                                            VERTICES[INDICES[j + 2]].normal,
-                                                            _tri_normal);
-                if (_tri_t > 0 && (_tri_t < t || t == 0) && (_tri_t < voxelGrid.size / voxelGrid.dimension)) {
-                    t = _tri_t;
-                    normal = _tri_normal;
-                }
+    TreeHit closest = (TreeHit)0;
+    for (uint mesh = 0; mesh < voxelGrid.instance_count; ++mesh) {
+        [unroll]
+        for (int i = 0; i < 3; ++i) {
+            TreeHit hit = traverse_mesh_tree(rays[i], closest.t > 0 ? closest.t : unit, MESH_INSTANCES[mesh]);
+            if (hit.t > 0) {
+                closest = hit;
+                closest.mesh = mesh;
             }
         }
+    }
 
-        uint hit_index = i / BITS_COUNT;
-        if (hit_index < ARRAY_SIZE) {
-            hit_buffer[hit_index] |= (1U << (i - hit_index * BITS_COUNT));
-        }
-
-        if (tri_t > 0 && (tri_t < t || t == 0)) {
-            box_t = box_distance;
-            t = tri_t;
-            normal = tri_normal;
-            break;
-        }
+    float t = closest.t;
+    float3 normal = (0).xxx;
+    if (t > 0) {
+        MeshInstance hit_mesh = MESH_INSTANCES[closest.mesh];
+        normal = VERTICES[hit_mesh.vertex_offset + INDICES[closest.index + 0]].normal * (1 - closest.u - closest.v) +
+                 VERTICES[hit_mesh.vertex_offset + INDICES[closest.index + 1]].normal * closest.u +
+                 VERTICES[hit_mesh.vertex_offset + INDICES[closest.index + 2]].normal * closest.v;
+        // vertex buffer stays in model space, only the picked normal is transformed
+        normal = normalize(mul(MODEL_MATRICES[hit_mesh.transform_index].inverse_transpose_transform, float4(normal, 0.f)).xyz);
     }
 
     Voxel voxel = (Voxel)0;
@@ -220,10 +229,6 @@ void CSMain(uint3 dispatchThreadID : SV_DispatchThreadID)
         voxel.normal = normal;
         voxel.metalness = t;
         voxel.sharpness = 0;
-    } else {
-        // between 10 and 30
-        uint frames_to_skip = ((dispatchThreadID.x * 900 + dispatchThreadID.y * 140 + dispatchThreadID.z * 4895) % 200) + 100;
-        voxel.sharpness = float(frames_to_skip);
     }
     VOXELS[uint3(dispatchThreadID.x, dispatchThreadID.y, dispatchThreadID.z)] = pack_voxel(voxel);
 }
\ No newline at end of file
@@ -0,0 +1,3 @@
+// fill.hlsl reading all resources through the bindless table, indices come from FILL_INDICES root constants
+#define BINDLESS
+#include "fill.hlsl"
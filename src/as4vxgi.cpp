@@ -1,16 +1,27 @@
 #include "render/common.h"
 
 #include "core/game.h"
+#include "core/profiler.h"
 #include "render/render.h"
 #include "render/camera.h"
+#include "render/resource/geometry_arena.h"
+#include "render/resource/staging_uploader.h"
+#include "render/resource/residency.h"
+#include "render/resource/pipeline_cache.h"
+#include "render/resource/shader_cache.h"
 
 #include "as4vxgi.h"
+#include "bench/voxelizer_benchmark.h"
+#include "bench/kernel_benchmark.h"
+#include "bench/bind_benchmark.h"
 
 #include <imgui/imgui.h>
 
 int32_t voxel_grid_dim = 300;
 float voxel_grid_size = 1000;
 
+constexpr UINT voxel_fill_groups_per_brick = (VOXEL_BRICK_DIM / 4) * (VOXEL_BRICK_DIM / 4) * (VOXEL_BRICK_DIM / 4);
+
 inline int align(int value, int alignment)
 {
     return (value + (alignment - 1)) & ~(alignment - 1);
@@ -44,14 +55,13 @@ void AS4VXGI_Component::initialize()
         // voxels fill pass
         {
             voxels_fill_.attach_compute_shader(L"./resources/shaders/voxels/fill.hlsl", {});
-            voxels_fill_.declare_bind<CAMERA_DATA_BIND>();
-            voxels_fill_.declare_bind<MESH_TREE_BIND>();
-            voxels_fill_.declare_bind<INDICES_BIND>();
-            voxels_fill_.declare_bind<VERTICES_BIND>();
-            voxels_fill_.declare_bind<MODEL_MATRICES_BIND>();
-            voxels_fill_.declare_bind<VOXEL_DATA_BIND>();
-            voxels_fill_.declare_bind<VOXELS_BIND>();
             voxels_fill_.create_pso_and_root_signature();
+
+            // root signature of the bindless fill can't be created below resource binding tier 3
+            if (Game::inst()->render().bindless_supported()) {
+                voxels_fill_bindless_.attach_compute_shader(L"./resources/shaders/voxels/fill_bindless.hlsl", {});
+                voxels_fill_bindless_.create_pso_and_root_signature();
+            }
         }
         // voxels vizualize pass
         {
@@ -63,13 +73,9 @@ void AS4VXGI_Component::initialize()
             };
             stage_visualize_pipeline_.setup_input_layout(inputs, _countof(inputs));
             stage_visualize_pipeline_.attach_vertex_shader(L"./resources/shaders/voxels/draw.hlsl", {});
-            stage_visualize_pipeline_.attach_geometry_shader(L"./resources/shaders/voxels/draw.hlsl", {});
+            stage_visualize_pipeline_.attach_geometry_shader(L"./resources/shaders/voxels/draw.hlsl", { L"DRAW_LINES=1" });
             stage_visualize_pipeline_.attach_pixel_shader(L"./resources/shaders/voxels/draw.hlsl", {});
 
-            stage_visualize_pipeline_.declare_bind<CAMERA_DATA_BIND>();
-            stage_visualize_pipeline_.declare_bind<VOXELS_BIND>();
-            stage_visualize_pipeline_.declare_bind<VOXEL_DATA_BIND>();
-
             CD3DX12_DEPTH_STENCIL_DESC ds_state(D3D12_DEFAULT);
             stage_visualize_pipeline_.setup_depth_stencil_state(ds_state);
 
@@ -99,112 +105,212 @@ void AS4VXGI_Component::initialize()
             uav_desc.Texture3D.MipSlice = 0;
             uav_desc.Texture3D.WSize = -1;
 
-            uav_voxels_resource_index_ = Game::inst()->render().allocate_gpu_resource_descriptor(uav_voxels_, uav_voxels_gpu_);
+            uav_voxels_range_ = Game::inst()->render().allocate_gpu_resource_descriptor(uav_voxels_, uav_voxels_gpu_);
             device->CreateUnorderedAccessView(uav_voxels_resource_.Get(), nullptr, &uav_desc, uav_voxels_);
 
-            uav_voxels_resource_index_cpu_ = Game::inst()->render().allocate_cpu_resource_descriptor(uav_voxels_cpu_);
+            uav_voxels_range_cpu_ = Game::inst()->render().allocate_cpu_resource_descriptor(uav_voxels_cpu_);
             device->CreateUnorderedAccessView(uav_voxels_resource_.Get(), nullptr, &uav_desc, uav_voxels_cpu_);
+
+            // textures have no GPU address, the view is keyed by its persistent descriptor which lives as long as it
+            D3D12_CPU_DESCRIPTOR_HANDLE bindless_handle;
+            bool created = false;
+            uav_voxels_bindless_ = Game::inst()->render().register_bindless(
+                uav_voxels_gpu_.ptr, BindlessKind::rw_texture, bindless_handle, created);
+            if (created) {
+                device->CreateUnorderedAccessView(uav_voxels_resource_.Get(), nullptr, &uav_desc, bindless_handle);
+            }
         }
 
-        ComPtr<ID3D12GraphicsCommandList> barrier;
-        device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, Game::inst()->render().graphics_command_allocator().Get(), nullptr, IID_PPV_ARGS(&barrier));
-        barrier->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(uav_voxels_resource_.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
-        barrier->Close();
-        Game::inst()->render().graphics_queue()->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList**>(barrier.GetAddressOf()));
+        // moved to UAV state by the graph before the first pass that uses it
+        voxels_graph_resource_ = Game::inst()->render().import_graph_resource("voxels", uav_voxels_resource_.Get(), GraphState::common);
     }
 
-    // fill voxels
-    for (int32_t i = 0; i < model_trees_.size(); ++i) {
-        ModelTree* model_tree = model_trees_[i];
-        Matrix transform = model_tree->get_transform();
-
-        index_buffers_srv_.push_back({});
-        for (D3D12_GPU_DESCRIPTOR_HANDLE srv : model_tree->get_index_buffers_srv()) {
-            index_buffers_srv_[i].push_back(srv);
-        }
-        vertex_buffers_srv_.push_back({});
-        for (D3D12_GPU_DESCRIPTOR_HANDLE srv : model_tree->get_vertex_buffers_srv()) {
-            vertex_buffers_srv_[i].push_back(srv);
-        }
-        mesh_trees_srv_.push_back({});
-        model_matrix_srv_.push_back({});
-        for (std::vector<MeshTreeNode> mesh_tree : model_tree->get_meshes_trees()) {
-            mesh_trees_srv_[i].push_back(new ShaderResource<MeshTreeNode>());
-            mesh_trees_srv_[i].back()->initialize(mesh_tree.data(), UINT(mesh_tree.size()));
+    // voxel updates scheduling
+    {
+        VoxelUpdateScheduler::Settings settings;
+        settings.brick_dim = VOXEL_BRICK_DIM;
+        settings.voxel_budget = 64 * 1024;
+        voxel_frame_.initialize(&instance_table_, voxel_grid_size, voxel_grid_dim, settings);
+    }
 
-            model_matrix_srv_[i].push_back({});
-            model_matrix_srv_[i].back() = new ShaderResource<Matrix>();
-            model_matrix_srv_[i].back()->initialize(&transform, 1);
+    // fill voxels
+    for (ModelTree* model_tree : model_trees_) {
+        voxel_frame_.add_model(model_tree->get_transform());
+
+        const std::vector<std::vector<uint32_t>> indices = model_tree->get_meshes_indices();
+        const std::vector<std::vector<Vertex>> vertices = model_tree->get_meshes_vertices();
+        const std::vector<std::vector<MeshTreeNode>> mesh_trees = model_tree->get_meshes_world_trees();
+        const std::vector<std::vector<TriangleRecord>> records = model_tree->get_meshes_triangle_records();
+        for (int32_t j = 0; j < mesh_trees.size(); ++j) {
+            voxel_frame_.add_mesh(indices[j], vertices[j], mesh_trees[j], records[j]);
         }
+        uploaded_world_versions_.push_back(model_tree->get_world_version());
+    }
+    {
+        // model space, never change
+        std::vector<uint32_t> indices = instance_table_.indices();
+        std::vector<Vertex> vertices = instance_table_.vertices();
+        indices_srv_.initialize(indices.data(), std::max<UINT>(UINT(indices.size()), 1), "Fill indices");
+        vertices_srv_.initialize(vertices.data(), std::max<UINT>(UINT(vertices.size()), 1), "Fill vertices");
+
+        // transform doesn't change tree and record counts, buffers are sized once
+        instances_srv_.initialize(std::max<UINT>(UINT(instance_table_.instances().size()), 1), "Mesh instances");
+        mesh_trees_srv_.initialize(std::max<UINT>(UINT(instance_table_.nodes().size()), 1), "World mesh trees");
+        triangle_records_srv_.initialize(std::max<UINT>(UINT(instance_table_.records().size()), 1), "World triangle records");
+        model_matrix_srv_.initialize(std::max<UINT>(UINT(instance_table_.transforms().size()), 1), "Model matrices");
+        upload_world_geometry();
+
+        indices_srv_.register_bindless();
+        vertices_srv_.register_bindless();
+        instances_srv_.register_bindless();
+        mesh_trees_srv_.register_bindless();
+        triangle_records_srv_.register_bindless();
+        model_matrix_srv_.register_bindless();
+
+        // end of loading, all static geometry goes in one batch
+        Game::inst()->render().uploader()->flush();
     }
+    scheduled_bricks_srv_.initialize(voxel_frame_.scheduler().brick_count(), "Scheduled bricks");
+    scheduled_bricks_srv_.register_bindless();
+    // fill pass cost for the time budget of the scheduler
+    {
+        D3D12_QUERY_HEAP_DESC desc = {};
+        desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        desc.Count = 2 * FrameRing::max_frames_in_flight;
+        HRESULT_CHECK(device->CreateQueryHeap(&desc, IID_PPV_ARGS(fill_timestamps_.GetAddressOf())));
+        HRESULT_CHECK(device->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+            D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(desc.Count * sizeof(UINT64)),
+            D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(fill_timestamps_readback_.GetAddressOf())));
+        fill_timestamps_readback_->SetName(L"Fill timestamps readback");
+        HRESULT_CHECK(Game::inst()->render().graphics_queue()->GetTimestampFrequency(&timestamp_frequency_));
+    }
+
     voxel_data_.voxelGrid.dimension = voxel_grid_dim;
     voxel_data_.voxelGrid.size = voxel_grid_size;
-    voxel_data_.voxelGrid.mesh_node_count = 0;
+    voxel_data_.voxelGrid.instance_count = UINT(instance_table_.instances().size());
+    voxel_data_.voxelGrid.brick_count = 0;
+    voxel_data_.voxelGrid.bricks_per_axis = voxel_frame_.scheduler().bricks_per_axis();
 
     // create const buffer view
     {
-        voxel_data_cb_.initialize();
+        voxel_data_cb_.initialize("Voxel data");
+        voxel_data_cb_.register_bindless();
         voxel_data_cb_.update(voxel_data_);
     }
 }
 
 void AS4VXGI_Component::draw()
 {
-    auto device = Game::inst()->render().device();
-    auto graphics_command_list_allocator = Game::inst()->render().graphics_command_allocator();
     auto resource_descriptor_heap = Game::inst()->render().resource_descriptor_heap();
     const auto render_target = Game::inst()->render().render_target();
     const auto depth_stencil_target = Game::inst()->render().depth_stencil();
-    auto graphics_queue = Game::inst()->render().graphics_queue();
+    Render& render = Game::inst()->render();
+    RenderGraph* graph = render.graph();
+
+    // lazily synced handles are resolved here, tasks run on recorder workers
+    const D3D12_GPU_DESCRIPTOR_HANDLE camera_handle = render.camera()->gpu_descriptor_handle();
+    // voxel data of this frame goes to the constant ring, the buffer version is kept for the bindless table
+    D3D12_GPU_DESCRIPTOR_HANDLE voxel_data_handle;
+    if (!render.push_constant_buffer(&voxel_data_, sizeof(voxel_data_), voxel_data_handle)) {
+        voxel_data_handle = voxel_data_cb_.gpu_descriptor_handle();
+    }
+    const D3D12_GPU_DESCRIPTOR_HANDLE bricks_handle = scheduled_bricks_srv_.gpu_descriptor_handle();
+    const D3D12_GPU_DESCRIPTOR_HANDLE instances_handle = instances_srv_.gpu_descriptor_handle();
+    const D3D12_GPU_DESCRIPTOR_HANDLE mesh_trees_handle = mesh_trees_srv_.gpu_descriptor_handle();
+    const D3D12_GPU_DESCRIPTOR_HANDLE indices_handle = indices_srv_.gpu_descriptor_handle();
+    const D3D12_GPU_DESCRIPTOR_HANDLE vertices_handle = vertices_srv_.gpu_descriptor_handle();
+    const D3D12_GPU_DESCRIPTOR_HANDLE model_matrices_handle = model_matrix_srv_.gpu_descriptor_handle();
+    const D3D12_GPU_DESCRIPTOR_HANDLE triangle_records_handle = triangle_records_srv_.gpu_descriptor_handle();
+    const UINT brick_count = scheduled_bricks_srv_.size();
+    const bool fill = brick_count > 0 && voxel_data_.voxelGrid.instance_count > 0;
+    const UINT slot = render.frame_slot();
+    ID3D12QueryHeap* timestamps = fill_timestamps_.Get();
+    ID3D12Resource* timestamps_readback = fill_timestamps_readback_.Get();
+    fill_voxels_[slot] = fill ? voxel_frame_.scheduler().scheduled_voxel_count() : 0;
+
+    // bindless fill passes table indices of the same versions instead of their tables
+    const bool bindless = bindless_fill_ && render.bindless_supported();
+    const D3D12_GPU_DESCRIPTOR_HANDLE bindless_table = render.bindless_table();
+    FillTableIndices fill_indices{};
+    if (bindless) {
+        fill_indices.camera_data = render.camera()->bindless_index();
+        fill_indices.voxel_data = voxel_data_cb_.bindless_index();
+        fill_indices.voxels = uav_voxels_bindless_.index;
+        fill_indices.voxel_bricks = scheduled_bricks_srv_.bindless_index();
+        fill_indices.mesh_instances = instances_srv_.bindless_index();
+        fill_indices.mesh_tree = mesh_trees_srv_.bindless_index();
+        fill_indices.indices = indices_srv_.bindless_index();
+        fill_indices.vertices = vertices_srv_.bindless_index();
+        fill_indices.model_matrices = model_matrix_srv_.bindless_index();
+        fill_indices.triangle_records = triangle_records_srv_.bindless_index();
+    }
 
-    {
-        ComPtr<ID3D12GraphicsCommandList> cmd;
-        HRESULT_CHECK(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, graphics_command_list_allocator.Get(), nullptr, IID_PPV_ARGS(cmd.ReleaseAndGetAddressOf())));
-        cmd->SetName(L"Voxels command list");
-        HRESULT_CHECK(cmd->Close());
-        HRESULT_CHECK(cmd->Reset(graphics_command_list_allocator.Get(), nullptr));
+    const GraphPass fill_pass = graph->add_pass("Voxels fill");
+    graph->write(fill_pass, voxels_graph_resource_, GraphState::unordered_access);
+    render.record_pass(fill_pass, [=](ID3D12GraphicsCommandList* cmd) {
         {
-            // PIXBeginEvent(cmd.Get(), PIX_COLOR(0xFF, 0x0, 0x0), "Voxels clear");
+            // PIXBeginEvent(cmd, PIX_COLOR(0xFF, 0x0, 0x0), "Voxels clear");
             // {
             //     FLOAT clear[4] = {0, 0, 0, 0};
             //     cmd->SetDescriptorHeaps(1, resource_descriptor_heap.GetAddressOf());
             //     cmd->ClearUnorderedAccessViewFloat(uav_voxels_gpu_, uav_voxels_cpu_, uav_voxels_resource_.Get(), clear, 0, nullptr);
             // }
-            // PIXEndEvent(cmd.Get());
+            // PIXEndEvent(cmd);
             
             // cmd->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::UAV(uav_voxels_resource_.Get()));
 
-            PIXBeginEvent(cmd.Get(), PIX_COLOR(0xFF, 0x0, 0x0), "Voxels fill");
-            {
-                for (int i = 0; i < mesh_trees_srv_.size(); ++i) {
-                    for (int32_t j = 0; j < mesh_trees_srv_[i].size(); ++j) {
-                        cmd->SetPipelineState(voxels_fill_.get_pso());
-                        cmd->SetComputeRootSignature(voxels_fill_.get_root_signature());
-                        cmd->SetDescriptorHeaps(1, resource_descriptor_heap.GetAddressOf());
-
-                        cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<CAMERA_DATA_BIND>(), Game::inst()->render().camera()->gpu_descriptor_handle());
-                        cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<VOXEL_DATA_BIND>(), voxel_data_cb_.gpu_descriptor_handle());
-                        cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<VOXELS_BIND>(), uav_voxels_gpu_);
-
-                        voxel_data_.voxelGrid.mesh_node_count = static_cast<int32_t>(mesh_trees_srv_[i][j]->size());
-                        voxel_data_cb_.update(voxel_data_);
-
-                        cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<MESH_TREE_BIND>(), mesh_trees_srv_[i][j]->gpu_descriptor_handle());
-                        cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<INDICES_BIND>(), index_buffers_srv_[i][j]);
-                        cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<VERTICES_BIND>(), vertex_buffers_srv_[i][j]);
-                        cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<MODEL_MATRICES_BIND>(), model_matrix_srv_[i][j]->gpu_descriptor_handle());
-
-                        cmd->Dispatch(align(voxel_grid_dim, 4) / 4,
-                            align(voxel_grid_dim, 4) / 4,
-                            align(voxel_grid_dim, 4) / 4);
-                    }
-                }
+            PROFILE_PIX_EVENT(cmd, PIX_COLOR(0xFF, 0x0, 0x0), "Voxels fill");
+            if (fill) {
+                cmd->EndQuery(timestamps, D3D12_QUERY_TYPE_TIMESTAMP, slot * 2);
             }
-            PIXEndEvent(cmd.Get());
+            if (fill && bindless) {
+                cmd->SetPipelineState(voxels_fill_bindless_.get_pso());
+                cmd->SetComputeRootSignature(voxels_fill_bindless_.get_root_signature());
+                cmd->SetDescriptorHeaps(1, resource_descriptor_heap.GetAddressOf());
+
+                cmd->SetComputeRootDescriptorTable(voxels_fill_bindless_.resource_index<FILL_TABLE_BIND>(), bindless_table);
+                cmd->SetComputeRoot32BitConstants(voxels_fill_bindless_.resource_index<FILL_INDICES_BIND>(),
+                    sizeof(fill_indices) / sizeof(UINT), &fill_indices, 0);
 
-            cmd->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::UAV(uav_voxels_resource_.Get()));
+                cmd->Dispatch(voxel_fill_groups_per_brick,
+                    std::min<UINT>(brick_count, D3D12_CS_DISPATCH_MAX_THREAD_GROUPS_PER_DIMENSION),
+                    brick_count / D3D12_CS_DISPATCH_MAX_THREAD_GROUPS_PER_DIMENSION + 1);
+            } else if (fill) {
+                cmd->SetPipelineState(voxels_fill_.get_pso());
+                cmd->SetComputeRootSignature(voxels_fill_.get_root_signature());
+                cmd->SetDescriptorHeaps(1, resource_descriptor_heap.GetAddressOf());
 
-            PIXBeginEvent(cmd.Get(), PIX_COLOR(0x0, 0xFF, 0x0), "Voxels draw");
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<CAMERA_DATA_BIND>(), camera_handle);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<VOXEL_DATA_BIND>(), voxel_data_handle);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<VOXELS_BIND>(), uav_voxels_gpu_);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<VOXEL_BRICKS_BIND>(), bricks_handle);
+
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<MESH_INSTANCES_BIND>(), instances_handle);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<MESH_TREE_BIND>(), mesh_trees_handle);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<INDICES_BIND>(), indices_handle);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<VERTICES_BIND>(), vertices_handle);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<MODEL_MATRICES_BIND>(), model_matrices_handle);
+                cmd->SetComputeRootDescriptorTable(voxels_fill_.resource_index<TRIANGLE_RECORDS_BIND>(), triangle_records_handle);
+
+                cmd->Dispatch(voxel_fill_groups_per_brick,
+                    std::min<UINT>(brick_count, D3D12_CS_DISPATCH_MAX_THREAD_GROUPS_PER_DIMENSION),
+                    brick_count / D3D12_CS_DISPATCH_MAX_THREAD_GROUPS_PER_DIMENSION + 1);
+            }
+            if (fill) {
+                cmd->EndQuery(timestamps, D3D12_QUERY_TYPE_TIMESTAMP, slot * 2 + 1);
+                cmd->ResolveQueryData(timestamps, D3D12_QUERY_TYPE_TIMESTAMP, slot * 2, 2, timestamps_readback, slot * 2 * sizeof(UINT64));
+            }
+        }
+    });
+
+    // UAV barrier between fill and draw comes from the graph
+    const GraphPass draw_pass = graph->add_pass("Voxels draw");
+    graph->read(draw_pass, voxels_graph_resource_, GraphState::unordered_access);
+    graph->write(draw_pass, render.back_buffer_resource(), GraphState::render_target);
+    graph->write(draw_pass, render.depth_stencil_resource(), GraphState::depth_write);
+    render.record_pass(draw_pass, [=](ID3D12GraphicsCommandList* cmd) {
+        {
+            PROFILE_PIX_EVENT(cmd, PIX_COLOR(0x0, 0xFF, 0x0), "Voxels draw");
             {
                 cmd->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_POINTLIST);
                 cmd->RSSetViewports(1, &Game::inst()->render().viewport());
@@ -214,32 +320,22 @@ void AS4VXGI_Component::draw()
                 cmd->SetPipelineState(stage_visualize_pipeline_.get_pso());
                 cmd->SetGraphicsRootSignature(stage_visualize_pipeline_.get_root_signature());
                 cmd->SetDescriptorHeaps(1, resource_descriptor_heap.GetAddressOf());
-                cmd->SetGraphicsRootDescriptorTable(stage_visualize_pipeline_.resource_index<CAMERA_DATA_BIND>(), Game::inst()->render().camera()->gpu_descriptor_handle());
+                cmd->SetGraphicsRootDescriptorTable(stage_visualize_pipeline_.resource_index<CAMERA_DATA_BIND>(), camera_handle);
                 cmd->SetGraphicsRootDescriptorTable(stage_visualize_pipeline_.resource_index<VOXELS_BIND>(), uav_voxels_gpu_);
-                cmd->SetGraphicsRootDescriptorTable(stage_visualize_pipeline_.resource_index<VOXEL_DATA_BIND>(), voxel_data_cb_.gpu_descriptor_handle());
+                cmd->SetGraphicsRootDescriptorTable(stage_visualize_pipeline_.resource_index<VOXEL_DATA_BIND>(), voxel_data_handle);
 
                 cmd->DrawInstanced(1, voxel_grid_dim * voxel_grid_dim * voxel_grid_dim, 0, 0);
             }
-            PIXEndEvent(cmd.Get());
         }
+    });
 
-        HRESULT_CHECK(cmd->Close());
-        graphics_queue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList**>(cmd.GetAddressOf()));
-    }
-
-    ComPtr<ID3D12GraphicsCommandList> draw_cmd_list;
-    device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, graphics_command_list_allocator.Get(), nullptr, IID_PPV_ARGS(&draw_cmd_list));
-    HRESULT_CHECK(draw_cmd_list->Close());
-    HRESULT_CHECK(draw_cmd_list->Reset(graphics_command_list_allocator.Get(), nullptr));
-
-    PIXBeginEvent(draw_cmd_list.Get(), PIX_COLOR(0x0, 0xFF, 0x0), "Meshes draw");
+    // every model records its meshes into own lists, submitted after voxels in model order
+    const GraphPass meshes_pass = graph->add_pass("Meshes draw");
+    graph->write(meshes_pass, render.back_buffer_resource(), GraphState::render_target);
+    graph->write(meshes_pass, render.depth_stencil_resource(), GraphState::depth_write);
     for (ModelTree* model_tree : model_trees_) {
-        model_tree->draw(draw_cmd_list.Get());
+        model_tree->draw(meshes_pass, camera_handle);
     }
-    PIXEndEvent(draw_cmd_list.Get());
-
-    HRESULT_CHECK(draw_cmd_list->Close());
-    graphics_queue->ExecuteCommandLists(1, (ID3D12CommandList**)draw_cmd_list.GetAddressOf());
 }
 
 void AS4VXGI_Component::imgui()
@@ -263,6 +359,224 @@ void AS4VXGI_Component::imgui()
         ImGui::Text("Voxel grid dimensions");
         ImGui::SameLine();
         ImGui::InputInt("##local_voxel_grid_dim", &local_voxel_grid_dim, 1, 10);
+
+        VoxelUpdateScheduler& scheduler = voxel_frame_.scheduler();
+        VoxelUpdateScheduler::Settings settings = scheduler.settings();
+        int voxel_budget = int(settings.voxel_budget);
+        ImGui::Text("Voxel updates per frame (0 - all)");
+        ImGui::SameLine();
+        if (ImGui::InputInt("##voxel_budget", &voxel_budget, 1024, 16 * 1024) && voxel_budget >= 0) {
+            settings.voxel_budget = uint32_t(voxel_budget);
+            scheduler.set_settings(settings);
+        }
+        float time_budget = settings.time_budget_ms;
+        ImGui::Text("Voxel fill milliseconds per frame (0 - off)");
+        ImGui::SameLine();
+        if (ImGui::InputFloat("##time_budget", &time_budget, 0.1f, 1.f) && time_budget >= 0.f) {
+            settings.time_budget_ms = time_budget;
+            scheduler.set_settings(settings);
+        }
+        ImGui::Text("Dirty bricks: %u / %u, fill pass %.3f ms, %.3f us per 1000 voxels",
+            scheduler.dirty_brick_count(), scheduler.brick_count(), fill_ms_, scheduler.ms_per_voxel() * 1e6f);
+
+        if (ImGui::Button("Scheduler convergence report")) {
+            scheduler_report_ = format_scheduler_convergence(measure_scheduler_convergence(voxel_frame_.camera_samples(),
+                voxel_grid_size, voxel_grid_dim, { 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 0 }, settings));
+            OutputDebugString(scheduler_report_.c_str());
+        }
+        if (!scheduler_report_.empty()) {
+            ImGui::TextUnformatted(scheduler_report_.c_str());
+        }
+
+        {
+            GeometryArena* arena = Game::inst()->render().geometry_arena();
+            const GeometryArena::Stats stats = arena->stats();
+            ImGui::Text("Geometry arena: vertices %u / %u, fragmentation %.2f; indices %u / %u, fragmentation %.2f",
+                stats.vertices.used, stats.vertices.size, stats.vertices.fragmentation(),
+                stats.indices.used, stats.indices.size, stats.indices.fragmentation());
+            ImGui::SameLine();
+            if (ImGui::Button("Defragment")) {
+                arena->defragment();
+            }
+        }
+        {
+            Render& render = Game::inst()->render();
+            int frames_in_flight = int(render.frames_in_flight());
+            ImGui::Text("Frames in flight");
+            ImGui::SameLine();
+            if (ImGui::SliderInt("##frames_in_flight", &frames_in_flight, 1, int(FrameRing::max_frames_in_flight))) {
+                render.set_frames_in_flight(uint32_t(frames_in_flight));
+            }
+            const FrameRing::Stats& stats = render.frame_stats();
+            ImGui::Text("CPU wait for frame slot: %.3f ms, average %.3f ms, %llu of %llu frames waited",
+                stats.last_wait_ms, stats.total_wait_ms / std::max<uint64_t>(stats.frames, 1), stats.waits, stats.frames);
+            const CommandListPoolStats& lists = render.command_list_stats();
+            ImGui::Text("Command lists: %llu acquired, %llu created this frame, %llu pooled",
+                lists.frame_acquired, lists.frame_created, lists.lists);
+            GraphicsCommandRecorder* recorder = render.recorder();
+            bool parallel_recording = recorder->max_workers() != 1;
+            if (ImGui::Checkbox("Parallel recording", &parallel_recording)) {
+                recorder->set_max_workers(parallel_recording ? 0 : 1);
+            }
+            const CommandRecorderStats& recording = recorder->stats();
+            ImGui::SameLine();
+            ImGui::Text("%llu lists on %u workers, record %.3f ms, submit %.3f ms",
+                recording.tasks, recording.workers, recording.record_ms, recording.submit_ms);
+        }
+        {
+            const StagingUploader::Stats stats = Game::inst()->render().uploader()->stats();
+            ImGui::Text("Staging: %llu uploads, %llu KB in %llu batches, %llu stalls, ring %llu / %llu KB",
+                stats.uploads, stats.bytes / 1024, stats.batches, stats.stalls, stats.ring_used / 1024, stats.ring_capacity / 1024);
+        }
+        {
+            const DescriptorAllocator::Stats stats = Game::inst()->render().descriptor_stats();
+            ImGui::Text("Descriptors: %u / %u in %u ranges, largest free %u, %u pending free, frame %u / %u (peak %u), %u failed",
+                stats.persistent_used, stats.persistent_capacity, stats.persistent_ranges, stats.largest_free_range, stats.pending_free,
+                stats.frame_used, stats.frame_capacity, stats.frame_peak, stats.failed_allocations);
+            const BindlessTable::Stats bindless = Game::inst()->render().bindless()->stats();
+            if (Game::inst()->render().bindless_supported()) {
+                ImGui::Checkbox("Bindless voxel fill", &bindless_fill_);
+            } else {
+                ImGui::Text("Bindless voxel fill needs resource binding tier 3");
+            }
+            ImGui::SameLine();
+            ImGui::Text("table %u / %u, peak %u, %u pending free", bindless.used, bindless.capacity, bindless.peak, bindless.pending_free);
+        }
+        {
+            const ConstantRing::Stats stats = Game::inst()->render().constant_stats();
+            ImGui::Text("Constants: %llu B/frame (peak %llu, avg %llu), %llu allocations, %llu stalls, %llu failed, ring %llu / %llu KB",
+                stats.last_frame_bytes, stats.peak_frame_bytes, stats.frames > 0 ? stats.total_bytes / stats.frames : 0,
+                stats.allocations, stats.stalls, stats.failed_allocations, stats.used / 1024, stats.capacity / 1024);
+        }
+        {
+            const PipelineCache::Stats& stats = Game::inst()->render().pipeline_cache()->stats();
+            ImGui::Text("Startup: %.1f ms, pipelines %u created (%.1f ms), %u loaded (%.1f ms), %u shared, %u / %u root signatures shared",
+                Game::inst()->startup_ms(), stats.created_pipelines, stats.create_ms, stats.loaded_pipelines, stats.load_ms,
+                stats.shared_pipelines, stats.shared_root_signatures, stats.root_signatures + stats.shared_root_signatures);
+            const ShaderCache::Stats& shaders = Game::inst()->render().shader_cache()->stats();
+            ImGui::Text("Shader cache: %u lookups in %u sources, %u hits, %u misses, %u invalid defines",
+                shaders.lookups, shaders.sources, shaders.hits, shaders.misses, shaders.invalid_defines);
+        }
+        if (ImGui::Button("Buffer placement report")) {
+            placement_report_ = Game::inst()->render().residency()->report();
+            OutputDebugString(placement_report_.c_str());
+        }
+        if (!placement_report_.empty()) {
+            ImGui::TextUnformatted(placement_report_.c_str());
+        }
+        {
+            const CompiledGraph::Stats& stats = Game::inst()->render().graph()->compiled().stats;
+            ImGui::Text("Render graph: %u passes, %u barriers in %u batches (%u without hoisting), transient %llu / %llu KB",
+                stats.passes, stats.barriers, stats.batches, stats.unhoisted_batches, stats.heap_bytes / 1024, stats.transient_bytes / 1024);
+            if (ImGui::Button("Render graph report")) {
+                graph_report_ = Game::inst()->render().graph()->report();
+                OutputDebugString(graph_report_.c_str());
+            }
+            if (!graph_report_.empty()) {
+                ImGui::TextUnformatted(graph_report_.c_str());
+            }
+        }
+        {
+            // zones of the last frames still in the per-thread rings
+            if (ImGui::Button("Profiler report")) {
+                char overhead[64];
+                sprintf_s(overhead, "%.1f ns per zone\n", Profiler::inst().measure_zone_overhead());
+                profiler_report_ = overhead + Profiler::inst().report();
+                OutputDebugString(profiler_report_.c_str());
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save Chrome trace")) {
+                Profiler::inst().write_chrome_trace("./profile.json");
+            }
+            if (!profiler_report_.empty()) {
+                ImGui::TextUnformatted(profiler_report_.c_str());
+            }
+        }
+        {
+            // percentiles of the last frames by phase of Game::run
+            const FrameTimings& timings = Game::inst()->frame_timings();
+            ImGui::Text("%-8s %9s %9s %9s %9s", "phase", "p50 ms", "p95 ms", "p99 ms", "max ms");
+            for (uint32_t column = 0; column < FrameTimings::column_count; ++column) {
+                const FrameTimings::Summary summary = timings.window_summary(column);
+                ImGui::Text("%-8s %9.3f %9.3f %9.3f %9.3f", FrameTimings::column_name(column),
+                    summary.p50_ms, summary.p95_ms, summary.p99_ms, summary.max_ms);
+            }
+            const std::vector<float> frame_ms = timings.window_values(FrameTimings::frame_column);
+            if (!frame_ms.empty()) {
+                ImGui::PlotLines("##frame_ms", frame_ms.data(), int(frame_ms.size()), 0, "frame ms", 0.f, 50.f, ImVec2(0, 60));
+                const std::vector<float> histogram = timings.window_histogram(FrameTimings::frame_column, 50, 50.f);
+                ImGui::PlotHistogram("##frame_histogram", histogram.data(), int(histogram.size()), 0, "frame ms, 0 - 50",
+                    0.f, FLT_MAX, ImVec2(0, 60));
+            }
+            if (ImGui::Button("Export frame timings (F9)")) {
+                Game::inst()->export_frame_timings();
+            }
+        }
+        {
+            // replays drive the camera and model transforms with a fixed timestep, as4vxgi_headless --replay takes the file
+            CameraPath& camera_path = Game::inst()->camera_path();
+            if (camera_path.recording()) {
+                ImGui::Text("Recording camera path: %zu frames", camera_path.frame_count());
+            } else if (camera_path.replaying()) {
+                ImGui::Text("Replaying camera path: frame %zu / %zu", camera_path.cursor(), camera_path.frame_count());
+            } else {
+                ImGui::Text("Camera path: %zu frames", camera_path.frame_count());
+            }
+            if (camera_path.mode() == CameraPath::Mode::off) {
+                if (ImGui::Button("Record")) {
+                    camera_path.start_recording();
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Replay")) {
+                    // timings of the replay only
+                    Game::inst()->frame_timings().clear();
+                    camera_path.start_replay();
+                }
+            } else if (ImGui::Button("Stop")) {
+                camera_path.stop();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save camera path")) {
+                camera_path.save("./camera_path.bin");
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Load camera path")) {
+                camera_path.load("./camera_path.bin");
+            }
+        }
+
+        if (ImGui::Button("CPU voxelizer benchmark")) {
+            benchmark_report_ = format_benchmark(run_binning_benchmark(voxel_grid_dim));
+            OutputDebugString(benchmark_report_.c_str());
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Mesh tree traversal benchmark")) {
+            benchmark_report_ = format_benchmark(run_traversal_benchmark(voxel_grid_dim));
+            OutputDebugString(benchmark_report_.c_str());
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Triangle records benchmark")) {
+            benchmark_report_ = format_benchmark(run_triangle_record_benchmark(voxel_grid_dim));
+            OutputDebugString(benchmark_report_.c_str());
+        }
+        if (ImGui::Button("SIMD kernels benchmark")) {
+            benchmark_report_ = format_kernel_benchmark(run_triangle_kernel_benchmark()) +
+                                format_benchmark(run_kernel_voxelizer_benchmark(voxel_grid_dim));
+            OutputDebugString(benchmark_report_.c_str());
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("World transform benchmark")) {
+            benchmark_report_ = format_benchmark(run_world_transform_benchmark(voxel_grid_dim));
+            OutputDebugString(benchmark_report_.c_str());
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Root binds benchmark")) {
+            benchmark_report_ = format_bind_benchmark(run_bind_benchmark());
+            OutputDebugString(benchmark_report_.c_str());
+        }
+        if (!benchmark_report_.empty()) {
+            ImGui::TextUnformatted(benchmark_report_.c_str());
+        }
     }
     ImGui::End();
 
@@ -295,7 +609,6 @@ void AS4VXGI_Component::imgui()
 
             voxel_data_.voxelGrid.dimension = voxel_grid_dim;
             voxel_data_.voxelGrid.size = voxel_grid_size;
-            voxel_data_.voxelGrid.mesh_node_count = 0;
             voxel_data_cb_.update(voxel_data_);
         }
     }
@@ -309,13 +622,77 @@ void AS4VXGI_Component::reload()
 
 void AS4VXGI_Component::update()
 {
+    // transform stage, moved instances go to world space once and are uploaded
+    bool world_changed = false;
+    CameraPath& camera_path = Game::inst()->camera_path();
+    for (int32_t i = 0; i < model_trees_.size(); ++i) {
+        ModelTree* model_tree = model_trees_[i];
+        // unchanged transforms keep world geometry
+        const Matrix transform = camera_path.frame_transform(uint32_t(i), model_tree->get_transform());
+        if (transform != model_tree->get_transform()) {
+            model_tree->set_transform(transform);
+        }
+        model_tree->update();
+        if (model_tree->get_world_version() == uploaded_world_versions_[i]) {
+            continue;
+        }
+        voxel_frame_.update_transform(uint32_t(i), model_tree->get_transform());
+        const std::vector<std::vector<MeshTreeNode>> mesh_trees = model_tree->get_meshes_world_trees();
+        const std::vector<std::vector<TriangleRecord>> records = model_tree->get_meshes_triangle_records();
+        for (int32_t j = 0; j < mesh_trees.size(); ++j) {
+            voxel_frame_.update_mesh(uint32_t(i), uint32_t(j), mesh_trees[j], records[j]);
+        }
+        uploaded_world_versions_[i] = model_tree->get_world_version();
+        world_changed = true;
+    }
+    if (world_changed) {
+        upload_world_geometry();
+    }
+
+    // every frame, so the time budget follows the GPU
+    read_fill_cost();
+
+    const Camera* camera = Game::inst()->render().camera();
+    const std::vector<uint32_t>& bricks = voxel_frame_.update(camera->position(), camera->direction());
+    scheduled_bricks_srv_.update(bricks.data(), UINT(bricks.size()));
+
+    voxel_data_.voxelGrid.brick_count = UINT(bricks.size());
+    voxel_data_cb_.update(voxel_data_);
+}
+
+void AS4VXGI_Component::read_fill_cost()
+{
+    // GPU is done with the frame that used the slot before, FrameRing waited for it
+    const UINT slot = Game::inst()->render().frame_slot();
+    if (fill_voxels_[slot] == 0) {
+        return;
+    }
+    const D3D12_RANGE range{ slot * 2 * sizeof(UINT64), (slot * 2 + 2) * sizeof(UINT64) };
+    UINT64* timestamps = nullptr;
+    HRESULT_CHECK(fill_timestamps_readback_->Map(0, &range, reinterpret_cast<void**>(&timestamps)));
+    const UINT64 begin = timestamps[slot * 2];
+    const UINT64 end = timestamps[slot * 2 + 1];
+    const D3D12_RANGE written{ 0, 0 };
+    fill_timestamps_readback_->Unmap(0, &written);
+
+    fill_ms_ = float(double(end - begin) * 1000.0 / double(timestamp_frequency_));
+    voxel_frame_.report_fill_cost(fill_ms_, fill_voxels_[slot]);
+    fill_voxels_[slot] = 0;
+}
 
+void AS4VXGI_Component::upload_world_geometry()
+{
+    // written to the version of the current frame slot, frames in flight keep reading their versions
+    instances_srv_.update(instance_table_.instances().data(), UINT(instance_table_.instances().size()));
+    mesh_trees_srv_.update(instance_table_.nodes().data(), UINT(instance_table_.nodes().size()));
+    triangle_records_srv_.update(instance_table_.records().data(), UINT(instance_table_.records().size()));
+    model_matrix_srv_.update(instance_table_.transforms().data(), UINT(instance_table_.transforms().size()));
 }
 
 void AS4VXGI_Component::destroy_resources()
 {
-    model_matrix_srv_.clear();
-    mesh_trees_srv_.clear();
+    voxel_frame_.clear();
+    uploaded_world_versions_.clear();
 
     for (ModelTree* model_tree : model_trees_) {
         model_tree->unload();
@@ -324,5 +701,11 @@ void AS4VXGI_Component::destroy_resources()
 
     model_trees_.clear();
 
+    // key of the bindless view is its descriptor, released before the descriptor can be reused
+    Game::inst()->render().release_bindless(uav_voxels_bindless_);
+    Game::inst()->render().free_gpu_resource_descriptor(uav_voxels_range_);
+    Game::inst()->render().free_cpu_resource_descriptor(uav_voxels_range_cpu_);
     uav_voxels_resource_.Reset();
+    fill_timestamps_.Reset();
+    fill_timestamps_readback_.Reset();
 }
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "render/common.h"
+#include "render/frame_ring.h"
 #include "component/game_component.h"
 #include "math/model_tree.h"
 #include "render/resource/pipeline.h"
+#include "voxels/voxel_frame.h"
+#include "voxels/mesh_instance_table.h"
 
 #include "resources/shaders/voxels/voxel.fx"
 
@@ -27,20 +30,62 @@ private:
     VOXEL_DATA_BIND voxel_data_;
     ConstBuffer<VOXEL_DATA_BIND> voxel_data_cb_;
 
-    ComputePipeline voxels_fill_;
+    DynamicShaderResource<UINT> scheduled_bricks_srv_;
+
+    // GPU time of the fill pass, a timestamp pair per frame slot read back when the slot comes around
+    ComPtr<ID3D12QueryHeap> fill_timestamps_;
+    ComPtr<ID3D12Resource> fill_timestamps_readback_;
+    UINT64 timestamp_frequency_{ 0 };
+    uint32_t fill_voxels_[FrameRing::max_frames_in_flight] = {}; // voxels filled by the slot, 0 - nothing measured
+    float fill_ms_{ 0.f };
+    void read_fill_cost();
+
+    std::string scheduler_report_;
+    std::string benchmark_report_;
+    std::string placement_report_;
+    std::string graph_report_;
+    std::string profiler_report_;
+
+    // root parameters in this order, binds are resolved at compile time
+    LayoutComputePipeline<PipelineLayout<
+        CAMERA_DATA_BIND,
+        MESH_TREE_BIND,
+        INDICES_BIND,
+        VERTICES_BIND,
+        MODEL_MATRICES_BIND,
+        TRIANGLE_RECORDS_BIND,
+        MESH_INSTANCES_BIND,
+        VOXEL_DATA_BIND,
+        VOXELS_BIND,
+        VOXEL_BRICKS_BIND>> voxels_fill_;
+    // same pass reading everything through the global table, one root constants parameter per dispatch
+    LayoutComputePipeline<PipelineLayout<FILL_INDICES_BIND, FILL_TABLE_BIND>> voxels_fill_bindless_;
+    bool bindless_fill_{ false };
 
     ComPtr<ID3D12Resource> uav_voxels_resource_{ nullptr };
     D3D12_CPU_DESCRIPTOR_HANDLE uav_voxels_cpu_;
-    UINT uav_voxels_resource_index_;
-    UINT uav_voxels_resource_index_cpu_;
+    DescriptorRange uav_voxels_range_;
+    DescriptorRange uav_voxels_range_cpu_;
+    BindlessHandle uav_voxels_bindless_;
     D3D12_CPU_DESCRIPTOR_HANDLE uav_voxels_;
     D3D12_GPU_DESCRIPTOR_HANDLE uav_voxels_gpu_;
+    GraphResource voxels_graph_resource_{ 0 };
+
+    // all meshes of all model trees, voxelized by one dispatch; model i of the frame is model tree i
+    MeshInstanceTable instance_table_;
+    VoxelFrame voxel_frame_;
+    std::vector<uint32_t> uploaded_world_versions_;
+
+    ShaderResource<uint32_t> indices_srv_;
+    ShaderResource<Vertex> vertices_srv_;
+    // world space, rewritten when model tree transform changes
+    DynamicShaderResource<MeshInstance> instances_srv_;
+    DynamicShaderResource<MeshTreeNode> mesh_trees_srv_;
+    DynamicShaderResource<TriangleRecord> triangle_records_srv_;
+    DynamicShaderResource<InstanceTransform> model_matrix_srv_;
 
-    std::vector<std::vector<ShaderResource<MeshTreeNode>*>> mesh_trees_srv_;
-    std::vector<std::vector<D3D12_GPU_DESCRIPTOR_HANDLE>> index_buffers_srv_;
-    std::vector<std::vector<D3D12_GPU_DESCRIPTOR_HANDLE>> vertex_buffers_srv_;
-    std::vector<std::vector<ShaderResource<Matrix>*>> model_matrix_srv_;
+    void upload_world_geometry();
 // #ifndef NDEBUG
-    GraphicsPipeline stage_visualize_pipeline_;
+    LayoutGraphicsPipeline<PipelineLayout<CAMERA_DATA_BIND, VOXELS_BIND, VOXEL_DATA_BIND>> stage_visualize_pipeline_;
 // #endif
 };
@@ -0,0 +1,85 @@
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+#include "math/mesh_tree.h"
+#include "bench_scenes.h"
+
+void append_sphere(VoxelizerGeometry& geometry, const Vector3& center, float radius, uint32_t rings, uint32_t segments)
+{
+    constexpr float pi = 3.14159265358979f;
+
+    const uint32_t base = uint32_t(geometry.positions.size());
+    for (uint32_t ring = 0; ring <= rings; ++ring) {
+        const float theta = pi * ring / rings;
+        for (uint32_t segment = 0; segment <= segments; ++segment) {
+            const float phi = 2 * pi * segment / segments;
+            const Vector3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            geometry.positions.push_back(center + normal * radius);
+            geometry.normals.push_back(normal);
+        }
+    }
+
+    for (uint32_t ring = 0; ring < rings; ++ring) {
+        for (uint32_t segment = 0; segment < segments; ++segment) {
+            const uint32_t i0 = base + ring * (segments + 1) + segment;
+            const uint32_t i1 = i0 + segments + 1;
+            // pole rows collapse to a point, skip zero area triangles there
+            if (ring != 0) {
+                geometry.indices.insert(geometry.indices.end(), { i0, i1, i0 + 1 });
+            }
+            if (ring != rings - 1) {
+                geometry.indices.insert(geometry.indices.end(), { i0 + 1, i1, i1 + 1 });
+            }
+        }
+    }
+}
+
+void build_scene_tree(BenchScene& scene, float smallest_length)
+{
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vector3& position : scene.geometry.positions) {
+        const float p[3] = { position.x, position.y, position.z };
+        for (int32_t i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], p[i]);
+            max[i] = std::max(max[i], p[i]);
+        }
+    }
+    build_mesh_tree(scene.geometry.indices, scene.geometry.positions, min, max, smallest_length, scene.geometry.tree);
+    build_threaded_tree(scene.geometry.tree, scene.geometry.threaded_tree);
+}
+
+BenchScene make_dense_scene(float grid_size)
+{
+    BenchScene scene;
+    scene.name = "dense";
+    scene.grid_size = grid_size;
+    scene.camera_position = Vector3(0, 0, 0);
+    scene.camera_forward = Vector3(0, 0, 1);
+
+    constexpr int32_t count = 6;
+    const float step = grid_size / count;
+    for (int32_t z = 0; z < count; ++z) {
+        for (int32_t y = 0; y < count; ++y) {
+            for (int32_t x = 0; x < count; ++x) {
+                const Vector3 center = Vector3(x + .5f, y + .5f, z + .5f) * step - Vector3(1, 1, 1) * (grid_size / 2);
+                append_sphere(scene.geometry, center, step * .45f, 16, 32);
+            }
+        }
+    }
+    return scene;
+}
+
+BenchScene make_sparse_scene(float grid_size)
+{
+    BenchScene scene;
+    scene.name = "sparse";
+    scene.grid_size = grid_size;
+    scene.camera_position = Vector3(0, 0, 0);
+    scene.camera_forward = Vector3(0, 0, 1);
+
+    append_sphere(scene.geometry, Vector3(grid_size * .2f, 0, grid_size * .1f), grid_size * .08f, 24, 48);
+    append_sphere(scene.geometry, Vector3(-grid_size * .25f, grid_size * .2f, -grid_size * .2f), grid_size * .05f, 24, 48);
+    return scene;
+}
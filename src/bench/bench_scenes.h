@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "voxels/cpu_voxelizer.h"
+
+// procedural scenes for CPU benchmarks, don't need assets or GPU
+struct BenchScene
+{
+    std::string name;
+    VoxelizerGeometry geometry;
+    Vector3 camera_position;
+    Vector3 camera_forward;
+    float grid_size;
+};
+
+void append_sphere(VoxelizerGeometry& geometry, const Vector3& center, float radius, uint32_t rings, uint32_t segments);
+
+// builds geometry.tree and geometry.threaded_tree, reorders geometry.indices
+void build_scene_tree(BenchScene& scene, float smallest_length);
+
+// spheres packed over the whole grid volume
+BenchScene make_dense_scene(float grid_size);
+// couple of spheres in a mostly empty grid
+BenchScene make_sparse_scene(float grid_size);
@@ -0,0 +1,123 @@
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+
+#include "render/resource/pipeline_layout.h"
+#include "bind_benchmark.h"
+
+namespace
+{
+
+using FillLayout = PipelineLayout<
+    CAMERA_DATA_BIND,
+    MESH_TREE_BIND,
+    INDICES_BIND,
+    VERTICES_BIND,
+    MODEL_MATRICES_BIND,
+    TRIANGLE_RECORDS_BIND,
+    MESH_INSTANCES_BIND,
+    VOXEL_DATA_BIND,
+    VOXELS_BIND,
+    VOXEL_BRICKS_BIND>;
+
+// declared ranges as Pipeline kept them before layouts, keyed by register class too: b0 and t0 are different ranges
+struct RuntimeRange
+{
+    char register_class;
+    UINT slot;
+    UINT space;
+};
+
+template<class... binds>
+std::vector<RuntimeRange> runtime_ranges(PipelineLayout<binds...>)
+{
+    return { RuntimeRange{ PipelineLayout<>::register_class<binds>(), binds::slot(), binds::space() }... };
+}
+
+template<class bind>
+int runtime_index(const std::vector<RuntimeRange>& ranges)
+{
+    constexpr char register_class = PipelineLayout<>::register_class<bind>();
+    for (int i = 0; i < int(ranges.size()); ++i) {
+        if (ranges[i].register_class == register_class && ranges[i].slot == bind::slot() && ranges[i].space == bind::space()) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// binds in the order AS4VXGI_Component::draw sets them
+template<class Lookup>
+uint64_t bind_fill_tables(uint32_t frames, uint32_t meshes, Lookup lookup)
+{
+    uint64_t checksum = 0;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        for (uint32_t mesh = 0; mesh < meshes; ++mesh) {
+            checksum += lookup(CAMERA_DATA_BIND{});
+            checksum += lookup(VOXEL_DATA_BIND{});
+            checksum += lookup(VOXELS_BIND{});
+            checksum += lookup(VOXEL_BRICKS_BIND{});
+            checksum += lookup(MESH_INSTANCES_BIND{});
+            checksum += lookup(MESH_TREE_BIND{});
+            checksum += lookup(INDICES_BIND{});
+            checksum += lookup(VERTICES_BIND{});
+            checksum += lookup(MODEL_MATRICES_BIND{});
+            checksum += lookup(TRIANGLE_RECORDS_BIND{});
+        }
+    }
+    return checksum;
+}
+
+constexpr uint32_t binds_per_mesh = 10;
+
+} // namespace
+
+std::vector<BindBenchmarkResult> run_bind_benchmark(uint32_t frames, uint32_t meshes_per_frame)
+{
+    std::vector<BindBenchmarkResult> results;
+    const uint64_t binds = uint64_t(frames) * meshes_per_frame * binds_per_mesh;
+
+    {
+        // volatile keeps the search from being folded, ranges live in a member vector in Pipeline too
+        std::vector<RuntimeRange> ranges = runtime_ranges(FillLayout{});
+        std::vector<RuntimeRange>* volatile ranges_ptr = &ranges;
+
+        BindBenchmarkResult result;
+        result.variant = "linear search";
+        const auto time = std::chrono::steady_clock::now();
+        result.checksum = bind_fill_tables(frames, meshes_per_frame, [ranges_ptr](auto bind) {
+            return uint64_t(runtime_index<decltype(bind)>(*ranges_ptr));
+        });
+        const float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+        result.binds = binds;
+        result.ns_per_bind = binds > 0 ? ms * 1e6f / float(binds) : 0.f;
+        results.push_back(result);
+    }
+    {
+        BindBenchmarkResult result;
+        result.variant = "layout";
+        const auto time = std::chrono::steady_clock::now();
+        result.checksum = bind_fill_tables(frames, meshes_per_frame, [](auto bind) {
+            return uint64_t(FillLayout::root_index<decltype(bind)>());
+        });
+        const float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+        result.binds = binds;
+        result.ns_per_bind = binds > 0 ? ms * 1e6f / float(binds) : 0.f;
+        results.push_back(result);
+    }
+    return results;
+}
+
+std::string format_bind_benchmark(const std::vector<BindBenchmarkResult>& results)
+{
+    std::stringstream ss;
+    ss << std::left << std::setw(16) << "binds" << std::right << std::setw(12) << "ns/bind" << std::setw(14) << "lookups"
+       << std::setw(14) << "checksum" << "\n";
+    for (const BindBenchmarkResult& result : results) {
+        ss << std::left << std::setw(16) << result.variant << std::right << std::fixed
+           << std::setw(12) << std::setprecision(3) << result.ns_per_bind
+           << std::setw(14) << result.binds
+           << std::setw(14) << result.checksum << "\n";
+    }
+    return ss.str();
+}
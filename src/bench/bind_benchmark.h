@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct BindBenchmarkResult
+{
+    std::string variant;
+    float ns_per_bind{ 0.f };
+    uint64_t binds{ 0 };
+    uint64_t checksum{ 0 }; // sum of root parameter indices, equal for all variants
+};
+
+// root parameter lookups of the voxel fill pass: the old linear search over declared ranges
+// against the compile-time pipeline layout, every bind of every mesh of frames
+std::vector<BindBenchmarkResult> run_bind_benchmark(uint32_t frames = 1000, uint32_t meshes_per_frame = 256);
+
+std::string format_bind_benchmark(const std::vector<BindBenchmarkResult>& results);
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+
+#include "headless_component.h"
+#include "core/game.h"
+
+namespace
+{
+
+constexpr float grid_size = 100.f;
+// radians per frame, fixed so headless runs are deterministic
+constexpr float camera_orbit_step = 0.01f;
+constexpr float instance_rotation_step = 0.02f;
+
+double elapsed_ms(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+} // namespace
+
+HeadlessComponent::HeadlessComponent(NullBackend* backend, const Settings& settings)
+    : backend_(backend), settings_(settings)
+{
+}
+
+void HeadlessComponent::initialize()
+{
+    const float unit = grid_size / settings_.grid_dimension;
+    scenes_ = { make_dense_scene(grid_size), make_sparse_scene(grid_size) };
+
+    VoxelUpdateScheduler::Settings settings;
+    settings.brick_dim = VOXEL_BRICK_DIM;
+    settings.voxel_budget = settings_.voxel_budget;
+    voxel_frame_.initialize(&geometry_.instance_table, grid_size, settings_.grid_dimension, settings);
+    voxel_frame_.clear();
+
+    // tree builds and first transform stage, as ModelTree does on load; scene i is model i
+    for (BenchScene& scene : scenes_) {
+        build_scene_tree(scene, unit * settings_.tree_cell_voxels);
+        update_world_geometry(scene.geometry.positions, scene.geometry.indices, scene.geometry.tree, Matrix::Identity, world_);
+
+        std::vector<Vertex> vertices(scene.geometry.positions.size());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            vertices[i].position = scene.geometry.positions[i];
+            vertices[i].normal = scene.geometry.normals[i];
+        }
+        voxel_frame_.add_model(Matrix::Identity);
+        voxel_frame_.add_mesh(scene.geometry.indices, vertices, world_.tree, world_.records);
+    }
+
+    voxels_resource_ = backend_->graph()->import_resource("voxels", GraphState::common);
+    stats_ = Stats{};
+}
+
+void HeadlessComponent::update()
+{
+    const float frame = float(backend_->frame());
+    // replayed path overrides camera and transform of the moving instance, recorded path takes them
+    CameraPath& camera_path = Game::inst()->camera_path();
+    const CameraPath::Frame* replayed = camera_path.replay_frame();
+
+    // transform stage of the moving instance, the last scene spins in place
+    const auto transform_begin = std::chrono::steady_clock::now();
+    const uint32_t moving = uint32_t(scenes_.size() - 1);
+    const BenchScene& scene = scenes_[moving];
+    const Matrix transform = camera_path.frame_transform(moving, Matrix::CreateRotationY(frame * instance_rotation_step));
+    update_world_geometry(scene.geometry.positions, scene.geometry.indices, scene.geometry.tree, transform, world_);
+    voxel_frame_.update_transform(moving, transform);
+    voxel_frame_.update_mesh(moving, 0, world_.tree, world_.records);
+    stats_.transform_ms += elapsed_ms(transform_begin);
+
+    // camera orbits the grid
+    const auto schedule_begin = std::chrono::steady_clock::now();
+    Vector3 camera_position = scenes_[0].camera_position;
+    Vector3 camera_forward = Vector3::TransformNormal(scenes_[0].camera_forward, Matrix::CreateRotationY(frame * camera_orbit_step));
+    if (replayed != nullptr) {
+        camera_position = replayed->position;
+        camera_forward = replayed->forward;
+    }
+    camera_path.record_camera(camera_position, camera_forward);
+    const std::vector<uint32_t>& bricks = voxel_frame_.update(camera_position, camera_forward);
+    brick_count_ = uint32_t(bricks.size());
+    stats_.schedule_ms += elapsed_ms(schedule_begin);
+
+    // fill pass on CPU
+    voxelizer_.voxelize(voxel_frame_.grid(), VOXEL_BRICK_DIM, geometry_, CpuVoxelizer::Mode::instance_table, &bricks);
+    const CpuVoxelizer::Stats& voxelized = voxelizer_.stats();
+    voxel_frame_.report_fill_cost(voxelized.voxelize_ms);
+
+    ++stats_.frames;
+    stats_.voxelize_ms += voxelized.voxelize_ms;
+    stats_.bricks += brick_count_;
+    stats_.voxels += voxelized.voxels;
+    stats_.filled_voxels += voxelized.filled_voxels;
+    stats_.triangle_tests += voxelized.triangle_tests;
+}
+
+void HeadlessComponent::draw()
+{
+    RenderGraph* graph = backend_->graph();
+
+    const uint32_t brick_count = brick_count_;
+    const GraphPass fill_pass = graph->add_pass("Voxels fill");
+    graph->write(fill_pass, voxels_resource_, GraphState::unordered_access);
+    backend_->record_pass(fill_pass, [brick_count](NullCommandDevice::List list) {
+        list->command("SetComputeRootSignature voxels fill");
+        list->command("SetPipelineState voxels fill");
+        list->command("Dispatch " + std::to_string(brick_count));
+    });
+
+    const GraphPass draw_pass = graph->add_pass("Voxels draw");
+    graph->read(draw_pass, voxels_resource_, GraphState::unordered_access);
+    graph->write(draw_pass, backend_->back_buffer_resource(), GraphState::render_target);
+    graph->write(draw_pass, backend_->depth_stencil_resource(), GraphState::depth_write);
+    backend_->record_pass(draw_pass, [](NullCommandDevice::List list) {
+        list->command("SetPipelineState voxels draw");
+        list->command("DrawInstanced voxels");
+    });
+
+    // one list per mesh as model trees record theirs
+    const GraphPass meshes_pass = graph->add_pass("Meshes draw");
+    graph->write(meshes_pass, backend_->back_buffer_resource(), GraphState::render_target);
+    graph->write(meshes_pass, backend_->depth_stencil_resource(), GraphState::depth_write);
+    for (const BenchScene& scene : scenes_) {
+        const std::string name = scene.name;
+        backend_->record_pass(meshes_pass, [name](NullCommandDevice::List list) {
+            list->command("SetPipelineState model");
+            list->command("DrawIndexedInstanced " + name);
+        });
+    }
+}
+
+void HeadlessComponent::destroy_resources()
+{
+    voxel_frame_.clear();
+    scenes_.clear();
+    geometry_ = VoxelizerGeometry{};
+    brick_count_ = 0;
+}
+
+std::string HeadlessComponent::report() const
+{
+    const double frames = double(std::max<uint64_t>(stats_.frames, 1));
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "grid " << settings_.grid_dimension << ", budget " << settings_.voxel_budget << " voxels, "
+       << geometry_.instance_table.instances().size() << " instances\n";
+    ss << "per frame: transform " << stats_.transform_ms / frames << " ms, schedule " << stats_.schedule_ms / frames
+       << " ms, voxelize " << stats_.voxelize_ms / frames << " ms\n";
+    ss << "per frame: " << stats_.bricks / frames << " bricks, " << stats_.voxels / frames << " voxels, "
+       << stats_.filled_voxels / frames << " filled, " << stats_.triangle_tests / frames << " triangle tests\n";
+    return ss.str();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "component/game_component.h"
+#include "render/null_backend.h"
+#include "math/world_transform.h"
+#include "voxels/cpu_voxelizer.h"
+#include "voxels/voxel_frame.h"
+#include "bench_scenes.h"
+
+// CPU work of an as4vxgi frame on NullBackend: procedural scenes in the VoxelFrame of AS4VXGI_Component, transform
+// stage of a moving instance, voxel update scheduling and CPU voxelization of the scheduled bricks in place of the fill dispatch.
+// Passes of AS4VXGI_Component are declared on the graph and recorded as null commands.
+// Camera orbits the grid and one instance rotates, so every frame refits, reschedules and voxelizes.
+// A replayed camera path of Game drives camera and the moving instance instead.
+class HeadlessComponent final : public GameComponent
+{
+public:
+    struct Settings
+    {
+        int32_t grid_dimension{ 128 };
+        uint32_t voxel_budget{ 64 * 1024 }; // voxels per frame, 0 - whole grid
+        float tree_cell_voxels{ 4.f };
+    };
+
+    struct Stats
+    {
+        uint64_t frames{ 0 };
+        double transform_ms{ 0.0 };
+        double schedule_ms{ 0.0 };
+        double voxelize_ms{ 0.0 };
+        uint64_t bricks{ 0 };        // scheduled over all frames
+        uint64_t voxels{ 0 };
+        uint64_t filled_voxels{ 0 };
+        uint64_t triangle_tests{ 0 };
+    };
+
+    HeadlessComponent(NullBackend* backend, const Settings& settings);
+    ~HeadlessComponent() override = default;
+
+    void initialize() override;
+    void draw() override;
+    void imgui() override {}
+    void reload() override {}
+    void update() override;
+    void destroy_resources() override;
+
+    const Stats& stats() const { return stats_; }
+    std::string report() const;
+private:
+    NullBackend* backend_;
+    Settings settings_;
+
+    // model space scenes, scene i is instance i of the table
+    std::vector<BenchScene> scenes_;
+    // instance table of the frame, read by the voxelizer
+    VoxelizerGeometry geometry_;
+    WorldGeometry world_;
+
+    VoxelFrame voxel_frame_;
+    CpuVoxelizer voxelizer_;
+    uint32_t brick_count_{ 0 };
+    GraphResource voxels_resource_{ 0 };
+
+    Stats stats_;
+};
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+#include "math/triangle_records.h"
+#include "bench_scenes.h"
+#include "kernel_benchmark.h"
+
+namespace
+{
+
+struct KernelQuery
+{
+    Ray ray;
+    uint32_t begin;
+    uint32_t end;
+};
+
+// deterministic, independent from std implementation
+struct Random
+{
+    uint32_t state{ 0x12345678u };
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float uniform(float min, float max)
+    {
+        return min + (max - min) * float(next() >> 8) / float(1u << 24);
+    }
+};
+
+// reference: one record at a time, same acceptance as test_node_triangles
+bool reference_closest(const std::vector<TriangleRecord>& records, const KernelQuery& query, float t_max, KernelHit& hit)
+{
+    bool found = false;
+    for (uint32_t i = query.begin; i < query.end; ++i) {
+        float u;
+        float v;
+        const float t = triangle_record_intersection(query.ray, records[i], u, v);
+        if (t > 0 && t < t_max && (!found || t < hit.t)) {
+            hit = { t, i, u, v };
+            found = true;
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+std::vector<KernelBenchmarkResult> run_triangle_kernel_benchmark(uint32_t query_count, float epsilon)
+{
+    constexpr float grid_size = 100.f;
+    constexpr uint32_t max_range = 512;
+    constexpr float t_max = grid_size;
+
+    const BenchScene scene = make_dense_scene(grid_size);
+    std::vector<TriangleRecord> records;
+    build_triangle_records(scene.geometry.positions, scene.geometry.indices, Matrix::Identity, records);
+    TriangleRecordPackets packets;
+    build_triangle_record_packets(records, packets);
+
+    // rays aim at a triangle inside the tested range, neighbouring triangles in range are on the same sphere
+    std::vector<KernelQuery> queries(query_count);
+    Random random;
+    for (KernelQuery& query : queries) {
+        const uint32_t triangle = random.next() % packets.count;
+        const uint32_t* index = &scene.geometry.indices[triangle * 3];
+        const Vector3 target = (scene.geometry.positions[index[0]] + scene.geometry.positions[index[1]] + scene.geometry.positions[index[2]]) / 3;
+        query.ray.origin = target + Vector3(random.uniform(-5, 5), random.uniform(-5, 5), random.uniform(-5, 5));
+        query.ray.direction = target - query.ray.origin;
+        // every fourth ray goes in random direction, mostly misses
+        if (random.next() % 4 == 0) {
+            query.ray.direction = Vector3(random.uniform(-1, 1), random.uniform(-1, 1), random.uniform(-1, 1));
+        }
+        query.ray.direction.Normalize();
+
+        const uint32_t length = 1 + random.next() % max_range;
+        query.begin = triangle - std::min(triangle, random.next() % length);
+        query.end = std::min(query.begin + length, packets.count);
+    }
+
+    std::vector<KernelHit> reference(queries.size());
+    std::vector<bool> reference_found(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        reference_found[i] = reference_closest(records, queries[i], t_max, reference[i]);
+    }
+
+    std::vector<KernelBenchmarkResult> results;
+    for (uint32_t level = 0; level < uint32_t(SimdLevel::count); ++level) {
+        const TriangleKernel kernel = triangle_kernel(SimdLevel(level));
+        if (kernel == nullptr) {
+            continue;
+        }
+
+        KernelBenchmarkResult result;
+        result.level = SimdLevel(level);
+        result.queries = query_count;
+
+        std::vector<KernelHit> hits(queries.size());
+        std::vector<bool> found(queries.size());
+        const auto time = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            found[i] = kernel(packets.data.data(), packets.stride, queries[i].begin, queries[i].end, kernel_ray(queries[i].ray), t_max, hits[i]);
+            result.tests += queries[i].end - queries[i].begin;
+        }
+        const float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+        result.ns_per_test = float(ms * 1e6 / std::max<double>(double(result.tests), 1));
+
+        for (size_t i = 0; i < queries.size(); ++i) {
+            if (found[i] != reference_found[i]) {
+                ++result.mismatches;
+                continue;
+            }
+            if (!found[i]) {
+                ++result.bit_exact;
+                continue;
+            }
+            ++result.hits;
+            const KernelHit& a = hits[i];
+            const KernelHit& b = reference[i];
+            if (a.record == b.record && a.t == b.t && a.u == b.u && a.v == b.v) {
+                ++result.bit_exact;
+                continue;
+            }
+            const float error = std::max(std::fabs(a.t - b.t), std::max(std::fabs(a.u - b.u), std::fabs(a.v - b.v)));
+            result.max_error = std::max(result.max_error, error);
+            // same t from a neighbouring triangle is a tie on the shared edge
+            if (error > epsilon && !(a.record != b.record && std::fabs(a.t - b.t) <= epsilon)) {
+                ++result.mismatches;
+            }
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+std::string format_kernel_benchmark(const std::vector<KernelBenchmarkResult>& results)
+{
+    std::stringstream ss;
+    ss << std::left << std::setw(10) << "kernel" << std::right << std::setw(12) << "ns/test" << std::setw(14) << "tests"
+       << std::setw(10) << "hits" << std::setw(12) << "bit exact" << std::setw(12) << "mismatch" << std::setw(12) << "max error" << "\n";
+    for (const KernelBenchmarkResult& result : results) {
+        ss << std::left << std::setw(10) << simd_level_name(result.level) << std::right << std::fixed
+           << std::setw(12) << std::setprecision(3) << result.ns_per_test
+           << std::setw(14) << result.tests
+           << std::setw(10) << result.hits
+           << std::setw(12) << result.bit_exact
+           << std::setw(12) << result.mismatches
+           << std::setw(12) << std::scientific << std::setprecision(2) << result.max_error << "\n";
+    }
+    return ss.str();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "math/triangle_kernels.h"
+
+struct KernelBenchmarkResult
+{
+    SimdLevel level{ SimdLevel::scalar };
+    float ns_per_test{ 0.f };
+    uint64_t tests{ 0 };
+    uint32_t queries{ 0 };
+    uint32_t hits{ 0 };
+
+    // against one by one triangle_record_intersection
+    uint32_t mismatches{ 0 };   // different hit or miss, or error above epsilon
+    uint32_t bit_exact{ 0 };    // queries with identical t, u, v and record
+    float max_error{ 0.f };     // max of t, u, v absolute differences
+};
+
+// one ray against ranges of triangle records of the dense scene, every supported kernel
+// ranges have random begin and length, so partial packets are covered
+std::vector<KernelBenchmarkResult> run_triangle_kernel_benchmark(uint32_t query_count = 20000, float epsilon = 1e-5f);
+
+std::string format_kernel_benchmark(const std::vector<KernelBenchmarkResult>& results);
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+
+#include "voxels/cpu_voxelizer.h"
+#include "math/triangle_records.h"
+#include "math/triangle_kernels.h"
+#include "math/world_transform.h"
+#include "bench_scenes.h"
+#include "voxelizer_benchmark.h"
+
+namespace
+{
+
+// bricks spread evenly over the grid, deterministic
+std::vector<uint32_t> sample_bricks(uint32_t brick_count, uint32_t count)
+{
+    std::vector<uint32_t> result;
+    count = std::min(count, brick_count);
+    for (uint32_t i = 0; i < count; ++i) {
+        result.push_back(uint32_t(uint64_t(brick_count) * (2 * i + 1) / (2 * count)));
+    }
+    return result;
+}
+
+BenchmarkResult make_result(const BenchScene& scene, const char* variant, const CpuVoxelizer::Stats& stats)
+{
+    BenchmarkResult result;
+    result.scene = scene.name;
+    result.variant = variant;
+    result.prepare_ms = stats.binning_ms;
+    result.run_ms = stats.voxelize_ms;
+    result.voxels = stats.voxels;
+    result.triangle_tests = stats.triangle_tests;
+    result.node_visits = stats.node_visits;
+    result.filled_voxels = stats.filled_voxels;
+    return result;
+}
+
+} // namespace
+
+std::vector<BenchmarkResult> run_binning_benchmark(int32_t grid_dimension, uint32_t brute_force_bricks)
+{
+    constexpr float grid_size = 100.f;
+
+    std::vector<BenchmarkResult> results;
+    for (const BenchScene& scene : { make_dense_scene(grid_size), make_sparse_scene(grid_size) }) {
+        const VoxelGridFrame grid = VoxelGridFrame::from_camera(scene.camera_position, scene.camera_forward, scene.grid_size, grid_dimension);
+
+        CpuVoxelizer voxelizer;
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::binned);
+        results.push_back(make_result(scene, "binned", voxelizer.stats()));
+
+        const uint32_t bricks_per_axis = uint32_t((grid_dimension + VOXEL_BRICK_DIM - 1) / VOXEL_BRICK_DIM);
+        const std::vector<uint32_t> bricks = sample_bricks(bricks_per_axis * bricks_per_axis * bricks_per_axis, brute_force_bricks);
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::binned, &bricks);
+        results.push_back(make_result(scene, "binned, sampled bricks", voxelizer.stats()));
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::brute_force, &bricks);
+        results.push_back(make_result(scene, "brute force, sampled bricks", voxelizer.stats()));
+    }
+    return results;
+}
+
+std::vector<BenchmarkResult> run_traversal_benchmark(int32_t grid_dimension, uint32_t sampled_bricks, float tree_cell_voxels)
+{
+    constexpr float grid_size = 100.f;
+
+    std::vector<BenchScene> scenes;
+    scenes.push_back(make_dense_scene(grid_size));
+    scenes.push_back(make_sparse_scene(grid_size));
+
+    std::vector<BenchmarkResult> results;
+    for (BenchScene& scene : scenes) {
+        const VoxelGridFrame grid = VoxelGridFrame::from_camera(scene.camera_position, scene.camera_forward, scene.grid_size, grid_dimension);
+        build_scene_tree(scene, grid.unit * tree_cell_voxels);
+
+        const uint32_t bricks_per_axis = uint32_t((grid_dimension + VOXEL_BRICK_DIM - 1) / VOXEL_BRICK_DIM);
+        const std::vector<uint32_t> bricks = sample_bricks(bricks_per_axis * bricks_per_axis * bricks_per_axis, sampled_bricks);
+
+        CpuVoxelizer voxelizer;
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::tree_linear, &bricks);
+        results.push_back(make_result(scene, "tree linear walk", voxelizer.stats()));
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::tree_stack, &bricks);
+        results.push_back(make_result(scene, "tree stack", voxelizer.stats()));
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::tree_threaded, &bricks);
+        results.push_back(make_result(scene, "tree threaded", voxelizer.stats()));
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::binned, &bricks);
+        results.push_back(make_result(scene, "binned", voxelizer.stats()));
+    }
+    return results;
+}
+
+std::vector<BenchmarkResult> run_triangle_record_benchmark(int32_t grid_dimension, uint32_t sampled_bricks, float tree_cell_voxels)
+{
+    constexpr float grid_size = 100.f;
+
+    std::vector<BenchScene> scenes;
+    scenes.push_back(make_dense_scene(grid_size));
+    scenes.push_back(make_sparse_scene(grid_size));
+
+    std::vector<BenchmarkResult> results;
+    for (BenchScene& scene : scenes) {
+        const VoxelGridFrame grid = VoxelGridFrame::from_camera(scene.camera_position, scene.camera_forward, scene.grid_size, grid_dimension);
+        build_scene_tree(scene, grid.unit * tree_cell_voxels);
+
+        const auto time = std::chrono::steady_clock::now();
+        build_triangle_records(scene.geometry.positions, scene.geometry.indices, Matrix::Identity, scene.geometry.records);
+        const float records_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+
+        const uint32_t bricks_per_axis = uint32_t((grid_dimension + VOXEL_BRICK_DIM - 1) / VOXEL_BRICK_DIM);
+        const std::vector<uint32_t> bricks = sample_bricks(bricks_per_axis * bricks_per_axis * bricks_per_axis, sampled_bricks);
+
+        CpuVoxelizer voxelizer;
+        for (CpuVoxelizer::Mode mode : { CpuVoxelizer::Mode::tree_stack, CpuVoxelizer::Mode::binned }) {
+            const char* mode_name = (mode == CpuVoxelizer::Mode::tree_stack) ? "tree stack" : "binned";
+
+            voxelizer.set_use_triangle_records(false);
+            voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, mode, &bricks);
+            results.push_back(make_result(scene, (std::string(mode_name) + ", vertex fetch").c_str(), voxelizer.stats()));
+
+            voxelizer.set_use_triangle_records(true);
+            voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, mode, &bricks);
+            results.push_back(make_result(scene, (std::string(mode_name) + ", records").c_str(), voxelizer.stats()));
+            results.back().prepare_ms += records_ms;
+        }
+    }
+    return results;
+}
+
+std::vector<BenchmarkResult> run_kernel_voxelizer_benchmark(int32_t grid_dimension, uint32_t sampled_bricks, float tree_cell_voxels)
+{
+    constexpr float grid_size = 100.f;
+
+    BenchScene scene = make_dense_scene(grid_size);
+    const VoxelGridFrame grid = VoxelGridFrame::from_camera(scene.camera_position, scene.camera_forward, scene.grid_size, grid_dimension);
+    build_scene_tree(scene, grid.unit * tree_cell_voxels);
+    build_triangle_records(scene.geometry.positions, scene.geometry.indices, Matrix::Identity, scene.geometry.records);
+    build_triangle_record_packets(scene.geometry.records, scene.geometry.record_packets);
+
+    const uint32_t bricks_per_axis = uint32_t((grid_dimension + VOXEL_BRICK_DIM - 1) / VOXEL_BRICK_DIM);
+    const std::vector<uint32_t> bricks = sample_bricks(bricks_per_axis * bricks_per_axis * bricks_per_axis, sampled_bricks);
+
+    std::vector<BenchmarkResult> results;
+    CpuVoxelizer voxelizer;
+    voxelizer.set_use_triangle_records(true);
+    voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::tree_stack, &bricks);
+    results.push_back(make_result(scene, "tree stack, records", voxelizer.stats()));
+    for (uint32_t level = 0; level < uint32_t(SimdLevel::count); ++level) {
+        const TriangleKernel kernel = triangle_kernel(SimdLevel(level));
+        if (kernel == nullptr) {
+            continue;
+        }
+        voxelizer.set_triangle_kernel(kernel);
+        voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::tree_stack, &bricks);
+        results.push_back(make_result(scene, (std::string("tree stack, kernel ") + simd_level_name(SimdLevel(level))).c_str(), voxelizer.stats()));
+    }
+    return results;
+}
+
+std::vector<BenchmarkResult> run_world_transform_benchmark(int32_t grid_dimension, uint32_t sampled_bricks, float tree_cell_voxels)
+{
+    constexpr float grid_size = 100.f;
+
+    // dense scene is model space of a rotated and shifted instance
+    BenchScene scene = make_dense_scene(grid_size);
+    const VoxelGridFrame grid = VoxelGridFrame::from_camera(scene.camera_position, scene.camera_forward, scene.grid_size, grid_dimension);
+    build_scene_tree(scene, grid.unit * tree_cell_voxels);
+    const Matrix transform = Matrix::CreateRotationY(0.5f) * Matrix::CreateTranslation(grid.unit * 1.5f, 0.f, 0.f);
+
+    WorldGeometry world;
+    WorldTransformStats world_stats;
+    update_world_geometry(scene.geometry.positions, scene.geometry.indices, scene.geometry.tree, transform, world, &world_stats);
+
+    VoxelizerGeometry world_geometry;
+    world_geometry.positions = world.positions;
+    world_geometry.normals.resize(scene.geometry.normals.size());
+    Vector3::TransformNormal(scene.geometry.normals.data(), scene.geometry.normals.size(), transform.Invert().Transpose(),
+                             world_geometry.normals.data());
+    world_geometry.indices = scene.geometry.indices;
+    world_geometry.tree = world.tree;
+    world_geometry.threaded_tree = world.threaded_tree;
+    world_geometry.records = world.records;
+    build_triangle_record_packets(world_geometry.records, world_geometry.record_packets);
+
+    const uint32_t bricks_per_axis = uint32_t((grid_dimension + VOXEL_BRICK_DIM - 1) / VOXEL_BRICK_DIM);
+    const std::vector<uint32_t> bricks = sample_bricks(bricks_per_axis * bricks_per_axis * bricks_per_axis, sampled_bricks);
+
+    std::vector<BenchmarkResult> results;
+    CpuVoxelizer voxelizer;
+    voxelizer.set_per_test_transform(&transform);
+    voxelizer.voxelize(grid, VOXEL_BRICK_DIM, scene.geometry, CpuVoxelizer::Mode::tree_stack, &bricks);
+    results.push_back(make_result(scene, "tree stack, per test transform", voxelizer.stats()));
+    // eight box corners per node visit, three vertices per triangle test
+    results.back().point_transforms = 8 * voxelizer.stats().node_visits + 3 * voxelizer.stats().triangle_tests;
+
+    voxelizer.set_per_test_transform(nullptr);
+    voxelizer.voxelize(grid, VOXEL_BRICK_DIM, world_geometry, CpuVoxelizer::Mode::tree_stack, &bricks);
+    results.push_back(make_result(scene, "tree stack, world space", voxelizer.stats()));
+    results.back().prepare_ms += world_stats.transform_ms + world_stats.refit_ms;
+
+    voxelizer.set_use_triangle_records(true);
+    voxelizer.voxelize(grid, VOXEL_BRICK_DIM, world_geometry, CpuVoxelizer::Mode::tree_stack, &bricks);
+    results.push_back(make_result(scene, "tree stack, world space records", voxelizer.stats()));
+    results.back().prepare_ms += world_stats.transform_ms + world_stats.refit_ms + world_stats.records_ms;
+
+    const SimdLevel level = supported_simd_level();
+    voxelizer.set_triangle_kernel(triangle_kernel(level));
+    voxelizer.voxelize(grid, VOXEL_BRICK_DIM, world_geometry, CpuVoxelizer::Mode::tree_stack, &bricks);
+    results.push_back(make_result(scene, (std::string("tree stack, world space ") + simd_level_name(level)).c_str(), voxelizer.stats()));
+    results.back().prepare_ms += world_stats.transform_ms + world_stats.refit_ms + world_stats.records_ms;
+    return results;
+}
+
+std::string format_benchmark(const std::vector<BenchmarkResult>& results)
+{
+    std::stringstream ss;
+    ss << std::left << std::setw(10) << "scene" << std::setw(34) << "variant" << std::right
+       << std::setw(12) << "prepare ms" << std::setw(12) << "run ms" << std::setw(12) << "ns/voxel"
+       << std::setw(14) << "tests/voxel" << std::setw(14) << "nodes/voxel" << std::setw(14) << "xforms/voxel"
+       << std::setw(10) << "filled" << "\n";
+    for (const BenchmarkResult& result : results) {
+        const double voxels = std::max<double>(result.voxels, 1);
+        ss << std::left << std::setw(10) << result.scene << std::setw(34) << result.variant << std::right << std::fixed
+           << std::setw(12) << std::setprecision(3) << result.prepare_ms
+           << std::setw(12) << std::setprecision(3) << result.run_ms
+           << std::setw(12) << std::setprecision(1) << result.run_ms * 1e6 / voxels
+           << std::setw(14) << std::setprecision(1) << result.triangle_tests / voxels
+           << std::setw(14) << std::setprecision(1) << result.node_visits / voxels
+           << std::setw(14) << std::setprecision(1) << result.point_transforms / voxels
+           << std::setw(10) << result.filled_voxels << "\n";
+    }
+    return ss.str();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct BenchmarkResult
+{
+    std::string scene;
+    std::string variant;
+    float prepare_ms{ 0.f }; // per frame preprocessing (binning, transforms, ...)
+    float run_ms{ 0.f };
+    uint32_t voxels{ 0 };
+    uint64_t triangle_tests{ 0 };
+    uint64_t node_visits{ 0 };
+    uint32_t filled_voxels{ 0 };
+    uint64_t point_transforms{ 0 }; // matrix by point products inside the voxel loop
+};
+
+// binned vs brute force voxelization on dense and sparse scenes
+// brute force runs only on brute_force_bricks sampled bricks, compare per voxel columns
+std::vector<BenchmarkResult> run_binning_benchmark(int32_t grid_dimension, uint32_t brute_force_bricks = 2);
+
+// stack and stackless mesh tree traversals vs old linear walk on sampled bricks
+// trees are split down to tree_cell_voxels voxels, so large scenes produce deep trees
+std::vector<BenchmarkResult> run_traversal_benchmark(int32_t grid_dimension, uint32_t sampled_bricks = 8, float tree_cell_voxels = 4.f);
+
+// precomputed triangle records vs vertex fetches, stack traversal and binning on sampled bricks
+// prepare time of record variants is record building
+std::vector<BenchmarkResult> run_triangle_record_benchmark(int32_t grid_dimension, uint32_t sampled_bricks = 8, float tree_cell_voxels = 4.f);
+
+// stack traversal over triangle records with every supported SIMD kernel on sampled bricks
+std::vector<BenchmarkResult> run_kernel_voxelizer_benchmark(int32_t grid_dimension, uint32_t sampled_bricks = 8, float tree_cell_voxels = 4.f);
+
+// model space geometry transformed on every node and triangle test vs world space geometry prepared once
+// by update_world_geometry, stack traversal of a rotated dense scene on sampled bricks
+// prepare time of pre-transformed variants is the transform stage, paid only when instance moves
+std::vector<BenchmarkResult> run_world_transform_benchmark(int32_t grid_dimension, uint32_t sampled_bricks = 8, float tree_cell_voxels = 4.f);
+
+std::string format_benchmark(const std::vector<BenchmarkResult>& results);
@@ -0,0 +1,103 @@
+// Frame loop of as4vxgi without window and GPU: Game runs on NullBackend for a fixed number of frames
+// and prints where the CPU time of a frame goes; profiler zones of the last frames go to a Chrome trace on request,
+// frame timings by phase to <path>.csv and <path>.json for regression jobs.
+// Camera and moving instance follow a recorded camera path with --replay, one frame per path frame,
+// --record writes the path of the run for later replays.
+//
+// as4vxgi_headless [--frames <count>] [--grid <dimension>] [--budget <voxels per frame>] [--trace <json>] [--timings <path>]
+//                  [--record <path> | --replay <path>]
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "core/game.h"
+#include "core/profiler.h"
+#include "render/null_backend.h"
+#include "bench/headless_component.h"
+
+namespace
+{
+int usage()
+{
+    fprintf(stderr, "usage: as4vxgi_headless [--frames <count>] [--grid <dimension>] [--budget <voxels per frame>] [--trace <json>] [--timings <path>]\n"
+                    "                        [--record <path> | --replay <path>]\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = 60;
+    HeadlessComponent::Settings settings;
+    std::string trace;
+    std::string timings;
+    std::string record;
+    std::string replay;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (argument == "--frames" && has_value) {
+            frames = uint32_t(strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--grid" && has_value) {
+            settings.grid_dimension = int32_t(strtol(argv[++i], nullptr, 10));
+        } else if (argument == "--budget" && has_value) {
+            settings.voxel_budget = uint32_t(strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--trace" && has_value) {
+            trace = argv[++i];
+        } else if (argument == "--timings" && has_value) {
+            timings = argv[++i];
+        } else if (argument == "--record" && has_value) {
+            record = argv[++i];
+        } else if (argument == "--replay" && has_value) {
+            replay = argv[++i];
+        } else {
+            return usage();
+        }
+    }
+    if (frames == 0 || settings.grid_dimension <= 0 || (!record.empty() && !replay.empty())) {
+        return usage();
+    }
+
+    CameraPath& camera_path = Game::inst()->camera_path();
+    if (!replay.empty()) {
+        if (!camera_path.load(replay) || camera_path.frame_count() == 0) {
+            fprintf(stderr, "%s: can't read camera path\n", replay.c_str());
+            return 1;
+        }
+        frames = uint32_t(camera_path.frame_count());
+    }
+
+    auto backend = std::make_unique<NullBackend>(frames);
+    NullBackend* null_backend = backend.get();
+    HeadlessComponent component(null_backend, settings);
+
+    Game::inst()->set_backend(std::move(backend));
+    Game::inst()->add_component(&component);
+    Game::inst()->set_frame_timings_path(timings);
+    if (!Game::inst()->initialize(1280, 720)) {
+        return 1;
+    }
+    if (!replay.empty()) {
+        camera_path.start_replay();
+    } else if (!record.empty()) {
+        camera_path.start_recording();
+    }
+    Game::inst()->run();
+    if (!record.empty()) {
+        camera_path.stop();
+        if (!camera_path.save(record)) {
+            fprintf(stderr, "%s: can't write camera path\n", record.c_str());
+        }
+    }
+
+    printf("%s%s%s", component.report().c_str(), null_backend->report().c_str(), Game::inst()->frame_timings().report().c_str());
+    printf("%.1f ns per profiler zone\n%s", Profiler::inst().measure_zone_overhead(), Profiler::inst().report().c_str());
+    if (!trace.empty() && !Profiler::inst().write_chrome_trace(trace)) {
+        fprintf(stderr, "%s: can't write trace\n", trace.c_str());
+    }
+    // writes the frame timings
+    Game::inst()->destroy();
+    return 0;
+}
@@ -1,5 +1,9 @@
 #include <Windows.h>
+#include <memory>
+#include <cstring>
 #include "core/game.h"
+#include "render/d3d12_backend.h"
+#include "render/render.h"
 #include "as4vxgi.h"
 
 #pragma comment(lib, "d3d12.lib")
@@ -7,7 +11,7 @@
 #pragma comment(lib, "d3dcompiler.lib")
 #pragma comment(lib, "dxguid.lib")
 
-int WINAPI WinMain(HINSTANCE, HINSTANCE, char*, int)
+int WINAPI WinMain(HINSTANCE, HINSTANCE, char* command_line, int)
 {
     // FILE* pix;
     // fopen_s(&pix, "WinPixGpuCapturer.dll", "r");
@@ -16,7 +20,14 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, char*, int)
     //     LoadLibrary("WinPixGpuCapturer.dll");
     // }
 
+    Game::inst()->set_backend(std::make_unique<D3D12Backend>());
+    // --static-in-upload-heap: old placement of static geometry, to compare with default heap
+    ResidencyPolicy::Settings residency;
+    residency.static_in_upload_heap = strstr(command_line, "--static-in-upload-heap") != nullptr;
+    Game::inst()->render().set_residency_settings(residency);
     Game::inst()->add_component(new AS4VXGI_Component{});
+    // written on exit and on F9
+    Game::inst()->set_frame_timings_path("./frame_timings");
 
     Game::inst()->initialize(1280, 720);
     Game::inst()->run();
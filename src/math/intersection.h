@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+struct Ray
+{
+    Vector3 origin;
+    Vector3 direction;
+};
+
+// CPU port of triangleIntersection from fill.hlsl
+// returns distance along the ray, 0 - no hit; u and v are barycentrics of v1 and v2
+inline float triangle_intersection(const Ray& ray, const Vector3& v0, const Vector3& v1, const Vector3& v2, float& u, float& v)
+{
+    const Vector3 edge1 = v1 - v0;
+    const Vector3 edge2 = v2 - v0;
+
+    const float e11 = edge1.Dot(edge1);
+    const float e22 = edge2.Dot(edge2);
+    const float e12 = edge1.Dot(edge2);
+    const float denominator = e11 * e22 - e12 * e12; // squared doubled area
+    if (denominator <= 1e-7f * e11 * e22) {
+        // degenerate triangle, the barycentric basis below would explode
+        return 0.f;
+    }
+
+    Vector3 normal = edge1.Cross(edge2);
+    normal = normal / normal.Length();
+
+    const float dn = ray.direction.Dot(normal);
+    if (dn == 0.f) {
+        return 0.f;
+    }
+
+    const float t = -(ray.origin.Dot(normal) - v0.Dot(normal)) / dn;
+    if (t < 0.f) {
+        return 0.f;
+    }
+
+    const Vector3 u1 = (edge1 * e22 - edge2 * e12) / denominator;
+    const Vector3 v1_basis = (edge2 * e11 - edge1 * e12) / denominator;
+
+    const Vector3 p = ray.origin + ray.direction * t;
+    u = (p - v0).Dot(u1);
+    if (u < 0.f || u > 1.f) {
+        return 0.f;
+    }
+    v = (p - v0).Dot(v1_basis);
+    if (v < 0.f || v > 1.f || u + v > 1.f) {
+        return 0.f;
+    }
+    return t;
+}
+
+// distances to the planes of one axis, same as box_intersection of fill.hlsl
+// a ray parallel to the axis is inside the slab along all of its length if the origin is, faces included,
+// and nowhere otherwise; the epsilon of inverse_direction would clip a ray starting on the max face at 0
+inline void slab_intersection(float min, float max, float origin, float direction, float inv_direction, float& t_near, float& t_far)
+{
+    if (direction == 0.f) {
+        t_near = origin >= min && origin <= max ? -FLT_MAX : FLT_MAX;
+        t_far = FLT_MAX;
+        return;
+    }
+    const float t0 = (min - origin) * inv_direction;
+    const float t1 = (max - origin) * inv_direction;
+    t_near = std::min(t0, t1);
+    t_far = std::max(t0, t1);
+}
+
+// slab test, returns false if ray misses box inside [0, t_max]
+// t_entry is distance to the box entry point, 0 if ray starts inside
+inline bool box_intersection(const Ray& ray, const Vector3& inv_direction, const Vector3& min, const Vector3& max, float t_max, float& t_entry)
+{
+    float tx0, tx1, ty0, ty1, tz0, tz1;
+    slab_intersection(min.x, max.x, ray.origin.x, ray.direction.x, inv_direction.x, tx0, tx1);
+    slab_intersection(min.y, max.y, ray.origin.y, ray.direction.y, inv_direction.y, ty0, ty1);
+    slab_intersection(min.z, max.z, ray.origin.z, ray.direction.z, inv_direction.z, tz0, tz1);
+
+    const float t_near = std::max(std::max(tx0, ty0), std::max(tz0, 0.f));
+    const float t_far = std::min(std::min(tx1, ty1), std::min(tz1, t_max));
+
+    t_entry = t_near;
+    return t_near <= t_far;
+}
+
+// zero components are replaced by epsilon as in fill.hlsl, no inf or NaN reaches the slab test
+inline Vector3 inverse_direction(const Vector3& direction)
+{
+    const float epsilon = 0.000001f;
+    return Vector3(1.f / (direction.x == 0.f ? epsilon : direction.x),
+                   1.f / (direction.y == 0.f ? epsilon : direction.y),
+                   1.f / (direction.z == 0.f ? epsilon : direction.z));
+}
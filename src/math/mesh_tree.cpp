@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+
+#include "core/profiler.h"
+#include "mesh_tree.h"
+
+namespace
+{
+
+class MeshTreeBuilder
+{
+public:
+    MeshTreeBuilder(std::vector<uint32_t>& indices, const std::vector<Vector3>& positions, float smallest_length)
+        : indices_(indices), positions_(positions), smallest_length_(smallest_length)
+    {
+    }
+
+    void build(const float min[3], const float max[3], std::vector<MeshTreeNode>& nodes)
+    {
+        mesh_tree_.reserve(indices_.size() / 3);
+        split_vertices(min, max, 0, int32_t(indices_.size()), 0);
+
+        uint32_t max_index = 0;
+        for (auto& node : mesh_tree_) {
+            max_index = std::max<uint32_t>(node.first, max_index);
+        }
+
+        // 0 - root index, already present
+        // max_index - last present index, don't check it
+        for (uint32_t i = 1; i < max_index; ++i) {
+            auto it = mesh_tree_.find(i);
+            if (it == mesh_tree_.end()) {
+                uint32_t parent_index = (i - 1) / 2;
+                MeshTreeNode parent = mesh_tree_[parent_index];
+
+                const float length[3] = { max[0] - min[0], max[1] - min[1], max[2] - min[2] };
+                const float mean[3] = { (max[0] + min[0]) / 2, (max[1] + min[1]) / 2, (max[2] + min[2]) / 2 };
+                int32_t split_index = -1;
+                if (length[0] >= length[1] && length[0] >= length[2] && length[0] > smallest_length_) {
+                    split_index = 0;
+                } else if (length[1] >= length[0] && length[1] >= length[2] && length[1] > smallest_length_) {
+                    split_index = 1;
+                } else if (length[2] >= length[0] && length[2] >= length[1] && length[2] > smallest_length_) {
+                    split_index = 2;
+                }
+
+                float node_min[3] = { parent.min.x, parent.min.y, parent.min.z };
+                float node_max[3] = { parent.max.x, parent.max.y, parent.max.z };
+                if (split_index != -1) {
+                    if (i & 1) {
+                        node_max[split_index] = mean[split_index];
+                    } else {
+                        node_min[split_index] = mean[split_index];
+                    }
+                }
+
+                MeshTreeNode node{};
+                node.min = Vector3(node_min);
+                node.max = Vector3(node_max);
+                node.start_index = 0;
+                node.count = 0;
+
+                mesh_tree_[i] = node;
+            }
+        }
+
+        nodes.resize(mesh_tree_.size());
+        for (uint32_t i = 0; i < nodes.size(); ++i) {
+            nodes[i] = mesh_tree_.at(i);
+        }
+    }
+private:
+    void split_vertices(const float min[3], const float max[3], int32_t start, int32_t count, int32_t current_mesh_node_index)
+    {
+        if (count == 0) {
+            return;
+        }
+
+        const float length[3] = { max[0] - min[0], max[1] - min[1], max[2] - min[2] };
+        const float mean[3] = { (max[0] + min[0]) / 2, (max[1] + min[1]) / 2, (max[2] + min[2]) / 2 };
+        int32_t split_index = -1;
+        if (length[0] >= length[1] && length[0] >= length[2] && length[0] > smallest_length_) {
+            split_index = 0;
+        } else if (length[1] >= length[0] && length[1] >= length[2] && length[1] > smallest_length_) {
+            split_index = 1;
+        } else if (length[2] >= length[0] && length[2] >= length[1] && length[2] > smallest_length_) {
+            split_index = 2;
+        }
+
+        // radix sort
+
+        std::vector<uint32_t> indices[3]; // 0 - parent, 1 - less child, 2 - greater child
+        for (int32_t i = 0; i < 3; ++i) {
+            indices[i].reserve(count);
+        }
+        for (int32_t i = start; i < start + count; i += 3) {
+            const uint32_t triangle_indices[3] = { indices_[i + 0], indices_[i + 1], indices_[i + 2] };
+            const float triangle[3][3] = {
+                { positions_[triangle_indices[0]].x, positions_[triangle_indices[0]].y, positions_[triangle_indices[0]].z },
+                { positions_[triangle_indices[1]].x, positions_[triangle_indices[1]].y, positions_[triangle_indices[1]].z },
+                { positions_[triangle_indices[2]].x, positions_[triangle_indices[2]].y, positions_[triangle_indices[2]].z }
+            };
+            int32_t target = 0;
+            if (split_index != -1 && triangle[0][split_index] < mean[split_index] && triangle[1][split_index] < mean[split_index] && triangle[2][split_index] < mean[split_index]) {
+                target = 1;
+            } else if (split_index != -1 && triangle[0][split_index] > mean[split_index] && triangle[1][split_index] > mean[split_index] && triangle[2][split_index] > mean[split_index]) {
+                target = 2;
+            }
+            indices[target].insert(indices[target].end(), triangle_indices, triangle_indices + 3);
+        }
+
+        const int32_t indices_count[3] = { (int32_t)indices[0].size(), (int32_t)indices[1].size(), (int32_t)indices[2].size() };
+
+        MeshTreeNode node;
+        node.min = Vector3(min);
+        node.max = Vector3(max);
+        node.start_index = start;
+        node.count = indices_count[0];
+        mesh_tree_[current_mesh_node_index] = node;
+
+        {
+            int32_t offset = start;
+            for (int32_t i = 0; i < 3; ++i) {
+                if (indices_count[i] != 0) {
+                    memcpy(&indices_[offset], indices[i].data(), indices_count[i] * sizeof(uint32_t));
+                }
+                offset += indices_count[i];
+            }
+        }
+
+        if (split_index != -1) {
+            int32_t offset = start + indices_count[0];
+            for (int32_t i = 0; i < 2; ++i) {
+                float new_min[3];
+                float new_max[3];
+
+                memcpy(new_min, min, sizeof(float) * 3);
+                memcpy(new_max, max, sizeof(float) * 3);
+
+                if (i == 0) {
+                    new_max[split_index] = mean[split_index];
+                } else {
+                    new_min[split_index] = mean[split_index];
+                }
+
+                // children:
+                // (2i + 1) and (2i + 2)
+                // parent:
+                // (i - 1) / 2
+                split_vertices(new_min, new_max, offset, indices_count[i + 1], 2 * current_mesh_node_index + 1 + i);
+                offset += indices_count[i + 1];
+            }
+        }
+    }
+
+    std::vector<uint32_t>& indices_;
+    const std::vector<Vector3>& positions_;
+    const float smallest_length_;
+
+    std::unordered_map<int32_t, MeshTreeNode> mesh_tree_;
+};
+
+} // namespace
+
+void build_mesh_tree(std::vector<uint32_t>& indices, const std::vector<Vector3>& positions,
+                     const float min[3], const float max[3], float smallest_length,
+                     std::vector<MeshTreeNode>& nodes)
+{
+    PROFILE_ZONE("Build mesh tree");
+    assert(std::all_of(indices.begin(), indices.end(), [&positions](uint32_t index) { return index < positions.size(); }));
+    MeshTreeBuilder(indices, positions, smallest_length).build(min, max, nodes);
+    // fill.hlsl keeps one pending node per level on its traversal stack
+    assert(mesh_tree_depth(uint32_t(nodes.size())) < MESH_TREE_STACK_SIZE);
+}
+
+void build_threaded_tree(const std::vector<MeshTreeNode>& tree, std::vector<ThreadedTreeNode>& nodes)
+{
+    PROFILE_ZONE("Build threaded tree");
+    nodes.clear();
+    if (tree.empty()) {
+        return;
+    }
+
+    // triangles in subtree, children are always after parents in heap order
+    std::vector<uint32_t> subtree_count(tree.size());
+    for (size_t i = tree.size(); i-- > 0;) {
+        subtree_count[i] = uint32_t(tree[i].count);
+        for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < tree.size(); ++child) {
+            subtree_count[i] += subtree_count[child];
+        }
+    }
+
+    // pre-order walk, skip of a node is patched when its subtree is done
+    struct Entry
+    {
+        uint32_t heap_index;
+        uint32_t threaded_index; // ~0u - node is not emitted yet
+    };
+    std::vector<Entry> stack;
+    stack.push_back({ 0, ~0u });
+    while (!stack.empty()) {
+        Entry& entry = stack.back();
+        if (entry.threaded_index != ~0u) {
+            nodes[entry.threaded_index].skip = uint32_t(nodes.size());
+            stack.pop_back();
+            continue;
+        }
+
+        const MeshTreeNode& node = tree[entry.heap_index];
+        entry.threaded_index = uint32_t(nodes.size());
+
+        ThreadedTreeNode threaded{};
+        threaded.min = node.min;
+        threaded.start_index = node.start_index;
+        threaded.max = node.max;
+        threaded.count = node.count;
+        nodes.push_back(threaded);
+
+        // right child is pushed first, so left one is emitted right after the parent
+        const uint32_t heap_index = entry.heap_index;
+        for (uint32_t child = 2 * heap_index + 2; child >= 2 * heap_index + 1; --child) {
+            if (child < tree.size() && subtree_count[child] > 0) {
+                stack.push_back({ child, ~0u });
+            }
+        }
+    }
+}
+
+float mesh_tree_smallest_length(const float min[3], const float max[3])
+{
+    return (std::min<float>(max[0] - min[0],
+            std::min<float>(max[1] - min[1],
+                            max[2] - min[2]))) / 2;
+}
+
+uint32_t mesh_tree_depth(uint32_t node_count)
+{
+    uint32_t depth = 0;
+    while (node_count > 1) {
+        node_count /= 2;
+        ++depth;
+    }
+    return depth;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "shaders/common/types.fx"
+
+// mesh tree is an implicit binary heap: children of node i are 2i + 1 and 2i + 2
+// node keeps triangles that straddle its split plane, missing nodes are filled with empty ones
+// indices are reordered so that every node owns a contiguous range [start_index, start_index + count)
+void build_mesh_tree(std::vector<uint32_t>& indices, const std::vector<Vector3>& positions,
+                     const float min[3], const float max[3], float smallest_length,
+                     std::vector<MeshTreeNode>& nodes);
+
+// depth first copy of the heap tree with skip links, see ThreadedTreeNode
+// triangle ranges are shared with the heap tree, so it is traversed with the same indices
+void build_threaded_tree(const std::vector<MeshTreeNode>& tree, std::vector<ThreadedTreeNode>& nodes);
+
+// nodes stop splitting at half of the smallest mesh extent, rule used for loaded models
+float mesh_tree_smallest_length(const float min[3], const float max[3]);
+
+uint32_t mesh_tree_depth(uint32_t node_count);
@@ -1,12 +1,17 @@
 #define NOMINMAX
 
+#include <algorithm>
 #include <functional>
 #include <assimp/Importer.hpp>
 
 #include "core/game.h"
+#include "core/profiler.h"
 #include "render/common.h"
 #include "render/render.h"
 #include "render/camera.h"
+#include "render/resource/geometry_arena.h"
+#include "mesh_tree.h"
+#include "world_transform.h"
 #include "model_tree.h"
 
 void ModelTree::Mesh::initialize(//Material& material,
@@ -26,85 +31,15 @@ void ModelTree::Mesh::initialize(//Material& material,
     }
     index_count_ = static_cast<UINT>(indices.size());
 
-    const float smallest_length = (std::min<float>(max_[0] - min_[0],
-                                    std::min<float>(max_[1] - min_[1],
-                                                    max_[2] - min_[2]))) / 2;
-
-    mesh_tree_.reserve(index_count_ / 3);
-    split_vertices(min_, max_, 0, index_count_, 0, smallest_length);
-    uint32_t max_index = 0;
-    for (auto& node : mesh_tree_) {
-        max_index = std::max<uint32_t>(node.first, max_index);
-    }
-
-    // 0 - root index, already present
-    // max_index - last present index, don't check it
-    for (uint32_t i = 1; i < max_index; ++i) {
-        auto it = mesh_tree_.find(i);
-        if (it == mesh_tree_.end()) {
-            uint32_t parent_index = (i - 1) / 2;
-            MeshTreeNode parent = mesh_tree_[parent_index];
-
-            const float length[3] = { max[0] - min[0], max[1] - min[1], max[2] - min[2] };
-            const float mean[3] = { (max[0] + min[0]) / 2, (max[1] + min[1]) / 2, (max[2] + min[2]) / 2 };
-            int32_t split_index = -1;
-            if (length[0] >= length[1] && length[0] >= length[2] && length[0] > smallest_length) {
-                split_index = 0;
-            }
-            else if (length[1] >= length[0] && length[1] >= length[2] && length[1] > smallest_length) {
-                split_index = 1;
-            }
-            else if (length[2] >= length[0] && length[2] >= length[1] && length[2] > smallest_length) {
-                split_index = 2;
-            }
-
-            aiVector3D node_min;
-            aiVector3D node_max;
-            memcpy(&node_min, &parent.min, sizeof(float) * 3);
-            memcpy(&node_max, &parent.max, sizeof(float) * 3);
-
-            if (i & 1) {
-                node_max[split_index] = mean[split_index];
-            } else {
-                node_min[split_index] = mean[split_index];
-            }
-
-            MeshTreeNode node{};
-            memcpy(&node.min, &node_min, sizeof(float) * 3);
-            memcpy(&node.max, &node_max, sizeof(float) * 3);
-            node.start_index = 0;
-            node.count = 0;
-
-            mesh_tree_[i] = node;
-        }
+    positions_.reserve(vertices_.size());
+    for (const Vertex& vertex : vertices_) {
+        positions_.push_back(vertex.position);
     }
+    build_mesh_tree(indices_, positions_, min_, max_, mesh_tree_smallest_length(min_, max_), mesh_tree_);
 
     auto device = Game::inst()->render().device();
 
-    index_buffer_.initialize(indices_);
-    { // index buffer srv
-        index_buffer_srv_resource_index_ = Game::inst()->render().allocate_gpu_resource_descriptor(index_buffer_srv_, index_buffer_srv_gpu_);
-        D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
-        desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-        desc.Format = DXGI_FORMAT_UNKNOWN;
-        desc.Buffer.FirstElement = 0;
-        desc.Buffer.NumElements = UINT(indices_.size());
-        desc.Buffer.StructureByteStride = sizeof(UINT32);
-        desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        device->CreateShaderResourceView(index_buffer_.resource(), &desc, index_buffer_srv_);
-    }
-    vertex_buffer_.initialize(vertices_);
-    { // vertex buffer srv
-        vertex_buffer_srv_resource_index_ = Game::inst()->render().allocate_gpu_resource_descriptor(vertex_buffer_srv_, vertex_buffer_srv_gpu_);
-        D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
-        desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-        desc.Format = DXGI_FORMAT_UNKNOWN;
-        desc.Buffer.FirstElement = 0;
-        desc.Buffer.NumElements = UINT(vertices_.size());
-        desc.Buffer.StructureByteStride = sizeof(Vertex);
-        desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        device->CreateShaderResourceView(vertex_buffer_.resource(), &desc, vertex_buffer_srv_);
-    }
+    geometry_ = Game::inst()->render().geometry_arena()->allocate(vertices_, indices_);
 
 #ifndef NDEBUG
     std::vector<uint32_t> box_indices;
@@ -153,8 +88,8 @@ void ModelTree::Mesh::initialize(//Material& material,
 
     assert(box_indices.size() == 24); // 12 edges
 
-    box_index_buffer_.initialize(box_indices);
-    box_vertex_buffer_.initialize(box_vertices);
+    box_index_buffer_.initialize(box_indices, BufferUsage::static_data, "Mesh tree box indices");
+    box_vertex_buffer_.initialize(box_vertices, BufferUsage::static_data, "Mesh tree box vertices");
 
     std::vector<Matrix> box_transformations;
     for (int32_t i = 0; i < mesh_tree_.size(); ++i) {
@@ -186,7 +121,7 @@ void ModelTree::Mesh::initialize(//Material& material,
         HRESULT_CHECK(box_transformations_->Map(0, &range, &box_transformations_mapped_ptr_));
         memcpy(box_transformations_mapped_ptr_, box_transformations.data(), box_transformations.size() * sizeof(Matrix));
 
-        box_transformation_resource_index_ = Game::inst()->render().allocate_gpu_resource_descriptor(box_transformations_srv_, box_transformations_srv_gpu_);
+        box_transformation_range_ = Game::inst()->render().allocate_gpu_resource_descriptor(box_transformations_srv_, box_transformations_srv_gpu_);
 
         D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
         desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
@@ -203,10 +138,12 @@ void ModelTree::Mesh::initialize(//Material& material,
 
 void ModelTree::Mesh::destroy()
 {
+    Game::inst()->render().geometry_arena()->free(geometry_);
+#ifndef NDEBUG
+    Game::inst()->render().free_gpu_resource_descriptor(box_transformation_range_);
+#endif
 //     material_.destroy();
 //     index_count_ = 0;
-//     index_buffer_.destroy();
-//     vertex_buffer_.destroy();
 //     index_buffer_resource_view_.destroy();
 //     vertex_buffer_resource_view_.destroy();
 // 
@@ -239,8 +176,13 @@ const std::vector<Vertex>& ModelTree::Mesh::get_vertices() const
 
 void ModelTree::load(const std::string& file, Vector3 position, Quaternion rotation, Vector3 scale)
 {
+    PROFILE_ZONE("Load model");
     Assimp::Importer importer;
-    auto scene = importer.ReadFile(file, aiProcess_Triangulate | aiProcess_ConvertToLeftHanded | aiProcess_GenUVCoords);
+    const aiScene* scene = nullptr;
+    {
+        PROFILE_ZONE("Import model file");
+        scene = importer.ReadFile(file, aiProcess_Triangulate | aiProcess_ConvertToLeftHanded | aiProcess_GenUVCoords);
+    }
     assert(scene != nullptr);
     meshes_.reserve(scene->mNumMeshes);
     load_node(scene->mRootNode, scene);
@@ -259,16 +201,12 @@ void ModelTree::load(const std::string& file, Vector3 position, Quaternion rotat
         ds_state.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
         graphics_pipeline_.setup_depth_stencil_state(ds_state);
 
-        if (false) {
-            graphics_pipeline_.attach_vertex_shader(L"./resources/shaders/debug/albedo.hlsl", {});
-            graphics_pipeline_.attach_pixel_shader(L"./resources/shaders/debug/albedo.hlsl", {});
-        } else {
-            graphics_pipeline_.attach_vertex_shader(L"./resources/shaders/debug/normal.hlsl", {});
-            graphics_pipeline_.attach_pixel_shader(L"./resources/shaders/debug/normal.hlsl", {});
-        }
+        // albedo needs a texture the pipeline doesn't bind yet
+        const bool albedo = false;
+        const std::vector<std::wstring> defines = { albedo ? L"ALBEDO=1" : L"ALBEDO=0" };
+        graphics_pipeline_.attach_vertex_shader(L"./resources/shaders/debug/model.hlsl", defines);
+        graphics_pipeline_.attach_pixel_shader(L"./resources/shaders/debug/model.hlsl", defines);
 
-        graphics_pipeline_.declare_bind<CAMERA_DATA_BIND>();
-        graphics_pipeline_.declare_bind<MODEL_DATA_BIND>();
         graphics_pipeline_.create_pso_and_root_signature();
     }
 
@@ -281,19 +219,26 @@ void ModelTree::load(const std::string& file, Vector3 position, Quaternion rotat
         };
         box_visualize_pipeline_.setup_input_layout(inputs, _countof(inputs));
         box_visualize_pipeline_.setup_primitive_topology_type(D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE);
-        box_visualize_pipeline_.declare_bind<CAMERA_DATA_BIND>();
-        box_visualize_pipeline_.declare_bind<MODEL_DATA_BIND>();
-        box_visualize_pipeline_.declare_bind<BOX_TRANSFORM_BIND>();
         box_visualize_pipeline_.create_pso_and_root_signature();
     }
 
     // initialize GPU buffers
-    model_data_.transform = Matrix::CreateTranslation(position) * Matrix::CreateFromQuaternion(rotation) * Matrix::CreateScale(scale);
+    model_cb_.initialize("Model data");
+    set_transform(position, rotation, scale);
+    update();
+}
+
+void ModelTree::set_transform(Vector3 position, Quaternion rotation, Vector3 scale)
+{
+    set_transform(Matrix::CreateTranslation(position) * Matrix::CreateFromQuaternion(rotation) * Matrix::CreateScale(scale));
+}
+
+void ModelTree::set_transform(const Matrix& transform)
+{
+    model_data_.transform = transform;
     model_data_.inverse_transpose_transform = model_data_.transform.Invert().Transpose();
-    {
-        model_cb_.initialize();
-        model_cb_.update(model_data_);
-    }
+    model_cb_.update(model_data_);
+    world_dirty_ = true;
 }
 
 void ModelTree::unload()
@@ -321,18 +266,44 @@ void ModelTree::unload()
 
 void ModelTree::update()
 {
+    if (!world_dirty_) {
+        return;
+    }
 
+    world_transform_stats_ = WorldTransformStats{};
+    for (Mesh* mesh : meshes_) {
+        WorldTransformStats stats;
+        mesh->update_world_geometry(model_data_.transform, stats);
+        world_transform_stats_.transform_ms += stats.transform_ms;
+        world_transform_stats_.refit_ms += stats.refit_ms;
+        world_transform_stats_.records_ms += stats.records_ms;
+        world_transform_stats_.vertices += stats.vertices;
+        world_transform_stats_.nodes += stats.nodes;
+    }
+    world_dirty_ = false;
+    ++world_version_;
 }
 
-void ModelTree::draw(ID3D12GraphicsCommandList* cmd_list)
+void ModelTree::draw(GraphPass pass, D3D12_GPU_DESCRIPTOR_HANDLE camera_handle)
+{
+    // model constants are synced here, not on recorder workers
+    const D3D12_GPU_DESCRIPTOR_HANDLE model_handle = model_cb_.gpu_descriptor_handle();
+    for (size_t begin = 0; begin < meshes_.size(); begin += meshes_per_list) {
+        const size_t end = std::min(begin + meshes_per_list, meshes_.size());
+        Game::inst()->render().record_pass(pass, [this, camera_handle, model_handle, begin, end](ID3D12GraphicsCommandList* cmd_list) {
+            draw_meshes(cmd_list, camera_handle, model_handle, begin, end);
+        });
+    }
+}
+
+void ModelTree::draw_meshes(ID3D12GraphicsCommandList* cmd_list, D3D12_GPU_DESCRIPTOR_HANDLE camera_handle,
+                            D3D12_GPU_DESCRIPTOR_HANDLE model_handle, size_t begin, size_t end)
 {
     const auto render_target = Game::inst()->render().render_target();
     const auto depth_stencil_target = Game::inst()->render().depth_stencil();
     auto resource_descriptor_heap = Game::inst()->render().resource_descriptor_heap();
-    const auto command_list_allocator = Game::inst()->render().graphics_command_allocator();
-    const auto graphics_queue = Game::inst()->render().graphics_queue();
     {
-        PIXBeginEvent(cmd_list, PIX_COLOR(0x0, 0xFF, 0x0), "Draw model mesh");
+        PROFILE_PIX_EVENT(cmd_list, PIX_COLOR(0x0, 0xFF, 0x0), "Draw model mesh");
         cmd_list->SetPipelineState(graphics_pipeline_.get_pso());
 
         cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -343,15 +314,18 @@ void ModelTree::draw(ID3D12GraphicsCommandList* cmd_list)
         // bind resources
         cmd_list->SetGraphicsRootSignature(graphics_pipeline_.get_root_signature());
         cmd_list->SetDescriptorHeaps(1, resource_descriptor_heap.GetAddressOf());
-        cmd_list->SetGraphicsRootDescriptorTable(graphics_pipeline_.resource_index<CAMERA_DATA_BIND>(), Game::inst()->render().camera()->gpu_descriptor_handle());
-        cmd_list->SetGraphicsRootDescriptorTable(graphics_pipeline_.resource_index<MODEL_DATA_BIND>(), model_cb_.gpu_descriptor_handle());
-
-        for (Mesh* mesh : meshes_) {
-            cmd_list->IASetIndexBuffer(&mesh->get_index_buffer_view());
-            cmd_list->IASetVertexBuffers(0, 1, &mesh->get_vertex_buffer_view());
-            cmd_list->DrawIndexedInstanced(UINT(mesh->get_indices().size()), 1, 0, 0, 0);
+        cmd_list->SetGraphicsRootDescriptorTable(graphics_pipeline_.resource_index<CAMERA_DATA_BIND>(), camera_handle);
+        cmd_list->SetGraphicsRootDescriptorTable(graphics_pipeline_.resource_index<MODEL_DATA_BIND>(), model_handle);
+
+        // all meshes share arena buffers
+        const GeometryArena* arena = Game::inst()->render().geometry_arena();
+        cmd_list->IASetIndexBuffer(&arena->index_buffer_view());
+        cmd_list->IASetVertexBuffers(0, 1, &arena->vertex_buffer_view());
+        for (size_t i = begin; i < end; ++i) {
+            const Mesh* mesh = meshes_[i];
+            const GeometryRange& geometry = mesh->get_geometry();
+            cmd_list->DrawIndexedInstanced(UINT(mesh->get_indices().size()), 1, arena->first_index(geometry), INT(arena->first_vertex(geometry)), 0);
         }
-        PIXEndEvent(cmd_list);
     }
 
 #if !defined(NDEBUG)
@@ -398,135 +372,49 @@ std::vector<std::vector<Vertex>> ModelTree::get_meshes_vertices()
     return result;
 }
 
-std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> ModelTree::get_index_buffers_srv()
+std::vector<std::vector<MeshTreeNode>> ModelTree::get_meshes_trees()
 {
-    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> result;
+    std::vector<std::vector<MeshTreeNode>> result;
     result.reserve(meshes_.size());
     for (Mesh* mesh : meshes_) {
-        result.push_back(mesh->get_index_buffer_srv());
+        result.push_back(mesh->get_mesh_tree());
     }
     return result;
 }
 
-std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> ModelTree::get_vertex_buffers_srv()
+std::vector<MeshTreeNode> ModelTree::Mesh::get_mesh_tree() const
 {
-    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> result;
+    return mesh_tree_;
+}
+
+std::vector<std::vector<MeshTreeNode>> ModelTree::get_meshes_world_trees()
+{
+    std::vector<std::vector<MeshTreeNode>> result;
     result.reserve(meshes_.size());
     for (Mesh* mesh : meshes_) {
-        result.push_back(mesh->get_vertex_buffer_srv());
+        result.push_back(mesh->get_world_geometry().tree);
     }
     return result;
 }
 
-std::vector<std::vector<MeshTreeNode>> ModelTree::get_meshes_trees()
+std::vector<std::vector<TriangleRecord>> ModelTree::get_meshes_triangle_records()
 {
-    std::vector<std::vector<MeshTreeNode>> result;
+    std::vector<std::vector<TriangleRecord>> result;
     result.reserve(meshes_.size());
     for (Mesh* mesh : meshes_) {
-        result.push_back(mesh->get_mesh_tree());
+        result.push_back(mesh->get_world_geometry().records);
     }
     return result;
 }
 
-std::vector<MeshTreeNode> ModelTree::Mesh::get_mesh_tree() const
+void ModelTree::Mesh::update_world_geometry(const Matrix& transform, WorldTransformStats& stats)
 {
-    std::vector<MeshTreeNode> res;
-    res.reserve(mesh_tree_.size());
-    for (int i = 0; i < mesh_tree_.size(); ++i) {
-        res.push_back(mesh_tree_.at(i));
-    }
-    return res;
+    ::update_world_geometry(positions_, indices_, mesh_tree_, transform, world_, &stats);
 }
 
-void ModelTree::Mesh::split_vertices(float min[3], float max[3], int32_t start, int32_t count, int32_t current_mesh_node_index, float smallest_length)
+const WorldGeometry& ModelTree::Mesh::get_world_geometry() const
 {
-    if (count == 0) {
-        return;
-    }
-
-    const float length[3] = { max[0] - min[0], max[1] - min[1], max[2] - min[2] };
-    const float mean[3] = { (max[0] + min[0]) / 2, (max[1] + min[1]) / 2, (max[2] + min[2]) / 2 };
-    int32_t split_index = -1;
-    if (length[0] >= length[1] && length[0] >= length[2] && length[0] > smallest_length) {
-        split_index = 0;
-    } else if (length[1] >= length[0] && length[1] >= length[2] && length[1] > smallest_length) {
-        split_index = 1;
-    } else if (length[2] >= length[0] && length[2] >= length[1] && length[2] > smallest_length) {
-        split_index = 2;
-    }
-
-    // radix sort
-
-    std::vector<int32_t> indices[3]; // 0 - parent, 1 - less child, 2 - greater child
-    for (int32_t i = 0; i < 3; ++i) {
-        indices[i].reserve(count);
-    }
-    for (int32_t i = start; i < start + count; i += 3) {
-        uint32_t triangle_indices[3] = { indices_[i + 0], indices_[i + 1], indices_[i + 2] };
-        float triangle[3][3] = {
-            { vertices_[triangle_indices[0]].position.x, vertices_[triangle_indices[0]].position.y, vertices_[triangle_indices[0]].position.z },
-            { vertices_[triangle_indices[1]].position.x, vertices_[triangle_indices[1]].position.y, vertices_[triangle_indices[1]].position.z },
-            { vertices_[triangle_indices[2]].position.x, vertices_[triangle_indices[2]].position.y, vertices_[triangle_indices[2]].position.z }
-        };
-        if (split_index != -1 && triangle[0][split_index] < mean[split_index] && triangle[1][split_index] < mean[split_index] && triangle[2][split_index] < mean[split_index]) {
-            indices[1].push_back(indices_[i + 0]);
-            indices[1].push_back(indices_[i + 1]);
-            indices[1].push_back(indices_[i + 2]);
-        } else if (split_index != -1 && triangle[0][split_index] > mean[split_index] && triangle[1][split_index] > mean[split_index] && triangle[2][split_index] > mean[split_index]) {
-            indices[2].push_back(indices_[i + 0]);
-            indices[2].push_back(indices_[i + 1]);
-            indices[2].push_back(indices_[i + 2]);
-        } else {
-            indices[0].push_back(indices_[i + 0]);
-            indices[0].push_back(indices_[i + 1]);
-            indices[0].push_back(indices_[i + 2]);
-        }
-    }
-
-    int32_t indices_count[3] = { (int32_t)indices[0].size(), (int32_t)indices[1].size(), (int32_t)indices[2].size() };
-
-    //if (indices_count[0] > 0) {
-        MeshTreeNode node;
-        node.min = Vector3(min);
-        node.max = Vector3(max);
-        node.start_index = start;
-        node.count = indices_count[0];
-        mesh_tree_[current_mesh_node_index] = node;
-    //}
-
-    {
-        int32_t offset = start;
-        for (int32_t i = 0; i < 3; ++i) {
-            if (indices_count[i] != 0) {
-                memcpy(&indices_[offset], indices[i].data(), indices_count[i] * sizeof(uint32_t));
-            }
-            offset += indices_count[i];
-        }
-    }
-
-    if (split_index != -1) {
-        int32_t offset = start + indices_count[0];
-        for (int32_t i = 0; i < 2; ++i) {
-            float new_min[3];
-            float new_max[3];
-
-            memcpy(new_min, min, sizeof(float) * 3);
-            memcpy(new_max, max, sizeof(float) * 3);
-
-            if (i == 0) {
-                new_max[split_index] = mean[split_index];
-            } else {
-                new_min[split_index] = mean[split_index];
-            }
-
-            // children:
-            // (2i + 1) and (2i + 2)
-            // parent:
-            // (i - 1) / 2
-            split_vertices(new_min, new_max, offset, indices_count[i + 1], 2 * current_mesh_node_index + 1 + i, smallest_length);
-            offset += indices_count[i + 1];
-        }
-    }
+    return world_;
 }
 
 void ModelTree::load_node(aiNode* node, const aiScene* scene)
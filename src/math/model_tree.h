@@ -2,13 +2,14 @@
 
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 #include "render/common.h"
+#include "render/render_graph.h"
 #include "render/resource/buffer.hpp"
+#include "render/resource/geometry_arena.h"
 #include "render/resource/texture.h"
 #include "render/resource/pipeline.h"
 
@@ -16,6 +17,7 @@
 using namespace DirectX::SimpleMath;
 
 #include "resources/shaders/voxels/voxel.fx"
+#include "math/world_transform.h"
 
 class Camera;
 
@@ -32,18 +34,33 @@ public:
     // destroy resources
     void unload();
 
+    // world geometry of meshes is rebuilt in the next update
+    void set_transform(Vector3 position, Quaternion rotation = Quaternion(), Vector3 scale = Vector3(1, 1, 1));
+    void set_transform(const Matrix& transform);
+
+    // per frame transform stage, moves meshes to world space if transform changed
     void update();
 
-    void draw(ID3D12GraphicsCommandList* cmd_list);
+    // records mesh draws as tasks of the pass, meshes_per_list meshes per list
+    void draw(GraphPass pass, D3D12_GPU_DESCRIPTOR_HANDLE camera_handle);
 
-    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> get_index_buffers_srv();
-    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> get_vertex_buffers_srv();
     std::vector<std::vector<uint32_t>> get_meshes_indices();
     std::vector<std::vector<Vertex>> get_meshes_vertices();
     Matrix get_transform() const { return model_data_.transform; }
+    // incremented every time world geometry is rebuilt
+    uint32_t get_world_version() const { return world_version_; }
 
     std::vector<std::vector<MeshTreeNode>> get_meshes_trees();
+    // world space, rebuilt when model transform changes
+    std::vector<std::vector<MeshTreeNode>> get_meshes_world_trees();
+    std::vector<std::vector<TriangleRecord>> get_meshes_triangle_records();
+    const WorldTransformStats& get_world_transform_stats() const { return world_transform_stats_; }
 private:
+    static constexpr uint32_t meshes_per_list = 64;
+
+    void draw_meshes(ID3D12GraphicsCommandList* cmd_list, D3D12_GPU_DESCRIPTOR_HANDLE camera_handle,
+                     D3D12_GPU_DESCRIPTOR_HANDLE model_handle, size_t begin, size_t end);
+
     class Mesh
     {
     public:
@@ -63,15 +80,16 @@ private:
         D3D12_GPU_DESCRIPTOR_HANDLE box_transformation_srv_gpu_handle();
 #endif
 
-        const D3D12_INDEX_BUFFER_VIEW& get_index_buffer_view() { return index_buffer_.view(); }
-        D3D12_GPU_DESCRIPTOR_HANDLE& get_index_buffer_srv() { return index_buffer_srv_gpu_; }
-        const D3D12_VERTEX_BUFFER_VIEW& get_vertex_buffer_view() { return vertex_buffer_.view(); }
-        D3D12_GPU_DESCRIPTOR_HANDLE& get_vertex_buffer_srv() { return vertex_buffer_srv_gpu_; }
+        // vertex and index ranges in Render::geometry_arena
+        const GeometryRange& get_geometry() const { return geometry_; }
 
         const std::vector<uint32_t>& get_indices() const;
         const std::vector<Vertex>& get_vertices() const;
 
         std::vector<MeshTreeNode> get_mesh_tree() const;
+
+        void update_world_geometry(const Matrix& transform, WorldTransformStats& stats);
+        const WorldGeometry& get_world_geometry() const;
     private:
         // Material material_;
 
@@ -84,24 +102,16 @@ private:
 
         UINT index_count_{ 0 };
 
-        IndexBuffer index_buffer_;
-        VertexBuffer<Vertex> vertex_buffer_;
+        GeometryRange geometry_;
 
-        D3D12_CPU_DESCRIPTOR_HANDLE index_buffer_srv_;
-        D3D12_GPU_DESCRIPTOR_HANDLE index_buffer_srv_gpu_;
-        UINT index_buffer_srv_resource_index_;
-        D3D12_CPU_DESCRIPTOR_HANDLE vertex_buffer_srv_;
-        D3D12_GPU_DESCRIPTOR_HANDLE vertex_buffer_srv_gpu_;
-        UINT vertex_buffer_srv_resource_index_;
-
-        std::unordered_map<int32_t, MeshTreeNode> mesh_tree_;
-
-        void split_vertices(float min[3], float max[3], int32_t start, int32_t count, int32_t current_mesh_node_index, float smallest_length);
+        std::vector<Vector3> positions_;
+        std::vector<MeshTreeNode> mesh_tree_;
+        WorldGeometry world_;
 
 #ifndef NDEBUG
         ComPtr<ID3D12Resource> box_transformations_;
         void* box_transformations_mapped_ptr_ = nullptr;
-        UINT box_transformation_resource_index_;
+        DescriptorRange box_transformation_range_;
         D3D12_CPU_DESCRIPTOR_HANDLE box_transformations_srv_;
         D3D12_GPU_DESCRIPTOR_HANDLE box_transformations_srv_gpu_;
 
@@ -118,7 +128,11 @@ private:
     MODEL_DATA_BIND model_data_;
     ConstBuffer<decltype(model_data_)> model_cb_;
 
-    GraphicsPipeline graphics_pipeline_;
+    bool world_dirty_{ false };
+    uint32_t world_version_{ 0 };
+    WorldTransformStats world_transform_stats_;
+
+    LayoutGraphicsPipeline<PipelineLayout<CAMERA_DATA_BIND, MODEL_DATA_BIND>> graphics_pipeline_;
 
-    GraphicsPipeline box_visualize_pipeline_;
+    LayoutGraphicsPipeline<PipelineLayout<CAMERA_DATA_BIND, MODEL_DATA_BIND, BOX_TRANSFORM_BIND>> box_visualize_pipeline_;
 };
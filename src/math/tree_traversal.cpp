@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+
+#include "tree_traversal.h"
+
+namespace
+{
+
+// with transform all 8 corners of model space box are transformed, bounds of them are tested
+template<class View, class Node>
+bool test_node_box(const View& tree, const Node& node, const Ray& ray, const Vector3& inv_direction, float t_max, float& t_entry)
+{
+    if (tree.transform != nullptr) {
+        Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (uint32_t i = 0; i < 8; ++i) {
+            const Vector3 corner((i & 1) ? node.max.x : node.min.x, (i & 2) ? node.max.y : node.min.y, (i & 4) ? node.max.z : node.min.z);
+            const Vector3 world_corner = Vector3::Transform(corner, *tree.transform);
+            min = Vector3::Min(min, world_corner);
+            max = Vector3::Max(max, world_corner);
+        }
+        return box_intersection(ray, inv_direction, min, max, t_max, t_entry);
+    }
+    return box_intersection(ray, inv_direction, node.min, node.max, t_max, t_entry);
+}
+
+template<class View, class Node>
+void test_node_triangles(const View& tree, const Node& node, const Ray& ray, float t_max,
+                         TraversalHit& hit, TraversalCounters& counters)
+{
+    assert(tree.transform == nullptr || (tree.kernel == nullptr && tree.records == nullptr));
+    if (tree.kernel != nullptr) {
+        const uint32_t begin = uint32_t(node.start_index / 3);
+        const uint32_t end = begin + uint32_t(node.count / 3);
+        counters.triangle_tests += end - begin;
+
+        KernelHit kernel_hit;
+        const float t_limit = (hit.t > 0 && hit.t < t_max) ? hit.t : t_max;
+        if (begin < end && tree.kernel(tree.packets->data.data(), tree.packets->stride, begin, end, kernel_ray(ray), t_limit, kernel_hit)) {
+            hit.t = kernel_hit.t;
+            hit.index = kernel_hit.record * 3;
+            hit.u = kernel_hit.u;
+            hit.v = kernel_hit.v;
+        }
+        return;
+    }
+
+    for (int32_t i = node.start_index; i < node.start_index + node.count; i += 3) {
+        ++counters.triangle_tests;
+        float u;
+        float v;
+        float t;
+        if (tree.transform != nullptr) {
+            t = triangle_intersection(ray, Vector3::Transform(tree.positions[tree.indices[i + 0]], *tree.transform),
+                                           Vector3::Transform(tree.positions[tree.indices[i + 1]], *tree.transform),
+                                           Vector3::Transform(tree.positions[tree.indices[i + 2]], *tree.transform), u, v);
+        } else {
+            t = tree.records != nullptr ?
+                triangle_record_intersection(ray, tree.records[i / 3], u, v) :
+                triangle_intersection(ray, tree.positions[tree.indices[i + 0]],
+                                           tree.positions[tree.indices[i + 1]],
+                                           tree.positions[tree.indices[i + 2]], u, v);
+        }
+        if (t > 0 && t < t_max && (t < hit.t || hit.t == 0)) {
+            hit.t = t;
+            hit.index = uint32_t(i);
+            hit.u = u;
+            hit.v = v;
+        }
+    }
+}
+
+} // namespace
+
+TraversalHit traverse_mesh_tree(const MeshTreeView& tree, const Ray& ray, float t_max, TraversalCounters& counters)
+{
+    TraversalHit hit;
+    if (tree.node_count == 0) {
+        return hit;
+    }
+    // one pending sibling per level plus the root
+    assert(tree.node_count < (1u << (MESH_TREE_STACK_SIZE - 1)));
+
+    const Vector3 inv_direction = inverse_direction(ray.direction);
+
+    // closest hit so far clips the ray
+    float t_limit = t_max;
+
+    uint32_t stack[MESH_TREE_STACK_SIZE];
+    float stack_entry[MESH_TREE_STACK_SIZE];
+    uint32_t stack_size = 0;
+
+    float entry;
+    ++counters.node_visits;
+    if (test_node_box(tree, tree.nodes[0], ray, inv_direction, t_limit, entry)) {
+        stack[stack_size] = 0;
+        stack_entry[stack_size] = entry;
+        ++stack_size;
+    }
+
+    while (stack_size > 0) {
+        --stack_size;
+        const uint32_t index = stack[stack_size];
+        if (stack_entry[stack_size] > t_limit) {
+            continue; // closer hit was found after the node was pushed
+        }
+
+        const MeshTreeNode& node = tree.nodes[index];
+        test_node_triangles(tree, node, ray, t_limit, hit, counters);
+        if (hit.t > 0) {
+            t_limit = hit.t;
+        }
+
+        const uint32_t children[2] = { 2 * index + 1, 2 * index + 2 };
+        float children_entry[2];
+        bool children_hit[2] = { false, false };
+        for (uint32_t i = 0; i < 2; ++i) {
+            if (children[i] < tree.node_count) {
+                ++counters.node_visits;
+                const MeshTreeNode& child = tree.nodes[children[i]];
+                children_hit[i] = test_node_box(tree, child, ray, inv_direction, t_limit, children_entry[i]);
+            }
+        }
+
+        // far child goes first, so near child is popped next
+        const uint32_t near_child = (children_hit[0] && children_hit[1] && children_entry[1] < children_entry[0]) ? 1 : 0;
+        const uint32_t far_child = 1 - near_child;
+        if (children_hit[far_child]) {
+            stack[stack_size] = children[far_child];
+            stack_entry[stack_size] = children_entry[far_child];
+            ++stack_size;
+        }
+        if (children_hit[near_child]) {
+            stack[stack_size] = children[near_child];
+            stack_entry[stack_size] = children_entry[near_child];
+            ++stack_size;
+        }
+        assert(stack_size <= MESH_TREE_STACK_SIZE);
+    }
+    return hit;
+}
+
+TraversalHit traverse_mesh_tree_linear(const MeshTreeView& tree, const Ray& ray, float t_max, TraversalCounters& counters)
+{
+    constexpr uint32_t bits_count = 32;
+    constexpr uint32_t array_size = 64;
+
+    TraversalHit hit;
+    const Vector3 inv_direction = inverse_direction(ray.direction);
+
+    uint32_t hit_buffer[array_size] = {};
+    for (uint32_t i = 0; i < tree.node_count; ++i) {
+        uint32_t parent_index = (std::max(i, 1u) - 1u) / 2u;
+        while (parent_index / bits_count >= array_size) {
+            parent_index = (std::max(parent_index, 1u) - 1u) / 2u;
+        }
+        const uint32_t parent_hit_bit = 1u << (parent_index % bits_count);
+        if (i != 0 && (hit_buffer[parent_index / bits_count] & parent_hit_bit) == 0) {
+            continue;
+        }
+
+        ++counters.node_visits;
+        float entry;
+        const MeshTreeNode& node = tree.nodes[i];
+        if (!test_node_box(tree, node, ray, inv_direction, t_max, entry)) {
+            if (i == 0) {
+                break;
+            }
+            continue;
+        }
+
+        test_node_triangles(tree, node, ray, t_max, hit, counters);
+
+        if (i / bits_count < array_size) {
+            hit_buffer[i / bits_count] |= 1u << (i % bits_count);
+        }
+    }
+    return hit;
+}
+
+TraversalHit traverse_threaded_tree(const ThreadedTreeView& tree, const Ray& ray, float t_max, TraversalCounters& counters)
+{
+    TraversalHit hit;
+    const Vector3 inv_direction = inverse_direction(ray.direction);
+
+    float t_limit = t_max;
+    uint32_t i = 0;
+    while (i < tree.node_count) {
+        ++counters.node_visits;
+        const ThreadedTreeNode& node = tree.nodes[i];
+        float entry;
+        if (!test_node_box(tree, node, ray, inv_direction, t_limit, entry)) {
+            i = node.skip;
+            continue;
+        }
+
+        test_node_triangles(tree, node, ray, t_limit, hit, counters);
+        if (hit.t > 0) {
+            t_limit = hit.t;
+        }
+        ++i;
+    }
+    return hit;
+}
+
+TraversalHit traverse_instance_table(const InstanceTableView& table, const Ray& ray, float t_max, TraversalCounters& counters)
+{
+    TraversalHit closest;
+    for (uint32_t i = 0; i < table.instance_count; ++i) {
+        const MeshInstance& instance = table.instances[i];
+        assert(instance.index_offset % 3 == 0);
+
+        MeshTreeView tree;
+        tree.nodes = table.nodes + instance.node_offset;
+        tree.node_count = instance.node_count;
+        tree.indices = table.indices + instance.index_offset;
+        tree.records = table.records + instance.index_offset / 3;
+
+        const TraversalHit hit = traverse_mesh_tree(tree, ray, closest.t > 0 ? closest.t : t_max, counters);
+        if (hit.t > 0) {
+            closest = hit;
+            closest.index += instance.index_offset;
+            closest.instance = i;
+        }
+    }
+    return closest;
+}
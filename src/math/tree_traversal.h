@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "shaders/common/types.fx"
+#include "math/intersection.h"
+#include "math/triangle_records.h"
+#include "math/triangle_kernels.h"
+
+struct TraversalCounters
+{
+    uint64_t node_visits{ 0 };    // box tests
+    uint64_t triangle_tests{ 0 };
+
+    TraversalCounters& operator+=(const TraversalCounters& other)
+    {
+        node_visits += other.node_visits;
+        triangle_tests += other.triangle_tests;
+        return *this;
+    }
+};
+
+struct TraversalHit
+{
+    float t{ 0.f };       // 0 - no hit
+    uint32_t index{ 0 };  // first index of the triangle
+    float u{ 0.f };
+    float v{ 0.f };
+    uint32_t instance{ 0 }; // traverse_instance_table only
+};
+
+// mesh tree (see build_mesh_tree) with geometry in the same space as rays, see WorldGeometry
+struct MeshTreeView
+{
+    const MeshTreeNode* nodes{ nullptr };
+    uint32_t node_count{ 0 };
+    const uint32_t* indices{ nullptr };
+    const Vector3* positions{ nullptr };
+    const TriangleRecord* records{ nullptr }; // optional, used instead of positions
+    const TriangleRecordPackets* packets{ nullptr }; // optional with kernel, used instead of records
+    TriangleKernel kernel{ nullptr };
+    // optional, model space nodes and positions transformed on every test (8 box corners, 3 vertices); vertex fetch only
+    const Matrix* transform{ nullptr };
+};
+
+struct ThreadedTreeView
+{
+    const ThreadedTreeNode* nodes{ nullptr };
+    uint32_t node_count{ 0 };
+    const uint32_t* indices{ nullptr };
+    const Vector3* positions{ nullptr };
+    const TriangleRecord* records{ nullptr }; // optional, used instead of positions
+    const TriangleRecordPackets* packets{ nullptr }; // optional with kernel, used instead of records
+    TriangleKernel kernel{ nullptr };
+    // optional, model space nodes and positions transformed on every test (8 box corners, 3 vertices); vertex fetch only
+    const Matrix* transform{ nullptr };
+};
+
+// meshes of MeshInstanceTable: world space trees and triangle records, offsets as in MeshInstance
+struct InstanceTableView
+{
+    const MeshInstance* instances{ nullptr };
+    uint32_t instance_count{ 0 };
+    const MeshTreeNode* nodes{ nullptr };
+    const uint32_t* indices{ nullptr };
+    const TriangleRecord* records{ nullptr };
+};
+
+// closest hit in (0, t_max) with explicit stack, nearest child first
+// subtrees entered farther than current closest hit are skipped
+// same traversal as fill.hlsl
+TraversalHit traverse_mesh_tree(const MeshTreeView& tree, const Ray& ray, float t_max, TraversalCounters& counters);
+
+// old fill.hlsl walk: every node in heap order, checked if its parent box was hit
+// hit mask holds 2048 nodes, deeper nodes look at their first ancestor inside the mask
+TraversalHit traverse_mesh_tree_linear(const MeshTreeView& tree, const Ray& ray, float t_max, TraversalCounters& counters);
+
+// closest hit in (0, t_max) without stack: one loop over depth first nodes following skip links on misses
+// children are visited in fixed order, closest hit still clips the ray
+TraversalHit traverse_threaded_tree(const ThreadedTreeView& tree, const Ray& ray, float t_max, TraversalCounters& counters);
+
+// closest hit over all instances with traverse_mesh_tree, closer hits clip following instances
+// hit index is global index of the table, same loop as fill.hlsl
+TraversalHit traverse_instance_table(const InstanceTableView& table, const Ray& ray, float t_max, TraversalCounters& counters);
@@ -0,0 +1,186 @@
+#include <cfloat>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#include "triangle_kernels.h"
+
+namespace
+{
+
+#if TRIANGLE_KERNELS_X64
+
+void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#ifdef _MSC_VER
+    int result[4];
+    __cpuidex(result, int(leaf), int(subleaf));
+    for (int32_t i = 0; i < 4; ++i) {
+        registers[i] = uint32_t(result[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// register state enabled by OS, XCR0
+uint64_t os_register_state()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t low;
+    uint32_t high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (uint64_t(high) << 32) | low;
+#endif
+}
+
+SimdLevel detect_simd_level()
+{
+    uint32_t registers[4];
+    cpuid(0, 0, registers);
+    const uint32_t max_leaf = registers[0];
+
+    cpuid(1, 0, registers);
+    const bool sse4 = (registers[2] & (1u << 19)) != 0;
+    const bool osxsave = (registers[2] & (1u << 27)) != 0;
+    if (!sse4) {
+        return SimdLevel::scalar;
+    }
+    if (!osxsave || max_leaf < 7) {
+        return SimdLevel::sse4;
+    }
+
+    const uint64_t state = os_register_state();
+    const bool ymm_state = (state & 0x6) == 0x6;   // xmm, ymm
+    const bool zmm_state = (state & 0xE0) == 0xE0; // opmask, zmm 0-15 high halves, zmm 16-31
+
+    cpuid(7, 0, registers);
+    const bool avx2 = (registers[1] & (1u << 5)) != 0;
+    const bool avx512f = (registers[1] & (1u << 16)) != 0;
+    if (avx512f && avx2 && ymm_state && zmm_state) {
+        return SimdLevel::avx512;
+    }
+    if (avx2 && ymm_state) {
+        return SimdLevel::avx2;
+    }
+    return SimdLevel::sse4;
+}
+
+#else
+
+SimdLevel detect_simd_level()
+{
+    return SimdLevel::scalar;
+}
+
+#endif
+
+} // namespace
+
+const char* simd_level_name(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::scalar:
+        return "scalar";
+    case SimdLevel::sse4:
+        return "sse4";
+    case SimdLevel::avx2:
+        return "avx2";
+    case SimdLevel::avx512:
+        return "avx512";
+    default:
+        return "unknown";
+    }
+}
+
+SimdLevel supported_simd_level()
+{
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+TriangleKernel triangle_kernel(SimdLevel level)
+{
+    if (level > supported_simd_level()) {
+        return nullptr;
+    }
+
+    switch (level) {
+    case SimdLevel::scalar:
+        return intersect_records_scalar;
+#if TRIANGLE_KERNELS_X64
+    case SimdLevel::sse4:
+        return intersect_records_sse4;
+    case SimdLevel::avx2:
+        return intersect_records_avx2;
+    case SimdLevel::avx512:
+        return intersect_records_avx512;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+void build_triangle_record_packets(const std::vector<TriangleRecord>& records, TriangleRecordPackets& packets)
+{
+    packets.count = uint32_t(records.size());
+    packets.stride = packets.count + TriangleRecordPackets::max_packet_width;
+    // zero records never hit: direction along the normal is 0
+    packets.data.assign(size_t(packets.stride) * 12, 0.f);
+
+    float* data = packets.data.data();
+    for (uint32_t i = 0; i < packets.count; ++i) {
+        const Vector4* rows[3] = { &records[i].row0, &records[i].row1, &records[i].row2 };
+        for (uint32_t row = 0; row < 3; ++row) {
+            data[(row * 4 + 0) * packets.stride + i] = rows[row]->x;
+            data[(row * 4 + 1) * packets.stride + i] = rows[row]->y;
+            data[(row * 4 + 2) * packets.stride + i] = rows[row]->z;
+            data[(row * 4 + 3) * packets.stride + i] = rows[row]->w;
+        }
+    }
+}
+
+bool intersect_records_scalar(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                              const KernelRay& ray, float t_max, KernelHit& hit)
+{
+    const float* r[12];
+    for (uint32_t c = 0; c < 12; ++c) {
+        r[c] = records + size_t(c) * stride;
+    }
+
+    bool found = false;
+    float best_t = t_max;
+    for (uint32_t i = begin; i < end; ++i) {
+        const float direction_z = r[8][i] * ray.direction[0] + r[9][i] * ray.direction[1] + r[10][i] * ray.direction[2];
+        if (direction_z == 0.f) {
+            continue;
+        }
+        const float origin_z = r[8][i] * ray.origin[0] + r[9][i] * ray.origin[1] + r[10][i] * ray.origin[2] + r[11][i];
+        const float t = -origin_z / direction_z;
+        if (!(t > 0.f) || !(t < best_t)) {
+            continue;
+        }
+
+        const float p[3] = { ray.origin[0] + t * ray.direction[0], ray.origin[1] + t * ray.direction[1], ray.origin[2] + t * ray.direction[2] };
+        const float u = r[0][i] * p[0] + r[1][i] * p[1] + r[2][i] * p[2] + r[3][i];
+        if (u < 0.f || u > 1.f) {
+            continue;
+        }
+        const float v = r[4][i] * p[0] + r[5][i] * p[1] + r[6][i] * p[2] + r[7][i];
+        if (v < 0.f || u + v > 1.f) {
+            continue;
+        }
+
+        best_t = t;
+        hit = { t, i, u, v };
+        found = true;
+    }
+    return found;
+}
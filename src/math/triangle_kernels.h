@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "shaders/common/types.fx"
+#include "math/intersection.h"
+#include "math/triangle_kernels_isa.h"
+
+enum class SimdLevel : uint32_t
+{
+    scalar,
+    sse4,
+    avx2,   // 8 triangles per packet
+    avx512, // 16 triangles per packet
+    count,
+};
+
+const char* simd_level_name(SimdLevel level);
+
+// highest level supported by both build and CPU (including OS support of wide registers)
+SimdLevel supported_simd_level();
+
+// nullptr if level is not supported
+TriangleKernel triangle_kernel(SimdLevel level);
+
+// TriangleRecord array in SoA packets for triangle kernels, same record order
+struct TriangleRecordPackets
+{
+    static constexpr uint32_t max_packet_width = 16;
+
+    uint32_t count{ 0 };
+    uint32_t stride{ 0 }; // count + max_packet_width, padding records never hit
+    std::vector<float> data;
+};
+
+void build_triangle_record_packets(const std::vector<TriangleRecord>& records, TriangleRecordPackets& packets);
+
+inline KernelRay kernel_ray(const Ray& ray)
+{
+    return { { ray.origin.x, ray.origin.y, ray.origin.z }, { ray.direction.x, ray.direction.y, ray.direction.z } };
+}
@@ -0,0 +1,98 @@
+#include "triangle_kernels_isa.h"
+
+#if TRIANGLE_KERNELS_X64
+
+#include <immintrin.h>
+
+// built with AVX2 enabled, see triangle_kernels_isa.h
+bool intersect_records_avx2(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                            const KernelRay& ray, float t_max, KernelHit& hit)
+{
+    const __m256 origin_x = _mm256_set1_ps(ray.origin[0]);
+    const __m256 origin_y = _mm256_set1_ps(ray.origin[1]);
+    const __m256 origin_z = _mm256_set1_ps(ray.origin[2]);
+    const __m256 direction_x = _mm256_set1_ps(ray.direction[0]);
+    const __m256 direction_y = _mm256_set1_ps(ray.direction[1]);
+    const __m256 direction_z = _mm256_set1_ps(ray.direction[2]);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 sign = _mm256_set1_ps(-0.f);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256 best_t = _mm256_set1_ps(t_max);
+    __m256 best_u = zero;
+    __m256 best_v = zero;
+    __m256i best_record = _mm256_set1_epi32(-1);
+
+    const float* r[12];
+    for (uint32_t c = 0; c < 12; ++c) {
+        r[c] = records + size_t(c) * stride;
+    }
+
+    for (uint32_t i = begin; i < end; i += 8) {
+        const __m256i record = _mm256_add_epi32(_mm256_set1_epi32(int32_t(i)), lanes);
+        const __m256 in_range = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(int32_t(end - i)), lanes));
+
+        const __m256 r2x = _mm256_loadu_ps(r[8] + i);
+        const __m256 r2y = _mm256_loadu_ps(r[9] + i);
+        const __m256 r2z = _mm256_loadu_ps(r[10] + i);
+        const __m256 r2w = _mm256_loadu_ps(r[11] + i);
+
+        const __m256 plane_direction = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r2x, direction_x), _mm256_mul_ps(r2y, direction_y)), _mm256_mul_ps(r2z, direction_z));
+        const __m256 plane_origin = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r2x, origin_x), _mm256_mul_ps(r2y, origin_y)), _mm256_mul_ps(r2z, origin_z)), r2w);
+        const __m256 t = _mm256_div_ps(_mm256_xor_ps(plane_origin, sign), plane_direction);
+
+        __m256 mask = _mm256_and_ps(in_range, _mm256_cmp_ps(plane_direction, zero, _CMP_NEQ_UQ));
+        mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GT_OQ), _mm256_cmp_ps(t, best_t, _CMP_LT_OQ)));
+        if (_mm256_movemask_ps(mask) == 0) {
+            continue;
+        }
+
+        const __m256 px = _mm256_add_ps(origin_x, _mm256_mul_ps(t, direction_x));
+        const __m256 py = _mm256_add_ps(origin_y, _mm256_mul_ps(t, direction_y));
+        const __m256 pz = _mm256_add_ps(origin_z, _mm256_mul_ps(t, direction_z));
+
+        const __m256 u = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(r[0] + i), px), _mm256_mul_ps(_mm256_loadu_ps(r[1] + i), py)),
+                                               _mm256_mul_ps(_mm256_loadu_ps(r[2] + i), pz)), _mm256_loadu_ps(r[3] + i));
+        const __m256 v = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(r[4] + i), px), _mm256_mul_ps(_mm256_loadu_ps(r[5] + i), py)),
+                                               _mm256_mul_ps(_mm256_loadu_ps(r[6] + i), pz)), _mm256_loadu_ps(r[7] + i));
+
+        // not less / not greater keep scalar behaviour for NaN
+        mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_NLT_UQ), _mm256_cmp_ps(u, one, _CMP_NGT_UQ)));
+        mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_NLT_UQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_NGT_UQ)));
+
+        best_t = _mm256_blendv_ps(best_t, t, mask);
+        best_u = _mm256_blendv_ps(best_u, u, mask);
+        best_v = _mm256_blendv_ps(best_v, v, mask);
+        best_record = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_record), _mm256_castsi256_ps(record), mask));
+    }
+
+    alignas(32) float lane_t[8];
+    alignas(32) float lane_u[8];
+    alignas(32) float lane_v[8];
+    alignas(32) int32_t lane_record[8];
+    _mm256_store_ps(lane_t, best_t);
+    _mm256_store_ps(lane_u, best_u);
+    _mm256_store_ps(lane_v, best_v);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lane_record), best_record);
+
+    int32_t best = -1;
+    for (int32_t lane = 0; lane < 8; ++lane) {
+        if (lane_record[lane] < 0) {
+            continue;
+        }
+        if (best < 0 || lane_t[lane] < lane_t[best] || (lane_t[lane] == lane_t[best] && lane_record[lane] < lane_record[best])) {
+            best = lane;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    hit.t = lane_t[best];
+    hit.record = uint32_t(lane_record[best]);
+    hit.u = lane_u[best];
+    hit.v = lane_v[best];
+    return true;
+}
+
+#endif
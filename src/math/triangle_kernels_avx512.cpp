@@ -0,0 +1,100 @@
+#include "triangle_kernels_isa.h"
+
+#if TRIANGLE_KERNELS_X64
+
+#include <immintrin.h>
+
+// built with AVX-512F enabled, see triangle_kernels_isa.h
+bool intersect_records_avx512(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                              const KernelRay& ray, float t_max, KernelHit& hit)
+{
+    const __m512 origin_x = _mm512_set1_ps(ray.origin[0]);
+    const __m512 origin_y = _mm512_set1_ps(ray.origin[1]);
+    const __m512 origin_z = _mm512_set1_ps(ray.origin[2]);
+    const __m512 direction_x = _mm512_set1_ps(ray.direction[0]);
+    const __m512 direction_y = _mm512_set1_ps(ray.direction[1]);
+    const __m512 direction_z = _mm512_set1_ps(ray.direction[2]);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.f);
+    const __m512i sign = _mm512_set1_epi32(int32_t(0x80000000u));
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    __m512 best_t = _mm512_set1_ps(t_max);
+    __m512 best_u = zero;
+    __m512 best_v = zero;
+    __m512i best_record = _mm512_set1_epi32(-1);
+
+    const float* r[12];
+    for (uint32_t c = 0; c < 12; ++c) {
+        r[c] = records + size_t(c) * stride;
+    }
+
+    for (uint32_t i = begin; i < end; i += 16) {
+        const __m512i record = _mm512_add_epi32(_mm512_set1_epi32(int32_t(i)), lanes);
+        const __mmask16 in_range = (end - i >= 16) ? __mmask16(0xFFFF) : __mmask16((1u << (end - i)) - 1);
+
+        const __m512 r2x = _mm512_loadu_ps(r[8] + i);
+        const __m512 r2y = _mm512_loadu_ps(r[9] + i);
+        const __m512 r2z = _mm512_loadu_ps(r[10] + i);
+        const __m512 r2w = _mm512_loadu_ps(r[11] + i);
+
+        const __m512 plane_direction = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r2x, direction_x), _mm512_mul_ps(r2y, direction_y)), _mm512_mul_ps(r2z, direction_z));
+        const __m512 plane_origin = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r2x, origin_x), _mm512_mul_ps(r2y, origin_y)), _mm512_mul_ps(r2z, origin_z)), r2w);
+        // float xor needs AVX-512DQ, flip sign bit as integers
+        const __m512 negative_origin = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(plane_origin), sign));
+        const __m512 t = _mm512_div_ps(negative_origin, plane_direction);
+
+        __mmask16 mask = in_range & _mm512_cmp_ps_mask(plane_direction, zero, _CMP_NEQ_UQ);
+        mask &= _mm512_cmp_ps_mask(t, zero, _CMP_GT_OQ) & _mm512_cmp_ps_mask(t, best_t, _CMP_LT_OQ);
+        if (mask == 0) {
+            continue;
+        }
+
+        const __m512 px = _mm512_add_ps(origin_x, _mm512_mul_ps(t, direction_x));
+        const __m512 py = _mm512_add_ps(origin_y, _mm512_mul_ps(t, direction_y));
+        const __m512 pz = _mm512_add_ps(origin_z, _mm512_mul_ps(t, direction_z));
+
+        const __m512 u = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(r[0] + i), px), _mm512_mul_ps(_mm512_loadu_ps(r[1] + i), py)),
+                                                     _mm512_mul_ps(_mm512_loadu_ps(r[2] + i), pz)), _mm512_loadu_ps(r[3] + i));
+        const __m512 v = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(r[4] + i), px), _mm512_mul_ps(_mm512_loadu_ps(r[5] + i), py)),
+                                                     _mm512_mul_ps(_mm512_loadu_ps(r[6] + i), pz)), _mm512_loadu_ps(r[7] + i));
+
+        // not less / not greater keep scalar behaviour for NaN
+        mask &= _mm512_cmp_ps_mask(u, zero, _CMP_NLT_UQ) & _mm512_cmp_ps_mask(u, one, _CMP_NGT_UQ);
+        mask &= _mm512_cmp_ps_mask(v, zero, _CMP_NLT_UQ) & _mm512_cmp_ps_mask(_mm512_add_ps(u, v), one, _CMP_NGT_UQ);
+
+        best_t = _mm512_mask_blend_ps(mask, best_t, t);
+        best_u = _mm512_mask_blend_ps(mask, best_u, u);
+        best_v = _mm512_mask_blend_ps(mask, best_v, v);
+        best_record = _mm512_mask_blend_epi32(mask, best_record, record);
+    }
+
+    alignas(64) float lane_t[16];
+    alignas(64) float lane_u[16];
+    alignas(64) float lane_v[16];
+    alignas(64) int32_t lane_record[16];
+    _mm512_store_ps(lane_t, best_t);
+    _mm512_store_ps(lane_u, best_u);
+    _mm512_store_ps(lane_v, best_v);
+    _mm512_store_si512(lane_record, best_record);
+
+    int32_t best = -1;
+    for (int32_t lane = 0; lane < 16; ++lane) {
+        if (lane_record[lane] < 0) {
+            continue;
+        }
+        if (best < 0 || lane_t[lane] < lane_t[best] || (lane_t[lane] == lane_t[best] && lane_record[lane] < lane_record[best])) {
+            best = lane;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    hit.t = lane_t[best];
+    hit.record = uint32_t(lane_record[best]);
+    hit.u = lane_u[best];
+    hit.v = lane_v[best];
+    return true;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// interface of instruction set specific triangle kernels
+// kernel translation units are built with their own instruction set flags, so they include only this header
+// and intrinsics: inline functions compiled there could be picked by linker for the rest of the program
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define TRIANGLE_KERNELS_X64 1
+#else
+#define TRIANGLE_KERNELS_X64 0
+#endif
+
+struct KernelRay
+{
+    float origin[3];
+    float direction[3];
+};
+
+struct KernelHit
+{
+    float t;
+    uint32_t record;
+    float u;
+    float v;
+};
+
+// records - TriangleRecord components in SoA: component c of record i is records[c * stride + i],
+// components are row0.xyzw, row1.xyzw, row2.xyzw, stride leaves room for full last packet
+// tests records [begin, end), returns true and writes closest hit in (0, t_max) to hit, ties go to lower record
+// per lane math and comparisons repeat triangle_record_intersection without fused multiply-add, results are bit exact
+using TriangleKernel = bool (*)(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                                const KernelRay& ray, float t_max, KernelHit& hit);
+
+bool intersect_records_scalar(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                              const KernelRay& ray, float t_max, KernelHit& hit);
+#if TRIANGLE_KERNELS_X64
+bool intersect_records_sse4(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                            const KernelRay& ray, float t_max, KernelHit& hit);
+bool intersect_records_avx2(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                            const KernelRay& ray, float t_max, KernelHit& hit);
+bool intersect_records_avx512(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                              const KernelRay& ray, float t_max, KernelHit& hit);
+#endif
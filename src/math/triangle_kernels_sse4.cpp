@@ -0,0 +1,98 @@
+#include "triangle_kernels_isa.h"
+
+#if TRIANGLE_KERNELS_X64
+
+#include <smmintrin.h>
+
+// built with SSE4.1 enabled, see triangle_kernels_isa.h
+bool intersect_records_sse4(const float* records, uint32_t stride, uint32_t begin, uint32_t end,
+                            const KernelRay& ray, float t_max, KernelHit& hit)
+{
+    const __m128 origin_x = _mm_set1_ps(ray.origin[0]);
+    const __m128 origin_y = _mm_set1_ps(ray.origin[1]);
+    const __m128 origin_z = _mm_set1_ps(ray.origin[2]);
+    const __m128 direction_x = _mm_set1_ps(ray.direction[0]);
+    const __m128 direction_y = _mm_set1_ps(ray.direction[1]);
+    const __m128 direction_z = _mm_set1_ps(ray.direction[2]);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 sign = _mm_set1_ps(-0.f);
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    __m128 best_t = _mm_set1_ps(t_max);
+    __m128 best_u = zero;
+    __m128 best_v = zero;
+    __m128i best_record = _mm_set1_epi32(-1);
+
+    const float* r[12];
+    for (uint32_t c = 0; c < 12; ++c) {
+        r[c] = records + size_t(c) * stride;
+    }
+
+    for (uint32_t i = begin; i < end; i += 4) {
+        const __m128i record = _mm_add_epi32(_mm_set1_epi32(int32_t(i)), lanes);
+        const __m128 in_range = _mm_castsi128_ps(_mm_cmplt_epi32(lanes, _mm_set1_epi32(int32_t(end - i))));
+
+        const __m128 r2x = _mm_loadu_ps(r[8] + i);
+        const __m128 r2y = _mm_loadu_ps(r[9] + i);
+        const __m128 r2z = _mm_loadu_ps(r[10] + i);
+        const __m128 r2w = _mm_loadu_ps(r[11] + i);
+
+        const __m128 plane_direction = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r2x, direction_x), _mm_mul_ps(r2y, direction_y)), _mm_mul_ps(r2z, direction_z));
+        const __m128 plane_origin = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r2x, origin_x), _mm_mul_ps(r2y, origin_y)), _mm_mul_ps(r2z, origin_z)), r2w);
+        const __m128 t = _mm_div_ps(_mm_xor_ps(plane_origin, sign), plane_direction);
+
+        __m128 mask = _mm_and_ps(in_range, _mm_cmpneq_ps(plane_direction, zero));
+        mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, best_t)));
+        if (_mm_movemask_ps(mask) == 0) {
+            continue;
+        }
+
+        const __m128 px = _mm_add_ps(origin_x, _mm_mul_ps(t, direction_x));
+        const __m128 py = _mm_add_ps(origin_y, _mm_mul_ps(t, direction_y));
+        const __m128 pz = _mm_add_ps(origin_z, _mm_mul_ps(t, direction_z));
+
+        const __m128 u = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r[0] + i), px), _mm_mul_ps(_mm_loadu_ps(r[1] + i), py)),
+                                               _mm_mul_ps(_mm_loadu_ps(r[2] + i), pz)), _mm_loadu_ps(r[3] + i));
+        const __m128 v = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r[4] + i), px), _mm_mul_ps(_mm_loadu_ps(r[5] + i), py)),
+                                               _mm_mul_ps(_mm_loadu_ps(r[6] + i), pz)), _mm_loadu_ps(r[7] + i));
+
+        // not less / not greater keep scalar behaviour for NaN
+        mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpnlt_ps(u, zero), _mm_cmpngt_ps(u, one)));
+        mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpnlt_ps(v, zero), _mm_cmpngt_ps(_mm_add_ps(u, v), one)));
+
+        best_t = _mm_blendv_ps(best_t, t, mask);
+        best_u = _mm_blendv_ps(best_u, u, mask);
+        best_v = _mm_blendv_ps(best_v, v, mask);
+        best_record = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(best_record), _mm_castsi128_ps(record), mask));
+    }
+
+    alignas(16) float lane_t[4];
+    alignas(16) float lane_u[4];
+    alignas(16) float lane_v[4];
+    alignas(16) int32_t lane_record[4];
+    _mm_store_ps(lane_t, best_t);
+    _mm_store_ps(lane_u, best_u);
+    _mm_store_ps(lane_v, best_v);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lane_record), best_record);
+
+    int32_t best = -1;
+    for (int32_t lane = 0; lane < 4; ++lane) {
+        if (lane_record[lane] < 0) {
+            continue;
+        }
+        if (best < 0 || lane_t[lane] < lane_t[best] || (lane_t[lane] == lane_t[best] && lane_record[lane] < lane_record[best])) {
+            best = lane;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    hit.t = lane_t[best];
+    hit.record = uint32_t(lane_record[best]);
+    hit.u = lane_u[best];
+    hit.v = lane_v[best];
+    return true;
+}
+
+#endif
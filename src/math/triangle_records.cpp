@@ -0,0 +1,44 @@
+#include <cassert>
+
+#include "core/profiler.h"
+
+#include "triangle_records.h"
+
+namespace
+{
+
+Vector4 record_row(const Vector3& axis, const Vector3& origin)
+{
+    return Vector4(axis.x, axis.y, axis.z, -axis.Dot(origin));
+}
+
+} // namespace
+
+void build_triangle_records(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices,
+                            const Matrix& transform, std::vector<TriangleRecord>& records)
+{
+    PROFILE_ZONE("Triangle records");
+    assert(indices.size() % 3 == 0);
+
+    records.resize(indices.size() / 3);
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Vector3 v0 = Vector3::Transform(positions[indices[3 * i + 0]], transform);
+        const Vector3 v1 = Vector3::Transform(positions[indices[3 * i + 1]], transform);
+        const Vector3 v2 = Vector3::Transform(positions[indices[3 * i + 2]], transform);
+
+        const Vector3 edge1 = v1 - v0;
+        const Vector3 edge2 = v2 - v0;
+        const Vector3 normal = edge1.Cross(edge2);
+
+        // columns edge1, edge2, normal: det = |normal|^2, inverse rows are cross products over det
+        const float det = normal.Dot(normal);
+        if (det <= 1e-7f * edge1.Dot(edge1) * edge2.Dot(edge2)) {
+            records[i] = TriangleRecord{};
+            continue;
+        }
+
+        records[i].row0 = record_row(edge2.Cross(normal) / det, v0);
+        records[i].row1 = record_row(normal.Cross(edge1) / det, v0);
+        records[i].row2 = record_row(normal / det, v0);
+    }
+}
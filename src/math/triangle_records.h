@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "shaders/common/types.fx"
+#include "math/intersection.h"
+
+// one record per triangle of indices (in mesh tree order), positions are transformed by transform
+// degenerate triangles get zero records which never hit
+void build_triangle_records(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices,
+                            const Matrix& transform, std::vector<TriangleRecord>& records);
+
+// same result as triangle_intersection on the source triangle
+inline float triangle_record_intersection(const Ray& ray, const TriangleRecord& record, float& u, float& v)
+{
+    const float direction_z = record.row2.x * ray.direction.x + record.row2.y * ray.direction.y + record.row2.z * ray.direction.z;
+    if (direction_z == 0.f) {
+        return 0.f;
+    }
+    const float origin_z = record.row2.x * ray.origin.x + record.row2.y * ray.origin.y + record.row2.z * ray.origin.z + record.row2.w;
+    const float t = -origin_z / direction_z;
+    if (t < 0.f) {
+        return 0.f;
+    }
+
+    u = record.row0.x * (ray.origin.x + t * ray.direction.x) + record.row0.y * (ray.origin.y + t * ray.direction.y) +
+        record.row0.z * (ray.origin.z + t * ray.direction.z) + record.row0.w;
+    if (u < 0.f || u > 1.f) {
+        return 0.f;
+    }
+    v = record.row1.x * (ray.origin.x + t * ray.direction.x) + record.row1.y * (ray.origin.y + t * ray.direction.y) +
+        record.row1.z * (ray.origin.z + t * ray.direction.z) + record.row1.w;
+    if (v < 0.f || u + v > 1.f) {
+        return 0.f;
+    }
+    return t;
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+
+#include "core/profiler.h"
+#include "mesh_tree.h"
+#include "triangle_records.h"
+#include "world_transform.h"
+
+void transform_positions(const std::vector<Vector3>& positions, const Matrix& transform, std::vector<Vector3>& world_positions)
+{
+    world_positions.resize(positions.size());
+    if (!positions.empty()) {
+        Vector3::Transform(positions.data(), positions.size(), transform, world_positions.data());
+    }
+}
+
+void refit_mesh_tree(const std::vector<MeshTreeNode>& tree, const std::vector<uint32_t>& indices,
+                     const std::vector<Vector3>& world_positions, std::vector<MeshTreeNode>& world_tree)
+{
+    world_tree = tree;
+
+    // children are always after parents in heap order
+    std::vector<uint8_t> has_bounds(tree.size(), 0);
+    for (size_t i = tree.size(); i-- > 0;) {
+        MeshTreeNode& node = world_tree[i];
+        Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (int32_t j = node.start_index; j < node.start_index + node.count; ++j) {
+            assert(indices[j] < world_positions.size());
+            min = Vector3::Min(min, world_positions[indices[j]]);
+            max = Vector3::Max(max, world_positions[indices[j]]);
+        }
+        has_bounds[i] = node.count > 0;
+        for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < tree.size(); ++child) {
+            if (has_bounds[child]) {
+                min = Vector3::Min(min, world_tree[child].min);
+                max = Vector3::Max(max, world_tree[child].max);
+                has_bounds[i] = 1;
+            }
+        }
+
+        if (has_bounds[i]) {
+            node.min = min;
+            node.max = max;
+        } else {
+            node.min = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+            node.max = node.min;
+        }
+    }
+}
+
+void update_world_geometry(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices,
+                           const std::vector<MeshTreeNode>& tree, const Matrix& transform,
+                           WorldGeometry& world, WorldTransformStats* stats)
+{
+    PROFILE_ZONE("World transform");
+    auto time = std::chrono::steady_clock::now();
+    transform_positions(positions, transform, world.positions);
+    const float transform_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+
+    time = std::chrono::steady_clock::now();
+    refit_mesh_tree(tree, indices, world.positions, world.tree);
+    build_threaded_tree(world.tree, world.threaded_tree);
+    const float refit_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+
+    time = std::chrono::steady_clock::now();
+    build_triangle_records(world.positions, indices, Matrix::Identity, world.records);
+    const float records_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+
+    if (stats != nullptr) {
+        stats->transform_ms = transform_ms;
+        stats->refit_ms = refit_ms;
+        stats->records_ms = records_ms;
+        stats->vertices = uint32_t(world.positions.size());
+        stats->nodes = uint32_t(world.tree.size());
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "shaders/common/types.fx"
+
+// mesh data moved to world space once per transform change, traversal reads it without matrices
+struct WorldGeometry
+{
+    std::vector<Vector3> positions;
+    std::vector<MeshTreeNode> tree;                // refit_mesh_tree of model space tree
+    std::vector<ThreadedTreeNode> threaded_tree;   // build_threaded_tree of tree
+    std::vector<TriangleRecord> records;
+};
+
+struct WorldTransformStats
+{
+    float transform_ms{ 0.f };
+    float refit_ms{ 0.f };
+    float records_ms{ 0.f };
+    uint32_t vertices{ 0 };
+    uint32_t nodes{ 0 };
+};
+
+// batch transform, DirectXMath stream (SIMD) under Vector3::Transform
+void transform_positions(const std::vector<Vector3>& positions, const Matrix& transform, std::vector<Vector3>& world_positions);
+
+// same heap layout and triangle ranges, bounds recomputed bottom up from world positions
+// box of a node holds its own triangles and its children, so it stays tight under rotation
+// nodes with empty subtrees get a point box at FLT_MAX which slab test never hits
+void refit_mesh_tree(const std::vector<MeshTreeNode>& tree, const std::vector<uint32_t>& indices,
+                     const std::vector<Vector3>& world_positions, std::vector<MeshTreeNode>& world_tree);
+
+// positions, refit tree, threaded tree and triangle records of the transformed mesh
+// tree and indices are model space output of build_mesh_tree
+void update_world_geometry(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices,
+                           const std::vector<MeshTreeNode>& tree, const Matrix& transform,
+                           WorldGeometry& world, WorldTransformStats* stats = nullptr);
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+#include "core/parallel.h"
+#include "core/profiler.h"
+#include "cpu_voxelizer.h"
+
+void CpuVoxelizer::voxelize(const VoxelGridFrame& grid, int32_t brick_dim, const VoxelizerGeometry& geometry, Mode mode,
+                            const std::vector<uint32_t>* bricks)
+{
+    PROFILE_ZONE("CPU voxelize");
+    assert(grid.dimension > 0);
+    assert(geometry.positions.size() == geometry.normals.size());
+    assert(mode != Mode::instance_table || !geometry.instance_table.instances().empty());
+    assert((mode != Mode::tree_linear && mode != Mode::tree_stack) || !geometry.tree.empty());
+    assert(mode != Mode::tree_threaded || !geometry.threaded_tree.empty());
+    assert(!use_triangle_records_ || geometry.records.size() == geometry.indices.size() / 3);
+    assert(triangle_kernel_ == nullptr || geometry.record_packets.count == geometry.indices.size() / 3);
+    assert(per_test_transform_ == nullptr || (mode != Mode::brute_force && mode != Mode::binned &&
+                                              !use_triangle_records_ && triangle_kernel_ == nullptr));
+
+    stats_ = Stats{};
+    if (dimension_ != grid.dimension) {
+        dimension_ = grid.dimension;
+        voxels_.assign(size_t(dimension_) * dimension_ * dimension_, Voxel{});
+    }
+
+    // bins are needed in brute force mode too, for brick enumeration
+    auto time = std::chrono::steady_clock::now();
+    if (mode == Mode::binned) {
+        bin_triangles(grid, brick_dim, geometry.positions, geometry.indices, bins_, &stats_.binning);
+    } else {
+        bins_.brick_dim = brick_dim;
+        bins_.bricks_per_axis = uint32_t((grid.dimension + brick_dim - 1) / brick_dim);
+    }
+    stats_.binning_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+
+    std::vector<uint32_t> all_bricks;
+    if (bricks == nullptr) {
+        all_bricks.resize(bins_.brick_count());
+        for (uint32_t i = 0; i < bins_.brick_count(); ++i) {
+            all_bricks[i] = i;
+        }
+        bricks = &all_bricks;
+    }
+
+    time = std::chrono::steady_clock::now();
+    const uint32_t brick_count = uint32_t(bricks->size());
+    const uint32_t worker_count = parallel_worker_count(brick_count, 4);
+    std::vector<TraversalCounters> worker_counters(worker_count);
+    std::vector<uint32_t> worker_filled(worker_count, 0);
+    parallel_for_ranges(brick_count, worker_count, [&](uint32_t begin, uint32_t end, uint32_t worker) {
+        PROFILE_ZONE("Voxelize bricks");
+        for (uint32_t i = begin; i < end; ++i) {
+            voxelize_brick(grid, brick_dim, (*bricks)[i], geometry, mode, worker_counters[worker], worker_filled[worker]);
+        }
+    });
+    stats_.voxelize_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - time).count();
+
+    for (uint32_t i = 0; i < worker_count; ++i) {
+        stats_.triangle_tests += worker_counters[i].triangle_tests;
+        stats_.node_visits += worker_counters[i].node_visits;
+        stats_.filled_voxels += worker_filled[i];
+    }
+    for (uint32_t brick : *bricks) {
+        int32_t coord[3] = { int32_t(brick % bins_.bricks_per_axis),
+                             int32_t((brick / bins_.bricks_per_axis) % bins_.bricks_per_axis),
+                             int32_t(brick / (bins_.bricks_per_axis * bins_.bricks_per_axis)) };
+        uint32_t count = 1;
+        for (int32_t axis = 0; axis < 3; ++axis) {
+            count *= uint32_t(std::min(brick_dim, grid.dimension - coord[axis] * brick_dim));
+        }
+        stats_.voxels += count;
+    }
+}
+
+void CpuVoxelizer::set_use_triangle_records(bool use)
+{
+    use_triangle_records_ = use;
+}
+
+void CpuVoxelizer::set_triangle_kernel(TriangleKernel kernel)
+{
+    triangle_kernel_ = kernel;
+}
+
+void CpuVoxelizer::set_per_test_transform(const Matrix* transform)
+{
+    per_test_transform_ = transform;
+}
+
+const std::vector<Voxel>& CpuVoxelizer::voxels() const
+{
+    return voxels_;
+}
+
+const Voxel& CpuVoxelizer::voxel(int32_t x, int32_t y, int32_t z) const
+{
+    return voxels_[(size_t(z) * dimension_ + y) * dimension_ + x];
+}
+
+const CpuVoxelizer::Stats& CpuVoxelizer::stats() const
+{
+    return stats_;
+}
+
+void CpuVoxelizer::voxelize_brick(const VoxelGridFrame& grid, int32_t brick_dim, uint32_t brick,
+                                  const VoxelizerGeometry& geometry, Mode mode, TraversalCounters& counters, uint32_t& filled)
+{
+    const uint32_t bricks_per_axis = bins_.bricks_per_axis;
+    const int32_t brick_coord[3] = { int32_t(brick % bricks_per_axis),
+                                     int32_t((brick / bricks_per_axis) % bricks_per_axis),
+                                     int32_t(brick / (bricks_per_axis * bricks_per_axis)) };
+
+    uint32_t triangles_begin = 0;
+    uint32_t triangles_end = uint32_t(geometry.indices.size() / 3);
+    if (mode == Mode::binned) {
+        triangles_begin = bins_.begin(brick);
+        triangles_end = bins_.end(brick);
+    }
+
+    MeshTreeView tree;
+    tree.nodes = geometry.tree.data();
+    tree.node_count = uint32_t(geometry.tree.size());
+    tree.indices = geometry.indices.data();
+    tree.positions = geometry.positions.data();
+    tree.records = use_triangle_records_ ? geometry.records.data() : nullptr;
+    tree.packets = &geometry.record_packets;
+    tree.kernel = triangle_kernel_;
+    tree.transform = per_test_transform_;
+
+    ThreadedTreeView threaded_tree;
+    threaded_tree.nodes = geometry.threaded_tree.data();
+    threaded_tree.node_count = uint32_t(geometry.threaded_tree.size());
+    threaded_tree.indices = geometry.indices.data();
+    threaded_tree.positions = geometry.positions.data();
+    threaded_tree.records = tree.records;
+    threaded_tree.packets = tree.packets;
+    threaded_tree.kernel = tree.kernel;
+    threaded_tree.transform = tree.transform;
+
+    const MeshInstanceTable& table = geometry.instance_table;
+    InstanceTableView instances;
+    instances.instances = table.instances().data();
+    instances.instance_count = uint32_t(table.instances().size());
+    instances.nodes = table.nodes().data();
+    instances.indices = table.indices().data();
+    instances.records = table.records().data();
+
+    const int32_t x_end = std::min((brick_coord[0] + 1) * brick_dim, grid.dimension);
+    const int32_t y_end = std::min((brick_coord[1] + 1) * brick_dim, grid.dimension);
+    const int32_t z_end = std::min((brick_coord[2] + 1) * brick_dim, grid.dimension);
+    for (int32_t z = brick_coord[2] * brick_dim; z < z_end; ++z) {
+        for (int32_t y = brick_coord[1] * brick_dim; y < y_end; ++y) {
+            for (int32_t x = brick_coord[0] * brick_dim; x < x_end; ++x) {
+                Ray rays[3];
+                grid.voxel_rays(x, y, z, rays);
+
+                // hits are clipped to the voxel extent
+                TraversalHit closest;
+                for (const Ray& ray : rays) {
+                    TraversalHit hit;
+                    if (mode == Mode::instance_table) {
+                        hit = traverse_instance_table(instances, ray, grid.unit, counters);
+                    } else if (mode == Mode::tree_stack) {
+                        hit = traverse_mesh_tree(tree, ray, grid.unit, counters);
+                    } else if (mode == Mode::tree_threaded) {
+                        hit = traverse_threaded_tree(threaded_tree, ray, grid.unit, counters);
+                    } else if (mode == Mode::tree_linear) {
+                        hit = traverse_mesh_tree_linear(tree, ray, grid.unit, counters);
+                    } else {
+                        for (uint32_t i = triangles_begin; i < triangles_end; ++i) {
+                            const uint32_t triangle = (mode == Mode::binned) ? bins_.triangles[i] : i;
+                            const uint32_t* index = &geometry.indices[triangle * 3];
+                            ++counters.triangle_tests;
+                            float u;
+                            float v;
+                            const float t = use_triangle_records_ ?
+                                triangle_record_intersection(ray, geometry.records[triangle], u, v) :
+                                triangle_intersection(ray, geometry.positions[index[0]], geometry.positions[index[1]],
+                                                      geometry.positions[index[2]], u, v);
+                            if (t > 0 && t < grid.unit && (t < hit.t || hit.t == 0)) {
+                                hit.t = t;
+                                hit.index = triangle * 3;
+                                hit.u = u;
+                                hit.v = v;
+                            }
+                        }
+                    }
+                    if (hit.t > 0 && (hit.t < closest.t || closest.t == 0)) {
+                        closest = hit;
+                    }
+                }
+
+                Voxel& voxel = voxels_[(size_t(z) * dimension_ + y) * dimension_ + x];
+                voxel = Voxel{};
+                if (closest.t > 0) {
+                    voxel.albedo = Vector3(float(x), float(y), float(z));
+                    if (mode == Mode::instance_table) {
+                        // table vertices are model space
+                        const MeshInstance& instance = table.instances()[closest.instance];
+                        const uint32_t* index = &table.indices()[closest.index];
+                        const Vertex* vertices = &table.vertices()[instance.vertex_offset];
+                        voxel.normal = Vector3::TransformNormal(vertices[index[0]].normal * (1 - closest.u - closest.v) +
+                                                                vertices[index[1]].normal * closest.u + vertices[index[2]].normal * closest.v,
+                                                                table.transforms()[instance.transform_index].inverse_transpose_transform);
+                    } else {
+                        const uint32_t* index = &geometry.indices[closest.index];
+                        voxel.normal = geometry.normals[index[0]] * (1 - closest.u - closest.v) +
+                                       geometry.normals[index[1]] * closest.u + geometry.normals[index[2]] * closest.v;
+                    }
+                    // interpolated and scaled normals are shorter or longer than one, same as fill.hlsl
+                    voxel.normal.Normalize();
+                    voxel.metalness = closest.t;
+                    ++filled;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "shaders/common/types.fx"
+
+#include "voxels/voxel_grid.h"
+#include "voxels/triangle_binning.h"
+#include "voxels/mesh_instance_table.h"
+#include "math/tree_traversal.h"
+
+// world space triangle soup
+struct VoxelizerGeometry
+{
+    std::vector<Vector3> positions;
+    std::vector<Vector3> normals;
+    std::vector<uint32_t> indices;
+
+    // optional, needed by tree modes, built over indices by build_mesh_tree
+    std::vector<MeshTreeNode> tree;
+    std::vector<ThreadedTreeNode> threaded_tree; // build_threaded_tree of tree
+
+    // optional, build_triangle_records of positions and indices
+    std::vector<TriangleRecord> records;
+    TriangleRecordPackets record_packets; // build_triangle_record_packets of records
+
+    // optional, needed by instance_table mode, other members are not used by it
+    MeshInstanceTable instance_table;
+};
+
+// CPU reference of the voxels fill pass, writes the same voxel layout as fill.hlsl
+class CpuVoxelizer
+{
+public:
+    enum class Mode : uint32_t
+    {
+        brute_force,   // every voxel tests every triangle
+        binned,        // every voxel tests triangles of its brick only
+        tree_linear,   // old fill.hlsl mesh tree walk
+        tree_stack,    // front to back mesh tree traversal, same as fill.hlsl
+        tree_threaded, // stackless traversal of threaded tree
+        instance_table, // stack traversal of every instance table mesh with triangle records, same as fill.hlsl
+    };
+
+    struct Stats
+    {
+        float binning_ms{ 0.f };
+        float voxelize_ms{ 0.f };
+        uint64_t triangle_tests{ 0 };
+        uint64_t node_visits{ 0 };
+        uint32_t voxels{ 0 };
+        uint32_t filled_voxels{ 0 };
+        TriangleBinningStats binning;
+    };
+
+    CpuVoxelizer() = default;
+    ~CpuVoxelizer() = default;
+
+    // bricks - brick indices to update (VoxelUpdateScheduler output), nullptr - whole grid
+    void voxelize(const VoxelGridFrame& grid, int32_t brick_dim, const VoxelizerGeometry& geometry, Mode mode,
+                  const std::vector<uint32_t>* bricks = nullptr);
+
+    // intersect precomputed triangle records instead of fetching vertices, geometry.records must be built
+    void set_use_triangle_records(bool use);
+    // tree modes test node triangles with SIMD kernel, geometry.record_packets must be built; nullptr - one by one
+    void set_triangle_kernel(TriangleKernel kernel);
+    // tree modes read model space geometry and transform node corners and vertices on every test, nullptr - off
+    // baseline for pre-transformed WorldGeometry
+    void set_per_test_transform(const Matrix* transform);
+
+    const std::vector<Voxel>& voxels() const;
+    const Voxel& voxel(int32_t x, int32_t y, int32_t z) const;
+    const Stats& stats() const;
+private:
+    void voxelize_brick(const VoxelGridFrame& grid, int32_t brick_dim, uint32_t brick,
+                        const VoxelizerGeometry& geometry, Mode mode, TraversalCounters& counters, uint32_t& filled);
+
+    std::vector<Voxel> voxels_;
+    int32_t dimension_{ 0 };
+    bool use_triangle_records_{ false };
+    TriangleKernel triangle_kernel_{ nullptr };
+    const Matrix* per_test_transform_{ nullptr };
+
+    TriangleBins bins_;
+    Stats stats_;
+};
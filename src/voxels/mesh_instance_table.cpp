@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cassert>
+
+#include "mesh_instance_table.h"
+
+void MeshInstanceTable::clear()
+{
+    instances_.clear();
+    nodes_.clear();
+    indices_.clear();
+    vertices_.clear();
+    records_.clear();
+    transforms_.clear();
+}
+
+uint32_t MeshInstanceTable::add_transform(const Matrix& transform)
+{
+    transforms_.emplace_back();
+    update_transform(uint32_t(transforms_.size() - 1), transform);
+    return uint32_t(transforms_.size() - 1);
+}
+
+void MeshInstanceTable::update_transform(uint32_t transform_index, const Matrix& transform)
+{
+    assert(transform_index < transforms_.size());
+    transforms_[transform_index].transform = transform;
+    transforms_[transform_index].inverse_transpose_transform = transform.Invert().Transpose();
+}
+
+uint32_t MeshInstanceTable::add_mesh(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                                     const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records,
+                                     uint32_t transform_index)
+{
+    assert(indices.size() % 3 == 0);
+    assert(records.size() == indices.size() / 3);
+    assert(transform_index < transforms_.size());
+    // records are addressed by global index / 3
+    assert(indices_.size() % 3 == 0);
+
+    MeshInstance instance{};
+    instance.node_offset = uint32_t(nodes_.size());
+    instance.node_count = uint32_t(tree.size());
+    instance.index_offset = uint32_t(indices_.size());
+    instance.vertex_offset = uint32_t(vertices_.size());
+    instance.transform_index = transform_index;
+    instances_.push_back(instance);
+
+    for (const MeshTreeNode& node : tree) {
+        assert(node.start_index >= 0 && size_t(node.start_index) + node.count <= indices.size());
+        nodes_.push_back(node);
+    }
+    for (uint32_t index : indices) {
+        assert(index < vertices.size());
+        indices_.push_back(index);
+    }
+    vertices_.insert(vertices_.end(), vertices.begin(), vertices.end());
+    records_.insert(records_.end(), records.begin(), records.end());
+    return uint32_t(instances_.size() - 1);
+}
+
+void MeshInstanceTable::update_mesh(uint32_t instance, const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records)
+{
+    assert(instance < instances_.size());
+    const MeshInstance& entry = instances_[instance];
+    assert(tree.size() == entry.node_count);
+
+    std::copy(tree.begin(), tree.end(), nodes_.begin() + entry.node_offset);
+    assert(entry.index_offset / 3 + records.size() <= records_.size());
+    std::copy(records.begin(), records.end(), records_.begin() + entry.index_offset / 3);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "shaders/common/types.fx"
+
+// Geometry of all meshes concatenated into flat arrays, addressed through MeshInstance entries.
+// Arrays map one to one to fill.hlsl buffers, so every mesh is voxelized by a single dispatch.
+// Meshes are appended once; moved instances rewrite their tree, records and transform in place.
+class MeshInstanceTable
+{
+public:
+    MeshInstanceTable() = default;
+    ~MeshInstanceTable() = default;
+
+    void clear();
+
+    // returns transform index, shared by meshes of one model
+    uint32_t add_transform(const Matrix& transform);
+    void update_transform(uint32_t transform_index, const Matrix& transform);
+
+    // indices in tree order (see build_mesh_tree), tree and records in world space (see WorldGeometry)
+    // vertices stay in model space, only normals are read from them; returns instance index
+    uint32_t add_mesh(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                      const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records,
+                      uint32_t transform_index);
+    // tree and records of the same mesh after transform change, sizes must match
+    void update_mesh(uint32_t instance, const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records);
+
+    const std::vector<MeshInstance>& instances() const { return instances_; }
+    const std::vector<MeshTreeNode>& nodes() const { return nodes_; }
+    const std::vector<uint32_t>& indices() const { return indices_; }
+    const std::vector<Vertex>& vertices() const { return vertices_; }
+    const std::vector<TriangleRecord>& records() const { return records_; }
+    const std::vector<InstanceTransform>& transforms() const { return transforms_; }
+private:
+    std::vector<MeshInstance> instances_;
+    std::vector<MeshTreeNode> nodes_;
+    std::vector<uint32_t> indices_;
+    std::vector<Vertex> vertices_;
+    std::vector<TriangleRecord> records_;
+    std::vector<InstanceTransform> transforms_;
+};
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+#include "core/parallel.h"
+#include "core/profiler.h"
+#include "triangle_binning.h"
+
+namespace
+{
+
+// inclusive brick range of a triangle, empty if min > max
+struct BrickRange
+{
+    int32_t min[3];
+    int32_t max[3];
+
+    bool empty() const
+    {
+        return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+    }
+};
+
+// bounds are padded to keep triangles lying exactly on brick faces in both bricks
+constexpr float bounds_padding = 1e-3f; // in voxels
+
+float elapsed_ms(std::chrono::steady_clock::time_point from)
+{
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - from).count();
+}
+
+} // namespace
+
+void bin_triangles(const VoxelGridFrame& grid, int32_t brick_dim,
+                   const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices,
+                   TriangleBins& bins, TriangleBinningStats* stats)
+{
+    PROFILE_ZONE("Triangle binning");
+    assert(brick_dim > 0);
+    assert(indices.size() % 3 == 0);
+
+    bins.brick_dim = brick_dim;
+    bins.bricks_per_axis = uint32_t((grid.dimension + brick_dim - 1) / brick_dim);
+    const uint32_t brick_count = bins.brick_count();
+    const uint32_t triangle_count = uint32_t(indices.size() / 3);
+    const int32_t last_brick = int32_t(bins.bricks_per_axis) - 1;
+
+    const uint32_t worker_count = parallel_worker_count(triangle_count, 4096);
+    std::vector<BrickRange> ranges(triangle_count);
+    std::vector<std::vector<uint32_t>> worker_counts(worker_count);
+
+    // 1. triangle bounds in grid space, per worker brick histograms
+    auto time = std::chrono::steady_clock::now();
+    parallel_for_ranges(triangle_count, worker_count, [&](uint32_t begin, uint32_t end, uint32_t worker) {
+        std::vector<uint32_t>& counts = worker_counts[worker];
+        counts.assign(brick_count, 0);
+        for (uint32_t i = begin; i < end; ++i) {
+            const Vector3 p0 = grid.to_grid(positions[indices[i * 3 + 0]]);
+            const Vector3 p1 = grid.to_grid(positions[indices[i * 3 + 1]]);
+            const Vector3 p2 = grid.to_grid(positions[indices[i * 3 + 2]]);
+            const float min[3] = { std::min({ p0.x, p1.x, p2.x }), std::min({ p0.y, p1.y, p2.y }), std::min({ p0.z, p1.z, p2.z }) };
+            const float max[3] = { std::max({ p0.x, p1.x, p2.x }), std::max({ p0.y, p1.y, p2.y }), std::max({ p0.z, p1.z, p2.z }) };
+
+            BrickRange& range = ranges[i];
+            for (int32_t axis = 0; axis < 3; ++axis) {
+                range.min[axis] = std::max(int32_t(std::floor((min[axis] - bounds_padding) / brick_dim)), 0);
+                range.max[axis] = std::min(int32_t(std::floor((max[axis] + bounds_padding) / brick_dim)), last_brick);
+                if (max[axis] + bounds_padding < 0.f) {
+                    range.max[axis] = -1;
+                }
+            }
+            if (range.empty()) {
+                continue;
+            }
+
+            for (int32_t z = range.min[2]; z <= range.max[2]; ++z) {
+                for (int32_t y = range.min[1]; y <= range.max[1]; ++y) {
+                    for (int32_t x = range.min[0]; x <= range.max[0]; ++x) {
+                        ++counts[bins.brick(x, y, z)];
+                    }
+                }
+            }
+        }
+    });
+    const float bounds_ms = elapsed_ms(time);
+
+    // 2. exclusive prefix sum over (brick, worker) pairs, bricks outer
+    // every worker gets its own write cursor inside each brick, so scatter needs no atomics
+    // and triangles inside a brick stay ordered by index
+    time = std::chrono::steady_clock::now();
+    bins.brick_offsets.resize(brick_count + 1);
+    const uint32_t scan_worker_count = parallel_worker_count(brick_count, 4096);
+    std::vector<uint32_t> block_sums(scan_worker_count + 1, 0);
+    parallel_for_ranges(brick_count, scan_worker_count, [&](uint32_t begin, uint32_t end, uint32_t worker) {
+        uint32_t sum = 0;
+        for (uint32_t brick = begin; brick < end; ++brick) {
+            for (uint32_t w = 0; w < worker_count; ++w) {
+                sum += worker_counts[w][brick];
+            }
+        }
+        block_sums[worker + 1] = sum;
+    });
+    for (uint32_t i = 1; i <= scan_worker_count; ++i) {
+        block_sums[i] += block_sums[i - 1];
+    }
+    parallel_for_ranges(brick_count, scan_worker_count, [&](uint32_t begin, uint32_t end, uint32_t worker) {
+        uint32_t offset = block_sums[worker];
+        for (uint32_t brick = begin; brick < end; ++brick) {
+            bins.brick_offsets[brick] = offset;
+            for (uint32_t w = 0; w < worker_count; ++w) {
+                const uint32_t count = worker_counts[w][brick];
+                worker_counts[w][brick] = offset; // count becomes write cursor
+                offset += count;
+            }
+        }
+    });
+    const uint32_t references = block_sums[scan_worker_count];
+    bins.brick_offsets[brick_count] = references;
+    const float scan_ms = elapsed_ms(time);
+
+    // 3. scatter triangle indices with the same triangle ranges as in pass 1
+    time = std::chrono::steady_clock::now();
+    bins.triangles.resize(references);
+    parallel_for_ranges(triangle_count, worker_count, [&](uint32_t begin, uint32_t end, uint32_t worker) {
+        std::vector<uint32_t>& cursors = worker_counts[worker];
+        for (uint32_t i = begin; i < end; ++i) {
+            const BrickRange& range = ranges[i];
+            if (range.empty()) {
+                continue;
+            }
+            for (int32_t z = range.min[2]; z <= range.max[2]; ++z) {
+                for (int32_t y = range.min[1]; y <= range.max[1]; ++y) {
+                    for (int32_t x = range.min[0]; x <= range.max[0]; ++x) {
+                        bins.triangles[cursors[bins.brick(x, y, z)]++] = i;
+                    }
+                }
+            }
+        }
+    });
+    const float scatter_ms = elapsed_ms(time);
+
+    if (stats != nullptr) {
+        stats->bounds_ms = bounds_ms;
+        stats->scan_ms = scan_ms;
+        stats->scatter_ms = scatter_ms;
+        stats->worker_count = worker_count;
+        stats->references = references;
+        stats->max_brick_triangles = 0;
+        for (uint32_t brick = 0; brick < brick_count; ++brick) {
+            stats->max_brick_triangles = std::max(stats->max_brick_triangles, bins.end(brick) - bins.begin(brick));
+        }
+    }
+}
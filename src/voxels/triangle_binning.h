@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "voxels/voxel_grid.h"
+
+// triangles assigned to voxel bricks by their grid space bounds
+// layout is GPU friendly: per brick ranges in one flat array
+struct TriangleBins
+{
+    int32_t brick_dim{ 0 };
+    uint32_t bricks_per_axis{ 0 };
+
+    std::vector<uint32_t> brick_offsets; // brick_count + 1 entries, exclusive prefix sum of per brick triangle counts
+    std::vector<uint32_t> triangles;     // triangle indices (first index / 3) grouped by brick, ascending inside brick
+
+    uint32_t brick_count() const
+    {
+        return bricks_per_axis * bricks_per_axis * bricks_per_axis;
+    }
+
+    uint32_t brick(int32_t x, int32_t y, int32_t z) const
+    {
+        return uint32_t((z * int32_t(bricks_per_axis) + y) * int32_t(bricks_per_axis) + x);
+    }
+
+    uint32_t begin(uint32_t brick) const
+    {
+        return brick_offsets[brick];
+    }
+
+    uint32_t end(uint32_t brick) const
+    {
+        return brick_offsets[brick + 1];
+    }
+};
+
+struct TriangleBinningStats
+{
+    float bounds_ms{ 0.f };  // grid space bounds and per worker brick counts
+    float scan_ms{ 0.f };    // prefix sum
+    float scatter_ms{ 0.f };
+    uint32_t worker_count{ 0 };
+    uint32_t references{ 0 }; // triangle-brick pairs
+    uint32_t max_brick_triangles{ 0 };
+};
+
+// positions are world space, indices form triangle list
+void bin_triangles(const VoxelGridFrame& grid, int32_t brick_dim,
+                   const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices,
+                   TriangleBins& bins, TriangleBinningStats* stats = nullptr);
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+#include "core/profiler.h"
+#include "update_scheduler.h"
+
+void VoxelUpdateScheduler::initialize(int32_t grid_dimension, const Settings& settings)
+{
+    assert(grid_dimension > 0);
+    assert(settings.brick_dim > 0);
+
+    settings_ = settings;
+    grid_dimension_ = grid_dimension;
+    bricks_per_axis_ = uint32_t((grid_dimension + settings_.brick_dim - 1) / settings_.brick_dim);
+
+    const uint32_t count = brick_count();
+    last_update_.assign(count, 0);
+    dirty_.assign(count, 1);
+    distance_.assign(count, 0.f);
+    dirty_count_ = count;
+
+    queue_.clear();
+    queue_.reserve(count);
+    queue_outdated_ = true;
+
+    grid_ = VoxelGridFrame{};
+    scheduled_.clear();
+    scheduled_voxels_ = 0;
+    frame_ = 0;
+    ms_per_voxel_ = 0.f;
+}
+
+void VoxelUpdateScheduler::set_settings(const Settings& settings)
+{
+    if (settings.brick_dim != settings_.brick_dim) {
+        initialize(grid_dimension_, settings);
+        return;
+    }
+    settings_ = settings;
+    queue_outdated_ = true;
+}
+
+const VoxelUpdateScheduler::Settings& VoxelUpdateScheduler::settings() const
+{
+    return settings_;
+}
+
+void VoxelUpdateScheduler::mark_dirty(uint32_t brick)
+{
+    assert(brick < brick_count());
+    if (dirty_[brick] == 0) {
+        dirty_[brick] = 1;
+        ++dirty_count_;
+        queue_outdated_ = true;
+    }
+}
+
+void VoxelUpdateScheduler::mark_dirty(const Vector3& grid_min, const Vector3& grid_max)
+{
+    const float min[3] = { grid_min.x, grid_min.y, grid_min.z };
+    const float max[3] = { grid_max.x, grid_max.y, grid_max.z };
+    int32_t from[3];
+    int32_t to[3];
+    for (int32_t i = 0; i < 3; ++i) {
+        from[i] = std::max(int32_t(std::floor(min[i])) / settings_.brick_dim, 0);
+        to[i] = std::min(int32_t(std::floor(max[i])) / settings_.brick_dim, int32_t(bricks_per_axis_) - 1);
+        if (max[i] < 0 || from[i] > to[i]) {
+            return;
+        }
+    }
+
+    for (int32_t z = from[2]; z <= to[2]; ++z) {
+        for (int32_t y = from[1]; y <= to[1]; ++y) {
+            for (int32_t x = from[0]; x <= to[0]; ++x) {
+                mark_dirty(uint32_t((z * bricks_per_axis_ + y) * bricks_per_axis_ + x));
+            }
+        }
+    }
+}
+
+void VoxelUpdateScheduler::mark_all_dirty()
+{
+    std::fill(dirty_.begin(), dirty_.end(), uint8_t(1));
+    dirty_count_ = brick_count();
+    queue_outdated_ = true;
+}
+
+const std::vector<uint32_t>& VoxelUpdateScheduler::schedule(const VoxelGridFrame& grid, const Vector3& camera_position)
+{
+    PROFILE_ZONE("Schedule voxel updates");
+    ++frame_;
+    scheduled_.clear();
+    scheduled_voxels_ = 0;
+
+    if (grid != grid_ || camera_position != camera_position_) {
+        grid_ = grid;
+        camera_position_ = camera_position;
+
+        const float brick_length = settings_.brick_dim * grid_.unit;
+        for (uint32_t i = 0; i < brick_count(); ++i) {
+            int32_t coord[3];
+            brick_coord(i, coord);
+            Vector3 center = grid_.origin + (grid_.right * (coord[0] + .5f) + grid_.up * (coord[1] + .5f) + grid_.forward * (coord[2] + .5f)) * brick_length;
+            distance_[i] = (center - camera_position_).Length() / brick_length;
+        }
+        queue_outdated_ = true;
+    }
+
+    if (queue_outdated_) {
+        rebuild_queue();
+    }
+
+    const uint32_t budget = voxel_budget();
+    while (!queue_.empty()) {
+        const uint32_t brick = queue_.front().brick;
+        const uint32_t voxels = brick_voxel_count(brick);
+        // always issue at least one brick so the grid converges with any budget
+        if (budget != 0 && !scheduled_.empty() && scheduled_voxels_ + voxels > budget) {
+            break;
+        }
+        std::pop_heap(queue_.begin(), queue_.end(), entry_less);
+        queue_.pop_back();
+
+        scheduled_.push_back(brick);
+        scheduled_voxels_ += voxels;
+    }
+
+    for (uint32_t brick : scheduled_) {
+        last_update_[brick] = frame_;
+        if (dirty_[brick] != 0) {
+            dirty_[brick] = 0;
+            --dirty_count_;
+        }
+        queue_.push_back({ entry_key(brick), brick });
+        std::push_heap(queue_.begin(), queue_.end(), entry_less);
+    }
+
+    return scheduled_;
+}
+
+void VoxelUpdateScheduler::report_frame_cost(float milliseconds)
+{
+    report_frame_cost(milliseconds, scheduled_voxels_);
+}
+
+void VoxelUpdateScheduler::report_frame_cost(float milliseconds, uint32_t voxels)
+{
+    if (voxels == 0 || milliseconds <= 0.f) {
+        return;
+    }
+    const float cost = milliseconds / voxels;
+    ms_per_voxel_ = (ms_per_voxel_ == 0.f) ? cost : ms_per_voxel_ * .9f + cost * .1f;
+}
+
+void VoxelUpdateScheduler::brick_coord(uint32_t brick, int32_t coord[3]) const
+{
+    coord[0] = int32_t(brick % bricks_per_axis_);
+    coord[1] = int32_t((brick / bricks_per_axis_) % bricks_per_axis_);
+    coord[2] = int32_t(brick / (bricks_per_axis_ * bricks_per_axis_));
+}
+
+uint32_t VoxelUpdateScheduler::brick_voxel_count(uint32_t brick) const
+{
+    // bricks on the far grid border may be cut
+    int32_t coord[3];
+    brick_coord(brick, coord);
+    uint32_t count = 1;
+    for (int32_t i = 0; i < 3; ++i) {
+        count *= uint32_t(std::min(settings_.brick_dim, grid_dimension_ - coord[i] * settings_.brick_dim));
+    }
+    return count;
+}
+
+uint32_t VoxelUpdateScheduler::brick_count() const
+{
+    return bricks_per_axis_ * bricks_per_axis_ * bricks_per_axis_;
+}
+
+uint32_t VoxelUpdateScheduler::bricks_per_axis() const
+{
+    return bricks_per_axis_;
+}
+
+uint32_t VoxelUpdateScheduler::dirty_brick_count() const
+{
+    return dirty_count_;
+}
+
+uint32_t VoxelUpdateScheduler::scheduled_voxel_count() const
+{
+    return scheduled_voxels_;
+}
+
+uint64_t VoxelUpdateScheduler::frame() const
+{
+    return frame_;
+}
+
+float VoxelUpdateScheduler::ms_per_voxel() const
+{
+    return ms_per_voxel_;
+}
+
+// static
+bool VoxelUpdateScheduler::entry_less(const Entry& l, const Entry& r)
+{
+    // equal keys - lower brick index wins, keeps order deterministic
+    if (l.key != r.key) {
+        return l.key < r.key;
+    }
+    return l.brick > r.brick;
+}
+
+float VoxelUpdateScheduler::entry_key(uint32_t brick) const
+{
+    // age term is age_weight * (frame - last_update), frame part is the same for every brick and dropped
+    return settings_.dirty_weight * dirty_[brick] -
+           settings_.distance_weight * distance_[brick] -
+           settings_.age_weight * float(last_update_[brick]);
+}
+
+void VoxelUpdateScheduler::rebuild_queue()
+{
+    queue_.clear();
+    for (uint32_t i = 0; i < brick_count(); ++i) {
+        queue_.push_back({ entry_key(i), i });
+    }
+    std::make_heap(queue_.begin(), queue_.end(), entry_less);
+    queue_outdated_ = false;
+}
+
+uint32_t VoxelUpdateScheduler::voxel_budget() const
+{
+    uint32_t budget = settings_.voxel_budget;
+    if (settings_.time_budget_ms > 0.f && ms_per_voxel_ > 0.f) {
+        const uint32_t time_budget = std::max(uint32_t(settings_.time_budget_ms / ms_per_voxel_), 1u);
+        budget = (budget == 0) ? time_budget : std::min(budget, time_budget);
+    }
+    return budget;
+}
+
+std::vector<SchedulerConvergence> measure_scheduler_convergence(const std::vector<CameraSample>& path,
+                                                                float grid_size, int32_t grid_dimension,
+                                                                const std::vector<uint32_t>& voxel_budgets,
+                                                                VoxelUpdateScheduler::Settings settings)
+{
+    // frames to wait after the path end before giving up
+    constexpr uint32_t max_tail_frames = 1u << 20;
+
+    std::vector<SchedulerConvergence> result;
+    if (path.empty()) {
+        return result;
+    }
+
+    for (uint32_t budget : voxel_budgets) {
+        settings.voxel_budget = budget;
+        settings.time_budget_ms = 0.f;
+
+        VoxelUpdateScheduler scheduler;
+        scheduler.initialize(grid_dimension, settings);
+
+        uint64_t last_change = 0;
+        uint64_t converged = 0;
+        double clean_sum = 0;
+        for (size_t i = 0; i < path.size(); ++i) {
+            if (i > 0 && (path[i].position != path[i - 1].position || path[i].forward != path[i - 1].forward)) {
+                // grid is attached to camera, everything it holds is outdated
+                scheduler.mark_all_dirty();
+                last_change = scheduler.frame();
+                converged = 0;
+            }
+            scheduler.schedule(VoxelGridFrame::from_camera(path[i].position, path[i].forward, grid_size, grid_dimension), path[i].position);
+            if (converged == 0 && scheduler.dirty_brick_count() == 0) {
+                converged = scheduler.frame();
+            }
+            clean_sum += 1.0 - double(scheduler.dirty_brick_count()) / scheduler.brick_count();
+        }
+
+        const VoxelGridFrame last_grid = VoxelGridFrame::from_camera(path.back().position, path.back().forward, grid_size, grid_dimension);
+        for (uint32_t tail = 0; converged == 0 && tail < max_tail_frames; ++tail) {
+            scheduler.schedule(last_grid, path.back().position);
+            if (scheduler.dirty_brick_count() == 0) {
+                converged = scheduler.frame();
+            }
+        }
+
+        SchedulerConvergence entry;
+        entry.voxel_budget = budget;
+        entry.frames_to_converge = converged != 0 ? uint32_t(converged - last_change) : UINT32_MAX;
+        entry.mean_clean_fraction = float(clean_sum / path.size());
+        result.push_back(entry);
+    }
+    return result;
+}
+
+std::string format_scheduler_convergence(const std::vector<SchedulerConvergence>& report)
+{
+    std::stringstream ss;
+    ss << std::setw(14) << "voxel budget" << std::setw(20) << "frames to converge" << std::setw(16) << "mean clean %" << "\n";
+    for (const SchedulerConvergence& entry : report) {
+        ss << std::setw(14);
+        if (entry.voxel_budget == 0) {
+            ss << "unlimited";
+        } else {
+            ss << entry.voxel_budget;
+        }
+        ss << std::setw(20);
+        if (entry.frames_to_converge == UINT32_MAX) {
+            ss << "never";
+        } else {
+            ss << entry.frames_to_converge;
+        }
+        ss << std::setw(16) << std::fixed << std::setprecision(1) << entry.mean_clean_fraction * 100.f << "\n";
+    }
+    return ss.str();
+}
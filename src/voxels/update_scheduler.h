@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "voxels/voxel_grid.h"
+
+// Spreads voxel grid updates over frames.
+// Grid is split to bricks of brick_dim^3 voxels, bricks are kept in a priority queue
+// and every frame only the most important bricks fitting into the budget are issued.
+class VoxelUpdateScheduler
+{
+public:
+    struct Settings
+    {
+        int32_t brick_dim{ 8 };
+
+        // 0 - unlimited
+        uint32_t voxel_budget{ 0 };  // voxel updates per frame
+        float time_budget_ms{ 0.f }; // milliseconds of work per frame, applied after first report_frame_cost()
+
+        // priority = age_weight * frames since update + dirty_weight * dirty - distance_weight * distance in bricks
+        float age_weight{ 1.f };
+        float dirty_weight{ 1000.f };
+        float distance_weight{ 4.f };
+    };
+
+    VoxelUpdateScheduler() = default;
+    ~VoxelUpdateScheduler() = default;
+
+    void initialize(int32_t grid_dimension, const Settings& settings);
+
+    void set_settings(const Settings& settings);
+    const Settings& settings() const;
+
+    void mark_dirty(uint32_t brick);
+    void mark_dirty(const Vector3& grid_min, const Vector3& grid_max); // box in grid space (voxels)
+    void mark_all_dirty();
+
+    // bricks to update this frame, most important first
+    const std::vector<uint32_t>& schedule(const VoxelGridFrame& grid, const Vector3& camera_position);
+
+    // measured cost of the bricks returned by last schedule(), calibrates time budget
+    void report_frame_cost(float milliseconds);
+    // cost of voxels scheduled by an earlier frame, e.g. GPU time read back when its frame slot comes around
+    void report_frame_cost(float milliseconds, uint32_t voxels);
+
+    void brick_coord(uint32_t brick, int32_t coord[3]) const;
+    uint32_t brick_voxel_count(uint32_t brick) const;
+
+    uint32_t brick_count() const;
+    uint32_t bricks_per_axis() const;
+    uint32_t dirty_brick_count() const;
+    uint32_t scheduled_voxel_count() const;
+    uint64_t frame() const;
+    float ms_per_voxel() const;
+private:
+    struct Entry
+    {
+        float key;
+        uint32_t brick;
+    };
+    static bool entry_less(const Entry& l, const Entry& r);
+
+    float entry_key(uint32_t brick) const;
+    void rebuild_queue();
+    uint32_t voxel_budget() const;
+
+    Settings settings_;
+    int32_t grid_dimension_{ 0 };
+    uint32_t bricks_per_axis_{ 0 };
+
+    // per brick
+    std::vector<uint64_t> last_update_;
+    std::vector<uint8_t> dirty_;
+    std::vector<float> distance_;
+    uint32_t dirty_count_{ 0 };
+
+    // max-heap on entry key, key doesn't depend on current frame so heap stays valid between frames
+    std::vector<Entry> queue_;
+    bool queue_outdated_{ true };
+
+    VoxelGridFrame grid_;
+    Vector3 camera_position_;
+
+    std::vector<uint32_t> scheduled_;
+    uint32_t scheduled_voxels_{ 0 };
+    uint64_t frame_{ 0 };
+    float ms_per_voxel_{ 0.f };
+};
+
+struct CameraSample
+{
+    Vector3 position;
+    Vector3 forward;
+};
+
+struct SchedulerConvergence
+{
+    uint32_t voxel_budget;
+    uint32_t frames_to_converge; // frames after last camera movement until every brick is updated
+    float mean_clean_fraction; // average part of up to date bricks over the path
+};
+
+// replays camera path through scheduler for every budget
+std::vector<SchedulerConvergence> measure_scheduler_convergence(const std::vector<CameraSample>& path,
+                                                                float grid_size, int32_t grid_dimension,
+                                                                const std::vector<uint32_t>& voxel_budgets,
+                                                                VoxelUpdateScheduler::Settings settings);
+
+std::string format_scheduler_convergence(const std::vector<SchedulerConvergence>& report);
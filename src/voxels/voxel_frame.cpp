@@ -0,0 +1,82 @@
+#include <cassert>
+
+#include "voxel_frame.h"
+
+void VoxelFrame::initialize(MeshInstanceTable* table, float grid_size, int32_t grid_dimension, const VoxelUpdateScheduler::Settings& settings)
+{
+    assert(table != nullptr && grid_size > 0.f && grid_dimension > 0);
+    table_ = table;
+    grid_size_ = grid_size;
+    grid_dimension_ = grid_dimension;
+    scheduler_.initialize(grid_dimension, settings);
+    camera_samples_.clear();
+    world_changed_ = false;
+}
+
+void VoxelFrame::clear()
+{
+    if (table_ != nullptr) {
+        table_->clear();
+    }
+    model_transforms_.clear();
+    model_first_instances_.clear();
+    camera_samples_.clear();
+    world_changed_ = false;
+}
+
+uint32_t VoxelFrame::add_model(const Matrix& transform)
+{
+    model_transforms_.push_back(table_->add_transform(transform));
+    model_first_instances_.push_back(uint32_t(table_->instances().size()));
+    world_changed_ = true;
+    return uint32_t(model_transforms_.size() - 1);
+}
+
+uint32_t VoxelFrame::add_mesh(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                              const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records)
+{
+    assert(!model_transforms_.empty());
+    world_changed_ = true;
+    return table_->add_mesh(indices, vertices, tree, records, model_transforms_.back());
+}
+
+void VoxelFrame::update_transform(uint32_t model, const Matrix& transform)
+{
+    table_->update_transform(model_transforms_[model], transform);
+    world_changed_ = true;
+}
+
+void VoxelFrame::update_mesh(uint32_t model, uint32_t mesh, const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records)
+{
+    table_->update_mesh(model_first_instances_[model] + mesh, tree, records);
+    world_changed_ = true;
+}
+
+const std::vector<uint32_t>& VoxelFrame::update(const Vector3& camera_position, const Vector3& camera_forward)
+{
+    const CameraSample sample{ camera_position, camera_forward };
+    // voxel grid is attached to camera, everything it holds is outdated
+    const bool camera_moved = !camera_samples_.empty() &&
+        (sample.position != camera_samples_.back().position || sample.forward != camera_samples_.back().forward);
+    if (world_changed_ || camera_moved) {
+        scheduler_.mark_all_dirty();
+        world_changed_ = false;
+    }
+    if (camera_samples_.size() == camera_history) {
+        camera_samples_.erase(camera_samples_.begin());
+    }
+    camera_samples_.push_back(sample);
+
+    grid_ = VoxelGridFrame::from_camera(camera_position, camera_forward, grid_size_, grid_dimension_);
+    return scheduler_.schedule(grid_, camera_position);
+}
+
+void VoxelFrame::report_fill_cost(float milliseconds)
+{
+    scheduler_.report_frame_cost(milliseconds);
+}
+
+void VoxelFrame::report_fill_cost(float milliseconds, uint32_t voxels)
+{
+    scheduler_.report_frame_cost(milliseconds, voxels);
+}
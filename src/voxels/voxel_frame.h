@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "voxels/mesh_instance_table.h"
+#include "voxels/update_scheduler.h"
+
+// CPU side of a voxel frame, the same for AS4VXGI_Component on D3D12 and HeadlessComponent on NullBackend:
+// meshes of all models go to one instance table, bricks are scheduled around the camera and all of them
+// are outdated when the camera or a model moved; measured fill cost calibrates the scheduler.
+// Uploads of the table and the fill pass stay with the owner.
+class VoxelFrame
+{
+public:
+    VoxelFrame() = default;
+    ~VoxelFrame() = default;
+
+    // table is owned by the caller, e.g. VoxelizerGeometry of the CPU voxelizer
+    void initialize(MeshInstanceTable* table, float grid_size, int32_t grid_dimension, const VoxelUpdateScheduler::Settings& settings);
+    void clear();
+
+    // meshes added after the model share its transform, returns model index
+    uint32_t add_model(const Matrix& transform);
+    // mesh of the last added model, tree and records in world space; returns instance index
+    uint32_t add_mesh(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                      const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records);
+    // moved model, mesh is the index of the mesh in the model
+    void update_transform(uint32_t model, const Matrix& transform);
+    void update_mesh(uint32_t model, uint32_t mesh, const std::vector<MeshTreeNode>& tree, const std::vector<TriangleRecord>& records);
+
+    // bricks to update this frame, most important first
+    const std::vector<uint32_t>& update(const Vector3& camera_position, const Vector3& camera_forward);
+    // measured cost of the bricks of the last update(), every frame so time budget of the scheduler follows the fill pass
+    void report_fill_cost(float milliseconds);
+    // cost of voxels scheduled by an earlier frame, GPU times are known frames in flight later
+    void report_fill_cost(float milliseconds, uint32_t voxels);
+
+    const VoxelGridFrame& grid() const { return grid_; }
+    VoxelUpdateScheduler& scheduler() { return scheduler_; }
+    const VoxelUpdateScheduler& scheduler() const { return scheduler_; }
+    // cameras of the last frames, oldest first, replayed by scheduler convergence report
+    const std::vector<CameraSample>& camera_samples() const { return camera_samples_; }
+    uint32_t model_count() const { return uint32_t(model_transforms_.size()); }
+private:
+    static constexpr size_t camera_history = 4096;
+
+    MeshInstanceTable* table_{ nullptr };
+    float grid_size_{ 0.f };
+    int32_t grid_dimension_{ 0 };
+
+    std::vector<uint32_t> model_transforms_;     // transform index by model
+    std::vector<uint32_t> model_first_instances_; // meshes of model i are instances [first, first + mesh count)
+    bool world_changed_{ false };
+
+    VoxelUpdateScheduler scheduler_;
+    VoxelGridFrame grid_;
+    std::vector<CameraSample> camera_samples_;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SimpleMath.h"
+using namespace DirectX::SimpleMath;
+
+#include "math/intersection.h"
+
+// CPU mirror of the camera attached voxel grid built by GenerateRay* in voxel.fx
+struct VoxelGridFrame
+{
+    Vector3 origin;  // world position of the (0, 0, 0) voxel corner
+    Vector3 right;
+    Vector3 up;
+    Vector3 forward;
+    float unit{ 1.f }; // voxel edge length
+    int32_t dimension{ 0 };
+
+    static VoxelGridFrame from_camera(const Vector3& position, const Vector3& direction, float size, int32_t dimension)
+    {
+        VoxelGridFrame frame;
+        frame.forward = direction;
+        frame.forward.Normalize();
+        frame.right = frame.forward.Cross(Vector3(0, 1, 0));
+        frame.right.Normalize();
+        frame.up = frame.forward.Cross(frame.right);
+        frame.up.Normalize();
+
+        frame.origin = position - (frame.forward + frame.right + frame.up) * (size / 2);
+        frame.unit = size / dimension;
+        frame.dimension = dimension;
+        return frame;
+    }
+
+    Vector3 voxel_corner(int32_t x, int32_t y, int32_t z) const
+    {
+        return origin + right * (x * unit) + up * (y * unit) + forward * (z * unit);
+    }
+
+    // rays along forward, right and up through the voxel center, starting on the voxel face
+    // voxel is filled if any of them hits a triangle closer than unit
+    void voxel_rays(int32_t x, int32_t y, int32_t z, Ray rays[3]) const
+    {
+        const Vector3 center = voxel_corner(x, y, z) + (right + up + forward) * (unit / 2);
+        rays[0] = { center - forward * (unit / 2), forward };
+        rays[1] = { center - right * (unit / 2), right };
+        rays[2] = { center - up * (unit / 2), up };
+    }
+
+    // world position to grid space, measured in voxels
+    Vector3 to_grid(const Vector3& world) const
+    {
+        Vector3 local = world - origin;
+        return Vector3(local.Dot(right), local.Dot(up), local.Dot(forward)) / unit;
+    }
+
+    bool operator==(const VoxelGridFrame& other) const
+    {
+        return origin == other.origin && right == other.right && up == other.up && forward == other.forward &&
+               unit == other.unit && dimension == other.dimension;
+    }
+
+    bool operator!=(const VoxelGridFrame& other) const
+    {
+        return !(*this == other);
+    }
+};
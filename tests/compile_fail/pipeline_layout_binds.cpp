@@ -0,0 +1,29 @@
+// built by try_compile in tests/CMakeLists.txt: compiles without defines, every define has to break the build
+#include "render/resource/pipeline_layout.h"
+
+struct NullPipeline
+{
+protected:
+    template<class bind>
+    void declare_bind() {}
+};
+
+using Layout = PipelineLayout<CAMERA_DATA_BIND, MESH_TREE_BIND, VOXEL_DATA_BIND>;
+
+int main()
+{
+#if defined(WRONG_SLOT)
+    // t3 isn't declared
+    return int(LayoutPipeline<NullPipeline, Layout>::resource_index<BindInfo<SRV, 3, 0>>());
+#elif defined(WRONG_SPACE)
+    // t2 is declared in space 0 only
+    return int(LayoutPipeline<NullPipeline, Layout>::resource_index<BindInfo<SRV, 2, 1>>());
+#elif defined(CLASHING_REGISTERS)
+    // b0 of space 0 twice
+    LayoutPipeline<NullPipeline, PipelineLayout<CAMERA_DATA_BIND, BindInfo<CBV, 0, 0>>> pipeline;
+    return 0;
+#else
+    LayoutPipeline<NullPipeline, Layout> pipeline;
+    return int(LayoutPipeline<NullPipeline, Layout>::resource_index<MESH_TREE_BIND>());
+#endif
+}
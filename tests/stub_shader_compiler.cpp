@@ -0,0 +1,23 @@
+// Stands in for dxc in tests: writes its arguments to the -Fo file, one per line, so tests can see
+// which defines a blob was compiled with. Fails without -Fo.
+#include <cstdio>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    std::string output;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "-Fo") {
+            output = argv[i + 1];
+        }
+    }
+    FILE* file = output.empty() ? nullptr : fopen(output.c_str(), "wb");
+    if (file == nullptr) {
+        return 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        fprintf(file, "%s\n", argv[i]);
+    }
+    fclose(file);
+    return 0;
+}
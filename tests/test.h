@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Checks for device free tests, one executable per area registered with CTest.
+// A failed check is reported and the case goes on; the executable fails if any check failed.
+namespace test
+{
+
+struct Case
+{
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<Case>& cases()
+{
+    static std::vector<Case> registered;
+    return registered;
+}
+
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+struct Registrar
+{
+    Registrar(const char* name, void (*run)()) { cases().push_back({ name, run }); }
+};
+
+// runs cases in declaration order, returns exit code
+inline int run_all()
+{
+    for (const Case& test_case : cases()) {
+        const int before = failures();
+        test_case.run();
+        printf("%s %s\n", failures() == before ? "pass" : "FAIL", test_case.name);
+    }
+    return failures() == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define TEST_CASE(name)                                                   \
+    static void name();                                                   \
+    static const test::Registrar name##_registrar(#name, name);           \
+    static void name()
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);   \
+            ++test::failures();                                                             \
+        }                                                                                   \
+    } while (false)
+
+#define CHECK_EQ(a, b)                                                                      \
+    do {                                                                                    \
+        const auto check_a = (a);                                                           \
+        const auto check_b = (b);                                                           \
+        if (!(check_a == check_b)) {                                                        \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+                #a, #b, (long long)check_a, (long long)check_b);                            \
+            ++test::failures();                                                             \
+        }                                                                                   \
+    } while (false)
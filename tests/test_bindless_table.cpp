@@ -0,0 +1,83 @@
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "render/resource/bindless_table.h"
+
+TEST_CASE(same_key_shares_one_index)
+{
+    BindlessTable table;
+    table.initialize(8, 2);
+    bool created = false;
+    BindlessHandle first = table.add(0x1000, BindlessKind::buffer, &created);
+    CHECK(created);
+    CHECK_EQ(first.index, 0);
+    BindlessHandle second = table.add(0x1000, BindlessKind::buffer, &created);
+    CHECK(!created);
+    CHECK_EQ(second.index, first.index);
+    CHECK_EQ(table.stats().used, 1);
+    CHECK_EQ(table.find(0x1000), 0);
+
+    // index lives until the last registration is released
+    table.release(first);
+    CHECK(!first.valid());
+    CHECK(table.is_valid(second));
+    CHECK_EQ(table.find(0x1000), 0);
+    table.release(second);
+    CHECK_EQ(table.find(0x1000), BindlessHandle::invalid_index);
+    CHECK_EQ(table.stats().pending_free, 1);
+}
+
+TEST_CASE(released_index_waits_for_its_slot)
+{
+    BindlessTable table;
+    table.initialize(2, 3);
+    table.begin_frame(0);
+    BindlessHandle a = table.add(1, BindlessKind::constant_buffer);
+    BindlessHandle b = table.add(2, BindlessKind::rw_texture);
+    const BindlessHandle stale = a;
+    table.release(a);
+    CHECK(!table.is_valid(stale));
+
+    // key registered again right away gets another index, the old one may still be read on GPU
+    CHECK(!table.add(1, BindlessKind::constant_buffer).valid());
+    CHECK_EQ(table.stats().failed_registrations, 1);
+    table.begin_frame(1);
+    table.begin_frame(2);
+    CHECK(!table.add(3, BindlessKind::buffer).valid());
+    table.begin_frame(0);
+    BindlessHandle reused = table.add(3, BindlessKind::buffer);
+    CHECK_EQ(reused.index, stale.index);
+    CHECK(reused.generation != stale.generation);
+    CHECK(!table.is_valid(stale));
+    CHECK(table.is_valid(b));
+}
+
+TEST_CASE(lowest_free_index_is_taken_first)
+{
+    BindlessTable table;
+    table.initialize(16, 1);
+    std::vector<BindlessHandle> handles;
+    for (uint64_t key = 0; key < 8; ++key) {
+        handles.push_back(table.add(100 + key, BindlessKind::buffer));
+    }
+    table.release(handles[5]);
+    table.release(handles[2]);
+    table.release(handles[6]);
+    table.release_pending();
+    CHECK_EQ(table.add(200, BindlessKind::buffer).index, 2);
+    CHECK_EQ(table.add(201, BindlessKind::buffer).index, 5);
+    CHECK_EQ(table.add(202, BindlessKind::buffer).index, 6);
+    CHECK_EQ(table.add(203, BindlessKind::buffer).index, 8);
+
+    const BindlessTable::Stats stats = table.stats();
+    CHECK_EQ(stats.used, 9);
+    CHECK_EQ(stats.peak, 9);
+    CHECK_EQ(stats.pending_free, 0);
+    CHECK(table.report().find("9 / 16 used") != std::string::npos);
+}
+
+int main()
+{
+    return test::run_all();
+}
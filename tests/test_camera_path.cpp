@@ -0,0 +1,185 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "core/camera_path.h"
+
+namespace
+{
+
+std::string scratch_file(const char* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<char> read_bytes(const std::string& path)
+{
+    std::ifstream fin(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+}
+
+void write_bytes(const std::string& path, const std::vector<char>& bytes)
+{
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(bytes.data(), std::streamsize(bytes.size()));
+}
+
+// three recorded frames, the second one without records of its own
+CameraPath make_path()
+{
+    CameraPath path;
+    path.set_timestep(1.f / 30.f);
+    path.start_recording();
+    path.begin_frame();
+    path.record_camera(Vector3(1.f, 2.f, 3.f), Vector3(0.f, 0.f, 1.f));
+    path.record_transform(1, Matrix::CreateTranslation(4.f, 5.f, 6.f));
+    path.begin_frame();
+    path.begin_frame();
+    path.record_camera(Vector3(7.f, 8.f, 9.f), Vector3(1.f, 0.f, 0.f));
+    path.record_transform(0, Matrix::CreateScale(2.f));
+    path.stop();
+    return path;
+}
+
+bool same_frames(const CameraPath& a, const CameraPath& b)
+{
+    if (a.frame_count() != b.frame_count()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.frame_count(); ++i) {
+        const CameraPath::Frame& x = a.frames()[i];
+        const CameraPath::Frame& y = b.frames()[i];
+        if (x.position != y.position || x.forward != y.forward || x.transforms != y.transforms) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE(recorded_frames_repeat_previous_state)
+{
+    const CameraPath path = make_path();
+    CHECK_EQ(path.frame_count(), 3);
+    CHECK(path.frames()[1].position == Vector3(1.f, 2.f, 3.f));
+    CHECK_EQ(path.frames()[0].transforms.size(), 2);
+    CHECK(path.frames()[0].transforms[0] == Matrix::Identity);
+    CHECK(path.frames()[2].transforms[0] == Matrix::CreateScale(2.f));
+    CHECK(path.frames()[2].transforms[1] == Matrix::CreateTranslation(4.f, 5.f, 6.f));
+}
+
+TEST_CASE(save_and_load_round_trip)
+{
+    const CameraPath path = make_path();
+    const std::string file = scratch_file("as4vxgi_test_camera_path.bin");
+    CHECK(path.save(file));
+
+    CameraPath loaded;
+    CHECK(loaded.load(file));
+    CHECK(same_frames(path, loaded));
+    CHECK_EQ(loaded.timestep(), path.timestep());
+    CHECK(loaded.mode() == CameraPath::Mode::off);
+}
+
+// broken files leave the frames and timestep of the path as they were
+TEST_CASE(broken_files_are_rejected)
+{
+    const CameraPath path = make_path();
+    const std::string file = scratch_file("as4vxgi_test_camera_path_broken.bin");
+    CHECK(path.save(file));
+    const std::vector<char> bytes = read_bytes(file);
+
+    CameraPath current;
+    current.start_recording();
+    current.begin_frame();
+    current.record_camera(Vector3(-1.f, -1.f, -1.f), Vector3(0.f, 1.f, 0.f));
+    current.stop();
+    const CameraPath before = current;
+
+    std::vector<char> truncated(bytes.begin(), bytes.end() - 1);
+    write_bytes(file, truncated);
+    CHECK(!current.load(file));
+
+    std::vector<char> bad_magic = bytes;
+    bad_magic[0] = 'X';
+    write_bytes(file, bad_magic);
+    CHECK(!current.load(file));
+
+    std::vector<char> wrong_version = bytes;
+    wrong_version[4] = 2;
+    write_bytes(file, wrong_version);
+    CHECK(!current.load(file));
+
+    CHECK(!current.load(scratch_file("as4vxgi_test_camera_path_missing.bin")));
+
+    CHECK(same_frames(before, current));
+    CHECK_EQ(current.timestep(), before.timestep());
+
+    write_bytes(file, bytes);
+    CHECK(current.load(file));
+    CHECK(same_frames(path, current));
+}
+
+TEST_CASE(replay_stops_after_last_frame)
+{
+    CameraPath path = make_path();
+    CHECK(path.replay_frame() == nullptr);
+    CHECK(path.start_replay());
+    for (size_t frame = 0; frame < 3; ++frame) {
+        path.begin_frame();
+        CHECK(path.replaying());
+        CHECK_EQ(path.cursor(), frame);
+        CHECK(path.replay_frame() == &path.frames()[frame]);
+    }
+    path.begin_frame();
+    CHECK(!path.replaying());
+    CHECK(path.replay_frame() == nullptr);
+
+    CameraPath empty;
+    CHECK(!empty.start_replay());
+    CHECK(empty.mode() == CameraPath::Mode::off);
+}
+
+TEST_CASE(looped_replay_starts_over)
+{
+    CameraPath path = make_path();
+    CHECK(path.start_replay(true));
+    for (size_t frame = 0; frame < 7; ++frame) {
+        path.begin_frame();
+        CHECK(path.replaying());
+        CHECK_EQ(path.cursor(), frame % 3);
+    }
+}
+
+// replayed transform wins over the live one, owners missing from the frame stay live
+TEST_CASE(frame_transform_prefers_replayed)
+{
+    const Matrix live = Matrix::CreateTranslation(-3.f, 0.f, 0.f);
+    CameraPath path = make_path();
+    CHECK(path.frame_transform(0, live) == live);
+
+    CHECK(path.start_replay());
+    path.begin_frame();
+    CHECK(path.frame_transform(0, live) == Matrix::Identity);
+    CHECK(path.frame_transform(1, live) == Matrix::CreateTranslation(4.f, 5.f, 6.f));
+    CHECK(path.frame_transform(2, live) == live);
+    path.begin_frame();
+    path.begin_frame();
+    CHECK(path.frame_transform(0, live) == Matrix::CreateScale(2.f));
+
+    // recording takes the live transform
+    path.start_recording();
+    path.begin_frame();
+    CHECK(path.frame_transform(2, live) == live);
+    CHECK_EQ(path.frames()[0].transforms.size(), 3);
+    CHECK(path.frames()[0].transforms[2] == live);
+}
+
+int main()
+{
+    return test::run_all();
+}
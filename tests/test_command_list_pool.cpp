@@ -0,0 +1,201 @@
+#include <set>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "render/command_list_pool.hpp"
+#include "render/command_recorder.hpp"
+#include "render/null_command_device.h"
+
+namespace
+{
+
+// Lists are ids; remembers type and state of every list to catch misuse by the pool
+class FakeListDevice
+{
+public:
+    using List = uint32_t;
+    using Type = uint32_t;
+
+    List create_list(Type type)
+    {
+        lists_.push_back({ type, true, false });
+        ++created_;
+        return List(lists_.size() - 1);
+    }
+
+    void reset_list(List list, Type type)
+    {
+        CHECK(!lists_[list].destroyed);
+        CHECK(!lists_[list].open);
+        // a list keeps its type, allocators of other types can't reopen it
+        CHECK_EQ(lists_[list].type, type);
+        lists_[list].open = true;
+        ++resets_;
+    }
+
+    void destroy_list(List list)
+    {
+        CHECK(!lists_[list].destroyed);
+        lists_[list].destroyed = true;
+        ++destroyed_;
+    }
+
+    // recording is done, GPU may execute it
+    void close(List list)
+    {
+        CHECK(lists_[list].open);
+        lists_[list].open = false;
+    }
+
+    uint32_t created() const { return created_; }
+    uint32_t resets() const { return resets_; }
+    uint32_t destroyed() const { return destroyed_; }
+private:
+    struct State
+    {
+        Type type;
+        bool open;
+        bool destroyed;
+    };
+
+    std::vector<State> lists_;
+    uint32_t created_{ 0 };
+    uint32_t resets_{ 0 };
+    uint32_t destroyed_{ 0 };
+};
+
+constexpr uint32_t direct = 0;
+constexpr uint32_t compute = 2;
+
+// acquires and closes count lists of type, returns them
+std::vector<uint32_t> record_frame(CommandListPool<FakeListDevice>& pool, FakeListDevice& device, uint32_t type, uint32_t count)
+{
+    std::vector<uint32_t> lists;
+    for (uint32_t i = 0; i < count; ++i) {
+        lists.push_back(pool.acquire(type));
+        device.close(lists.back());
+    }
+    return lists;
+}
+
+} // namespace
+
+TEST_CASE(steady_state_creates_no_lists)
+{
+    FakeListDevice device;
+    CommandListPool<FakeListDevice> pool;
+    pool.initialize(&device);
+
+    // three frames in flight, GPU two frames behind
+    for (uint64_t frame = 1; frame <= 20; ++frame) {
+        pool.begin_frame(frame > 3 ? frame - 3 : 0);
+        record_frame(pool, device, direct, 4);
+        CHECK_EQ(pool.stats().frame_acquired, 4);
+        if (frame > 3) {
+            CHECK_EQ(pool.stats().frame_created, 0);
+        }
+        pool.end_frame(frame);
+    }
+    CHECK_EQ(device.created(), 12);
+    CHECK_EQ(pool.stats().lists, 12);
+    CHECK_EQ(device.resets(), 20 * 4 - 12);
+
+    pool.destroy();
+    CHECK_EQ(device.destroyed(), 12);
+}
+
+TEST_CASE(lists_in_flight_are_not_reused)
+{
+    FakeListDevice device;
+    CommandListPool<FakeListDevice> pool;
+    pool.initialize(&device);
+
+    pool.begin_frame(0);
+    const std::vector<uint32_t> first = record_frame(pool, device, direct, 2);
+    pool.end_frame(1);
+
+    // frame 1 is still on GPU
+    pool.begin_frame(0);
+    const std::vector<uint32_t> second = record_frame(pool, device, direct, 2);
+    pool.end_frame(2);
+    for (uint32_t list : second) {
+        CHECK(list != first[0] && list != first[1]);
+    }
+
+    // frame 1 completed, its lists come back
+    pool.begin_frame(1);
+    const std::vector<uint32_t> third = record_frame(pool, device, direct, 2);
+    pool.end_frame(3);
+    CHECK((std::set<uint32_t>(third.begin(), third.end()) == std::set<uint32_t>(first.begin(), first.end())));
+    CHECK_EQ(pool.stats().frame_created, 0);
+    pool.destroy();
+}
+
+TEST_CASE(lists_are_pooled_by_type)
+{
+    FakeListDevice device;
+    CommandListPool<FakeListDevice> pool;
+    pool.initialize(&device);
+
+    pool.begin_frame(0);
+    record_frame(pool, device, direct, 1);
+    pool.end_frame(1);
+
+    // a free direct list doesn't serve compute
+    pool.begin_frame(1);
+    record_frame(pool, device, compute, 1);
+    CHECK_EQ(pool.stats().frame_created, 1);
+    record_frame(pool, device, direct, 1);
+    CHECK_EQ(pool.stats().frame_created, 1);
+    pool.end_frame(2);
+
+    // lists acquired but never submitted are destroyed too
+    pool.begin_frame(2);
+    pool.acquire(direct);
+    pool.destroy();
+    CHECK_EQ(device.destroyed(), device.created());
+}
+
+// recorder takes pooled lists and submits them by group, then record order, whatever the workers did
+TEST_CASE(recorder_submits_in_record_order)
+{
+    NullCommandDevice device;
+    CommandListPool<NullCommandDevice> pool;
+    pool.initialize(&device);
+    CommandRecorder<NullCommandDevice> recorder;
+    recorder.initialize(&device, &pool, 0);
+    recorder.set_max_workers(4);
+
+    for (uint64_t frame = 1; frame <= 3; ++frame) {
+        pool.begin_frame(frame - 1);
+        recorder.begin_group(1);
+        recorder.record([](NullCommandDevice::List list) { list->command("late a"); });
+        recorder.record([](NullCommandDevice::List list) { list->command("late b"); });
+        recorder.begin_group(0);
+        for (int i = 0; i < 8; ++i) {
+            recorder.record([i](NullCommandDevice::List list) { list->command("early " + std::to_string(i)); });
+        }
+        recorder.flush();
+        pool.end_frame(frame);
+
+        std::vector<std::string> expected;
+        for (int i = 0; i < 8; ++i) {
+            expected.push_back("early " + std::to_string(i));
+        }
+        expected.push_back("late a");
+        expected.push_back("late b");
+        CHECK(device.executed() == expected);
+        device.clear_executed();
+        CHECK_EQ(recorder.stats().tasks, 10);
+    }
+    // second and third frame reuse the lists of the first
+    CHECK_EQ(pool.stats().lists, 10);
+    pool.destroy();
+    CHECK_EQ(device.live_lists(), 0);
+}
+
+int main()
+{
+    return test::run_all();
+}
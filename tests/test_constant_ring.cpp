@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "test.h"
+#include "render/resource/constant_ring.h"
+
+namespace
+{
+
+// Queue fence of frames that read their constants only when they complete,
+// a block overwritten before its frame is done shows up as a wrong value
+class FakeFence : public FrameFence
+{
+public:
+    uint64_t signal() override { return ++signaled_; }
+    uint64_t completed_value() override { return completed_; }
+
+    void wait(uint64_t value) override
+    {
+        CHECK(value <= signaled_);
+        ++waits_;
+        complete(value);
+    }
+
+    // frame reading the first value of a block when it completes
+    void expect(uint64_t fence_value, const ConstantAllocation& allocation, uint32_t value)
+    {
+        reads_.push_back({ fence_value, allocation.data, value });
+    }
+
+    // GPU finished frames up to value
+    void complete(uint64_t value)
+    {
+        value = std::min(value, signaled_);
+        while (!reads_.empty() && reads_.front().fence_value <= value) {
+            uint32_t read = 0;
+            memcpy(&read, reads_.front().data, sizeof(read));
+            if (read != reads_.front().value) {
+                ++corrupted_;
+            }
+            reads_.pop_front();
+        }
+        completed_ = std::max(completed_, value);
+    }
+
+    uint64_t waits() const { return waits_; }
+    uint64_t corrupted() const { return corrupted_; }
+private:
+    struct Read
+    {
+        uint64_t fence_value;
+        const uint8_t* data;
+        uint32_t value;
+    };
+
+    uint64_t signaled_{ 0 };
+    uint64_t completed_{ 0 };
+    uint64_t waits_{ 0 };
+    uint64_t corrupted_{ 0 };
+    std::deque<Read> reads_;
+};
+
+constexpr uint64_t gpu_base = 0x10000;
+
+} // namespace
+
+TEST_CASE(blocks_are_aligned_and_addressed)
+{
+    FakeFence fence;
+    std::vector<uint8_t> memory(4096);
+    ConstantRing ring;
+    ring.initialize(&fence, memory.data(), gpu_base, memory.size());
+
+    ring.begin_frame();
+    const uint32_t value = 42;
+    const ConstantAllocation first = ring.push(value);
+    const ConstantAllocation second = ring.allocate(300);
+    CHECK(first.valid() && second.valid());
+    CHECK_EQ(first.size, 256);
+    CHECK_EQ(second.size, 512);
+    CHECK_EQ(second.offset, 256);
+    CHECK_EQ(second.gpu_address, gpu_base + 256);
+    CHECK(second.data == memory.data() + 256);
+    CHECK(memcmp(memory.data(), &value, sizeof(value)) == 0);
+    ring.end_frame(fence.signal());
+
+    const ConstantRing::Stats& stats = ring.stats();
+    CHECK_EQ(stats.frames, 1);
+    CHECK_EQ(stats.allocations, 2);
+    CHECK_EQ(stats.last_frame_bytes, 768);
+    CHECK_EQ(stats.used, 768);
+}
+
+// GPU two frames behind CPU: the ring never waits and GPU reads what CPU wrote
+TEST_CASE(frames_in_flight_keep_their_constants)
+{
+    FakeFence fence;
+    std::vector<uint8_t> memory(8 * 256);
+    ConstantRing ring;
+    ring.initialize(&fence, memory.data(), gpu_base, memory.size());
+
+    for (uint32_t frame = 1; frame <= 50; ++frame) {
+        if (frame > 2) {
+            fence.complete(frame - 2);
+        }
+        ring.begin_frame();
+        for (uint32_t draw = 0; draw < 2; ++draw) {
+            const uint32_t value = frame * 16 + draw;
+            fence.expect(frame, ring.push(value), value);
+        }
+        ring.end_frame(fence.signal());
+    }
+    fence.complete(50);
+    CHECK_EQ(fence.corrupted(), 0);
+    CHECK_EQ(fence.waits(), 0);
+    CHECK_EQ(ring.stats().stalls, 0);
+    CHECK_EQ(ring.stats().peak_frame_bytes, 512);
+}
+
+// a frame larger than what GPU freed waits for the oldest frame instead of overwriting it
+TEST_CASE(full_ring_waits_for_oldest_frame)
+{
+    FakeFence fence;
+    std::vector<uint8_t> memory(4 * 256);
+    ConstantRing ring;
+    ring.initialize(&fence, memory.data(), gpu_base, memory.size());
+
+    for (uint32_t frame = 1; frame <= 10; ++frame) {
+        ring.begin_frame();
+        for (uint32_t draw = 0; draw < 3; ++draw) {
+            const uint32_t value = frame * 16 + draw;
+            const ConstantAllocation allocation = ring.push(value);
+            CHECK(allocation.valid());
+            fence.expect(frame, allocation, value);
+        }
+        ring.end_frame(fence.signal());
+    }
+    fence.complete(10);
+    CHECK_EQ(fence.corrupted(), 0);
+    CHECK(ring.stats().stalls > 0);
+    CHECK_EQ(ring.stats().stalls, fence.waits());
+    CHECK_EQ(ring.stats().failed_allocations, 0);
+}
+
+TEST_CASE(frame_larger_than_ring_fails)
+{
+    FakeFence fence;
+    std::vector<uint8_t> memory(2 * 256);
+    ConstantRing ring;
+    ring.initialize(&fence, memory.data(), gpu_base, memory.size());
+
+    ring.begin_frame();
+    CHECK(!ring.allocate(1024).valid());
+    CHECK(ring.allocate(256).valid());
+    CHECK(ring.allocate(256).valid());
+    // nothing in flight to wait for
+    CHECK(!ring.allocate(16).valid());
+    ring.end_frame(fence.signal());
+    CHECK_EQ(ring.stats().failed_allocations, 2);
+    CHECK_EQ(fence.waits(), 0);
+}
+
+int main()
+{
+    return test::run_all();
+}
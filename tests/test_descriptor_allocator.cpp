@@ -0,0 +1,151 @@
+#include <vector>
+
+#include "test.h"
+#include "render/resource/descriptor_allocator.h"
+
+namespace
+{
+
+// deterministic, independent from std implementation
+struct Random
+{
+    uint32_t state{ 0x9e3779b9u };
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+} // namespace
+
+TEST_CASE(freed_range_waits_for_its_slot)
+{
+    DescriptorAllocator allocator;
+    allocator.initialize(16, 8, 3);
+    allocator.begin_frame(0);
+    DescriptorRange all = allocator.allocate(16);
+    CHECK(all.valid());
+    CHECK_EQ(all.offset, 0);
+    CHECK(!allocator.allocate(1).valid());
+    CHECK_EQ(allocator.stats().failed_allocations, 1);
+
+    allocator.free(all);
+    CHECK(!all.valid());
+    CHECK_EQ(allocator.stats().pending_free, 16);
+    // frames 1 and 2 may still read the range on GPU
+    allocator.begin_frame(1);
+    CHECK(!allocator.allocate(1).valid());
+    allocator.begin_frame(2);
+    CHECK(!allocator.allocate(1).valid());
+    allocator.begin_frame(0);
+    CHECK_EQ(allocator.stats().pending_free, 0);
+    CHECK(allocator.allocate(16).valid());
+}
+
+TEST_CASE(generation_catches_stale_copies)
+{
+    DescriptorAllocator allocator;
+    allocator.initialize(64, 0, 2);
+    allocator.begin_frame(0);
+    DescriptorRange range = allocator.allocate(4);
+    const DescriptorRange copy = range;
+    CHECK(allocator.is_valid(copy));
+
+    allocator.free(range);
+    CHECK(!allocator.is_valid(copy));
+    CHECK(!allocator.is_valid(range));
+    CHECK(!allocator.is_valid(DescriptorRange{}));
+
+    // node handed out again keeps old copies invalid
+    allocator.release_pending();
+    DescriptorRange reused = allocator.allocate(4);
+    CHECK_EQ(reused.node, copy.node);
+    CHECK(allocator.is_valid(reused));
+    CHECK(!allocator.is_valid(copy));
+}
+
+TEST_CASE(frame_regions_rewind_per_slot)
+{
+    DescriptorAllocator allocator;
+    allocator.initialize(100, 10, 2);
+    CHECK_EQ(allocator.capacity(), 120);
+
+    allocator.begin_frame(0);
+    CHECK_EQ(allocator.allocate_frame(4), 100);
+    CHECK_EQ(allocator.allocate_frame(6), 104);
+    CHECK_EQ(allocator.allocate_frame(1), DescriptorAllocator::invalid_offset);
+    CHECK_EQ(allocator.stats().frame_used, 10);
+
+    allocator.begin_frame(1);
+    CHECK_EQ(allocator.allocate_frame(3), 110);
+    allocator.begin_frame(0);
+    CHECK_EQ(allocator.stats().frame_used, 0);
+    CHECK_EQ(allocator.allocate_frame(10), 100);
+
+    const DescriptorAllocator::Stats stats = allocator.stats();
+    CHECK_EQ(stats.frame_peak, 10);
+    CHECK_EQ(stats.failed_allocations, 1);
+    CHECK_EQ(stats.persistent_used, 0);
+}
+
+// random churn over many frames: live ranges stay disjoint and inside the persistent region,
+// a range freed in a frame never comes back before its slot does
+TEST_CASE(random_churn_stays_consistent)
+{
+    const uint32_t capacity = 1024;
+    const uint32_t slots = 3;
+    DescriptorAllocator allocator;
+    allocator.initialize(capacity, 64, slots);
+
+    std::vector<DescriptorRange> live;
+    // frame that freed the descriptor, GPU reads it until that frame's slot is reused
+    std::vector<int64_t> freed_in(capacity, -1);
+    Random random;
+    bool ok = true;
+    for (int64_t frame = 0; frame < 2000 && ok; ++frame) {
+        allocator.begin_frame(uint32_t(frame % slots));
+        for (int i = 0; i < 8; ++i) {
+            if (random.next() % 2 == 0) {
+                DescriptorRange range = allocator.allocate(1 + random.next() % 32);
+                if (!range.valid()) {
+                    continue;
+                }
+                for (uint32_t d = range.offset; d < range.offset + range.count; ++d) {
+                    ok = ok && (freed_in[d] < 0 || frame - freed_in[d] >= slots);
+                    freed_in[d] = -1;
+                }
+                live.push_back(range);
+            } else if (!live.empty()) {
+                const size_t index = random.next() % live.size();
+                for (uint32_t d = live[index].offset; d < live[index].offset + live[index].count; ++d) {
+                    freed_in[d] = frame;
+                }
+                allocator.free(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+
+        std::vector<uint8_t> owned(capacity, 0);
+        uint32_t used = 0;
+        for (const DescriptorRange& range : live) {
+            ok = ok && allocator.is_valid(range);
+            for (uint32_t d = range.offset; d < range.offset + range.count && ok; ++d) {
+                ok = owned[d]++ == 0;
+            }
+            used += range.count;
+        }
+        ok = ok && allocator.stats().persistent_used == used + allocator.stats().pending_free;
+    }
+    CHECK(ok);
+    CHECK(!live.empty());
+}
+
+int main()
+{
+    return test::run_all();
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+#include "render/frame_ring.h"
+
+namespace
+{
+
+// Queue fence that completes only when told to or waited for, the test plays GPU
+class FakeFence : public FrameFence
+{
+public:
+    uint64_t signal() override { return ++signaled_; }
+    uint64_t completed_value() override { return completed_; }
+
+    void wait(uint64_t value) override
+    {
+        CHECK(value <= signaled_);
+        waited_values_.push_back(value);
+        complete(value);
+    }
+
+    // GPU finished work up to value
+    void complete(uint64_t value) { completed_ = std::max(completed_, std::min(value, signaled_)); }
+
+    uint64_t signaled() const { return signaled_; }
+    const std::vector<uint64_t>& waited_values() const { return waited_values_; }
+private:
+    uint64_t signaled_{ 0 };
+    uint64_t completed_{ 0 };
+    std::vector<uint64_t> waited_values_;
+};
+
+} // namespace
+
+TEST_CASE(one_frame_in_flight_waits_for_every_frame)
+{
+    FakeFence fence;
+    FrameRing ring;
+    ring.initialize(&fence, 1);
+    for (int frame = 0; frame < 5; ++frame) {
+        CHECK_EQ(ring.begin_frame(), 0);
+        ring.end_frame();
+    }
+    // first frame has nothing to wait for
+    CHECK_EQ(ring.stats().waits, 4);
+    CHECK((fence.waited_values() == std::vector<uint64_t>{ 1, 2, 3, 4 }));
+}
+
+TEST_CASE(frames_overlap_while_gpu_keeps_up)
+{
+    FakeFence fence;
+    FrameRing ring;
+    ring.initialize(&fence, 3);
+    std::vector<uint32_t> slots;
+    for (uint64_t frame = 0; frame < 9; ++frame) {
+        // GPU runs two frames behind CPU
+        if (frame >= 2) {
+            fence.complete(frame - 1);
+        }
+        slots.push_back(ring.begin_frame());
+        CHECK_EQ(ring.end_frame(), frame + 1);
+    }
+    CHECK((slots == std::vector<uint32_t>{ 0, 1, 2, 0, 1, 2, 0, 1, 2 }));
+    CHECK_EQ(ring.stats().waits, 0);
+    CHECK_EQ(ring.frame_number(), 9);
+    CHECK(fence.waited_values().empty());
+}
+
+// slot is reused only after the frame that used it before is done, not the newest frame
+TEST_CASE(slot_waits_for_its_previous_frame_only)
+{
+    FakeFence fence;
+    FrameRing ring;
+    ring.initialize(&fence, 3);
+    for (int frame = 0; frame < 3; ++frame) {
+        ring.begin_frame();
+        ring.end_frame();
+    }
+    // GPU is still on the first frame
+    CHECK_EQ(ring.begin_frame(), 0);
+    CHECK((fence.waited_values() == std::vector<uint64_t>{ 1 }));
+    CHECK_EQ(fence.completed_value(), 1);
+    CHECK_EQ(ring.stats().waits, 1);
+    ring.end_frame();
+
+    fence.complete(2);
+    CHECK_EQ(ring.begin_frame(), 1);
+    CHECK_EQ(ring.stats().waits, 1);
+    ring.end_frame();
+}
+
+TEST_CASE(changing_frames_in_flight_waits_for_all_frames)
+{
+    FakeFence fence;
+    FrameRing ring;
+    ring.initialize(&fence, 3);
+    for (int frame = 0; frame < 2; ++frame) {
+        ring.begin_frame();
+        ring.end_frame();
+    }
+    ring.set_frames_in_flight(1);
+    CHECK_EQ(fence.completed_value(), 2);
+    CHECK_EQ(ring.frames_in_flight(), 1);
+
+    ring.wait_idle();
+    CHECK_EQ(fence.waited_values().back(), 2);
+    // nothing was submitted before the first frame
+    FakeFence idle;
+    FrameRing empty;
+    empty.initialize(&idle, 2);
+    empty.wait_idle();
+    CHECK(idle.waited_values().empty());
+}
+
+int main()
+{
+    return test::run_all();
+}
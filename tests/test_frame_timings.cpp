@@ -0,0 +1,127 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "core/frame_timings.h"
+
+namespace
+{
+
+std::string scratch_file(const char* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<std::string> read_lines(const std::string& path)
+{
+    std::ifstream fin(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(fin, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+} // namespace
+
+// nearest rank over the window: p50 of 1..100 is the 50th value
+TEST_CASE(percentiles_are_nearest_rank)
+{
+    FrameTimings timings;
+    for (uint32_t frame = 100; frame >= 1; --frame) {
+        timings.end_frame(double(frame));
+    }
+    const FrameTimings::Summary summary = timings.window_summary(FrameTimings::frame_column);
+    CHECK_EQ(summary.frames, 100);
+    CHECK_EQ(summary.mean_ms, 50.5);
+    CHECK_EQ(summary.p50_ms, 50.0);
+    CHECK_EQ(summary.p95_ms, 95.0);
+    CHECK_EQ(summary.p99_ms, 99.0);
+    CHECK_EQ(summary.max_ms, 100.0);
+
+    FrameTimings single;
+    single.end_frame(7.0);
+    CHECK_EQ(single.window_summary(FrameTimings::frame_column).p50_ms, 7.0);
+    CHECK_EQ(FrameTimings().window_summary(FrameTimings::frame_column).frames, 0);
+}
+
+// after history frames the oldest are overwritten, window and history see the last ones in order
+TEST_CASE(ring_wraps_after_history_frames)
+{
+    FrameTimings timings(4, 8);
+    for (uint32_t frame = 0; frame < 20; ++frame) {
+        timings.end_frame(double(frame));
+    }
+    CHECK_EQ(timings.frames(), 20);
+    CHECK((timings.window_values(FrameTimings::frame_column) == std::vector<float>{ 16.f, 17.f, 18.f, 19.f }));
+
+    const FrameTimings::Summary history = timings.history_summary(FrameTimings::frame_column);
+    CHECK_EQ(history.frames, 8);
+    CHECK_EQ(history.mean_ms, 15.5);
+    CHECK_EQ(history.max_ms, 19.0);
+    CHECK_EQ(timings.window_summary(FrameTimings::frame_column).p50_ms, 17.0);
+
+    CHECK((timings.window_histogram(FrameTimings::frame_column, 2, 36.f) == std::vector<float>{ 2.f, 2.f }));
+    CHECK((timings.window_histogram(FrameTimings::frame_column, 2, 10.f) == std::vector<float>{ 0.f, 4.f }));
+
+    timings.clear();
+    CHECK_EQ(timings.frames(), 0);
+    CHECK(timings.window_values(FrameTimings::frame_column).empty());
+}
+
+// Game scopes input in both poll and end_poll, the frame gets the sum
+TEST_CASE(phase_added_twice_sums_up)
+{
+    FrameTimings timings;
+    timings.add(FrameTimings::input, 1.5);
+    timings.add(FrameTimings::update, 4.0);
+    timings.add(FrameTimings::input, 2.0);
+    timings.end_frame(10.0);
+    timings.end_frame(10.0);
+    CHECK((timings.window_values(FrameTimings::input) == std::vector<float>{ 3.5f, 0.f }));
+    CHECK((timings.window_values(FrameTimings::update) == std::vector<float>{ 4.f, 0.f }));
+}
+
+// layout parsed by regression jobs
+TEST_CASE(csv_has_a_row_per_kept_frame)
+{
+    FrameTimings timings(2, 2);
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+        timings.add(FrameTimings::draw, 0.25 * frame);
+        timings.end_frame(10.0 + frame);
+    }
+    const std::string path = scratch_file("as4vxgi_test_frame_timings.csv");
+    CHECK(timings.write_csv(path));
+    const std::vector<std::string> lines = read_lines(path);
+    CHECK_EQ(lines.size(), 3);
+    CHECK(lines[0] == "frame,input_ms,prepare_ms,update_ms,uploads_ms,draw_ms,record_ms,imgui_ms,present_ms,frame_ms");
+    CHECK(lines[1] == "1,0.0000,0.0000,0.0000,0.0000,0.2500,0.0000,0.0000,0.0000,11.0000");
+    CHECK(lines[2] == "2,0.0000,0.0000,0.0000,0.0000,0.5000,0.0000,0.0000,0.0000,12.0000");
+}
+
+TEST_CASE(json_summarizes_every_column)
+{
+    FrameTimings timings(2, 2);
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+        timings.end_frame(10.0 + frame);
+    }
+    const std::string path = scratch_file("as4vxgi_test_frame_timings.json");
+    CHECK(timings.write_json(path));
+    const std::vector<std::string> lines = read_lines(path);
+    CHECK_EQ(lines.size(), 2 + FrameTimings::column_count);
+    CHECK(lines[0] == "{\"frames\":3,\"kept_frames\":2,\"columns\":{");
+    CHECK(lines[1] == "\"input\":{\"mean_ms\":0.0000,\"p50_ms\":0.0000,\"p95_ms\":0.0000,\"p99_ms\":0.0000,\"max_ms\":0.0000},");
+    CHECK(lines[FrameTimings::column_count] ==
+          "\"frame\":{\"mean_ms\":11.5000,\"p50_ms\":11.0000,\"p95_ms\":12.0000,\"p99_ms\":12.0000,\"max_ms\":12.0000}");
+    CHECK(lines.back() == "}}");
+
+    CHECK(!timings.write_json((std::filesystem::temp_directory_path() / "missing_dir" / "timings.json").string()));
+}
+
+int main()
+{
+    return test::run_all();
+}
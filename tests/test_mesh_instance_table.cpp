@@ -0,0 +1,221 @@
+#include <cmath>
+#include <vector>
+
+#include "test.h"
+#include "bench/bench_scenes.h"
+#include "math/mesh_tree.h"
+#include "math/triangle_records.h"
+#include "math/world_transform.h"
+#include "voxels/mesh_instance_table.h"
+#include "voxels/cpu_voxelizer.h"
+
+namespace
+{
+
+constexpr float grid_size = 32.f;
+constexpr int32_t grid_dimension = 32;
+
+// one triangle per three vertices, records of the triangle index
+void make_mesh(uint32_t triangle_count, float record_tag, std::vector<uint32_t>& indices, std::vector<Vertex>& vertices,
+               std::vector<MeshTreeNode>& tree, std::vector<TriangleRecord>& records)
+{
+    indices.clear();
+    vertices.assign(triangle_count * 3, Vertex{});
+    records.assign(triangle_count, TriangleRecord{});
+    for (uint32_t i = 0; i < triangle_count * 3; ++i) {
+        indices.push_back(i);
+    }
+    for (uint32_t i = 0; i < triangle_count; ++i) {
+        records[i].row0.x = record_tag + i;
+    }
+    tree.assign(1, MeshTreeNode{});
+    tree[0].start_index = 0;
+    tree[0].count = int(triangle_count * 3);
+}
+
+// sphere in world space: model space soup, mesh tree and world geometry of transform
+struct Sphere
+{
+    VoxelizerGeometry model;
+    WorldGeometry world;
+    std::vector<Vertex> vertices;
+};
+
+Sphere make_sphere(const Vector3& center, float radius, const Matrix& transform)
+{
+    BenchScene scene;
+    append_sphere(scene.geometry, center, radius, 16, 24);
+    build_scene_tree(scene, 2.f);
+
+    Sphere sphere;
+    sphere.model = scene.geometry;
+    update_world_geometry(sphere.model.positions, sphere.model.indices, sphere.model.tree, transform, sphere.world);
+    sphere.vertices.resize(sphere.model.positions.size());
+    for (size_t i = 0; i < sphere.vertices.size(); ++i) {
+        sphere.vertices[i].position = sphere.model.positions[i];
+        sphere.vertices[i].normal = sphere.model.normals[i];
+    }
+    return sphere;
+}
+
+} // namespace
+
+TEST_CASE(meshes_are_concatenated)
+{
+    MeshInstanceTable table;
+    std::vector<uint32_t> indices;
+    std::vector<Vertex> vertices;
+    std::vector<MeshTreeNode> tree;
+    std::vector<TriangleRecord> records;
+
+    const uint32_t first = table.add_transform(Matrix::Identity);
+    make_mesh(4, 0.f, indices, vertices, tree, records);
+    CHECK_EQ(table.add_mesh(indices, vertices, tree, records, first), 0);
+    make_mesh(2, 100.f, indices, vertices, tree, records);
+    CHECK_EQ(table.add_mesh(indices, vertices, tree, records, first), 1);
+    const uint32_t second = table.add_transform(Matrix::CreateTranslation(1.f, 2.f, 3.f));
+    make_mesh(3, 200.f, indices, vertices, tree, records);
+    CHECK_EQ(table.add_mesh(indices, vertices, tree, records, second), 2);
+
+    const std::vector<MeshInstance>& instances = table.instances();
+    CHECK_EQ(instances.size(), 3);
+    CHECK_EQ(instances[1].node_offset, 1);
+    CHECK_EQ(instances[1].node_count, 1);
+    CHECK_EQ(instances[1].index_offset, 12);
+    CHECK_EQ(instances[1].vertex_offset, 12);
+    CHECK_EQ(instances[2].index_offset, 18);
+    CHECK_EQ(instances[2].vertex_offset, 18);
+    // meshes of a model share its transform
+    CHECK_EQ(instances[0].transform_index, first);
+    CHECK_EQ(instances[1].transform_index, first);
+    CHECK_EQ(instances[2].transform_index, second);
+
+    // indices stay local to the mesh, records are addressed by global index / 3
+    CHECK_EQ(table.indices().size(), 27);
+    CHECK_EQ(table.indices()[instances[1].index_offset], 0);
+    CHECK_EQ(table.records().size(), 9);
+    CHECK(table.records()[instances[1].index_offset / 3].row0.x == 100.f);
+    CHECK(table.records()[instances[2].index_offset / 3 + 2].row0.x == 202.f);
+    // tree ranges stay local to the mesh
+    CHECK_EQ(table.nodes()[instances[2].node_offset].count, 9);
+}
+
+TEST_CASE(moved_mesh_is_rewritten_in_place)
+{
+    MeshInstanceTable table;
+    std::vector<uint32_t> indices;
+    std::vector<Vertex> vertices;
+    std::vector<MeshTreeNode> tree;
+    std::vector<TriangleRecord> records;
+
+    const uint32_t transform = table.add_transform(Matrix::Identity);
+    make_mesh(2, 0.f, indices, vertices, tree, records);
+    table.add_mesh(indices, vertices, tree, records, transform);
+    make_mesh(3, 10.f, indices, vertices, tree, records);
+    table.add_mesh(indices, vertices, tree, records, transform);
+
+    make_mesh(3, 50.f, indices, vertices, tree, records);
+    tree[0].min = Vector3(-1.f, -2.f, -3.f);
+    table.update_mesh(1, tree, records);
+    table.update_transform(transform, Matrix::CreateTranslation(5.f, 0.f, 0.f));
+
+    CHECK_EQ(table.records().size(), 5);
+    CHECK(table.records()[1].row0.x == 1.f);
+    CHECK(table.records()[2].row0.x == 50.f);
+    CHECK(table.records()[4].row0.x == 52.f);
+    CHECK(table.nodes()[1].min.y == -2.f);
+    CHECK(table.nodes()[0].min.y == 0.f);
+    CHECK(table.transforms()[transform].transform._41 == 5.f);
+
+    table.clear();
+    CHECK(table.instances().empty() && table.records().empty() && table.transforms().empty());
+}
+
+// normal of the plane x + y = 1 after scaling x by 2 is the normal of x / 2 + y = 1
+TEST_CASE(normals_go_through_the_inverse_transpose)
+{
+    MeshInstanceTable table;
+    const uint32_t transform = table.add_transform(Matrix::CreateScale(2.f, 1.f, 1.f));
+    Vector3 normal = Vector3::TransformNormal(Vector3(1.f, 1.f, 0.f), table.transforms()[transform].inverse_transpose_transform);
+    normal.Normalize();
+    CHECK(Vector3(normal - Vector3(1.f, 2.f, 0.f) / std::sqrt(5.f)).Length() < 1e-5f);
+
+    table.update_transform(transform, Matrix::CreateScale(1.f, 4.f, 1.f));
+    CHECK(table.transforms()[transform].inverse_transpose_transform._22 == 0.25f);
+}
+
+// voxel normals of a scaled instance are unit length, like the ones of fill.hlsl
+TEST_CASE(voxelizer_normals_of_scaled_instance_are_normalized)
+{
+    const Matrix scaled = Matrix::CreateScale(1.5f, 0.75f, 1.f);
+    const Sphere sphere = make_sphere(Vector3(0.f, 0.f, 0.f), 8.f, scaled);
+    VoxelizerGeometry geometry;
+    const uint32_t transform = geometry.instance_table.add_transform(scaled);
+    geometry.instance_table.add_mesh(sphere.model.indices, sphere.vertices, sphere.world.tree, sphere.world.records, transform);
+
+    const VoxelGridFrame grid = VoxelGridFrame::from_camera(Vector3(0.f, 0.f, 0.f), Vector3(0.f, 0.f, 1.f), grid_size, grid_dimension);
+    CpuVoxelizer voxelizer;
+    voxelizer.set_use_triangle_records(true);
+    voxelizer.voxelize(grid, VOXEL_BRICK_DIM, geometry, CpuVoxelizer::Mode::instance_table);
+
+    CHECK(voxelizer.stats().filled_voxels > 0);
+    uint32_t not_unit = 0;
+    for (const Voxel& voxel : voxelizer.voxels()) {
+        if (voxel.metalness > 0 && std::fabs(Vector3(voxel.normal).Length() - 1.f) > 1e-4f) {
+            ++not_unit;
+        }
+    }
+    CHECK_EQ(not_unit, 0);
+}
+
+// instance table mode over two meshes fills the same voxels as brute force over their world space soup
+TEST_CASE(voxelizer_instance_table_matches_soup)
+{
+    const Matrix moved = Matrix::CreateTranslation(6.f, -2.f, 3.f);
+    const Sphere spheres[2] = { make_sphere(Vector3(-5.f, 0.f, 0.f), 6.f, Matrix::Identity),
+                                make_sphere(Vector3(0.f, 1.f, 0.f), 5.f, moved) };
+
+    VoxelizerGeometry table_geometry;
+    VoxelizerGeometry soup;
+    const Matrix transforms[2] = { Matrix::Identity, moved };
+    for (uint32_t i = 0; i < 2; ++i) {
+        const Sphere& sphere = spheres[i];
+        const uint32_t transform = table_geometry.instance_table.add_transform(transforms[i]);
+        table_geometry.instance_table.add_mesh(sphere.model.indices, sphere.vertices, sphere.world.tree, sphere.world.records, transform);
+
+        const uint32_t base = uint32_t(soup.positions.size());
+        soup.positions.insert(soup.positions.end(), sphere.world.positions.begin(), sphere.world.positions.end());
+        soup.normals.insert(soup.normals.end(), sphere.model.normals.begin(), sphere.model.normals.end());
+        for (uint32_t index : sphere.model.indices) {
+            soup.indices.push_back(base + index);
+        }
+        soup.records.insert(soup.records.end(), sphere.world.records.begin(), sphere.world.records.end());
+    }
+
+    const VoxelGridFrame grid = VoxelGridFrame::from_camera(Vector3(0.f, 0.f, 0.f), Vector3(0.f, 0.f, 1.f), grid_size, grid_dimension);
+    CpuVoxelizer table_voxelizer;
+    table_voxelizer.set_use_triangle_records(true);
+    table_voxelizer.voxelize(grid, VOXEL_BRICK_DIM, table_geometry, CpuVoxelizer::Mode::instance_table);
+    CpuVoxelizer soup_voxelizer;
+    soup_voxelizer.set_use_triangle_records(true);
+    soup_voxelizer.voxelize(grid, VOXEL_BRICK_DIM, soup, CpuVoxelizer::Mode::brute_force);
+
+    CHECK(soup_voxelizer.stats().filled_voxels > 0);
+    CHECK_EQ(table_voxelizer.stats().filled_voxels, soup_voxelizer.stats().filled_voxels);
+    uint32_t different = 0;
+    for (size_t i = 0; i < soup_voxelizer.voxels().size(); ++i) {
+        const Voxel& a = table_voxelizer.voxels()[i];
+        const Voxel& b = soup_voxelizer.voxels()[i];
+        // a ray through a shared edge may take either triangle, t differs by rounding only
+        if ((a.metalness > 0) != (b.metalness > 0) || std::fabs(a.metalness - b.metalness) > 1e-5f ||
+            Vector3(a.normal - b.normal).Length() > 1e-4f) {
+            ++different;
+        }
+    }
+    CHECK_EQ(different, 0);
+}
+
+int main()
+{
+    return test::run_all();
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+#include "render/resource/offset_allocator.h"
+
+namespace
+{
+
+// deterministic, independent from std implementation
+struct Random
+{
+    uint32_t state{ 0x2545f491u };
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+// live allocations don't overlap, stay inside the range and match used size
+bool consistent(const OffsetAllocator& allocator, const std::vector<OffsetAllocator::Allocation>& live)
+{
+    std::vector<uint8_t> owned(allocator.size(), 0);
+    uint32_t used = 0;
+    for (const OffsetAllocator::Allocation& allocation : live) {
+        const uint32_t offset = allocator.offset(allocation);
+        if (offset + allocation.size > allocator.size()) {
+            return false;
+        }
+        for (uint32_t i = offset; i < offset + allocation.size; ++i) {
+            if (owned[i]++ != 0) {
+                return false;
+            }
+        }
+        used += allocation.size;
+    }
+    const OffsetAllocator::Stats stats = allocator.stats();
+    return stats.used == used && stats.free == allocator.size() - used && stats.allocations == live.size() &&
+        stats.largest_free_block <= stats.free;
+}
+
+} // namespace
+
+TEST_CASE(neighbours_merge_on_free)
+{
+    OffsetAllocator allocator;
+    allocator.initialize(1024);
+    OffsetAllocator::Allocation a = allocator.allocate(100);
+    OffsetAllocator::Allocation b = allocator.allocate(200);
+    OffsetAllocator::Allocation c = allocator.allocate(300);
+    CHECK_EQ(a.offset, 0);
+    CHECK_EQ(b.offset, 100);
+    CHECK_EQ(c.offset, 300);
+    CHECK_EQ(allocator.stats().used, 600);
+
+    allocator.free(b);
+    CHECK_EQ(b.node, OffsetAllocator::invalid_node);
+    CHECK_EQ(allocator.stats().free_blocks, 2);
+    allocator.free(a);
+    CHECK_EQ(allocator.stats().free_blocks, 2);
+    CHECK_EQ(allocator.stats().largest_free_block, 424);
+    allocator.free(c);
+    const OffsetAllocator::Stats stats = allocator.stats();
+    CHECK_EQ(stats.free_blocks, 1);
+    CHECK_EQ(stats.largest_free_block, 1024);
+    CHECK_EQ(stats.allocations, 0);
+    CHECK(stats.fragmentation() == 0.f);
+}
+
+TEST_CASE(allocation_fails_without_fitting_block)
+{
+    OffsetAllocator allocator;
+    allocator.initialize(1024);
+    CHECK_EQ(allocator.allocate(1025).node, OffsetAllocator::invalid_node);
+    OffsetAllocator::Allocation all = allocator.allocate(1024);
+    CHECK(all.node != OffsetAllocator::invalid_node);
+    CHECK_EQ(allocator.allocate(1).node, OffsetAllocator::invalid_node);
+    allocator.free(all);
+    CHECK(allocator.allocate(1).node != OffsetAllocator::invalid_node);
+}
+
+TEST_CASE(defragment_compacts_and_reports_moves)
+{
+    OffsetAllocator allocator;
+    allocator.initialize(1024);
+    std::vector<OffsetAllocator::Allocation> blocks;
+    for (uint32_t i = 0; i < 16; ++i) {
+        blocks.push_back(allocator.allocate(64));
+    }
+    std::vector<OffsetAllocator::Allocation> live;
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (i % 2 == 0) {
+            allocator.free(blocks[i]);
+        } else {
+            live.push_back(blocks[i]);
+        }
+    }
+    OffsetAllocator::Stats stats = allocator.stats();
+    CHECK_EQ(stats.free_blocks, 8);
+    CHECK_EQ(stats.largest_free_block, 64);
+    CHECK(stats.fragmentation() == 1.f - 64.f / 512.f);
+    CHECK_EQ(allocator.allocate(128).node, OffsetAllocator::invalid_node);
+
+    std::vector<OffsetAllocator::Move> moves;
+    allocator.defragment(moves);
+    CHECK_EQ(moves.size(), 8);
+    for (size_t i = 0; i < moves.size(); ++i) {
+        CHECK(moves[i].to <= moves[i].from);
+        CHECK(i == 0 || moves[i - 1].from < moves[i].from);
+        CHECK_EQ(moves[i].size, 64);
+    }
+    // handles follow their moves
+    for (uint32_t i = 0; i < live.size(); ++i) {
+        CHECK_EQ(allocator.offset(live[i]), i * 64);
+    }
+    stats = allocator.stats();
+    CHECK_EQ(stats.free_blocks, 1);
+    CHECK_EQ(stats.largest_free_block, 512);
+    CHECK(stats.fragmentation() == 0.f);
+    CHECK_EQ(allocator.allocate(512).offset, 512);
+}
+
+TEST_CASE(grow_extends_free_tail_or_adds_block)
+{
+    OffsetAllocator allocator;
+    allocator.initialize(1024);
+    OffsetAllocator::Allocation all = allocator.allocate(1024);
+    allocator.grow(2048);
+    CHECK_EQ(allocator.size(), 2048);
+    CHECK_EQ(allocator.stats().free_blocks, 1);
+    OffsetAllocator::Allocation half = allocator.allocate(512);
+    CHECK_EQ(half.offset, 1024);
+    CHECK_EQ(allocator.offset(all), 0);
+
+    // free tail is extended instead of getting a neighbour
+    allocator.grow(4096);
+    CHECK_EQ(allocator.stats().free_blocks, 1);
+    CHECK_EQ(allocator.stats().largest_free_block, 4096 - 1536);
+
+    OffsetAllocator empty;
+    empty.initialize(0);
+    CHECK_EQ(empty.allocate(1).node, OffsetAllocator::invalid_node);
+    empty.grow(16);
+    CHECK_EQ(empty.allocate(16).offset, 0);
+}
+
+// random allocate, free, defragment and grow keep ranges disjoint and stats exact
+TEST_CASE(random_operations_stay_consistent)
+{
+    OffsetAllocator allocator;
+    allocator.initialize(1 << 14);
+    std::vector<OffsetAllocator::Allocation> live;
+    std::vector<OffsetAllocator::Move> moves;
+    Random random;
+    uint32_t failures = 0;
+    bool ok = true;
+    for (uint32_t step = 0; step < 5000 && ok; ++step) {
+        const uint32_t operation = random.next() % 100;
+        if (operation < 55) {
+            const uint32_t size = 1 + random.next() % ((random.next() % 8 == 0) ? 2048 : 64);
+            OffsetAllocator::Allocation allocation = allocator.allocate(size);
+            if (allocation.node == OffsetAllocator::invalid_node) {
+                ++failures;
+                // TLSF may miss a block of exactly the size, never one with a full bin to spare
+                ok = allocator.stats().largest_free_block < size * 2 + 8;
+            } else {
+                CHECK_EQ(allocation.size, size);
+                live.push_back(allocation);
+            }
+        } else if (operation < 95 && !live.empty()) {
+            const size_t index = random.next() % live.size();
+            allocator.free(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+        } else if (operation < 98) {
+            const OffsetAllocator::Stats before = allocator.stats();
+            allocator.defragment(moves);
+            const OffsetAllocator::Stats after = allocator.stats();
+            ok = after.used == before.used && after.free_blocks <= 1;
+        } else if (allocator.size() < (1 << 15)) {
+            allocator.grow(allocator.size() + 1 + random.next() % 4096);
+        }
+        ok = ok && consistent(allocator, live);
+    }
+    CHECK(ok);
+    CHECK(failures > 0);
+}
+
+int main()
+{
+    return test::run_all();
+}
@@ -0,0 +1,115 @@
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+#include "render/resource/pipeline_key.h"
+
+namespace
+{
+
+const uint8_t shader[] = { 'D', 'X', 'B', 'C', 1, 2, 3, 4 };
+
+// fields set, everything else left as garbage in padding and ignored pointers
+D3D12_COMPUTE_PIPELINE_STATE_DESC compute_desc(uint8_t garbage, const void* bytecode)
+{
+    D3D12_COMPUTE_PIPELINE_STATE_DESC desc;
+    memset(&desc, garbage, sizeof(desc));
+    desc.CS.pShaderBytecode = bytecode;
+    desc.CS.BytecodeLength = sizeof(shader);
+    desc.NodeMask = 0;
+    desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+    return desc;
+}
+
+D3D12_GRAPHICS_PIPELINE_STATE_DESC graphics_desc(const D3D12_INPUT_ELEMENT_DESC* inputs, UINT input_count)
+{
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
+    desc.VS = { shader, sizeof(shader) };
+    desc.InputLayout = { inputs, input_count };
+    desc.SampleMask = ~0u;
+    desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    desc.NumRenderTargets = 1;
+    desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+    desc.SampleDesc.Count = 1;
+    return desc;
+}
+
+} // namespace
+
+// pipelines of different objects share one PSO only if equal descriptions give equal keys
+TEST_CASE(equal_descriptions_share_a_key)
+{
+    const std::vector<uint8_t> copy(shader, shader + sizeof(shader));
+    const D3D12_COMPUTE_PIPELINE_STATE_DESC a = compute_desc(0x00, shader);
+    D3D12_COMPUTE_PIPELINE_STATE_DESC b = compute_desc(0xab, copy.data());
+    // root signature pointer and cached blob aren't part of the key, the root signature hash is
+    b.pRootSignature = reinterpret_cast<ID3D12RootSignature*>(uintptr_t(0x1234));
+    CHECK_EQ(hash_pipeline(a, 7), hash_pipeline(b, 7));
+}
+
+TEST_CASE(key_follows_every_compute_field)
+{
+    const D3D12_COMPUTE_PIPELINE_STATE_DESC base = compute_desc(0, shader);
+    const uint64_t key = hash_pipeline(base, 7);
+    CHECK(hash_pipeline(base, 8) != key);
+
+    std::vector<uint8_t> other(shader, shader + sizeof(shader));
+    other.back() ^= 1;
+    CHECK(hash_pipeline(compute_desc(0, other.data()), 7) != key);
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC shorter = base;
+    shorter.CS.BytecodeLength -= 1;
+    CHECK(hash_pipeline(shorter, 7) != key);
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC node = base;
+    node.NodeMask = 1;
+    CHECK(hash_pipeline(node, 7) != key);
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC flags = base;
+    flags.Flags = D3D12_PIPELINE_STATE_FLAG_TOOL_DEBUG;
+    CHECK(hash_pipeline(flags, 7) != key);
+}
+
+TEST_CASE(input_layout_is_hashed_by_content)
+{
+    const char position[] = "POSITION";
+    std::vector<char> position_copy(position, position + sizeof(position));
+    const D3D12_INPUT_ELEMENT_DESC inputs[] = {
+        { position, 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    };
+    D3D12_INPUT_ELEMENT_DESC same[] = { inputs[0], inputs[1] };
+    same[0].SemanticName = position_copy.data();
+    CHECK_EQ(hash_pipeline(graphics_desc(inputs, 2), 1), hash_pipeline(graphics_desc(same, 2), 1));
+
+    D3D12_INPUT_ELEMENT_DESC renamed[] = { inputs[0], inputs[1] };
+    renamed[1].SemanticName = "TEXCOORD";
+    CHECK(hash_pipeline(graphics_desc(inputs, 2), 1) != hash_pipeline(graphics_desc(renamed, 2), 1));
+    CHECK(hash_pipeline(graphics_desc(inputs, 2), 1) != hash_pipeline(graphics_desc(inputs, 1), 1));
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC wireframe = graphics_desc(inputs, 2);
+    wireframe.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
+    CHECK(hash_pipeline(graphics_desc(inputs, 2), 1) != hash_pipeline(wireframe, 1));
+}
+
+TEST_CASE(graphics_and_compute_keys_differ)
+{
+    const D3D12_GRAPHICS_PIPELINE_STATE_DESC graphics = {};
+    const D3D12_COMPUTE_PIPELINE_STATE_DESC compute = {};
+    CHECK(hash_pipeline(graphics, 0) != hash_pipeline(compute, 0));
+}
+
+// keys name pipelines in the library file, a change of the hash drops pipelines stored by earlier runs
+TEST_CASE(root_signature_key_is_stable)
+{
+    const char blob[] = { 1, 2, 3, 4 };
+    CHECK_EQ(hash_root_signature(blob, sizeof(blob)), hash_root_signature(blob, sizeof(blob)));
+    CHECK(hash_root_signature(blob, 3) != hash_root_signature(blob, 4));
+    CHECK(hash_root_signature(blob, sizeof(blob)) == 0xf0ae8250656ed8a1ull);
+}
+
+int main()
+{
+    return test::run_all();
+}
@@ -0,0 +1,95 @@
+#include <vector>
+
+#include "test.h"
+#include "render/resource/pipeline_layout.h"
+#include "bench/bind_benchmark.h"
+
+namespace
+{
+
+// layout of the voxel fill pass in AS4VXGI_Component
+using FillLayout = PipelineLayout<
+    CAMERA_DATA_BIND,
+    MESH_TREE_BIND,
+    INDICES_BIND,
+    VERTICES_BIND,
+    MODEL_MATRICES_BIND,
+    TRIANGLE_RECORDS_BIND,
+    MESH_INSTANCES_BIND,
+    VOXEL_DATA_BIND,
+    VOXELS_BIND,
+    VOXEL_BRICKS_BIND>;
+
+// pipeline base without device, remembers root parameters in declaration order
+class RecordingPipeline
+{
+public:
+    struct Declared
+    {
+        char register_class;
+        UINT slot;
+        UINT space;
+    };
+
+    const std::vector<Declared>& declared() const { return declared_; }
+protected:
+    template<class bind>
+    void declare_bind()
+    {
+        declared_.push_back({ PipelineLayout<>::register_class<bind>(), bind::slot(), bind::space() });
+    }
+private:
+    std::vector<Declared> declared_;
+};
+
+} // namespace
+
+// layout checks, nothing runs: a failing one breaks the build
+static_assert(FillLayout::size == 10);
+static_assert(FillLayout::root_index<CAMERA_DATA_BIND>() == 0);
+static_assert(FillLayout::root_index<VOXEL_BRICKS_BIND>() == 9);
+static_assert(FillLayout::contains<VOXELS_BIND>());
+static_assert(!FillLayout::contains<MODEL_DATA_BIND>());
+static_assert(!FillLayout::contains<BOX_TRANSFORM_BIND>());
+static_assert(LayoutPipeline<RecordingPipeline, FillLayout>::resource_index<TRIANGLE_RECORDS_BIND>() == 5);
+static_assert(PipelineLayout<>::size == 0);
+static_assert(!PipelineLayout<>::contains<CAMERA_DATA_BIND>());
+// b0 and t0 are different registers of the same slot and space
+static_assert(PipelineLayout<CAMERA_DATA_BIND, BindInfo<SRV, 0, 0>>::unique_registers());
+static_assert(PipelineLayout<CAMERA_DATA_BIND, BindInfo<SRV, 0, 0>>::root_index<BindInfo<SRV, 0, 0>>() == 1);
+static_assert(PipelineLayout<CAMERA_DATA_BIND, VOXEL_DATA_BIND>::unique_registers());
+// LayoutPipeline of such a layout doesn't compile, see compile_fail/pipeline_layout_binds.cpp
+static_assert(!PipelineLayout<CAMERA_DATA_BIND, BindInfo<CBV, 0, 0>>::unique_registers());
+// root constants use b registers, tables only their ranges' spaces
+static_assert(!PipelineLayout<BindInfo<CONSTANTS, 0, 2>, BindInfo<CBV, 0, 2>>::unique_registers());
+static_assert(PipelineLayout<FILL_INDICES_BIND, FILL_TABLE_BIND>::unique_registers());
+
+TEST_CASE(pipeline_declares_binds_in_layout_order)
+{
+    const LayoutPipeline<RecordingPipeline, FillLayout> pipeline;
+    const std::vector<RecordingPipeline::Declared>& declared = pipeline.declared();
+    CHECK_EQ(declared.size(), FillLayout::size);
+    CHECK_EQ(declared[0].register_class, 'b');
+    CHECK_EQ(declared[0].slot, 0);
+    CHECK_EQ(declared[0].space, 0);
+    CHECK_EQ(declared[8].register_class, 'u');
+    CHECK_EQ(declared[8].slot, 1);
+    CHECK_EQ(declared[8].space, 1);
+    CHECK_EQ(declared[9].register_class, 't');
+}
+
+// the linear search keyed by register class, slot and space finds the same root parameters as the layout
+TEST_CASE(bind_benchmark_variants_agree)
+{
+    const std::vector<BindBenchmarkResult> results = run_bind_benchmark(2, 4);
+    CHECK_EQ(results.size(), 2);
+    CHECK_EQ(results[0].binds, 2 * 4 * 10);
+    CHECK_EQ(results[0].checksum, results[1].checksum);
+    // sum of 0..9 per mesh
+    CHECK_EQ(results[1].checksum, 2 * 4 * 45);
+}
+
+int main()
+{
+    return test::run_all();
+}
@@ -0,0 +1,96 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+#include "core/profiler.h"
+
+namespace
+{
+
+uint64_t zone_count(const char* name)
+{
+    for (const ProfileZoneStats& zone : Profiler::inst().zone_stats()) {
+        if (zone.name == name) {
+            return zone.count;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST_CASE(zones_of_threads_are_counted)
+{
+    Profiler& profiler = Profiler::inst();
+    profiler.clear();
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            for (uint32_t zone = 0; zone < 100; ++zone) {
+                Profiler::record("Worker", Profiler::now(), Profiler::now());
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK_EQ(zone_count("Worker"), 400);
+    profiler.clear();
+    CHECK_EQ(zone_count("Worker"), 0);
+}
+
+// clear leaves the count of the writing thread alone, zones after it are kept and zones before it never come back
+TEST_CASE(clear_leaves_writers_alone)
+{
+    Profiler& profiler = Profiler::inst();
+    profiler.clear();
+    std::atomic<uint32_t> stage{ 0 };
+    std::thread writer([&stage] {
+        for (uint32_t zone = 0; zone < 5000; ++zone) {
+            Profiler::record("Before clear", Profiler::now(), Profiler::now());
+        }
+        stage.store(1);
+        while (stage.load() != 2) {
+            std::this_thread::yield();
+        }
+        for (uint32_t zone = 0; zone < 1000; ++zone) {
+            Profiler::record("After clear", Profiler::now(), Profiler::now());
+        }
+    });
+    while (stage.load() != 1) {
+        std::this_thread::yield();
+    }
+    CHECK_EQ(zone_count("Before clear"), 5000);
+    profiler.clear();
+    stage.store(2);
+    writer.join();
+
+    CHECK_EQ(zone_count("Before clear"), 0);
+    CHECK_EQ(zone_count("After clear"), 1000);
+}
+
+// under 50 ns where reading the counter is cheap, virtual machines may trap rdtsc,
+// so the bound is checked on what the zone adds to its two timestamps
+TEST_CASE(zone_overhead)
+{
+    const uint32_t iterations = 1000000;
+    uint64_t sum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        sum += Profiler::now();
+    }
+    const double timestamp_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / iterations;
+    const double zone_ns = Profiler::inst().measure_zone_overhead(iterations);
+    printf("%.1f ns per zone, %.1f ns per timestamp (%u)\n", zone_ns, timestamp_ns, uint32_t(sum & 1));
+#if defined(PROFILER_ENABLED) && defined(NDEBUG)
+    CHECK(zone_ns - 2.0 * timestamp_ns < 25.0);
+#endif
+}
+
+int main()
+{
+    return test::run_all();
+}
@@ -0,0 +1,227 @@
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "render/render_graph.h"
+#include "render/graph_recorder.hpp"
+#include "render/command_list_pool.hpp"
+#include "render/null_command_device.h"
+
+namespace
+{
+
+// barriers of type for resource in the batch before position, in batch order
+std::vector<GraphBarrier> find_barriers(const CompiledGraph& compiled, uint32_t position, GraphBarrier::Type type, GraphResource resource)
+{
+    std::vector<GraphBarrier> found;
+    for (const GraphBatch& batch : compiled.batches) {
+        if (batch.position != position) {
+            continue;
+        }
+        for (const GraphBarrier& barrier : batch.barriers) {
+            if (barrier.type == type && barrier.resource == resource) {
+                found.push_back(barrier);
+            }
+        }
+    }
+    return found;
+}
+
+// index of the first barrier of type for resource in the batch before position, -1 if there is none
+int barrier_index(const CompiledGraph& compiled, uint32_t position, GraphBarrier::Type type, GraphResource resource)
+{
+    for (const GraphBatch& batch : compiled.batches) {
+        if (batch.position != position) {
+            continue;
+        }
+        for (size_t i = 0; i < batch.barriers.size(); ++i) {
+            if (batch.barriers[i].type == type && batch.barriers[i].resource == resource) {
+                return int(i);
+            }
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+TEST_CASE(unused_passes_are_culled_and_order_kept)
+{
+    RenderGraph graph;
+    const GraphResource backbuffer = graph.import_resource("Backbuffer", GraphState::present, GraphState::present);
+    const GraphResource color = graph.create_transient("Color", 1024, 256);
+    const GraphResource unused = graph.create_transient("Unused", 1024, 256);
+
+    const GraphPass draw = graph.add_pass("Draw");
+    graph.write(draw, color, GraphState::render_target);
+    const GraphPass orphan = graph.add_pass("Orphan");
+    graph.write(orphan, unused, GraphState::render_target);
+    const GraphPass compose = graph.add_pass("Compose");
+    graph.read(compose, color, GraphState::pixel_shader_resource);
+    graph.write(compose, backbuffer, GraphState::render_target);
+    const GraphPass debug = graph.add_pass("Debug", true);
+
+    const CompiledGraph& compiled = graph.compile();
+    CHECK((compiled.order == std::vector<GraphPass>{ draw, compose, debug }));
+    CHECK(orphan == 1);
+    CHECK_EQ(compiled.stats.passes, 3);
+    CHECK_EQ(compiled.stats.culled_passes, 1);
+    // culled transient gets no memory
+    CHECK_EQ(compiled.placements.size(), 1);
+    CHECK_EQ(compiled.placements[0].resource, color);
+
+    // imported resource goes back to its final state after the last pass
+    const std::vector<GraphBarrier> restore = find_barriers(compiled, 3, GraphBarrier::Type::transition, backbuffer);
+    CHECK_EQ(restore.size(), 1);
+    CHECK_EQ(restore[0].state_before, GraphState::render_target);
+    CHECK_EQ(restore[0].state_after, GraphState::present);
+}
+
+TEST_CASE(following_reads_share_one_transition)
+{
+    RenderGraph graph;
+    const GraphResource voxels = graph.import_resource("Voxels", GraphState::unordered_access);
+
+    const GraphPass fill = graph.add_pass("Fill");
+    graph.write(fill, voxels, GraphState::unordered_access);
+    const GraphPass trace = graph.add_pass("Trace", true);
+    graph.read(trace, voxels, GraphState::non_pixel_shader_resource);
+    const GraphPass debug = graph.add_pass("Debug", true);
+    graph.read(debug, voxels, GraphState::pixel_shader_resource);
+
+    const CompiledGraph& compiled = graph.compile();
+    CHECK_EQ(compiled.stats.barriers, 1);
+    CHECK_EQ(compiled.stats.merged_reads, 1);
+    const std::vector<GraphBarrier> transitions = find_barriers(compiled, 1, GraphBarrier::Type::transition, voxels);
+    CHECK_EQ(transitions.size(), 1);
+    CHECK_EQ(transitions[0].state_before, GraphState::unordered_access);
+    CHECK_EQ(transitions[0].state_after, GraphState::non_pixel_shader_resource | GraphState::pixel_shader_resource);
+    CHECK(find_barriers(compiled, 2, GraphBarrier::Type::transition, voxels).empty());
+}
+
+// imported resources keep their ids and the state the last frame left them in
+TEST_CASE(imported_state_carries_over_reset)
+{
+    RenderGraph graph;
+    const GraphResource voxels = graph.import_resource("Voxels", GraphState::common);
+    for (int frame = 0; frame < 2; ++frame) {
+        graph.reset();
+        const GraphPass fill = graph.add_pass("Fill");
+        graph.write(fill, voxels, GraphState::unordered_access);
+        const GraphPass trace = graph.add_pass("Trace", true);
+        graph.read(trace, voxels, GraphState::non_pixel_shader_resource);
+
+        const CompiledGraph& compiled = graph.compile();
+        const std::vector<GraphBarrier> first = find_barriers(compiled, 0, GraphBarrier::Type::transition, voxels);
+        CHECK_EQ(first.size(), 1);
+        CHECK_EQ(first[0].state_before, frame == 0 ? GraphState::common : GraphState::non_pixel_shader_resource);
+        CHECK_EQ(first[0].state_after, GraphState::unordered_access);
+        // keep_state leaves the resource as the last pass did
+        CHECK_EQ(compiled.stats.barriers, 2);
+    }
+    CHECK_EQ(graph.resource(voxels).state, GraphState::non_pixel_shader_resource);
+}
+
+TEST_CASE(uav_writes_are_separated)
+{
+    RenderGraph graph;
+    const GraphResource bricks = graph.import_resource("Bricks", GraphState::unordered_access);
+    const GraphPass clear = graph.add_pass("Clear");
+    graph.write(clear, bricks, GraphState::unordered_access);
+    const GraphPass fill = graph.add_pass("Fill");
+    graph.write(fill, bricks, GraphState::unordered_access);
+
+    const CompiledGraph& compiled = graph.compile();
+    CHECK_EQ(compiled.stats.barriers, 1);
+    CHECK_EQ(find_barriers(compiled, 1, GraphBarrier::Type::uav, bricks).size(), 1);
+    CHECK(find_barriers(compiled, 1, GraphBarrier::Type::transition, bricks).empty());
+}
+
+TEST_CASE(disjoint_transients_share_memory)
+{
+    RenderGraph graph;
+    const GraphResource backbuffer = graph.import_resource("Backbuffer", GraphState::present, GraphState::present);
+    const GraphResource a = graph.create_transient("A", 1024, 256);
+    const GraphResource b = graph.create_transient("B", 1024, 256);
+    const GraphResource c = graph.create_transient("C", 1024, 256);
+
+    const GraphPass pass_a = graph.add_pass("Write A");
+    graph.write(pass_a, a, GraphState::render_target);
+    const GraphPass pass_b = graph.add_pass("A to B");
+    graph.read(pass_b, a, GraphState::pixel_shader_resource);
+    graph.write(pass_b, b, GraphState::render_target);
+    const GraphPass pass_c = graph.add_pass("B to C");
+    graph.read(pass_c, b, GraphState::pixel_shader_resource);
+    graph.write(pass_c, c, GraphState::render_target);
+    const GraphPass present = graph.add_pass("Present");
+    graph.read(present, c, GraphState::pixel_shader_resource);
+    graph.write(present, backbuffer, GraphState::render_target);
+
+    const CompiledGraph& compiled = graph.compile();
+    CHECK_EQ(compiled.stats.culled_passes, 0);
+    CHECK_EQ(compiled.stats.transient_bytes, 3072);
+    CHECK_EQ(compiled.stats.heap_bytes, 2048);
+    CHECK_EQ(compiled.placements.size(), 3);
+    uint64_t offsets[3] = {};
+    for (const CompiledGraph::Placement& placement : compiled.placements) {
+        offsets[placement.resource - a] = placement.offset;
+        CHECK_EQ(placement.initial_state, GraphState::render_target);
+    }
+    CHECK_EQ(offsets[0], 0);
+    CHECK_EQ(offsets[1], 1024);
+    CHECK_EQ(offsets[2], 0);
+
+    // C takes the memory of A over, A goes back to its initial state first
+    const std::vector<GraphBarrier> aliasing = find_barriers(compiled, 2, GraphBarrier::Type::aliasing, c);
+    CHECK_EQ(aliasing.size(), 1);
+    CHECK_EQ(aliasing[0].before, a);
+    const int restore = barrier_index(compiled, 2, GraphBarrier::Type::transition, a);
+    CHECK(restore >= 0 && restore < barrier_index(compiled, 2, GraphBarrier::Type::aliasing, c));
+    // A shares memory only with the previous frame
+    const std::vector<GraphBarrier> first = find_barriers(compiled, 0, GraphBarrier::Type::aliasing, a);
+    CHECK_EQ(first.size(), 1);
+    CHECK_EQ(first[0].before, GraphBarrier::invalid);
+    CHECK(find_barriers(compiled, 1, GraphBarrier::Type::aliasing, b).empty());
+    CHECK(compiled.stats.batches <= compiled.stats.unhoisted_batches);
+}
+
+// barriers go to the head of the first list of their pass, a pass without tasks gets an empty list
+TEST_CASE(recorder_puts_barriers_before_pass_tasks)
+{
+    RenderGraph graph;
+    const GraphResource voxels = graph.import_resource("Voxels", GraphState::common);
+    const GraphPass fill = graph.add_pass("Fill");
+    graph.write(fill, voxels, GraphState::unordered_access);
+    const GraphPass trace = graph.add_pass("Trace", true);
+    graph.read(trace, voxels, GraphState::non_pixel_shader_resource);
+    const GraphPass orphan = graph.add_pass("Orphan");
+    const CompiledGraph& compiled = graph.compile();
+    CHECK_EQ(compiled.stats.batches, 2);
+
+    NullCommandDevice device;
+    CommandListPool<NullCommandDevice> pool;
+    pool.initialize(&device);
+    CommandRecorder<NullCommandDevice> recorder;
+    recorder.initialize(&device, &pool, 0);
+    recorder.set_max_workers(2);
+    GraphRecorder<NullCommandDevice> graph_recorder;
+
+    pool.begin_frame(0);
+    graph_recorder.record_pass(fill, [](NullCommandDevice::List list) { list->command("fill a"); });
+    graph_recorder.record_pass(fill, [](NullCommandDevice::List list) { list->command("fill b"); });
+    graph_recorder.record_pass(orphan, [](NullCommandDevice::List list) { list->command("orphan"); });
+    graph_recorder.record(compiled, graph.pass_count(), recorder, [](NullCommandDevice::List list, const GraphBatch& batch) {
+        list->command("barriers " + std::to_string(batch.position));
+    });
+    recorder.flush();
+    pool.end_frame(1);
+
+    CHECK((device.executed() == std::vector<std::string>{ "barriers 0", "fill a", "fill b", "barriers 1" }));
+    graph_recorder.reset();
+    pool.destroy();
+}
+
+int main()
+{
+    return test::run_all();
+}
@@ -0,0 +1,69 @@
+#include <string>
+
+#include "test.h"
+#include "render/resource/residency.h"
+
+TEST_CASE(static_data_goes_to_default_heap)
+{
+    ResidencyPolicy policy;
+    uint32_t indices = ResidencyPolicy::invalid_placement;
+    uint32_t constants = ResidencyPolicy::invalid_placement;
+    // index, vertex and shader resource buffers are static, constant and dynamic shader resources are dynamic
+    CHECK(policy.place("Index buffer", BufferUsage::static_data, 4096, indices) == HeapPlacement::default_heap);
+    CHECK(policy.place("Constant buffer", BufferUsage::dynamic_data, 768, constants) == HeapPlacement::upload_heap);
+    CHECK(indices != constants);
+    CHECK_EQ(policy.bytes(HeapPlacement::default_heap), 4096);
+    CHECK_EQ(policy.bytes(HeapPlacement::upload_heap), 768);
+    CHECK_EQ(policy.live_count(), 2);
+}
+
+TEST_CASE(static_in_upload_heap_keeps_old_placement)
+{
+    ResidencyPolicy policy;
+    uint32_t before = ResidencyPolicy::invalid_placement;
+    policy.place("Before", BufferUsage::static_data, 16, before);
+
+    ResidencyPolicy::Settings settings;
+    settings.static_in_upload_heap = true;
+    policy.set_settings(settings);
+    uint32_t after = ResidencyPolicy::invalid_placement;
+    CHECK(policy.place("After", BufferUsage::static_data, 32, after) == HeapPlacement::upload_heap);
+    CHECK(policy.placement(BufferUsage::dynamic_data) == HeapPlacement::upload_heap);
+    // placed buffers don't move
+    CHECK(policy.placements()[before].heap == HeapPlacement::default_heap);
+    CHECK(policy.report().find("static data in upload heap") != std::string::npos);
+}
+
+TEST_CASE(released_buffers_leave_the_report)
+{
+    ResidencyPolicy policy;
+    uint32_t first = ResidencyPolicy::invalid_placement;
+    uint32_t second = ResidencyPolicy::invalid_placement;
+    policy.place("First vertices", BufferUsage::static_data, 1024, first);
+    policy.place("Second vertices", BufferUsage::static_data, 2048, second);
+
+    policy.release(first);
+    CHECK_EQ(first, ResidencyPolicy::invalid_placement);
+    CHECK_EQ(policy.live_count(), 1);
+    CHECK_EQ(policy.bytes(HeapPlacement::default_heap), 2048);
+    const std::string report = policy.report();
+    CHECK(report.find("First vertices") == std::string::npos);
+    CHECK(report.find("Second vertices") != std::string::npos);
+    // releasing twice or an invalid id does nothing
+    policy.release(first);
+    CHECK_EQ(policy.live_count(), 1);
+
+    // released slot is reused, the report doesn't grow with recreated buffers
+    for (int i = 0; i < 100; ++i) {
+        uint32_t placement = ResidencyPolicy::invalid_placement;
+        policy.place("Recreated", BufferUsage::dynamic_data, 64, placement);
+        policy.release(placement);
+    }
+    CHECK_EQ(policy.placements().size(), 2);
+    CHECK_EQ(policy.bytes(HeapPlacement::upload_heap), 0);
+}
+
+int main()
+{
+    return test::run_all();
+}
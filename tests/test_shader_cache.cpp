@@ -0,0 +1,183 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "render/resource/shader_cache.h"
+
+namespace
+{
+
+// scratch directory of the test, emptied on first use
+std::filesystem::path scratch()
+{
+    static const std::filesystem::path path = [] {
+        const std::filesystem::path dir = std::filesystem::temp_directory_path() / "as4vxgi_test_shader_cache";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }();
+    return path;
+}
+
+void write_file(const std::filesystem::path& path, const std::string& text)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream fout(path, std::ios::binary);
+    fout << text;
+}
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream fin(path, std::ios::binary);
+    std::stringstream ss;
+    ss << fin.rdbuf();
+    return ss.str();
+}
+
+std::string quote(const std::string& argument)
+{
+    return "\"" + argument + "\"";
+}
+
+// shader_permutations of the build with the stub compiler, exit code
+int build_cache(const std::filesystem::path& cache, const std::filesystem::path& include_dir, const std::filesystem::path& shader)
+{
+    std::string command = quote(SHADER_PERMUTATIONS_PATH) + " --compiler " + quote(STUB_COMPILER_PATH)
+        + " --cache " + quote(cache.string()) + " --stage compute --entry CSMain --profile cs_6_0"
+        + " -I " + quote(include_dir.string()) + " " + quote(shader.string());
+#if defined(_WIN32)
+    command = quote(command);
+#endif
+    return std::system(command.c_str());
+}
+
+const char* fill_source =
+    "// option: BRICKS 0 1\n"
+    "#include \"fill_common.fx\"\n"
+    "#include <builtin.h>\n"
+    "[numthreads(4, 4, 4)] void CSMain() {}\n";
+
+const char* common_source =
+    "// option: KERNEL scalar wide\n"
+    "#include \"types.fx\"\n";
+
+} // namespace
+
+TEST_CASE(options_are_parsed_from_comment_lines)
+{
+    const std::vector<ShaderOption> options = parse_shader_options(
+        "// option: A 0 1\n"
+        "   // option: MODE fast exact debug\n"
+        "// option: EMPTY\n"
+        "// not an option: B 0 1\n");
+    CHECK_EQ(options.size(), 2);
+    CHECK(options[0].name == "A");
+    CHECK((options[0].values == std::vector<std::string>{ "0", "1" }));
+    CHECK(options[1].name == "MODE");
+    CHECK_EQ(options[1].values.size(), 3);
+}
+
+TEST_CASE(defines_select_one_permutation)
+{
+    const std::vector<ShaderOption> options = { { "A", { "0", "1" } }, { "MODE", { "fast", "exact" } } };
+    std::vector<std::string> selected;
+    CHECK(select_permutation(options, {}, selected));
+    CHECK((selected == std::vector<std::string>{ "A=0", "MODE=fast" }));
+    // order of defines doesn't matter, NAME alone is NAME=1
+    CHECK(select_permutation(options, { "MODE=exact", "A" }, selected));
+    CHECK((selected == std::vector<std::string>{ "A=1", "MODE=exact" }));
+    CHECK(!select_permutation(options, { "B=1" }, selected));
+    CHECK(!select_permutation(options, { "MODE=debug" }, selected));
+}
+
+TEST_CASE(permutations_cover_every_combination)
+{
+    const std::vector<ShaderOption> options = { { "A", { "0", "1" } }, { "MODE", { "fast", "exact", "debug" } } };
+    const std::vector<std::vector<std::string>> permutations = shader_permutations(options);
+    CHECK_EQ(permutations.size(), 6);
+    CHECK((permutations.front() == std::vector<std::string>{ "A=0", "MODE=fast" }));
+    CHECK((permutations.back() == std::vector<std::string>{ "A=1", "MODE=debug" }));
+    CHECK_EQ(shader_permutations({}).size(), 1);
+}
+
+// options of includes count, editing any include changes the key, the stage and defines are part of it too
+TEST_CASE(key_follows_includes_stage_and_defines)
+{
+    const std::filesystem::path dir = scratch() / "keys";
+    write_file(dir / "shaders" / "fill.hlsl", fill_source);
+    write_file(dir / "shaders" / "fill_common.fx", common_source);
+    write_file(dir / "common" / "types.fx", "struct Voxel { float4 albedo; };\n");
+    const std::vector<std::string> include_dirs = { (dir / "common").string() };
+
+    const ShaderSource source = read_shader_source((dir / "shaders" / "fill.hlsl").string(), include_dirs);
+    CHECK(source.valid);
+    CHECK_EQ(source.options.size(), 2);
+    CHECK(source.options[0].name == "BRICKS");
+    CHECK(source.options[1].name == "KERNEL");
+
+    const std::vector<std::string> defaults = { "BRICKS=0", "KERNEL=scalar" };
+    const uint64_t key = shader_key(source, "compute", defaults);
+    CHECK(shader_key(source, "pixel", defaults) != key);
+    CHECK(shader_key(source, "compute", { "BRICKS=1", "KERNEL=scalar" }) != key);
+
+    write_file(dir / "common" / "types.fx", "struct Voxel { float4 albedo; float4 normal; };\n");
+    const ShaderSource edited = read_shader_source((dir / "shaders" / "fill.hlsl").string(), include_dirs);
+    CHECK_EQ(edited.source_hash, source.source_hash);
+    CHECK(edited.includes_hash != source.includes_hash);
+    CHECK(shader_key(edited, "compute", defaults) != key);
+
+    CHECK(!read_shader_source((dir / "missing.hlsl").string(), include_dirs).valid);
+}
+
+// cache built by tools/shader_permutations with the stub compiler: every permutation is found by its defines
+TEST_CASE(cache_finds_permutations_built_by_the_tool)
+{
+    const std::filesystem::path dir = scratch() / "build";
+    const std::filesystem::path shader = dir / "shaders" / "fill.hlsl";
+    write_file(shader, fill_source);
+    write_file(dir / "shaders" / "fill_common.fx", common_source);
+    write_file(dir / "common" / "types.fx", "struct Voxel { float4 albedo; };\n");
+    const std::filesystem::path cache_dir = dir / "cache";
+    CHECK_EQ(build_cache(cache_dir, dir / "common", shader), 0);
+    size_t blobs = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(cache_dir)) {
+        blobs += entry.path().extension() == ".cso" ? 1 : 0;
+    }
+    CHECK_EQ(blobs, 4);
+
+    ShaderCache cache;
+    cache.initialize(cache_dir.string(), { (dir / "common").string() });
+    const std::string wide = cache.find(shader.string(), "compute", { "KERNEL=wide" });
+    CHECK(!wide.empty());
+    const std::string arguments = read_file(wide);
+    CHECK(arguments.find("KERNEL=wide\n") != std::string::npos);
+    CHECK(arguments.find("BRICKS=0\n") != std::string::npos);
+    CHECK(arguments.find("CSMain\n") != std::string::npos);
+
+    CHECK(!cache.find(shader.string(), "compute", { "BRICKS", "KERNEL=scalar" }).empty());
+    CHECK(cache.find(shader.string(), "pixel", {}).empty());
+    CHECK(cache.find(shader.string(), "compute", { "KERNEL=simd" }).empty());
+    const ShaderCache::Stats& stats = cache.stats();
+    CHECK_EQ(stats.sources, 1);
+    CHECK_EQ(stats.lookups, 4);
+    CHECK_EQ(stats.hits, 2);
+    CHECK_EQ(stats.misses, 1);
+    CHECK_EQ(stats.invalid_defines, 1);
+
+    // edited include misses until the build compiles it again
+    write_file(dir / "common" / "types.fx", "struct Voxel { float4 normal; };\n");
+    ShaderCache stale;
+    stale.initialize(cache_dir.string(), { (dir / "common").string() });
+    CHECK(stale.find(shader.string(), "compute", {}).empty());
+    CHECK_EQ(build_cache(cache_dir, dir / "common", shader), 0);
+    CHECK(!stale.find(shader.string(), "compute", {}).empty());
+}
+
+int main()
+{
+    return test::run_all();
+}
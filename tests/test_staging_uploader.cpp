@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "test.h"
+#include "render/resource/staging_uploader.h"
+
+namespace
+{
+
+// GPU buffer of the fake queue, passed around as ID3D12Resource*
+struct FakeBuffer
+{
+    std::vector<uint8_t> bytes;
+
+    explicit FakeBuffer(size_t size) : bytes(size, 0) {}
+    ID3D12Resource* resource() { return reinterpret_cast<ID3D12Resource*>(this); }
+};
+
+// Copy queue that runs copies only when its fence is advanced, so staging memory reused too early
+// shows up as wrong destination bytes
+class FakeStagingDevice : public StagingDevice
+{
+public:
+    explicit FakeStagingDevice(uint64_t capacity) : memory_(size_t(capacity), 0) {}
+
+    uint8_t* staging_memory() override { return memory_.data(); }
+    uint64_t capacity() const override { return uint64_t(memory_.size()); }
+
+    void copy(ID3D12Resource* destination, uint64_t destination_offset, uint64_t staging_offset, uint64_t size) override
+    {
+        open_.push_back({ reinterpret_cast<FakeBuffer*>(destination), destination_offset, staging_offset, size, 0 });
+    }
+
+    uint64_t submit() override
+    {
+        ++submitted_;
+        for (Copy& copy : open_) {
+            copy.fence_value = submitted_;
+            queued_.push_back(copy);
+        }
+        open_.clear();
+        return submitted_;
+    }
+
+    uint64_t completed_value() override { return completed_; }
+
+    void wait(uint64_t fence_value) override
+    {
+        ++waits_;
+        complete(fence_value);
+    }
+
+    // GPU catches up to fence_value
+    void complete(uint64_t fence_value)
+    {
+        while (!queued_.empty() && queued_.front().fence_value <= fence_value) {
+            const Copy& copy = queued_.front();
+            memcpy(copy.destination->bytes.data() + copy.destination_offset, memory_.data() + copy.staging_offset, size_t(copy.size));
+            queued_.pop_front();
+        }
+        completed_ = std::max(completed_, std::min(fence_value, submitted_));
+    }
+
+    uint64_t submitted() const { return submitted_; }
+    uint64_t waits() const { return waits_; }
+    size_t queued_copies() const { return queued_.size(); }
+private:
+    struct Copy
+    {
+        FakeBuffer* destination;
+        uint64_t destination_offset;
+        uint64_t staging_offset;
+        uint64_t size;
+        uint64_t fence_value;
+    };
+
+    std::vector<uint8_t> memory_;
+    std::vector<Copy> open_;
+    std::deque<Copy> queued_;
+    uint64_t submitted_{ 0 };
+    uint64_t completed_{ 0 };
+    uint64_t waits_{ 0 };
+};
+
+std::vector<uint8_t> pattern(size_t size, uint8_t seed)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = uint8_t(seed + i * 7);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE(ring_aligns_wraps_and_fills)
+{
+    StagingRing ring;
+    ring.initialize(256);
+    uint64_t offset = 0;
+    CHECK(ring.allocate(100, 16, offset));
+    CHECK_EQ(offset, 0);
+    CHECK(ring.allocate(100, 16, offset));
+    CHECK_EQ(offset, 112);
+    ring.close_batch(1);
+    CHECK(ring.allocate(20, 16, offset));
+    CHECK_EQ(offset, 224);
+    ring.close_batch(2);
+    CHECK_EQ(ring.used(), 244);
+    // no room until the first batch retires
+    CHECK(!ring.allocate(64, 16, offset));
+
+    ring.retire(1);
+    CHECK_EQ(ring.batches_in_flight(), 1);
+    CHECK_EQ(ring.oldest_fence_value(), 2);
+    // end of the ring is too small, range starts over at 0
+    CHECK(ring.allocate(64, 16, offset));
+    CHECK_EQ(offset, 0);
+    ring.close_batch(3);
+    ring.retire(3);
+    CHECK_EQ(ring.used(), 0);
+    CHECK_EQ(ring.batches_in_flight(), 0);
+    CHECK_EQ(ring.oldest_fence_value(), 0);
+}
+
+TEST_CASE(uploads_share_one_batch)
+{
+    FakeStagingDevice device(4096);
+    StagingUploader uploader;
+    uploader.initialize(&device);
+    FakeBuffer buffer(1024);
+
+    const std::vector<uint8_t> data = pattern(1024, 3);
+    for (uint32_t i = 0; i < 16; ++i) {
+        uploader.upload(buffer.resource(), i * 64, data.data() + i * 64, 64);
+    }
+    CHECK_EQ(uploader.submit(), 1);
+    CHECK_EQ(uploader.submit(), 0);
+    CHECK_EQ(device.submitted(), 1);
+    CHECK_EQ(device.waits(), 0);
+    CHECK_EQ(device.queued_copies(), 16);
+
+    StagingUploader::Stats stats = uploader.stats();
+    CHECK_EQ(stats.uploads, 16);
+    CHECK_EQ(stats.bytes, 1024);
+    CHECK_EQ(stats.batches, 1);
+    CHECK_EQ(stats.batches_in_flight, 1);
+
+    // retired without waiting once GPU is done
+    device.complete(1);
+    uploader.retire();
+    stats = uploader.stats();
+    CHECK_EQ(stats.batches_in_flight, 0);
+    CHECK_EQ(stats.ring_used, 0);
+    CHECK_EQ(device.waits(), 0);
+    CHECK(buffer.bytes == data);
+}
+
+// staging memory is reused only after GPU copied it, however small the ring is
+TEST_CASE(full_ring_waits_for_oldest_batch)
+{
+    FakeStagingDevice device(256);
+    StagingUploader uploader;
+    uploader.initialize(&device);
+    FakeBuffer buffer(4096);
+
+    const std::vector<uint8_t> data = pattern(4096, 11);
+    for (uint32_t i = 0; i < 4096 / 96; ++i) {
+        uploader.upload(buffer.resource(), i * 96, data.data() + i * 96, 96);
+        if (i % 3 == 2) {
+            uploader.submit();
+        }
+    }
+    uploader.upload(buffer.resource(), 4096 / 96 * 96, data.data() + 4096 / 96 * 96, 4096 % 96);
+    uploader.flush();
+
+    const StagingUploader::Stats stats = uploader.stats();
+    CHECK(stats.stalls > 0);
+    CHECK_EQ(stats.flushes, 1);
+    CHECK_EQ(stats.batches_in_flight, 0);
+    CHECK_EQ(stats.ring_used, 0);
+    CHECK_EQ(device.queued_copies(), 0);
+    CHECK(buffer.bytes == data);
+}
+
+TEST_CASE(upload_larger_than_ring_is_split)
+{
+    FakeStagingDevice device(256);
+    StagingUploader uploader;
+    uploader.initialize(&device);
+    FakeBuffer buffer(1000);
+
+    const std::vector<uint8_t> data = pattern(1000, 5);
+    uploader.upload(buffer.resource(), 0, data.data(), 1000);
+    uploader.flush();
+    CHECK_EQ(uploader.stats().uploads, 1);
+    CHECK_EQ(uploader.stats().bytes, 1000);
+    CHECK(uploader.stats().batches >= 4);
+    CHECK(buffer.bytes == data);
+}
+
+TEST_CASE(flush_without_uploads_does_nothing)
+{
+    FakeStagingDevice device(256);
+    StagingUploader uploader;
+    uploader.initialize(&device);
+    uploader.flush();
+    CHECK_EQ(device.submitted(), 0);
+    CHECK_EQ(device.waits(), 0);
+}
+
+int main()
+{
+    return test::run_all();
+}
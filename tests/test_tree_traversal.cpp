@@ -0,0 +1,106 @@
+#include <vector>
+
+#include "test.h"
+#include "math/intersection.h"
+#include "math/mesh_tree.h"
+#include "math/tree_traversal.h"
+
+namespace
+{
+
+constexpr float t_max = 1000.f;
+
+// quads of one unit in the plane y = height, node boxes have faces on whole x and z
+struct Grid
+{
+    std::vector<Vector3> positions;
+    std::vector<uint32_t> indices;
+    std::vector<MeshTreeNode> tree;
+    std::vector<ThreadedTreeNode> threaded_tree;
+};
+
+Grid make_grid(uint32_t cells, float height)
+{
+    Grid grid;
+    for (uint32_t z = 0; z <= cells; ++z) {
+        for (uint32_t x = 0; x <= cells; ++x) {
+            grid.positions.push_back(Vector3(float(x), height, float(z)));
+        }
+    }
+    for (uint32_t z = 0; z < cells; ++z) {
+        for (uint32_t x = 0; x < cells; ++x) {
+            const uint32_t corner = z * (cells + 1) + x;
+            const uint32_t quad[6] = { corner, corner + 1, corner + cells + 1, corner + 1, corner + cells + 2, corner + cells + 1 };
+            grid.indices.insert(grid.indices.end(), quad, quad + 6);
+        }
+    }
+    const float min[3] = { 0.f, height, 0.f };
+    const float max[3] = { float(cells), height, float(cells) };
+    build_mesh_tree(grid.indices, grid.positions, min, max, 1.f, grid.tree);
+    build_threaded_tree(grid.tree, grid.threaded_tree);
+    return grid;
+}
+
+float brute_force(const Grid& grid, const Ray& ray)
+{
+    float closest = 0.f;
+    for (size_t i = 0; i < grid.indices.size(); i += 3) {
+        float u, v;
+        const float t = triangle_intersection(ray, grid.positions[grid.indices[i]], grid.positions[grid.indices[i + 1]],
+                                              grid.positions[grid.indices[i + 2]], u, v);
+        if (t > 0.f && t < t_max && (closest == 0.f || t < closest)) {
+            closest = t;
+        }
+    }
+    return closest;
+}
+
+} // namespace
+
+// up axis ray has zero x and z, starting on the x face of the box must not turn the slab test into NaN
+TEST_CASE(ray_starting_on_box_face_hits)
+{
+    const Ray ray{ Vector3(0.f, 0.f, 0.5f), Vector3(0.f, 1.f, 0.f) };
+    float entry = -1.f;
+    CHECK(box_intersection(ray, inverse_direction(ray.direction), Vector3(0.f, -1.f, 0.f), Vector3(1.f, 1.f, 1.f), t_max, entry));
+    CHECK_EQ(entry, 0.f);
+    CHECK(!box_intersection(ray, inverse_direction(ray.direction), Vector3(0.5f, -1.f, 0.f), Vector3(1.f, 1.f, 1.f), t_max, entry));
+}
+
+// rays along the up axis starting on node faces find what brute force finds
+TEST_CASE(traversal_from_node_faces_matches_brute_force)
+{
+    const Grid grid = make_grid(8, 5.f);
+    MeshTreeView tree;
+    tree.nodes = grid.tree.data();
+    tree.node_count = uint32_t(grid.tree.size());
+    tree.indices = grid.indices.data();
+    tree.positions = grid.positions.data();
+    ThreadedTreeView threaded_tree;
+    threaded_tree.nodes = grid.threaded_tree.data();
+    threaded_tree.node_count = uint32_t(grid.threaded_tree.size());
+    threaded_tree.indices = grid.indices.data();
+    threaded_tree.positions = grid.positions.data();
+
+    uint32_t hits = 0;
+    uint32_t different = 0;
+    for (uint32_t z = 0; z <= 16; ++z) {
+        for (uint32_t x = 0; x <= 16; ++x) {
+            const Ray ray{ Vector3(x * 0.5f, 0.f, z * 0.5f), Vector3(0.f, 1.f, 0.f) };
+            const float expected = brute_force(grid, ray);
+            TraversalCounters counters;
+            const TraversalHit stack_hit = traverse_mesh_tree(tree, ray, t_max, counters);
+            const TraversalHit threaded_hit = traverse_threaded_tree(threaded_tree, ray, t_max, counters);
+            hits += expected > 0.f ? 1 : 0;
+            different += stack_hit.t != expected ? 1 : 0;
+            different += threaded_hit.t != expected ? 1 : 0;
+        }
+    }
+    CHECK(hits > 0);
+    CHECK_EQ(different, 0);
+}
+
+int main()
+{
+    return test::run_all();
+}
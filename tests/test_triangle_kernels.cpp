@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+#include "math/triangle_records.h"
+#include "math/triangle_kernels.h"
+
+namespace
+{
+
+constexpr float t_max = 1000.f;
+
+// deterministic, independent from std implementation
+struct Random
+{
+    uint32_t state{ 0x9e3779b9u };
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float uniform(float min, float max)
+    {
+        return min + (max - min) * float(next() >> 8) / float(1u << 24);
+    }
+};
+
+struct Soup
+{
+    std::vector<Vector3> positions;
+    std::vector<uint32_t> indices;
+    std::vector<TriangleRecord> records;
+    TriangleRecordPackets packets;
+};
+
+// small triangles in a box, every tenth degenerate
+Soup make_soup(uint32_t triangle_count)
+{
+    Soup soup;
+    Random random;
+    for (uint32_t i = 0; i < triangle_count; ++i) {
+        const Vector3 center(random.uniform(-20, 20), random.uniform(-20, 20), random.uniform(-20, 20));
+        for (uint32_t j = 0; j < 3; ++j) {
+            soup.indices.push_back(uint32_t(soup.positions.size()));
+            soup.positions.push_back(i % 10 == 9 ? center :
+                center + Vector3(random.uniform(-3, 3), random.uniform(-3, 3), random.uniform(-3, 3)));
+        }
+    }
+    build_triangle_records(soup.positions, soup.indices, Matrix::Identity, soup.records);
+    build_triangle_record_packets(soup.records, soup.packets);
+    return soup;
+}
+
+// ray at the center of triangle, or in random direction
+Ray make_ray(const Soup& soup, uint32_t triangle, bool aimed, Random& random)
+{
+    const Vector3* v = &soup.positions[triangle * 3];
+    const Vector3 target = (v[0] + v[1] + v[2]) / 3;
+    Ray ray;
+    ray.origin = target + Vector3(random.uniform(-8, 8), random.uniform(-8, 8), random.uniform(-8, 8));
+    ray.direction = aimed ? target - ray.origin : Vector3(random.uniform(-1, 1), random.uniform(-1, 1), random.uniform(-1, 1));
+    ray.direction.Normalize();
+    return ray;
+}
+
+// one record at a time, lower record wins a tie
+bool reference_closest(const std::vector<TriangleRecord>& records, const Ray& ray, uint32_t begin, uint32_t end, KernelHit& hit)
+{
+    bool found = false;
+    for (uint32_t i = begin; i < end; ++i) {
+        float u;
+        float v;
+        const float t = triangle_record_intersection(ray, records[i], u, v);
+        if (t > 0 && t < t_max && (!found || t < hit.t)) {
+            hit = { t, i, u, v };
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool same_hit(const KernelHit& a, const KernelHit& b)
+{
+    return a.record == b.record && a.t == b.t && a.u == b.u && a.v == b.v;
+}
+
+// mismatches of kernel against the reference for queries of random ranges
+uint32_t count_mismatches(TriangleKernel kernel, const Soup& soup, uint32_t query_count, uint32_t max_range, uint32_t& hits)
+{
+    Random random;
+    uint32_t mismatches = 0;
+    hits = 0;
+    for (uint32_t query = 0; query < query_count; ++query) {
+        const uint32_t triangle = random.next() % soup.packets.count;
+        const Ray ray = make_ray(soup, triangle, random.next() % 4 != 0, random);
+        const uint32_t length = 1 + random.next() % max_range;
+        const uint32_t begin = triangle - std::min(triangle, random.next() % length);
+        const uint32_t end = std::min(begin + length, soup.packets.count);
+
+        KernelHit expected{};
+        KernelHit hit{};
+        const bool expected_found = reference_closest(soup.records, ray, begin, end, expected);
+        const bool found = kernel(soup.packets.data.data(), soup.packets.stride, begin, end, kernel_ray(ray), t_max, hit);
+        if (found != expected_found || (found && !same_hit(hit, expected))) {
+            ++mismatches;
+        }
+        hits += found ? 1 : 0;
+    }
+    return mismatches;
+}
+
+} // namespace
+
+TEST_CASE(packets_keep_record_order_and_pad)
+{
+    const Soup soup = make_soup(37);
+    CHECK_EQ(soup.packets.count, 37);
+    CHECK_EQ(soup.packets.stride, 37 + TriangleRecordPackets::max_packet_width);
+    CHECK_EQ(soup.packets.data.size(), 12 * soup.packets.stride);
+    for (uint32_t i = 0; i < soup.packets.count; ++i) {
+        CHECK(soup.packets.data[i] == soup.records[i].row0.x);
+        CHECK(soup.packets.data[11 * soup.packets.stride + i] == soup.records[i].row2.w);
+    }
+}
+
+TEST_CASE(scalar_kernel_is_always_supported)
+{
+    CHECK(triangle_kernel(SimdLevel::scalar) != nullptr);
+    CHECK(triangle_kernel(supported_simd_level()) != nullptr);
+    for (uint32_t level = uint32_t(supported_simd_level()) + 1; level < uint32_t(SimdLevel::count); ++level) {
+        CHECK(triangle_kernel(SimdLevel(level)) == nullptr);
+    }
+}
+
+// every kernel the CPU runs gives the same record, t, u and v as one by one triangle_record_intersection
+TEST_CASE(kernels_are_bit_exact_with_reference)
+{
+    const Soup soup = make_soup(4000);
+    for (uint32_t level = 0; level <= uint32_t(supported_simd_level()); ++level) {
+        const TriangleKernel kernel = triangle_kernel(SimdLevel(level));
+        uint32_t hits = 0;
+        const uint32_t mismatches = count_mismatches(kernel, soup, 20000, 256, hits);
+        if (mismatches != 0) {
+            printf("  %s: %u mismatches\n", simd_level_name(SimdLevel(level)), mismatches);
+        }
+        CHECK_EQ(mismatches, 0);
+        // aimed rays must mostly hit, otherwise the comparison proves little
+        CHECK(hits > 20000 / 2);
+    }
+}
+
+// ranges shorter than a packet and starting at any lane are masked
+TEST_CASE(partial_packets_are_masked)
+{
+    const Soup soup = make_soup(64);
+    Random random;
+    for (uint32_t level = 0; level <= uint32_t(supported_simd_level()); ++level) {
+        const TriangleKernel kernel = triangle_kernel(SimdLevel(level));
+        for (uint32_t begin = 0; begin < 40; ++begin) {
+            for (uint32_t end = begin; end <= begin + 2 * TriangleRecordPackets::max_packet_width + 1 && end <= 64; ++end) {
+                // aimed just outside the range, the kernel must not see it
+                const uint32_t outside = end < 64 ? end : (begin > 0 ? begin - 1 : 0);
+                const Ray ray = make_ray(soup, outside, true, random);
+                KernelHit expected{};
+                KernelHit hit{};
+                const bool expected_found = reference_closest(soup.records, ray, begin, end, expected);
+                const bool found = kernel(soup.packets.data.data(), soup.packets.stride, begin, end, kernel_ray(ray), t_max, hit);
+                CHECK(found == expected_found);
+                if (found && expected_found) {
+                    CHECK(same_hit(hit, expected));
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    return test::run_all();
+}
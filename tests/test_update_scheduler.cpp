@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+#include "voxels/update_scheduler.h"
+#include "voxels/voxel_frame.h"
+
+namespace
+{
+
+constexpr int32_t grid_dimension = 32;
+constexpr float grid_size = 32.f;
+constexpr int32_t brick_dim = 8;
+constexpr uint32_t brick_voxels = brick_dim * brick_dim * brick_dim;
+constexpr uint32_t brick_count = (grid_dimension / brick_dim) * (grid_dimension / brick_dim) * (grid_dimension / brick_dim);
+
+const Vector3 camera_position(0.f, 0.f, 0.f);
+const Vector3 camera_forward(0.f, 0.f, 1.f);
+
+VoxelGridFrame grid()
+{
+    return VoxelGridFrame::from_camera(camera_position, camera_forward, grid_size, grid_dimension);
+}
+
+VoxelUpdateScheduler make_scheduler(uint32_t voxel_budget, float time_budget_ms = 0.f)
+{
+    VoxelUpdateScheduler::Settings settings;
+    settings.brick_dim = brick_dim;
+    settings.voxel_budget = voxel_budget;
+    settings.time_budget_ms = time_budget_ms;
+    VoxelUpdateScheduler scheduler;
+    scheduler.initialize(grid_dimension, settings);
+    return scheduler;
+}
+
+} // namespace
+
+TEST_CASE(voxel_budget_limits_scheduled_voxels)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(4 * brick_voxels);
+    CHECK_EQ(scheduler.brick_count(), brick_count);
+    for (int frame = 0; frame < 8; ++frame) {
+        const std::vector<uint32_t>& bricks = scheduler.schedule(grid(), camera_position);
+        CHECK_EQ(bricks.size(), 4);
+        CHECK(scheduler.scheduled_voxel_count() <= 4 * brick_voxels);
+    }
+}
+
+TEST_CASE(budget_below_one_brick_still_issues_one)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(1);
+    CHECK_EQ(scheduler.schedule(grid(), camera_position).size(), 1);
+    CHECK_EQ(scheduler.scheduled_voxel_count(), brick_voxels);
+}
+
+TEST_CASE(unlimited_budget_updates_whole_grid)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(0);
+    CHECK_EQ(scheduler.schedule(grid(), camera_position).size(), brick_count);
+    CHECK_EQ(scheduler.dirty_brick_count(), 0);
+}
+
+TEST_CASE(every_brick_is_updated_once_before_convergence)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(4 * brick_voxels);
+    std::vector<uint32_t> updates(brick_count, 0);
+    const uint32_t frames = brick_count / 4;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        for (uint32_t brick : scheduler.schedule(grid(), camera_position)) {
+            ++updates[brick];
+        }
+    }
+    CHECK_EQ(scheduler.dirty_brick_count(), 0);
+    CHECK(std::all_of(updates.begin(), updates.end(), [](uint32_t count) { return count == 1; }));
+}
+
+TEST_CASE(nearest_dirty_brick_goes_first)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(brick_voxels);
+    const uint32_t first = scheduler.schedule(grid(), camera_position).front();
+
+    // camera is in the middle of the grid, the first brick is one of the eight around it
+    int32_t coord[3];
+    scheduler.brick_coord(first, coord);
+    const int32_t center = grid_dimension / brick_dim / 2;
+    for (int32_t i = 0; i < 3; ++i) {
+        CHECK(coord[i] == center - 1 || coord[i] == center);
+    }
+}
+
+TEST_CASE(dirty_brick_beats_older_clean_ones)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(brick_voxels);
+    for (uint32_t frame = 0; frame < brick_count; ++frame) {
+        scheduler.schedule(grid(), camera_position);
+    }
+    CHECK_EQ(scheduler.dirty_brick_count(), 0);
+
+    // farthest corner, the oldest update would go first without it
+    const uint32_t corner = brick_count - 1;
+    scheduler.mark_dirty(corner);
+    CHECK_EQ(scheduler.dirty_brick_count(), 1);
+    CHECK_EQ(scheduler.schedule(grid(), camera_position).front(), corner);
+    CHECK_EQ(scheduler.dirty_brick_count(), 0);
+}
+
+TEST_CASE(dirty_box_marks_covered_bricks)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(0);
+    scheduler.schedule(grid(), camera_position);
+    // voxels [0, 9] cover bricks 0 and 1 on every axis
+    scheduler.mark_dirty(Vector3(0.f, 0.f, 0.f), Vector3(9.f, 9.f, 9.f));
+    CHECK_EQ(scheduler.dirty_brick_count(), 8);
+    // box outside of the grid
+    scheduler.mark_dirty(Vector3(-20.f, -20.f, -20.f), Vector3(-10.f, -10.f, -10.f));
+    CHECK_EQ(scheduler.dirty_brick_count(), 8);
+}
+
+TEST_CASE(border_bricks_are_cut)
+{
+    VoxelUpdateScheduler::Settings settings;
+    settings.brick_dim = brick_dim;
+    VoxelUpdateScheduler scheduler;
+    scheduler.initialize(20, settings);
+    CHECK_EQ(scheduler.bricks_per_axis(), 3);
+    CHECK_EQ(scheduler.brick_voxel_count(0), brick_voxels);
+    CHECK_EQ(scheduler.brick_voxel_count(scheduler.brick_count() - 1), 4 * 4 * 4);
+}
+
+TEST_CASE(time_budget_applies_after_first_cost_report)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(0, 1.f);
+    // no cost known yet, nothing limits the first frame
+    CHECK_EQ(scheduler.schedule(grid(), camera_position).size(), brick_count);
+
+    // 2 ms for the whole grid, 1 ms of budget is half of it
+    scheduler.report_frame_cost(2.f);
+    CHECK(scheduler.ms_per_voxel() > 0.f);
+    scheduler.mark_all_dirty();
+    CHECK_EQ(scheduler.schedule(grid(), camera_position).size(), brick_count / 2);
+
+    // cost goes up, budget follows it
+    scheduler.report_frame_cost(4.f);
+    scheduler.schedule(grid(), camera_position);
+    CHECK(scheduler.scheduled_voxel_count() < brick_count / 2 * brick_voxels);
+}
+
+TEST_CASE(voxel_budget_caps_time_budget)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(2 * brick_voxels, 1000.f);
+    scheduler.schedule(grid(), camera_position);
+    scheduler.report_frame_cost(0.001f);
+    CHECK_EQ(scheduler.schedule(grid(), camera_position).size(), 2);
+}
+
+TEST_CASE(late_cost_report_uses_its_own_voxels)
+{
+    VoxelUpdateScheduler scheduler = make_scheduler(0, 1.f);
+    scheduler.schedule(grid(), camera_position);
+    // GPU time of a frame in flight comes with the voxels of that frame, not the last schedule
+    scheduler.report_frame_cost(2.f, brick_count * brick_voxels);
+    scheduler.report_frame_cost(5.f, 0);
+    scheduler.mark_all_dirty();
+    CHECK_EQ(scheduler.schedule(grid(), camera_position).size(), brick_count / 2);
+}
+
+TEST_CASE(schedule_is_deterministic)
+{
+    VoxelUpdateScheduler a = make_scheduler(3 * brick_voxels);
+    VoxelUpdateScheduler b = make_scheduler(3 * brick_voxels);
+    for (int frame = 0; frame < 40; ++frame) {
+        if (frame == 17) {
+            a.mark_all_dirty();
+            b.mark_all_dirty();
+        }
+        const std::vector<uint32_t> bricks_a = a.schedule(grid(), camera_position);
+        const std::vector<uint32_t>& bricks_b = b.schedule(grid(), camera_position);
+        CHECK(bricks_a == bricks_b);
+    }
+}
+
+TEST_CASE(convergence_shortens_with_budget)
+{
+    // camera moves for 10 frames, then stays
+    std::vector<CameraSample> path;
+    for (int i = 0; i < 30; ++i) {
+        path.push_back({ Vector3(float(std::min(i, 10)), 0.f, 0.f), camera_forward });
+    }
+    VoxelUpdateScheduler::Settings settings;
+    settings.brick_dim = brick_dim;
+    const std::vector<SchedulerConvergence> report = measure_scheduler_convergence(path, grid_size, grid_dimension,
+        { brick_voxels, 8 * brick_voxels, 0 }, settings);
+    CHECK_EQ(report.size(), 3);
+    CHECK_EQ(report[0].frames_to_converge, brick_count);
+    CHECK_EQ(report[1].frames_to_converge, brick_count / 8);
+    CHECK_EQ(report[2].frames_to_converge, 1);
+    CHECK(report[0].mean_clean_fraction < report[1].mean_clean_fraction);
+    CHECK(report[1].mean_clean_fraction < report[2].mean_clean_fraction);
+}
+
+TEST_CASE(voxel_frame_outdates_grid_on_camera_or_model_move)
+{
+    MeshInstanceTable table;
+    VoxelFrame frame;
+    VoxelUpdateScheduler::Settings settings;
+    settings.brick_dim = brick_dim;
+    settings.voxel_budget = brick_voxels;
+    frame.initialize(&table, grid_size, grid_dimension, settings);
+    frame.add_model(Matrix::Identity);
+
+    const auto converge = [&frame](const Vector3& position) {
+        for (uint32_t i = 0; i < brick_count; ++i) {
+            frame.update(position, camera_forward);
+        }
+        return frame.scheduler().dirty_brick_count();
+    };
+    CHECK_EQ(converge(camera_position), 0);
+    // still camera keeps the grid
+    frame.update(camera_position, camera_forward);
+    CHECK_EQ(frame.scheduler().dirty_brick_count(), 0);
+
+    const Vector3 moved(1.f, 0.f, 0.f);
+    frame.update(moved, camera_forward);
+    CHECK_EQ(frame.scheduler().dirty_brick_count(), brick_count - 1);
+    CHECK_EQ(converge(moved), 0);
+
+    frame.update_transform(0, Matrix::CreateTranslation(moved));
+    CHECK(table.transforms()[0].transform == Matrix::CreateTranslation(moved));
+    frame.update(moved, camera_forward);
+    CHECK_EQ(frame.scheduler().dirty_brick_count(), brick_count - 1);
+    CHECK_EQ(frame.camera_samples().size(), 2 * brick_count + 3);
+}
+
+int main()
+{
+    return test::run_all();
+}
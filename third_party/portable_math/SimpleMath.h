@@ -0,0 +1,409 @@
+#pragma once
+
+// Subset of DirectXTK SimpleMath for headless builds off Windows, where DirectXMath isn't available.
+// Same layout and conventions: row vectors, v * M, row major matrices, right handed coordinates.
+// Only what device free sources use, add members with the DirectXTK signature when more is needed.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef _WIN32
+typedef unsigned int UINT;
+#endif
+
+namespace DirectX
+{
+namespace SimpleMath
+{
+
+struct Matrix;
+
+struct Vector2
+{
+    float x{ 0.f };
+    float y{ 0.f };
+
+    Vector2() = default;
+    constexpr explicit Vector2(float ix) : x(ix), y(ix) {}
+    constexpr Vector2(float ix, float iy) : x(ix), y(iy) {}
+
+    bool operator==(const Vector2& v) const { return x == v.x && y == v.y; }
+    bool operator!=(const Vector2& v) const { return !(*this == v); }
+};
+
+struct Vector3
+{
+    float x{ 0.f };
+    float y{ 0.f };
+    float z{ 0.f };
+
+    Vector3() = default;
+    constexpr explicit Vector3(float ix) : x(ix), y(ix), z(ix) {}
+    constexpr Vector3(float ix, float iy, float iz) : x(ix), y(iy), z(iz) {}
+    explicit Vector3(const float* array) : x(array[0]), y(array[1]), z(array[2]) {}
+
+    bool operator==(const Vector3& v) const { return x == v.x && y == v.y && z == v.z; }
+    bool operator!=(const Vector3& v) const { return !(*this == v); }
+
+    Vector3& operator+=(const Vector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+    Vector3& operator-=(const Vector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    Vector3& operator*=(const Vector3& v) { x *= v.x; y *= v.y; z *= v.z; return *this; }
+    Vector3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+    Vector3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+
+    Vector3 operator+() const { return *this; }
+    Vector3 operator-() const { return Vector3(-x, -y, -z); }
+
+    float Length() const { return std::sqrt(LengthSquared()); }
+    float LengthSquared() const { return Dot(*this); }
+    float Dot(const Vector3& v) const { return x * v.x + y * v.y + z * v.z; }
+    Vector3 Cross(const Vector3& v) const { return Vector3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x); }
+
+    void Normalize() { Normalize(*this); }
+    void Normalize(Vector3& result) const
+    {
+        const float length = Length();
+        const float inverse = length > 0.f ? 1.f / length : 0.f;
+        result = Vector3(x * inverse, y * inverse, z * inverse);
+    }
+
+    static float Distance(const Vector3& v1, const Vector3& v2) { return Vector3(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z).Length(); }
+    static float DistanceSquared(const Vector3& v1, const Vector3& v2) { return Vector3(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z).LengthSquared(); }
+    static Vector3 Min(const Vector3& v1, const Vector3& v2) { return Vector3(std::fmin(v1.x, v2.x), std::fmin(v1.y, v2.y), std::fmin(v1.z, v2.z)); }
+    static Vector3 Max(const Vector3& v1, const Vector3& v2) { return Vector3(std::fmax(v1.x, v2.x), std::fmax(v1.y, v2.y), std::fmax(v1.z, v2.z)); }
+    static Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t) { return Vector3(v1.x + (v2.x - v1.x) * t, v1.y + (v2.y - v1.y) * t, v1.z + (v2.z - v1.z) * t); }
+
+    static Vector3 Transform(const Vector3& v, const Matrix& m);
+    static void Transform(const Vector3* varray, size_t count, const Matrix& m, Vector3* result);
+    static Vector3 TransformNormal(const Vector3& v, const Matrix& m);
+    static void TransformNormal(const Vector3* varray, size_t count, const Matrix& m, Vector3* result);
+
+    static const Vector3 Zero;
+    static const Vector3 One;
+    static const Vector3 UnitX;
+    static const Vector3 UnitY;
+    static const Vector3 UnitZ;
+    static const Vector3 Up;
+    static const Vector3 Down;
+    static const Vector3 Right;
+    static const Vector3 Left;
+    static const Vector3 Forward;
+    static const Vector3 Backward;
+};
+
+inline Vector3 operator+(const Vector3& v1, const Vector3& v2) { return Vector3(v1.x + v2.x, v1.y + v2.y, v1.z + v2.z); }
+inline Vector3 operator-(const Vector3& v1, const Vector3& v2) { return Vector3(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z); }
+inline Vector3 operator*(const Vector3& v1, const Vector3& v2) { return Vector3(v1.x * v2.x, v1.y * v2.y, v1.z * v2.z); }
+inline Vector3 operator*(const Vector3& v, float s) { return Vector3(v.x * s, v.y * s, v.z * s); }
+inline Vector3 operator*(float s, const Vector3& v) { return v * s; }
+inline Vector3 operator/(const Vector3& v1, const Vector3& v2) { return Vector3(v1.x / v2.x, v1.y / v2.y, v1.z / v2.z); }
+inline Vector3 operator/(const Vector3& v, float s) { return Vector3(v.x / s, v.y / s, v.z / s); }
+
+inline const Vector3 Vector3::Zero{ 0.f, 0.f, 0.f };
+inline const Vector3 Vector3::One{ 1.f, 1.f, 1.f };
+inline const Vector3 Vector3::UnitX{ 1.f, 0.f, 0.f };
+inline const Vector3 Vector3::UnitY{ 0.f, 1.f, 0.f };
+inline const Vector3 Vector3::UnitZ{ 0.f, 0.f, 1.f };
+inline const Vector3 Vector3::Up{ 0.f, 1.f, 0.f };
+inline const Vector3 Vector3::Down{ 0.f, -1.f, 0.f };
+inline const Vector3 Vector3::Right{ 1.f, 0.f, 0.f };
+inline const Vector3 Vector3::Left{ -1.f, 0.f, 0.f };
+inline const Vector3 Vector3::Forward{ 0.f, 0.f, -1.f };
+inline const Vector3 Vector3::Backward{ 0.f, 0.f, 1.f };
+
+struct Vector4
+{
+    float x{ 0.f };
+    float y{ 0.f };
+    float z{ 0.f };
+    float w{ 0.f };
+
+    Vector4() = default;
+    constexpr explicit Vector4(float ix) : x(ix), y(ix), z(ix), w(ix) {}
+    constexpr Vector4(float ix, float iy, float iz, float iw) : x(ix), y(iy), z(iz), w(iw) {}
+    constexpr Vector4(const Vector3& v, float iw) : x(v.x), y(v.y), z(v.z), w(iw) {}
+
+    bool operator==(const Vector4& v) const { return x == v.x && y == v.y && z == v.z && w == v.w; }
+    bool operator!=(const Vector4& v) const { return !(*this == v); }
+};
+
+struct Quaternion
+{
+    float x{ 0.f };
+    float y{ 0.f };
+    float z{ 0.f };
+    float w{ 1.f };
+
+    Quaternion() = default;
+    constexpr Quaternion(float ix, float iy, float iz, float iw) : x(ix), y(iy), z(iz), w(iw) {}
+
+    bool operator==(const Quaternion& q) const { return x == q.x && y == q.y && z == q.z && w == q.w; }
+    bool operator!=(const Quaternion& q) const { return !(*this == q); }
+
+    static Quaternion CreateFromAxisAngle(const Vector3& axis, float angle)
+    {
+        const float s = std::sin(angle * 0.5f);
+        return Quaternion(axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f));
+    }
+
+    static const Quaternion Identity;
+};
+
+inline const Quaternion Quaternion::Identity{ 0.f, 0.f, 0.f, 1.f };
+
+struct Matrix
+{
+    float _11{ 1.f }, _12{ 0.f }, _13{ 0.f }, _14{ 0.f };
+    float _21{ 0.f }, _22{ 1.f }, _23{ 0.f }, _24{ 0.f };
+    float _31{ 0.f }, _32{ 0.f }, _33{ 1.f }, _34{ 0.f };
+    float _41{ 0.f }, _42{ 0.f }, _43{ 0.f }, _44{ 1.f };
+
+    Matrix() = default;
+    constexpr Matrix(float m00, float m01, float m02, float m03,
+                     float m10, float m11, float m12, float m13,
+                     float m20, float m21, float m22, float m23,
+                     float m30, float m31, float m32, float m33)
+        : _11(m00), _12(m01), _13(m02), _14(m03),
+          _21(m10), _22(m11), _23(m12), _24(m13),
+          _31(m20), _32(m21), _33(m22), _34(m23),
+          _41(m30), _42(m31), _43(m32), _44(m33)
+    {
+    }
+    Matrix(const Vector3& r0, const Vector3& r1, const Vector3& r2)
+        : _11(r0.x), _12(r0.y), _13(r0.z),
+          _21(r1.x), _22(r1.y), _23(r1.z),
+          _31(r2.x), _32(r2.y), _33(r2.z)
+    {
+    }
+
+    float operator()(size_t row, size_t column) const { return (&_11)[row * 4 + column]; }
+    float& operator()(size_t row, size_t column) { return (&_11)[row * 4 + column]; }
+
+    bool operator==(const Matrix& m) const
+    {
+        for (size_t i = 0; i < 16; ++i) {
+            if ((&_11)[i] != (&m._11)[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const Matrix& m) const { return !(*this == m); }
+
+    Matrix& operator*=(const Matrix& m) { *this = *this * m; return *this; }
+    Matrix operator*(const Matrix& m) const
+    {
+        Matrix result;
+        for (size_t r = 0; r < 4; ++r) {
+            for (size_t c = 0; c < 4; ++c) {
+                result(r, c) = (*this)(r, 0) * m(0, c) + (*this)(r, 1) * m(1, c) + (*this)(r, 2) * m(2, c) + (*this)(r, 3) * m(3, c);
+            }
+        }
+        return result;
+    }
+
+    Vector3 Up() const { return Vector3(_21, _22, _23); }
+    Vector3 Down() const { return Vector3(-_21, -_22, -_23); }
+    Vector3 Right() const { return Vector3(_11, _12, _13); }
+    Vector3 Left() const { return Vector3(-_11, -_12, -_13); }
+    Vector3 Forward() const { return Vector3(-_31, -_32, -_33); }
+    Vector3 Backward() const { return Vector3(_31, _32, _33); }
+    Vector3 Translation() const { return Vector3(_41, _42, _43); }
+    void Translation(const Vector3& v) { _41 = v.x; _42 = v.y; _43 = v.z; }
+
+    Matrix Transpose() const
+    {
+        Matrix result;
+        Transpose(result);
+        return result;
+    }
+    void Transpose(Matrix& result) const
+    {
+        const Matrix m = *this;
+        for (size_t r = 0; r < 4; ++r) {
+            for (size_t c = 0; c < 4; ++c) {
+                result(r, c) = m(c, r);
+            }
+        }
+    }
+
+    // cofactor expansion; a singular matrix gives zero matrix like XMMatrixInverse gives infinities, callers don't invert those
+    Matrix Invert() const
+    {
+        Matrix result;
+        Invert(result);
+        return result;
+    }
+    void Invert(Matrix& result) const
+    {
+        const float* m = &_11;
+        float inv[16];
+        inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+        inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+        inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+        inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+        inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+        inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+        inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+        inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+        inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+        inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+        inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+        inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+        inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+        inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+        inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+        inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+        const float determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+        const float inverse = determinant != 0.f ? 1.f / determinant : 0.f;
+        float* out = &result._11;
+        for (size_t i = 0; i < 16; ++i) {
+            out[i] = inv[i] * inverse;
+        }
+    }
+
+    float Determinant() const
+    {
+        const Matrix& m = *this;
+        const float a = m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2);
+        const float b = m(2, 1) * m(3, 3) - m(2, 3) * m(3, 1);
+        const float c = m(2, 1) * m(3, 2) - m(2, 2) * m(3, 1);
+        const float d = m(2, 0) * m(3, 3) - m(2, 3) * m(3, 0);
+        const float e = m(2, 0) * m(3, 2) - m(2, 2) * m(3, 0);
+        const float f = m(2, 0) * m(3, 1) - m(2, 1) * m(3, 0);
+        return m(0, 0) * (m(1, 1) * a - m(1, 2) * b + m(1, 3) * c)
+             - m(0, 1) * (m(1, 0) * a - m(1, 2) * d + m(1, 3) * e)
+             + m(0, 2) * (m(1, 0) * b - m(1, 1) * d + m(1, 3) * f)
+             - m(0, 3) * (m(1, 0) * c - m(1, 1) * e + m(1, 2) * f);
+    }
+
+    static Matrix CreateTranslation(const Vector3& position)
+    {
+        Matrix result;
+        result.Translation(position);
+        return result;
+    }
+    static Matrix CreateTranslation(float x, float y, float z) { return CreateTranslation(Vector3(x, y, z)); }
+
+    static Matrix CreateScale(const Vector3& scales)
+    {
+        Matrix result;
+        result._11 = scales.x;
+        result._22 = scales.y;
+        result._33 = scales.z;
+        return result;
+    }
+    static Matrix CreateScale(float xs, float ys, float zs) { return CreateScale(Vector3(xs, ys, zs)); }
+    static Matrix CreateScale(float scale) { return CreateScale(Vector3(scale)); }
+
+    static Matrix CreateRotationX(float radians)
+    {
+        const float c = std::cos(radians);
+        const float s = std::sin(radians);
+        Matrix result;
+        result._22 = c;
+        result._23 = s;
+        result._32 = -s;
+        result._33 = c;
+        return result;
+    }
+    static Matrix CreateRotationY(float radians)
+    {
+        const float c = std::cos(radians);
+        const float s = std::sin(radians);
+        Matrix result;
+        result._11 = c;
+        result._13 = -s;
+        result._31 = s;
+        result._33 = c;
+        return result;
+    }
+    static Matrix CreateRotationZ(float radians)
+    {
+        const float c = std::cos(radians);
+        const float s = std::sin(radians);
+        Matrix result;
+        result._11 = c;
+        result._12 = s;
+        result._21 = -s;
+        result._22 = c;
+        return result;
+    }
+
+    static Matrix CreateFromQuaternion(const Quaternion& q)
+    {
+        const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+        return Matrix(1.f - 2.f * (yy + zz), 2.f * (xy + wz), 2.f * (xz - wy), 0.f,
+                      2.f * (xy - wz), 1.f - 2.f * (xx + zz), 2.f * (yz + wx), 0.f,
+                      2.f * (xz + wy), 2.f * (yz - wx), 1.f - 2.f * (xx + yy), 0.f,
+                      0.f, 0.f, 0.f, 1.f);
+    }
+
+    static Matrix CreateLookAt(const Vector3& position, const Vector3& target, const Vector3& up)
+    {
+        // right handed, camera looks along -z
+        Vector3 z = position - target;
+        z.Normalize();
+        Vector3 x = up.Cross(z);
+        x.Normalize();
+        const Vector3 y = z.Cross(x);
+        return Matrix(x.x, y.x, z.x, 0.f,
+                      x.y, y.y, z.y, 0.f,
+                      x.z, y.z, z.z, 0.f,
+                      -x.Dot(position), -y.Dot(position), -z.Dot(position), 1.f);
+    }
+
+    static Matrix CreatePerspectiveFieldOfView(float fov, float aspect_ratio, float near_plane, float far_plane)
+    {
+        // right handed, depth in [0, 1]
+        const float y_scale = 1.f / std::tan(fov * 0.5f);
+        const float x_scale = y_scale / aspect_ratio;
+        const float range = far_plane / (near_plane - far_plane);
+        return Matrix(x_scale, 0.f, 0.f, 0.f,
+                      0.f, y_scale, 0.f, 0.f,
+                      0.f, 0.f, range, -1.f,
+                      0.f, 0.f, range * near_plane, 0.f);
+    }
+
+    static const Matrix Identity;
+};
+
+inline const Matrix Matrix::Identity{};
+
+inline Vector3 Vector3::Transform(const Vector3& v, const Matrix& m)
+{
+    // w of 1, result is divided by w as XMVector3TransformCoord does
+    const float x = v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41;
+    const float y = v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42;
+    const float z = v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43;
+    const float w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44;
+    return w == 1.f ? Vector3(x, y, z) : Vector3(x / w, y / w, z / w);
+}
+
+inline void Vector3::Transform(const Vector3* varray, size_t count, const Matrix& m, Vector3* result)
+{
+    for (size_t i = 0; i < count; ++i) {
+        result[i] = Transform(varray[i], m);
+    }
+}
+
+inline Vector3 Vector3::TransformNormal(const Vector3& v, const Matrix& m)
+{
+    return Vector3(v.x * m._11 + v.y * m._21 + v.z * m._31,
+                   v.x * m._12 + v.y * m._22 + v.z * m._32,
+                   v.x * m._13 + v.y * m._23 + v.z * m._33);
+}
+
+inline void Vector3::TransformNormal(const Vector3* varray, size_t count, const Matrix& m, Vector3* result)
+{
+    for (size_t i = 0; i < count; ++i) {
+        result[i] = TransformNormal(varray[i], m);
+    }
+}
+
+} // namespace SimpleMath
+} // namespace DirectX
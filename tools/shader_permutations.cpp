@@ -0,0 +1,113 @@
+// Compiles every permutation of shader options of one stage into the content-hashed shader cache.
+// Blobs already in the cache are skipped, their key covers the source, includes, stage and defines.
+//
+// shader_permutations --compiler <dxc> --cache <dir> --stage <vertex|geometry|pixel|compute>
+//                     --entry <name> --profile <target> [-I <dir>]... <shader>...
+//
+// Compiler is called as dxc: <compiler> -E <entry> -T <profile> -D NAME=VALUE... -I <dir>... -Fo <blob> <shader>,
+// any program accepting these arguments (e.g. a stub writing its arguments) can stand in for it.
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "render/resource/shader_cache.h"
+
+namespace
+{
+std::string quote(const std::string& argument)
+{
+    return "\"" + argument + "\"";
+}
+
+int usage()
+{
+    fprintf(stderr, "usage: shader_permutations --compiler <path> --cache <dir> --stage <stage> --entry <name> --profile <target> "
+                    "[-I <dir>]... <shader>...\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string compiler;
+    std::string cache_dir;
+    std::string stage;
+    std::string entry;
+    std::string profile;
+    std::vector<std::string> include_dirs;
+    std::vector<std::string> shaders;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (argument == "--compiler" && has_value) {
+            compiler = argv[++i];
+        } else if (argument == "--cache" && has_value) {
+            cache_dir = argv[++i];
+        } else if (argument == "--stage" && has_value) {
+            stage = argv[++i];
+        } else if (argument == "--entry" && has_value) {
+            entry = argv[++i];
+        } else if (argument == "--profile" && has_value) {
+            profile = argv[++i];
+        } else if (argument == "-I" && has_value) {
+            include_dirs.push_back(argv[++i]);
+        } else if (argument.compare(0, 1, "-") == 0) {
+            return usage();
+        } else {
+            shaders.push_back(argument);
+        }
+    }
+    if (compiler.empty() || cache_dir.empty() || stage.empty() || entry.empty() || profile.empty()) {
+        return usage();
+    }
+
+    std::filesystem::create_directories(cache_dir);
+
+    uint32_t compiled = 0;
+    uint32_t cached = 0;
+    for (const std::string& shader : shaders) {
+        const ShaderSource source = read_shader_source(shader, include_dirs);
+        if (!source.valid) {
+            fprintf(stderr, "%s: can't read\n", shader.c_str());
+            return 1;
+        }
+
+        for (const std::vector<std::string>& defines : shader_permutations(source.options)) {
+            const std::string blob = (std::filesystem::path(cache_dir) / shader_blob_name(shader_key(source, stage, defines), stage)).string();
+
+            std::string description = shader + "." + stage;
+            for (const std::string& define : defines) {
+                description += " " + define;
+            }
+            if (std::filesystem::exists(blob)) {
+                ++cached;
+                continue;
+            }
+
+            std::string command = quote(compiler) + " -E " + quote(entry) + " -T " + quote(profile) + " -Zi -Fd " + quote(blob + ".pdb");
+            for (const std::string& define : defines) {
+                command += " -D " + quote(define);
+            }
+            for (const std::string& include_dir : include_dirs) {
+                command += " -I " + quote(include_dir);
+            }
+            command += " -Fo " + quote(blob) + " " + quote(shader);
+#if defined(_WIN32)
+            // cmd strips the outer quotes of the whole line
+            command = quote(command);
+#endif
+            printf("%s\n", description.c_str());
+            if (std::system(command.c_str()) != 0 || !std::filesystem::exists(blob)) {
+                fprintf(stderr, "%s: compilation failed\n", description.c_str());
+                std::filesystem::remove(blob);
+                return 1;
+            }
+            ++compiled;
+        }
+    }
+    printf("%s: %u permutations compiled, %u up to date\n", stage.c_str(), compiled, cached);
+    return 0;
+}